@@ -0,0 +1,63 @@
+# Copyright (C) Kreogist Dev Team
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+# The micro benchmark of the sample processing code in the playing thread and
+# the album art cache of the library. It prints the time used by processing the
+# samples as a percentage of one core, and the import, recovery and paint fetch
+# costs of a synthetic library.
+TEMPLATE = app
+TARGET = mu-benchmark
+
+# Add Qt modules, the music utilities need the image and color.
+QT += \
+    core \
+    gui
+
+# Enabled C++ 11 configures.
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# Use the same instruction sets as the main project.
+gcc: {
+    QMAKE_CXXFLAGS_RELEASE += -mmmx -msse -msse2 -msse3
+}
+
+# The benchmarked code is compiled from the main project.
+MUSIC_SDK = ../src/plugin/knmusicplugin/sdk
+LIBRARY_SDK = ../src/plugin/knmusicplugin/plugin/knmusiclibrary/sdk
+
+INCLUDEPATH += \
+    $$MUSIC_SDK \
+    $$LIBRARY_SDK
+
+# Source and Headers.
+SOURCES += \
+    main.cpp \
+    $$MUSIC_SDK/knmusicdspequalizer.cpp \
+    $$MUSIC_SDK/knmusicdspgain.cpp \
+    $$MUSIC_SDK/knmusicdsplimiter.cpp \
+    $$MUSIC_SDK/knmusicdspchain.cpp \
+    $$MUSIC_SDK/knmusicspectrumanalyser.cpp \
+    $$LIBRARY_SDK/knmusiclibraryimagecache.cpp
+
+HEADERS += \
+    $$MUSIC_SDK/knmusicdspprocessor.h \
+    $$MUSIC_SDK/knmusicdspequalizer.h \
+    $$MUSIC_SDK/knmusicdspgain.h \
+    $$MUSIC_SDK/knmusicdsplimiter.h \
+    $$MUSIC_SDK/knmusicdspchain.h \
+    $$MUSIC_SDK/knmusicspectrumanalyser.h \
+    $$LIBRARY_SDK/knmusiclibraryimagecache.h
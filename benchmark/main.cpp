@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QGuiApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QPixmapCache>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+#include <QtMath>
+
+#include <algorithm>
+
+#include "knmusicdspchain.h"
+#include "knmusicspectrumanalyser.h"
+#include "knmusiclibraryimagecache.h"
+
+#define BenchmarkChannels 2
+#define BenchmarkFrames 1024
+#define BenchmarkSeconds 600
+#define SourceBlocks 64
+#define ReaderInterval 33
+#define SyntheticCovers 1000
+#define CoverSize 600
+#define ArtworkSize 138
+#define ScreenColumns 6
+#define ScreenRows 5
+
+using namespace MusicUtil;
+
+static QVector<float> generateSource(int sampleRate)
+{
+    //Generate a 1kHz tone with a 60Hz hum, every channel has the same sample.
+    QVector<float> source(BenchmarkFrames*BenchmarkChannels*SourceBlocks);
+    for(int i=0; i<source.size(); ++i)
+    {
+        qreal time=(qreal)(i/BenchmarkChannels)/(qreal)sampleRate;
+        source[i]=(float)(0.5*qSin(2.0*M_PI*1000.0*time)+
+                          0.3*qSin(2.0*M_PI*60.0*time));
+    }
+    return source;
+}
+
+static void benchmarkDspChain(QTextStream &output, int sampleRate)
+{
+    //Enable all the processors, every band of the equalizer is not flat. This
+    //is the heaviest work of the chain.
+    KNMusicDspChain chain;
+    chain.prepare(sampleRate, BenchmarkChannels);
+    KNMusicDspParameters parameters;
+    parameters.equalizerEnabled=true;
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        parameters.bandGains[i]=(i & 1)?6.0:-6.0;
+    }
+    parameters.preamp=3.0;
+    parameters.balance=0.3;
+    parameters.limiterEnabled=true;
+    chain.setParameters(parameters);
+    //Process the samples buffer by buffer like the playing thread, only the
+    //processing is timed.
+    QVector<float> source=generateSource(sampleRate),
+                   buffer(BenchmarkFrames*BenchmarkChannels);
+    int bufferCount=BenchmarkSeconds*sampleRate/BenchmarkFrames;
+    qint64 elapsed=0;
+    double checksum=0.0;
+    QElapsedTimer timer;
+    for(int i=0; i<bufferCount; ++i)
+    {
+        //Copy a block of the source.
+        const float *block=source.constData()+
+                (i%SourceBlocks)*BenchmarkFrames*BenchmarkChannels;
+        std::copy(block, block+buffer.size(), buffer.begin());
+        //Process the buffer.
+        timer.start();
+        chain.process(buffer.data(), BenchmarkFrames);
+        elapsed+=timer.nsecsElapsed();
+        //Use the result, so the processing won't be optimized out.
+        for(auto sample : buffer)
+        {
+            checksum+=sample;
+        }
+    }
+    //Print the result.
+    double seconds=(double)elapsed/1e9;
+    output << "DSP chain, " << sampleRate << "Hz stereo: "
+           << QString::number(seconds, 'f', 3) << "s for "
+           << BenchmarkSeconds << "s of samples, "
+           << QString::number(seconds*100.0/BenchmarkSeconds, 'f', 3)
+           << "% of one core (checksum "
+           << QString::number(checksum, 'f', 3) << ")" << endl;
+}
+
+static void benchmarkSpectrum(QTextStream &output, int sampleRate)
+{
+    //Feed the analyser buffer by buffer like the playing thread, and read the
+    //snapshot every 33ms of the samples like the spectrum view.
+    KNMusicSpectrumAnalyser analyser;
+    analyser.prepare(sampleRate, BenchmarkChannels);
+    QVector<float> source=generateSource(sampleRate), bands;
+    int bufferCount=BenchmarkSeconds*sampleRate/BenchmarkFrames,
+        readerFrames=sampleRate*ReaderInterval/1000,
+        pendingFrames=0, reads=0, snapshots=0;
+    qint64 writerElapsed=0, readerElapsed=0;
+    double checksum=0.0;
+    QElapsedTimer timer;
+    for(int i=0; i<bufferCount; ++i)
+    {
+        //Add a block of the source.
+        const float *block=source.constData()+
+                (i%SourceBlocks)*BenchmarkFrames*BenchmarkChannels;
+        timer.start();
+        analyser.addSamples(block, BenchmarkFrames);
+        writerElapsed+=timer.nsecsElapsed();
+        //Check whether it's the time to read the snapshot.
+        pendingFrames+=BenchmarkFrames;
+        if(pendingFrames<readerFrames)
+        {
+            continue;
+        }
+        pendingFrames-=readerFrames;
+        //Read the snapshot.
+        ++reads;
+        timer.start();
+        bool updated=analyser.spectrum(bands);
+        readerElapsed+=timer.nsecsElapsed();
+        if(updated)
+        {
+            //Use the result, so the analysis won't be optimized out.
+            ++snapshots;
+            for(auto level : bands)
+            {
+                checksum+=level;
+            }
+        }
+    }
+    //Print the result.
+    double seconds=(double)writerElapsed/1e9;
+    output << "Spectrum, " << sampleRate << "Hz stereo: "
+           << QString::number(seconds, 'f', 3) << "s for "
+           << BenchmarkSeconds << "s of samples, "
+           << QString::number(seconds*100.0/BenchmarkSeconds, 'f', 3)
+           << "% of one core; " << snapshots << " new snapshots in "
+           << reads << " reads, "
+           << QString::number((double)readerElapsed/reads, 'f', 0)
+           << "ns per read (checksum "
+           << QString::number(checksum, 'f', 3) << ")" << endl;
+}
+
+static QImage generateCover(int index)
+{
+    //Generate a different pattern for each cover, so all the hash keys are
+    //different.
+    QImage cover(CoverSize, CoverSize, QImage::Format_RGB32);
+    for(int y=0; y<CoverSize; ++y)
+    {
+        QRgb *line=reinterpret_cast<QRgb *>(cover.scanLine(y));
+        for(int x=0; x<CoverSize; ++x)
+        {
+            line[x]=qRgb((x+index) & 0xFF,
+                         (y+(index>>8)*37) & 0xFF,
+                         (x*y+index) & 0xFF);
+        }
+    }
+    return cover;
+}
+
+static void benchmarkImageCache(QTextStream &output)
+{
+    //Import the synthetic covers like the image manager does for the new
+    //music files, the images are saved to a temporary image folder.
+    QTemporaryDir imageFolder;
+    KNMusicLibraryImageCache importCache;
+    importCache.setImageFolderPath(imageFolder.path());
+    QStringList hashList;
+    qint64 importElapsed=0;
+    QElapsedTimer timer;
+    for(int i=0; i<SyntheticCovers; ++i)
+    {
+        QImage cover=generateCover(i);
+        timer.start();
+        QString hashKey=KNMusicLibraryImageCache::hashKey(cover);
+        importCache.insert(hashKey, cover);
+        cover.save(imageFolder.path() + "/" + hashKey + ".png", "PNG");
+        importElapsed+=timer.nsecsElapsed();
+        hashList.append(hashKey);
+    }
+    output << "Album art import, " << SyntheticCovers << " covers of "
+           << CoverSize << "px: "
+           << QString::number((double)importElapsed/1e9, 'f', 3) << "s, "
+           << QString::number((double)importElapsed/1e6/SyntheticCovers,
+                              'f', 3)
+           << "ms per cover, "
+           << importCache.statistics().residentBytes << " resident bytes"
+           << endl;
+    //Recover the covers to a new cache like loading the library.
+    KNMusicLibraryImageCache cache;
+    cache.setImageFolderPath(imageFolder.path());
+    timer.start();
+    int recoverCount=cache.recover(hashList).size();
+    qint64 recoverElapsed=timer.nsecsElapsed();
+    KNMusicLibraryImageCache::Statistics statistics=cache.statistics();
+    output << "Album art recovery: " << recoverCount << " covers in "
+           << QString::number((double)recoverElapsed/1e9, 'f', 3) << "s, "
+           << QString::number((double)statistics.decodeTime/1e6, 'f', 3)
+           << "s decoding, " << statistics.residentBytes
+           << " resident bytes" << endl;
+    //Scroll the album view through the library one row per frame, every
+    //frame fetches the album arts of the whole screen.
+    QList<qreal> devicePixelRatios;
+    devicePixelRatios << 1.0 << 2.0;
+    for(auto devicePixelRatio : devicePixelRatios)
+    {
+        QPixmapCache::clear();
+        cache.resetStatistics();
+        int rowCount=(SyntheticCovers+ScreenColumns-1)/ScreenColumns,
+            fetchCount=0;
+        qint64 paintElapsed=0, checksum=0;
+        for(int top=0; top+ScreenRows<=rowCount; ++top)
+        {
+            int first=top*ScreenColumns,
+                last=qMin(SyntheticCovers, first+ScreenRows*ScreenColumns);
+            timer.start();
+            for(int i=first; i<last; ++i)
+            {
+                //Use the result, so the fetching won't be optimized out.
+                checksum+=cache.albumArt(hashList.at(i),
+                                         ArtworkSize,
+                                         devicePixelRatio).width();
+            }
+            paintElapsed+=timer.nsecsElapsed();
+            fetchCount+=last-first;
+        }
+        statistics=cache.statistics();
+        output << "Album art paint fetch, ratio "
+               << QString::number(devicePixelRatio, 'f', 1) << ": "
+               << QString::number((double)paintElapsed/fetchCount, 'f', 0)
+               << "ns per fetch, " << statistics.hitCount << " hits, "
+               << statistics.missCount << " misses, "
+               << statistics.decodeCount << " decoded, "
+               << statistics.residentBytes << " resident bytes (checksum "
+               << checksum << ")" << endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    //The album arts need the GUI application, but no display is needed.
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    //Get the sample rates from the arguments.
+    QList<int> sampleRates;
+    QStringList arguments=app.arguments().mid(1);
+    for(const auto &i : arguments)
+    {
+        sampleRates.append(i.toInt());
+    }
+    //Use the common sample rates by default.
+    if(sampleRates.isEmpty())
+    {
+        sampleRates << 44100 << 48000 << 192000;
+    }
+    //Run the benchmarks.
+    QTextStream output(stdout);
+#ifdef ENABLE_DSP_SSE2
+    output << "SSE2 kernels enabled." << endl;
+#else
+    output << "SSE2 kernels disabled." << endl;
+#endif
+    for(auto i : sampleRates)
+    {
+        benchmarkDspChain(output, i);
+        benchmarkSpectrum(output, i);
+    }
+    benchmarkImageCache(output);
+    return EXIT_SUCCESS;
+}
@@ -19,3 +19,10 @@ TEMPLATE = subdirs
 
 # Add subdirs projects.
 SUBDIRS = src
+
+# The micro benchmark of the sample processing and the album art cache could be
+# built with "qmake CONFIG+=benchmark".
+benchmark: SUBDIRS += benchmark
+
+# The unit tests could be built with "qmake CONFIG+=tests".
+tests: SUBDIRS += tests
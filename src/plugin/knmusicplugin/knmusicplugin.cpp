@@ -34,6 +34,7 @@
 #include "knmusicparser.h"
 #include "knmusiclyricsmanager.h"
 #include "knmusiclyricsbackend.h"
+#include "knmusicpositionclock.h"
 #include "knmusicdetailtageditpanel.h"
 
 //Ports
@@ -52,6 +53,8 @@
 #include "knmusictab.h"
 #include "knmusiclyricsdownloaddialogbase.h"
 #include "knmusicminiplayerbase.h"
+#include "knmusicdsppanel.h"
+#include "knmusicplaybackpanel.h"
 
 //Plugins
 // Detail Dialog Panels.
@@ -98,6 +101,9 @@
 #ifdef ENABLE_BACKEND_GSTREAMER
 #include "plugin/knmusicbackendgstreamer/knmusicbackendgstreamer.h"
 #endif
+#ifdef ENABLE_BACKEND_FFMPEG
+#include "plugin/knmusicbackendffmpeg/knmusicbackendffmpeg.h"
+#endif
 // Analysiser
 #ifdef ENABLED_FFMPEG_ANALYSISER
 #include "plugin/knmusicffmpeganalysiser/knmusicffmpeganalysiser.h"
@@ -138,6 +144,7 @@ KNMusicPlugin::KNMusicPlugin(QWidget *parent) :
     m_showInMapper(new QSignalMapper(this)),
     m_floatPlaylistList(nullptr),
     m_flowPlaylistListAnime(new QPropertyAnimation(this)),
+    m_lyricsClock(new KNMusicPositionClock(this)),
     m_headerPlayer(nullptr),
     m_mainPlayer(nullptr),
     m_miniPlayer(nullptr),
@@ -231,8 +238,15 @@ void KNMusicPlugin::loadPlugins()
 #ifdef ENABLE_BACKEND_GSTREAMER
     initialBackend(new KNMusicBackendGStreamer);
 #endif
+#ifdef ENABLE_BACKEND_FFMPEG
+    initialBackend(new KNMusicBackendFfmpeg);
+#endif
+    //Initial the DSP preference panel when the backend supports it.
+    initialDspPanel();
     //Initial the now playing.
     initialNowPlaying(new KNMusicNowPlaying);
+    //Initial the playback preference panel after the now playing.
+    initialPlaybackPanel();
     //Iniital the detail tooltip.
     initialDetailTooltip(new KNMusicDetailTooltip);
     //Iniital the header player.
@@ -669,13 +683,30 @@ void KNMusicPlugin::initialBackend(KNMusicBackend *backend)
     //Set the parent of the backend.
     backend->setParent(this);
     //Link the backend to lyrics manager's backend.
-    connect(backend, &KNMusicBackend::positionChanged,
+    connect(backend, &KNMusicBackend::positionAnchorChanged,
+            m_lyricsClock, &KNMusicPositionClock::setAnchor);
+    connect(m_lyricsClock, &KNMusicPositionClock::positionChanged,
             knMusicGlobal->lyricsManager()->backend(),
             &KNMusicLyricsBackend::setPosition);
     //Set the backend to music global.
     knMusicGlobal->setBackend(backend);
 }
 
+void KNMusicPlugin::initialDspPanel()
+{
+    //Check whether the backend could process the samples, or else the
+    //parameters would never take effect.
+    if(knMusicGlobal->backend()==nullptr ||
+            !knMusicGlobal->backend()->isDspSupported())
+    {
+        return;
+    }
+    //Generate the panel, the saved parameters are applied to the backend.
+    KNMusicDspPanel *dspPanel=new KNMusicDspPanel;
+    //Add the panel to the preference.
+    knGlobal->addPreferenceTab(dspPanel->preferenceItem(), dspPanel);
+}
+
 void KNMusicPlugin::initialNowPlaying(KNMusicNowPlayingBase *nowPlaying)
 {
     //Set the parent of the now playing.
@@ -694,6 +725,20 @@ void KNMusicPlugin::initialNowPlaying(KNMusicNowPlayingBase *nowPlaying)
     knMusicGlobal->setNowPlaying(nowPlaying);
 }
 
+void KNMusicPlugin::initialPlaybackPanel()
+{
+    //The settings are applied by the now playing to the backend.
+    if(knMusicGlobal->backend()==nullptr ||
+            knMusicGlobal->nowPlaying()==nullptr)
+    {
+        return;
+    }
+    //Generate the panel.
+    KNMusicPlaybackPanel *playbackPanel=new KNMusicPlaybackPanel;
+    //Add the panel to the preference.
+    knGlobal->addPreferenceTab(playbackPanel->preferenceItem(), playbackPanel);
+}
+
 void KNMusicPlugin::initialDetailTooltip(KNMusicDetailTooltipBase *tooltip)
 {
     //Set the detail tooltip to music global.
@@ -728,6 +773,8 @@ void KNMusicPlugin::initialHeaderPlayer(KNMusicHeaderPlayerBase *headerPlayer)
     //Add player and lyrics to the layout.
     containerLayout->addWidget(m_headerPlayer);
     containerLayout->addWidget(m_headerPlayer->lyrics(), 1);
+    //The lyrics is updated when the header lyrics is visible.
+    m_lyricsClock->addView(m_headerPlayer->lyrics());
     //Add the header player to the header left layout.
     m_headerWidgetContainer->addWidget(container);
     //Link the header widget to the header player.
@@ -763,6 +810,8 @@ void KNMusicPlugin::initialMainPlayer(KNMusicMainPlayerBase *mainPlayer)
     m_mainPlayer=mainPlayer;
     //Set the basic stuffs of a player.
     initialPlayer(m_mainPlayer);
+    //The lyrics is updated when the main player is visible.
+    m_lyricsClock->addView(m_mainPlayer);
     //Link the request.
     connect(m_mainPlayer, &KNMusicMainPlayerBase::requireHide,
             this, &KNMusicPlugin::requireHideMainPlayer);
@@ -779,6 +828,8 @@ void KNMusicPlugin::initialMiniPlayer(KNMusicMiniPlayerBase *miniPlayer)
     m_miniPlayer=miniPlayer;
     //Set the basic stuffs of a player.
     initialPlayer(m_miniPlayer);
+    //The lyrics is updated when the mini player is visible.
+    m_lyricsClock->addView(m_miniPlayer);
     //Load the configure.
     m_miniPlayer->loadConfigure();
     //Hide the mini player.
@@ -824,6 +875,11 @@ void KNMusicPlugin::initialLibrary(KNMusicLibraryBase *library)
     m_library->setParent(this);
     //Set the now playing.
     m_library->setNowPlaying(knMusicGlobal->nowPlaying());
+    //Set the library to the main player.
+    if(m_mainPlayer!=nullptr)
+    {
+        m_mainPlayer->setLibrary(m_library);
+    }
     //Link the library show request to music plugin.
     connect(m_library, &KNMusicLibraryBase::requireShowPlaylistList,
             this, &KNMusicPlugin::onActionShowPlaylistFlow);
@@ -44,6 +44,7 @@ class KNMusicMainPlayerBase;
 class KNMusicMiniPlayerBase;
 class KNMusicLibraryBase;
 class KNMusicLyricsDownloadDialogBase;
+class KNMusicPositionClock;
 /*!
  * \brief The KNMusicCategoryPlugin class is the official music category plugin.
  * You can treat this as a example.\n
@@ -152,7 +153,9 @@ private:
 
     void initialSearch(KNMusicSearchBase *search);
     void initialBackend(KNMusicBackend *backend);
+    void initialDspPanel();
     void initialNowPlaying(KNMusicNowPlayingBase *nowPlaying);
+    void initialPlaybackPanel();
     void initialDetailTooltip(KNMusicDetailTooltipBase *tooltip);
     void initialHeaderPlayer(KNMusicHeaderPlayerBase *headerPlayer);
     void initialMainPlayer(KNMusicMainPlayerBase *mainPlayer);
@@ -172,6 +175,7 @@ private:
     QSignalMapper *m_showInMapper;
     QWidget *m_floatPlaylistList;
     QPropertyAnimation *m_flowPlaylistListAnime;
+    KNMusicPositionClock *m_lyricsClock;
 
     //Plugins.
     KNMusicHeaderPlayerBase *m_headerPlayer;
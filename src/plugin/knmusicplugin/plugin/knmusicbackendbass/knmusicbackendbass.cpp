@@ -48,9 +48,10 @@ KNMusicBackendBass::KNMusicBackendBass(QObject *parent) :
     //Load the plugins in the application folder.
     loadPlugin(knGlobal->dirPath(KNGlobal::ResourceDir) + "/Plugins/Bass");
 #endif
-    //Initial the main and preview thread.
+    //Initial the main, preview and crossfade thread.
     setMainThread(generateThread(threadFlag));
     setPreviewThread(generateThread(threadFlag));
+    setCrossfadeThread(generateThread(threadFlag));
 }
 
 KNMusicBackendBass::~KNMusicBackendBass()
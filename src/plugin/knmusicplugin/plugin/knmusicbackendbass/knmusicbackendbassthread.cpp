@@ -15,8 +15,6 @@
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
-#include <QTimer>
-
 #include "knmusicbackendbassthread.h"
 
 #include <QDebug>
@@ -32,14 +30,11 @@ KNMusicBackendBassThread::KNMusicBackendBassThread(QObject *parent) :
     m_endPosition(-1),
     m_savedPosition(-1),
     m_volume(1.0),
+    m_fadeVolume(1.0),
+    m_gainVolume(1.0),
     m_state(Stopped),
-    m_positionUpdater(new QTimer(this)),
     m_syncHandlers(QList<HSYNC>())
 {
-    //Configure the position updater.
-    m_positionUpdater->setInterval(50);
-    connect(m_positionUpdater, &QTimer::timeout,
-            this, &KNMusicBackendBassThread::checkPosition);
     //Link the reachesFinished() signal.
     connect(this, &KNMusicBackendBassThread::reachesFinished,
             this, &KNMusicBackendBassThread::finishPlaying);
@@ -47,8 +42,6 @@ KNMusicBackendBassThread::KNMusicBackendBassThread(QObject *parent) :
 
 KNMusicBackendBassThread::~KNMusicBackendBassThread()
 {
-    //Stop the position updater.
-    m_positionUpdater->stop();
     //Clear up the channel sync handle.
     removeChannelSyncs();
     //Free the channel.
@@ -66,6 +59,8 @@ bool KNMusicBackendBassThread::loadFile(const QString &filePath)
     {
         //Reset the current state.
         resetChannelInformation();
+        //Set the sync handler back.
+        setChannelSyncs();
         //Update the duration.
         emit durationChanged(m_duration);
         //Emit the load success signal.
@@ -96,8 +91,6 @@ bool KNMusicBackendBassThread::loadFile(const QString &filePath)
 
 void KNMusicBackendBassThread::reset()
 {
-    //Stop the position updater.
-    m_positionUpdater->stop();
     //Clear up the channel sync handle.
     removeChannelSyncs();
     //Check if the channel is not null.
@@ -123,12 +116,10 @@ void KNMusicBackendBassThread::stop()
     }
     //Stop the channel.
     BASS_ChannelStop(m_channel);
-    //Stop the position updater.
-    m_positionUpdater->stop();
-    //Reset the position to the start position.
-    setPosition(0);
     //Update the state.
     setPlayingState(Stopped);
+    //Reset the position to the start position.
+    setPosition(0);
     //Emit stopped signal.
     emit stopped();
 }
@@ -142,8 +133,6 @@ void KNMusicBackendBassThread::play()
     {
         return;
     }
-    //Start the position updater.
-    m_positionUpdater->start();
     //Check the playing state before.
     if(m_state==Stopped)
     {
@@ -151,12 +140,14 @@ void KNMusicBackendBassThread::play()
         setPosition(0);
         //Set the volume to the last volume, because of the reset, the
         //volume is back to 1.0.
-        BASS_ChannelSetAttribute(m_channel, BASS_ATTRIB_VOL, m_volume);
+        applyChannelVolume();
     }
     //Play the thread.
     BASS_ChannelPlay(m_channel, FALSE);
     //Update the state.
     setPlayingState(Playing);
+    //The position starts moving.
+    updatePositionAnchor(getChannelPosition());
 }
 
 void KNMusicBackendBassThread::pause()
@@ -170,16 +161,16 @@ void KNMusicBackendBassThread::pause()
     }
     //Pause the thread.
     BASS_ChannelPause(m_channel);
-    //Stop the updater.
-    m_positionUpdater->stop();
     //Reset the state.
     setPlayingState(Paused);
+    //The position stops moving.
+    updatePositionAnchor(getChannelPosition());
 }
 
 int KNMusicBackendBassThread::volume()
 {
-    //Scale the float number.
-    return (int)(getChannelVolume()*100.0);
+    //Scale the float number, the fade volume is not a part of the volume.
+    return m_channel?(int)(m_volume*100.0):0;
 }
 
 qint64 KNMusicBackendBassThread::duration()
@@ -221,6 +212,8 @@ void KNMusicBackendBassThread::setPlaySection(const qint64 &start,
         }
         //Update the end position.
         m_endPosition=m_startPosition+m_duration;
+        //Stop at the end of the section.
+        setSectionSync();
         //Emit the new duration.
         emit durationChanged(m_duration);
     }
@@ -230,8 +223,6 @@ void KNMusicBackendBassThread::save()
 {
     //Pause the thread first.
     BASS_ChannelPause(m_channel);
-    //Stop the updater.
-    m_positionUpdater->stop();
     //Save the position of the current thread.
     m_savedPosition=position();
     //Reset the current playing thread, but saved all the other parameter.
@@ -254,18 +245,20 @@ void KNMusicBackendBassThread::restore(const QString &updatedFilePath)
             updatedFilePath.isEmpty()?m_filePath:updatedFilePath;
     //Reload the bass thread.
     loadBassThread(restoreFilePath);
+    //Set the section sync back.
+    setSectionSync();
     //Reset the postion.
     setPosition(m_savedPosition);
     //Set the volume to the last volume, because of the reset, the
     //volume is back to 1.0.
-    BASS_ChannelSetAttribute(m_channel, BASS_ATTRIB_VOL, m_volume);
+    applyChannelVolume();
     //Check out the state.
     if(m_state==Playing)
     {
-        //Start the updater.
-        m_positionUpdater->start();
         //Play the thread.
         BASS_ChannelPlay(m_channel, FALSE);
+        //The position starts moving.
+        updatePositionAnchor(getChannelPosition());
     }
     //Reset the saved position.
     m_savedPosition=-1;
@@ -278,10 +271,36 @@ void KNMusicBackendBassThread::setVolume(const int &volume)
     {
         return;
     }
-    //Set the volume to channel.
-    BASS_ChannelSetAttribute(m_channel, BASS_ATTRIB_VOL, ((float)volume)/100.0);
     //Save the latest volume size.
-    m_volume=getChannelVolume();
+    m_volume=((qreal)volume)/100.0;
+    //Set the volume to channel.
+    applyChannelVolume();
+}
+
+void KNMusicBackendBassThread::setFadeVolume(const qreal &scale)
+{
+    //Save the fade volume scale.
+    m_fadeVolume=scale;
+    //Check the channel is null.
+    if(!m_channel)
+    {
+        return;
+    }
+    //Apply the scaled volume to the channel.
+    applyChannelVolume();
+}
+
+void KNMusicBackendBassThread::setGainVolume(const qreal &scale)
+{
+    //Save the gain volume scale.
+    m_gainVolume=scale;
+    //Check the channel is null.
+    if(!m_channel)
+    {
+        return;
+    }
+    //Apply the scaled volume to the channel.
+    applyChannelVolume();
 }
 
 void KNMusicBackendBassThread::setPosition(const qint64 &position)
@@ -310,29 +329,12 @@ void KNMusicBackendBassThread::setPosition(const qint64 &position)
                                           (double)(m_startPosition+position)
                                           /1000.0),
                 BASS_POS_BYTE);
-    //Check the position.
-    checkPosition();
-}
-
-void KNMusicBackendBassThread::setCreateFlags(const DWORD &channelFlags)
-{
-    //Save the channel flags.
-    m_channelFlags=channelFlags;
-}
-
-void KNMusicBackendBassThread::checkPosition()
-{
     //Get the current position.
     qint64 currentPosition=getChannelPosition();
-    //Emit position changed signal.
-    emit positionChanged(currentPosition);
-    //Check the position is longer than the duration.
-    /*
-     * Q: Why we still need to do this?
-     * A: When cue is playing, it may not stopped at the end of the file.
-     *    The callback is only used to solve the position won't reach the end
-     *    bug, the track duration stopped will still process here.
-     */
+    //The position jumps to the new position.
+    updatePositionAnchor(currentPosition);
+    //Check the position is longer than the duration, the section sync won't
+    //be triggered when seeking over the end.
     if(currentPosition>=m_duration)
     {
         //Finished the playing.
@@ -340,6 +342,12 @@ void KNMusicBackendBassThread::checkPosition()
     }
 }
 
+void KNMusicBackendBassThread::setCreateFlags(const DWORD &channelFlags)
+{
+    //Save the channel flags.
+    m_channelFlags=channelFlags;
+}
+
 void KNMusicBackendBassThread::threadReachesEnd(HSYNC handle,
                                                 DWORD channel,
                                                 DWORD data,
@@ -383,6 +391,25 @@ inline void KNMusicBackendBassThread::setPlayingState(const int &state)
     }
 }
 
+inline void KNMusicBackendBassThread::setSectionSync()
+{
+    //Check whether the section ends before the end of the file.
+    if(!m_channel || m_endPosition<=0 || m_endPosition>=m_totalDuration)
+    {
+        return;
+    }
+    //Add a position sync at the end position, it will be triggered when the
+    //section reaches its end.
+    m_syncHandlers.append(BASS_ChannelSetSync(
+                              m_channel,
+                              BASS_SYNC_POS,
+                              BASS_ChannelSeconds2Bytes(
+                                  m_channel,
+                                  (double)m_endPosition/1000.0),
+                              threadReachesEnd,
+                              this));
+}
+
 inline void KNMusicBackendBassThread::removeChannelSyncs()
 {
     //Get all the handlers.
@@ -118,6 +118,16 @@ public slots:
      */
     void setVolume(const int &volume) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setFadeVolume().
+     */
+    void setFadeVolume(const qreal &scale) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setGainVolume().
+     */
+    void setGainVolume(const qreal &scale) Q_DECL_OVERRIDE;
+
     /*!
      * \brief Reimplemented from KNMusicStandardBackendThread::setPosition().
      */
@@ -129,9 +139,6 @@ public slots:
      */
     void setCreateFlags(const DWORD &channelFlags);
 
-private slots:
-    void checkPosition();
-
 private:
     static void CALLBACK threadReachesEnd(HSYNC handle,
                                           DWORD channel,
@@ -149,6 +156,13 @@ private:
                                                   this));
     }
 
+    inline void setSectionSync();
+    inline void applyChannelVolume()
+    {
+        //The channel volume is the volume scaled by the fade and the gain.
+        BASS_ChannelSetAttribute(m_channel, BASS_ATTRIB_VOL,
+                                 m_volume*m_fadeVolume*m_gainVolume);
+    }
     inline void removeChannelSyncs();
     inline qint64 getChannelPosition()
     {
@@ -161,21 +175,6 @@ private:
                  //position msecond.
                  *1000)-m_startPosition;
     }
-    inline qreal getChannelVolume()
-    {
-        //Check if the thread is loaded.
-        if(!m_channel)
-        {
-            //For a unloaded volume it will be 0.
-            return 0.0;
-        }
-        //Initial a cache.
-        float channelVolume;
-        //Get the volume to the cache.
-        BASS_ChannelGetAttribute(m_channel, BASS_ATTRIB_VOL, &channelVolume);
-        //Give back the channel volume.
-        return channelVolume;
-    }
     inline void freeChannel()
     {
         //Check if the channel is not null.
@@ -245,12 +244,9 @@ private:
            m_startPosition,
            m_endPosition;
     qint64 m_savedPosition;
-    qreal m_volume;
+    qreal m_volume, m_fadeVolume, m_gainVolume;
     int m_state;
 
-    //Updater.
-    QTimer *m_positionUpdater;
-
     //Sync Handlers.
     QList<HSYNC> m_syncHandlers;
 };
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+#include "knmusicbackendffmpegthread.h"
+
+#include "knmusicbackendffmpeg.h"
+
+KNMusicBackendFfmpeg::KNMusicBackendFfmpeg(QObject *parent) :
+    KNMusicStandardBackend(parent),
+    m_main(nullptr),
+    m_preview(nullptr),
+    m_crossfade(nullptr)
+{
+    //Register all the the muxers, demuxers and protocols first.
+    av_register_all();
+    //Initial the main, preview and crossfade of the threads.
+    m_main=new KNMusicBackendFfmpegThread;
+    m_preview=new KNMusicBackendFfmpegThread;
+    m_crossfade=new KNMusicBackendFfmpegThread;
+    //Set the main, preview and crossfade threads.
+    setMainThread(m_main);
+    setPreviewThread(m_preview);
+    setCrossfadeThread(m_crossfade);
+}
+
+KNMusicBackendFfmpeg::~KNMusicBackendFfmpeg()
+{
+    m_main->deleteLater();
+    m_preview->deleteLater();
+    m_crossfade->deleteLater();
+}
+
+int KNMusicBackendFfmpeg::volume() const
+{
+    return m_main->volume();
+}
+
+int KNMusicBackendFfmpeg::minimalVolume() const
+{
+    return 0;
+}
+
+int KNMusicBackendFfmpeg::maximumVolume() const
+{
+    return 10000;
+}
+
+void KNMusicBackendFfmpeg::setGlobalVolume(const int &volume)
+{
+    //Set to the main thread and the crossfade thread, the main thread might be
+    //swapped with the crossfade thread after crossfading.
+    m_main->setVolume(volume);
+    m_crossfade->setVolume(volume);
+    //Emit the volume changed signal.
+    emit volumeChanged(volume);
+}
+
+int KNMusicBackendFfmpeg::volumeLevel() const
+{
+    return 1000;
+}
+
+qreal KNMusicBackendFfmpeg::smartVolumeScale() const
+{
+    return 0.1;
+}
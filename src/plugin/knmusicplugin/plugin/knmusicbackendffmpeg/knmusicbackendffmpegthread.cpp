@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "knmusicffmpegdecoder.h"
+#include "knmusicffmpegoutput.h"
+
+#include "knmusicbackendffmpegthread.h"
+
+#define RingBufferDuration 500
+
+using namespace MusicUtil;
+
+KNMusicBackendFfmpegThread::KNMusicBackendFfmpegThread(QObject *parent) :
+    KNMusicStandardBackendThread(parent),
+    m_ringBuffer(KNMusicSampleRingBuffer()),
+    m_filePath(QString()),
+    m_decoder(new KNMusicFfmpegDecoder(&m_ringBuffer, this)),
+    m_output(new KNMusicFfmpegOutput(&m_ringBuffer, this)),
+    m_startPosition(0),
+    m_endPosition(-1),
+    m_duration(-1),
+    m_totalDuration(-1),
+    m_basePosition(0),
+    m_savedPosition(-1),
+    m_fadeVolume(1.0),
+    m_gainVolume(1.0),
+    m_state(Stopped),
+    m_volume(10000)
+{
+    //The drained signal is emitted from the output thread.
+    connect(m_output, &KNMusicFfmpegOutput::drained,
+            this, &KNMusicBackendFfmpegThread::onActionDrained,
+            Qt::QueuedConnection);
+}
+
+KNMusicBackendFfmpegThread::~KNMusicBackendFfmpegThread()
+{
+    //The worker threads have to be stopped before they are deleted.
+    stopWorkers();
+}
+
+bool KNMusicBackendFfmpegThread::loadFile(const QString &filePath)
+{
+    //Stop the worker threads first.
+    stopWorkers();
+    //Check out the file is loaded or not.
+    if(filePath==m_filePath && m_totalDuration!=-1)
+    {
+        //Reset the parameter and the state.
+        resetParameter();
+        setPlayingState(Stopped);
+        //Move back to the beginning.
+        setPosition(0);
+        //Update the duration.
+        emit durationChanged(m_duration);
+        //Emit the load success signal.
+        emit loadSuccess();
+        return true;
+    }
+    //Clear the previous file.
+    m_filePath=QString();
+    m_totalDuration=-1;
+    //Open the file.
+    if(!m_decoder->open(filePath))
+    {
+        //Reset the parameter and the state.
+        resetParameter();
+        setPlayingState(Stopped);
+        return false;
+    }
+    //Save the file path and the duration.
+    m_filePath=filePath;
+    m_totalDuration=m_decoder->duration();
+    //Prepare the ring buffer and the output device for the sample format.
+    prepareOutput();
+    //Reset the parameter and the state.
+    resetParameter();
+    setPlayingState(Stopped);
+    //The position is at the beginning.
+    updatePositionAnchor(0);
+    //Update the duration.
+    emit durationChanged(m_duration);
+    //The file is opened, it's loaded.
+    emit loadSuccess();
+    return true;
+}
+
+void KNMusicBackendFfmpegThread::reset()
+{
+    //Stop the worker threads.
+    stopWorkers();
+    //Close the file, the output device is kept for the next file.
+    m_decoder->close();
+    m_output->flush();
+    m_ringBuffer.clear();
+    //Clear up the file path and the duration.
+    m_filePath=QString();
+    m_totalDuration=-1;
+    //Reset the parameter and the state.
+    resetParameter();
+    setPlayingState(Stopped);
+}
+
+void KNMusicBackendFfmpegThread::stop()
+{
+    //Check the state.
+    if(m_filePath.isEmpty() || m_state==Stopped)
+    {
+        return;
+    }
+    //Stop the worker threads.
+    stopWorkers();
+    //Change the state.
+    setPlayingState(Stopped);
+    //Reset the position.
+    setPosition(0);
+}
+
+void KNMusicBackendFfmpegThread::play()
+{
+    //Check the state.
+    if(m_filePath.isEmpty() || m_state==Playing)
+    {
+        return;
+    }
+    //Start the decoding and the output.
+    startWorkers();
+    //Change the state.
+    setPlayingState(Playing);
+    //The position starts moving.
+    updatePositionAnchor(position());
+}
+
+void KNMusicBackendFfmpegThread::pause()
+{
+    //Check the state.
+    if(m_state!=Playing)
+    {
+        return;
+    }
+    //Stop the worker threads.
+    stopWorkers();
+    //The samples in the device are not played yet, the position is calculated
+    //from the latency of the device.
+    qint64 pausedPosition=position();
+    //Change the state.
+    setPlayingState(Paused);
+    //Drop the samples in the device instead of waiting for them, the playing
+    //continues from the paused position. The position stops moving.
+    setPosition(pausedPosition);
+}
+
+int KNMusicBackendFfmpegThread::volume()
+{
+    return m_volume;
+}
+
+qint64 KNMusicBackendFfmpegThread::duration()
+{
+    return m_duration;
+}
+
+qint64 KNMusicBackendFfmpegThread::position()
+{
+    //Check the file.
+    if(m_filePath.isEmpty())
+    {
+        return -1;
+    }
+    //When the file is released by save(), the position is not moving.
+    int sampleRate=m_decoder->sampleRate();
+    if(sampleRate<1)
+    {
+        return m_basePosition;
+    }
+    //The samples in the device are not played yet.
+    qint64 playedFrames=qMax(0, m_output->playedFrames()-
+                                m_output->latencyFrames());
+    //Calculate the position from the last seeking position.
+    return m_basePosition+playedFrames*1000/sampleRate;
+}
+
+int KNMusicBackendFfmpegThread::state() const
+{
+    return m_state;
+}
+
+void KNMusicBackendFfmpegThread::setPlaySection(const qint64 &start,
+                                                const qint64 &duration)
+{
+    //Check whether the file is loaded.
+    if(m_totalDuration==-1)
+    {
+        return;
+    }
+    //Check out the start position, if the start position is -1, then we have to
+    //play the whole part of the song.
+    if(start==-1)
+    {
+        m_startPosition=0;
+        m_endPosition=-1;
+        m_duration=m_totalDuration;
+    }
+    else
+    {
+        //The section cannot be out of the file.
+        m_startPosition=qBound((qint64)0, start, m_totalDuration);
+        m_endPosition=(duration==-1)?
+                    m_totalDuration:
+                    qMin(m_startPosition+duration, m_totalDuration);
+        m_duration=m_endPosition-m_startPosition;
+    }
+    //The decoder stops at the end of the section.
+    m_decoder->setEndPosition(m_endPosition);
+    //The duration is changed.
+    emit durationChanged(m_duration);
+    //We need to move the playing position to the start position.
+    setPosition(0);
+}
+
+bool KNMusicBackendFfmpegThread::spectrum(QVector<float> &bands)
+{
+    //The output thread analyses the samples it plays.
+    return m_output->spectrum(bands);
+}
+
+void KNMusicBackendFfmpegThread::save()
+{
+    //Check the file.
+    if(m_filePath.isEmpty())
+    {
+        return;
+    }
+    //Save the position of the current thread, it won't move until restored.
+    m_savedPosition=position();
+    m_basePosition=m_savedPosition;
+    //Release the file, the state is kept.
+    stopWorkers();
+    m_output->flush();
+    m_decoder->close();
+}
+
+void KNMusicBackendFfmpegThread::restore(const QString &updatedFilePath)
+{
+    //Check out the saved position, if it's -1, means it never saved before.
+    //Ignore the invalid call.
+    if(m_savedPosition==-1)
+    {
+        return;
+    }
+    //Reopen the file, the file path might be updated.
+    if(m_decoder->open(updatedFilePath.isEmpty()?m_filePath:updatedFilePath))
+    {
+        //The sample format of the updated file might be changed.
+        prepareOutput();
+        //Restore the end of the section.
+        m_decoder->setEndPosition(m_endPosition);
+    }
+    //Move back to the saved position, it will be played if the thread was
+    //playing.
+    setPosition(m_savedPosition);
+    //Reset the saved position.
+    m_savedPosition=-1;
+}
+
+void KNMusicBackendFfmpegThread::setVolume(const int &volume)
+{
+    //Save the volume size.
+    m_volume=volume;
+    //Apply the scaled volume.
+    updateVolumeScale();
+}
+
+void KNMusicBackendFfmpegThread::setFadeVolume(const qreal &scale)
+{
+    //Save the fade volume scale.
+    m_fadeVolume=scale;
+    //Apply the scaled volume.
+    updateVolumeScale();
+}
+
+void KNMusicBackendFfmpegThread::setGainVolume(const qreal &scale)
+{
+    //Save the gain volume scale.
+    m_gainVolume=scale;
+    //Apply the scaled volume.
+    updateVolumeScale();
+}
+
+bool KNMusicBackendFfmpegThread::isDspSupported()
+{
+    //The decoded samples are processed by the output thread.
+    return true;
+}
+
+void KNMusicBackendFfmpegThread::setDspParameters(
+        const KNMusicDspParameters &parameters)
+{
+    //The output thread processes the samples.
+    m_output->setDspParameters(parameters);
+}
+
+void KNMusicBackendFfmpegThread::setPosition(const qint64 &position)
+{
+    //Check the file.
+    if(m_filePath.isEmpty())
+    {
+        return;
+    }
+    //Stop the worker threads, all the buffered samples are for the previous
+    //position.
+    bool playing=(m_state==Playing);
+    stopWorkers();
+    m_output->flush();
+    m_ringBuffer.clear();
+    //Seek the decoder.
+    qint64 sectionPosition=qBound((qint64)0, position, m_duration);
+    m_decoder->seek(m_startPosition+sectionPosition);
+    //Count the position from the new position.
+    m_basePosition=sectionPosition;
+    m_output->resetPlayedFrames();
+    //Continue playing.
+    if(playing)
+    {
+        startWorkers();
+    }
+    //The position jumps to the new position.
+    updatePositionAnchor(sectionPosition);
+}
+
+void KNMusicBackendFfmpegThread::onActionDrained()
+{
+    //The signal is queued, check whether the samples of the current position
+    //are all played.
+    if(m_state!=Playing || !m_ringBuffer.isClosed() ||
+            m_ringBuffer.available()>0)
+    {
+        return;
+    }
+    //Stop the thread.
+    stop();
+    //Emit finished signal.
+    emit finished();
+}
+
+inline void KNMusicBackendFfmpegThread::startWorkers()
+{
+    //Start the decoder first, the output waits for the samples.
+    m_decoder->start();
+    m_output->start();
+}
+
+inline void KNMusicBackendFfmpegThread::stopWorkers()
+{
+    //Ask both of the threads to stop.
+    m_output->requestInterruption();
+    m_decoder->requestInterruption();
+    //Wait for the threads.
+    m_output->wait();
+    m_decoder->wait();
+}
+
+inline void KNMusicBackendFfmpegThread::prepareOutput()
+{
+    //Prepare the ring buffer and the output device for the sample format of
+    //the opened file.
+    m_ringBuffer.setCapacity(m_decoder->sampleRate()*m_decoder->channels()*
+                             RingBufferDuration/1000);
+    m_output->open(m_decoder->sampleRate(), m_decoder->channels());
+    m_output->resetPlayedFrames();
+}
+
+inline void KNMusicBackendFfmpegThread::resetParameter()
+{
+    //Play the whole file.
+    m_startPosition=0;
+    m_endPosition=-1;
+    m_duration=m_totalDuration;
+    m_basePosition=0;
+    m_decoder->setEndPosition(-1);
+}
+
+inline void KNMusicBackendFfmpegThread::updateVolumeScale()
+{
+    //Scale the volume with the fade volume and the gain volume.
+    m_output->setVolumeScale((qreal)m_volume/10000.0*m_fadeVolume*m_gainVolume);
+}
+
+inline void KNMusicBackendFfmpegThread::setPlayingState(const int &state)
+{
+    //Save the state.
+    m_state=state;
+    //Emit the changed signal.
+    emit stateChanged(m_state);
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICBACKENDFFMPEGTHREAD_H
+#define KNMUSICBACKENDFFMPEGTHREAD_H
+
+#include "knmusicsampleringbuffer.h"
+
+#include "knmusicstandardbackendthread.h"
+
+class KNMusicFfmpegDecoder;
+class KNMusicFfmpegOutput;
+/*!
+ * \brief The KNMusicBackendFfmpegThread class is the standard playing thread
+ * for the native FFMpeg backend.\n
+ * The decoding and the output are decoupled: the decoder thread writes the
+ * samples to a lock-free ring buffer, and the output thread plays the samples
+ * in the buffer. Both of the threads only run when the thread is playing, all
+ * the other operations are done when they are stopped, so the ring buffer only
+ * has one producer and one consumer at any time.\n
+ * It should only be used and constructed by KNMusicBackendFfmpeg.
+ */
+class KNMusicBackendFfmpegThread : public KNMusicStandardBackendThread
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicBackendFfmpegThread object.
+     * \param parent The parent object.
+     */
+    explicit KNMusicBackendFfmpegThread(QObject *parent = 0);
+    ~KNMusicBackendFfmpegThread();
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::loadFile().
+     */
+    bool loadFile(const QString &filePath) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::reset().
+     */
+    void reset() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::stop().
+     */
+    void stop() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::play().
+     */
+    void play() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::pause().
+     */
+    void pause() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::volume().
+     */
+    int volume() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::duration().
+     */
+    qint64 duration() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::position().
+     */
+    qint64 position() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::state().
+     */
+    int state() const Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setPlaySection().
+     */
+    void setPlaySection(const qint64 &start=-1,
+                        const qint64 &duration=-1) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::spectrum().
+     */
+    bool spectrum(QVector<float> &bands) Q_DECL_OVERRIDE;
+
+signals:
+
+public slots:
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::save().
+     */
+    void save() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::restore().
+     */
+    void restore(const QString &updatedFilePath=QString()) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setVolume().
+     */
+    void setVolume(const int &volume) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setFadeVolume().
+     */
+    void setFadeVolume(const qreal &scale) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setGainVolume().
+     */
+    void setGainVolume(const qreal &scale) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::isDspSupported().
+     */
+    bool isDspSupported() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from
+     * KNMusicStandardBackendThread::setDspParameters().
+     */
+    void setDspParameters(const MusicUtil::KNMusicDspParameters &parameters)
+    Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setPosition().
+     */
+    void setPosition(const qint64 &position) Q_DECL_OVERRIDE;
+
+private slots:
+    void onActionDrained();
+
+private:
+    inline void startWorkers();
+    inline void stopWorkers();
+    inline void prepareOutput();
+    inline void resetParameter();
+    inline void updateVolumeScale();
+    inline void setPlayingState(const int &state);
+    KNMusicSampleRingBuffer m_ringBuffer;
+    QString m_filePath;
+    KNMusicFfmpegDecoder *m_decoder;
+    KNMusicFfmpegOutput *m_output;
+    qint64 m_startPosition,
+           m_endPosition,
+           m_duration,
+           m_totalDuration,
+           m_basePosition,
+           m_savedPosition;
+    qreal m_fadeVolume, m_gainVolume;
+    int m_state, m_volume;
+};
+
+#endif // KNMUSICBACKENDFFMPEGTHREAD_H
@@ -0,0 +1,423 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QDir>
+
+extern "C"
+{
+#include <libavutil/avutil.h>
+#include <libavformat/avformat.h>
+}
+
+#include "knmusicsampleringbuffer.h"
+
+#include "knmusicffmpegdecoder.h"
+
+#define DecodeWaitInterval 5
+
+KNMusicFfmpegDecoder::KNMusicFfmpegDecoder(KNMusicSampleRingBuffer *ringBuffer,
+                                           QObject *parent) :
+    QThread(parent),
+    m_pending(QVector<float>()),
+    m_ringBuffer(ringBuffer),
+    m_formatContext(NULL),
+    m_codecContext(NULL),
+    m_frame(NULL),
+    m_duration(-1),
+    m_startFrame(0),
+    m_framePosition(-1),
+    m_targetFrame(0),
+    m_endFrame(-1),
+    m_streamIndex(-1),
+    m_sampleRate(0),
+    m_channels(0),
+    m_pendingOffset(0),
+    m_draining(false),
+    m_ended(false)
+{
+    //Initial the packets.
+    av_init_packet(&m_packet);
+    m_packet.data=NULL;
+    m_packet.size=0;
+    m_decodingPacket=m_packet;
+}
+
+KNMusicFfmpegDecoder::~KNMusicFfmpegDecoder()
+{
+    //Close the file.
+    close();
+}
+
+bool KNMusicFfmpegDecoder::open(const QString &filePath)
+{
+    //Close the previous file.
+    close();
+    //Open the file with ffmpeg.
+    if(avformat_open_input(
+                &m_formatContext,
+                QDir::toNativeSeparators(filePath).toLocal8Bit().data(),
+                NULL,
+                NULL))
+    {
+        //The context is freed when it failed.
+        m_formatContext=NULL;
+        return false;
+    }
+    //Find the stream info and the best audio stream.
+    if(avformat_find_stream_info(m_formatContext, NULL)<0 ||
+            (m_streamIndex=av_find_best_stream(m_formatContext,
+                                               AVMEDIA_TYPE_AUDIO,
+                                               -1, -1, NULL, 0))<0)
+    {
+        //We can't find any audio stream in the file.
+        close();
+        return false;
+    }
+    //Get the codec context of the stream.
+    AVStream *stream=m_formatContext->streams[m_streamIndex];
+    AVCodecContext *codecContext=stream->codec;
+    //Find the decoder, and then open the codec context using the codec.
+    AVCodec *codec=avcodec_find_decoder(codecContext->codec_id);
+    if((!codec) || (avcodec_open2(codecContext, codec, NULL)<0))
+    {
+        //Failed to decode the file.
+        close();
+        return false;
+    }
+    //Save the codec context, it should be closed with the file.
+    m_codecContext=codecContext;
+    //Check the sample format and the duration, the duration is in
+    //AV_TIME_BASE fractional seconds.
+    if(m_codecContext->channels<1 || m_codecContext->sample_rate<1 ||
+            m_formatContext->duration<=0)
+    {
+        //Failed to play the file.
+        close();
+        return false;
+    }
+    //Save the format of the samples.
+    m_sampleRate=m_codecContext->sample_rate;
+    m_channels=m_codecContext->channels;
+    m_duration=m_formatContext->duration/(AV_TIME_BASE/1000);
+    //The timestamps of the stream might not start from 0.
+    if(stream->start_time!=AV_NOPTS_VALUE)
+    {
+        AVRational frameBase={1, m_sampleRate};
+        m_startFrame=av_rescale_q(stream->start_time,
+                                  stream->time_base,
+                                  frameBase);
+    }
+    //The decoding starts from the beginning of the file.
+    m_targetFrame=m_startFrame;
+    //Prepare the decoding frame.
+    m_frame=av_frame_alloc();
+    return true;
+}
+
+void KNMusicFfmpegDecoder::close()
+{
+    //Free the packet and the frame.
+    resetPacket();
+    if(m_frame)
+    {
+        av_frame_free(&m_frame);
+    }
+    //Close the codec.
+    if(m_codecContext)
+    {
+        avcodec_close(m_codecContext);
+        m_codecContext=NULL;
+    }
+    //Close the format context.
+    if(m_formatContext)
+    {
+        avformat_close_input(&m_formatContext);
+    }
+    //Reset the parameters.
+    m_pending.clear();
+    m_duration=-1;
+    m_startFrame=0;
+    m_framePosition=-1;
+    m_targetFrame=0;
+    m_endFrame=-1;
+    m_streamIndex=-1;
+    m_sampleRate=0;
+    m_channels=0;
+    m_pendingOffset=0;
+    m_draining=false;
+    m_ended=false;
+}
+
+bool KNMusicFfmpegDecoder::seek(const qint64 &position)
+{
+    //Check the file.
+    if(m_formatContext==NULL)
+    {
+        return false;
+    }
+    //Seek the stream to the key frame before the position.
+    AVStream *stream=m_formatContext->streams[m_streamIndex];
+    AVRational msecondBase={1, 1000};
+    qint64 timestamp=av_rescale_q(position, msecondBase, stream->time_base);
+    if(stream->start_time!=AV_NOPTS_VALUE)
+    {
+        timestamp+=stream->start_time;
+    }
+    if(av_seek_frame(m_formatContext, m_streamIndex, timestamp,
+                     AVSEEK_FLAG_BACKWARD)<0)
+    {
+        return false;
+    }
+    //Drop all the decoded data of the previous position.
+    avcodec_flush_buffers(m_codecContext);
+    resetPacket();
+    m_pending.clear();
+    m_pendingOffset=0;
+    m_draining=false;
+    m_ended=false;
+    //The samples before the position will be dropped, the position of the
+    //frames is decided by the first decoded frame.
+    m_targetFrame=m_startFrame+msecondToFrame(position);
+    m_framePosition=-1;
+    return true;
+}
+
+void KNMusicFfmpegDecoder::setEndPosition(const qint64 &position)
+{
+    //Save the end frame.
+    m_endFrame=(position==-1)?-1:(m_startFrame+msecondToFrame(position));
+}
+
+qint64 KNMusicFfmpegDecoder::duration() const
+{
+    return m_duration;
+}
+
+int KNMusicFfmpegDecoder::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int KNMusicFfmpegDecoder::channels() const
+{
+    return m_channels;
+}
+
+void KNMusicFfmpegDecoder::run()
+{
+    //Keep decoding until the thread is asked to stop.
+    while(!isInterruptionRequested())
+    {
+        //Decode the next frame when all the pending samples are written.
+        if(m_pendingOffset>=m_pending.size() && !decodeFrame())
+        {
+            //There won't be any more samples, the output will stop after all
+            //the samples are played.
+            m_ringBuffer->close();
+            return;
+        }
+        //Write whole frames as much as possible.
+        int space=m_ringBuffer->space(),
+            written=m_ringBuffer->write(
+                m_pending.constData()+m_pendingOffset,
+                qMin(space-space%m_channels,
+                     m_pending.size()-m_pendingOffset));
+        m_pendingOffset+=written;
+        //When the buffer is full, wait for the output to consume it.
+        if(written==0)
+        {
+            msleep(DecodeWaitInterval);
+        }
+    }
+}
+
+inline float KNMusicFfmpegDecoder::sampleValue(const uint8_t *data,
+                                               const AVSampleFormat &format,
+                                               const int &position)
+{
+    //Translate the sample to the range [-1.0, 1.0].
+    switch(format)
+    {
+    case AV_SAMPLE_FMT_U8:
+        return ((float)data[position]-128.0f)/128.0f;
+    case AV_SAMPLE_FMT_S16:
+        return (float)((const qint16 *)data)[position]/32768.0f;
+    case AV_SAMPLE_FMT_S32:
+        return (float)((const qint32 *)data)[position]/2147483648.0f;
+    case AV_SAMPLE_FMT_FLT:
+        return ((const float *)data)[position];
+    case AV_SAMPLE_FMT_DBL:
+        return (float)((const double *)data)[position];
+    default:
+        return 0.0f;
+    }
+}
+
+inline bool KNMusicFfmpegDecoder::decodeFrame()
+{
+    //Check the file.
+    if(m_formatContext==NULL)
+    {
+        return false;
+    }
+    //Decode until a frame with samples to play is got.
+    while(!m_ended)
+    {
+        //Read the next packet when the current packet is used up.
+        if(m_decodingPacket.size<=0 && !m_draining)
+        {
+            //Free the previous packet.
+            resetPacket();
+            //Read the next packet.
+            if(av_read_frame(m_formatContext, &m_packet)<0)
+            {
+                //The file is finished, the frames delayed in the decoder are
+                //drained with empty packets.
+                resetPacket();
+                m_draining=true;
+            }
+            else if(m_packet.stream_index!=m_streamIndex)
+            {
+                //Only the packet of the audio stream is used.
+                continue;
+            }
+            //Decode the packet from its beginning.
+            m_decodingPacket=m_packet;
+        }
+        //Decode the packet, a packet might contains several frames.
+        int gotFrame=0,
+            usedSize=avcodec_decode_audio4(m_codecContext, m_frame,
+                                           &gotFrame, &m_decodingPacket);
+        //Check the result.
+        if(m_draining)
+        {
+            //The decoder is empty when there's no more frame.
+            if(usedSize<0 || !gotFrame)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            //Skip the broken packet.
+            if(usedSize<0)
+            {
+                m_decodingPacket.size=0;
+                continue;
+            }
+            //Move to the rest data.
+            m_decodingPacket.data+=usedSize;
+            m_decodingPacket.size-=usedSize;
+            //Check whether a frame is decoded.
+            if(!gotFrame)
+            {
+                continue;
+            }
+        }
+        //Append the samples of the frame.
+        if(appendFrame())
+        {
+            return true;
+        }
+    }
+    //The end position is reached.
+    return false;
+}
+
+inline bool KNMusicFfmpegDecoder::appendFrame()
+{
+    //The first frame after seeking decides the position of the frames.
+    if(m_framePosition==-1)
+    {
+        qint64 timestamp=av_frame_get_best_effort_timestamp(m_frame);
+        AVRational frameBase={1, m_sampleRate};
+        m_framePosition=
+                (timestamp==AV_NOPTS_VALUE)?
+                    m_targetFrame:
+                    av_rescale_q(timestamp,
+                                 m_formatContext->streams[m_streamIndex]->
+                                    time_base,
+                                 frameBase);
+    }
+    //Calculate the range of the samples to play, the samples before the target
+    //and after the end are dropped.
+    qint64 frameCount=m_frame->nb_samples,
+           first=qBound((qint64)0, m_targetFrame-m_framePosition, frameCount),
+           last=frameCount;
+    if(m_endFrame!=-1 && m_framePosition+frameCount>=m_endFrame)
+    {
+        //This is the last frame.
+        last=qBound(first, m_endFrame-m_framePosition, frameCount);
+        m_ended=true;
+    }
+    m_framePosition+=frameCount;
+    //Check whether there's any sample to play.
+    if(first>=last)
+    {
+        return false;
+    }
+    //Get the sample format, for planar format, each channel has its own data
+    //plane, or else the samples are interleaved in the first plane.
+    AVSampleFormat format=(AVSampleFormat)m_frame->format,
+                   packedFormat=av_get_packed_sample_fmt(format);
+    bool planar=av_sample_fmt_is_planar(format);
+    int frameChannels=av_frame_get_channels(m_frame);
+    //Translate the samples to interleaved float samples.
+    m_pending.resize((int)(last-first)*m_channels);
+    m_pendingOffset=0;
+    float *samples=m_pending.data();
+    for(int i=(int)first; i<(int)last; ++i)
+    {
+        for(int j=0; j<m_channels; ++j)
+        {
+            //The missing channel is silent.
+            if(j>=frameChannels)
+            {
+                *(samples++)=0.0f;
+            }
+            else if(planar)
+            {
+                *(samples++)=sampleValue(m_frame->extended_data[j],
+                                         packedFormat,
+                                         i);
+            }
+            else
+            {
+                *(samples++)=sampleValue(m_frame->extended_data[0],
+                                         packedFormat,
+                                         i*frameChannels+j);
+            }
+        }
+    }
+    return true;
+}
+
+inline void KNMusicFfmpegDecoder::resetPacket()
+{
+    //Free the packet, and reset the decoding packet.
+    av_free_packet(&m_packet);
+    av_init_packet(&m_packet);
+    m_packet.data=NULL;
+    m_packet.size=0;
+    m_decodingPacket=m_packet;
+}
+
+inline qint64 KNMusicFfmpegDecoder::msecondToFrame(
+        const qint64 &position) const
+{
+    return position*m_sampleRate/1000;
+}
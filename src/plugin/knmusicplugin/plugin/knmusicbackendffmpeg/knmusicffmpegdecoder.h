@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICFFMPEGDECODER_H
+#define KNMUSICFFMPEGDECODER_H
+
+#include <QVector>
+
+#include <QThread>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+struct AVFormatContext;
+class KNMusicSampleRingBuffer;
+/*!
+ * \brief The KNMusicFfmpegDecoder class decodes the audio stream of a file with
+ * FFMpeg in its own thread. The samples are translated to interleaved float
+ * samples and written to the ring buffer, the decoder waits when the buffer is
+ * full. When the file or the section is finished, the ring buffer is closed.\n
+ * All the functions except run() should only be called when the thread is not
+ * running.
+ */
+class KNMusicFfmpegDecoder : public QThread
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicFfmpegDecoder object.
+     * \param ringBuffer The ring buffer which receives the samples.
+     * \param parent The parent object.
+     */
+    explicit KNMusicFfmpegDecoder(KNMusicSampleRingBuffer *ringBuffer,
+                                  QObject *parent = 0);
+    ~KNMusicFfmpegDecoder();
+
+    /*!
+     * \brief Open a file and prepare the decoder of its audio stream.
+     * \param filePath The file path.
+     * \return If the audio stream could be decoded, return true.
+     */
+    bool open(const QString &filePath);
+
+    /*!
+     * \brief Close the opened file.
+     */
+    void close();
+
+    /*!
+     * \brief Move the decoding position. The samples before the position will
+     * be dropped, so the position is accurate.
+     * \param position The position in the whole file in msecond.
+     * \return If the position could be seeked, return true.
+     */
+    bool seek(const qint64 &position);
+
+    /*!
+     * \brief Set the position where the decoding stops.
+     * \param position The end position in the whole file in msecond, -1 for
+     * the end of the file.
+     */
+    void setEndPosition(const qint64 &position);
+
+    /*!
+     * \brief Get the duration of the opened file.
+     * \return The duration in msecond, -1 for no file.
+     */
+    qint64 duration() const;
+
+    /*!
+     * \brief Get the sample rate of the opened file.
+     * \return The sample rate of the decoded samples.
+     */
+    int sampleRate() const;
+
+    /*!
+     * \brief Get the channel count of the opened file.
+     * \return The channel count of the decoded samples.
+     */
+    int channels() const;
+
+protected:
+    /*!
+     * \brief Reimplemented from QThread::run().
+     */
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    static inline float sampleValue(const uint8_t *data,
+                                    const AVSampleFormat &format,
+                                    const int &position);
+    inline bool decodeFrame();
+    inline bool appendFrame();
+    inline void resetPacket();
+    inline qint64 msecondToFrame(const qint64 &position) const;
+    QVector<float> m_pending;
+    AVPacket m_packet, m_decodingPacket;
+    KNMusicSampleRingBuffer *m_ringBuffer;
+    AVFormatContext *m_formatContext;
+    AVCodecContext *m_codecContext;
+    AVFrame *m_frame;
+    qint64 m_duration, m_startFrame, m_framePosition, m_targetFrame,
+           m_endFrame;
+    int m_streamIndex, m_sampleRate, m_channels, m_pendingOffset;
+    bool m_draining, m_ended;
+};
+
+#endif // KNMUSICFFMPEGDECODER_H
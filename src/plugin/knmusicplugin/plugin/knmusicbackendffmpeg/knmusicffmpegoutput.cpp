@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QVector>
+
+#ifdef ENABLE_PULSEAUDIO_OUTPUT
+#include <pulse/simple.h>
+#endif
+
+#include "knmusicsampleringbuffer.h"
+
+#include "knmusicffmpegoutput.h"
+
+#define OutputChunkFrames 1024
+#define OutputWaitInterval 5
+#define SinkLatency 100
+#define VolumeScaleUnit 10000
+
+KNMusicFfmpegOutput::KNMusicFfmpegOutput(KNMusicSampleRingBuffer *ringBuffer,
+                                         QObject *parent) :
+    QThread(parent),
+    m_ringBuffer(ringBuffer),
+    m_sink(NULL),
+    m_playedFrames(0),
+    m_latencyFrames(0),
+    m_volumeScale(VolumeScaleUnit),
+    m_sampleRate(0),
+    m_channels(0)
+{
+}
+
+KNMusicFfmpegOutput::~KNMusicFfmpegOutput()
+{
+    //Close the device.
+    close();
+}
+
+bool KNMusicFfmpegOutput::open(int sampleRate, int channels)
+{
+    //Reset the DSP chain for the format, the states of the filters belong to
+    //the previous file.
+    m_dspChain.prepare(sampleRate, channels);
+    m_spectrumAnalyser.prepare(sampleRate, channels);
+    //Check whether the device is opened for the same format.
+    if(m_sink!=NULL && m_sampleRate==sampleRate && m_channels==channels)
+    {
+        return true;
+    }
+    //Close the previous device.
+    close();
+    //Save the format, the null sink needs it as well.
+    m_sampleRate=sampleRate;
+    m_channels=channels;
+#ifdef ENABLE_PULSEAUDIO_OUTPUT
+    //Check whether PulseAudio supports the channel count.
+    if(channels<=PA_CHANNELS_MAX)
+    {
+        //Prepare the sample format.
+        pa_sample_spec sampleSpec;
+        sampleSpec.format=PA_SAMPLE_FLOAT32NE;
+        sampleSpec.rate=(uint32_t)sampleRate;
+        sampleSpec.channels=(uint8_t)channels;
+        //Keep the buffer of the server short, the samples are buffered in the
+        //ring buffer, and a short buffer makes pausing and seeking responsive.
+        pa_buffer_attr bufferAttribute;
+        bufferAttribute.maxlength=(uint32_t)-1;
+        bufferAttribute.tlength=(uint32_t)pa_usec_to_bytes(SinkLatency*1000,
+                                                           &sampleSpec);
+        bufferAttribute.prebuf=(uint32_t)-1;
+        bufferAttribute.minreq=(uint32_t)-1;
+        bufferAttribute.fragsize=(uint32_t)-1;
+        //Connect to the server.
+        m_sink=pa_simple_new(NULL,
+                             "Mu",
+                             PA_STREAM_PLAYBACK,
+                             NULL,
+                             "Music",
+                             &sampleSpec,
+                             NULL,
+                             &bufferAttribute,
+                             NULL);
+    }
+#endif
+    //If the device cannot be opened, the null sink will be used.
+    return m_sink!=NULL;
+}
+
+void KNMusicFfmpegOutput::close()
+{
+#ifdef ENABLE_PULSEAUDIO_OUTPUT
+    //Disconnect from the server.
+    if(m_sink)
+    {
+        pa_simple_free(m_sink);
+    }
+#endif
+    //Reset the device.
+    m_sink=NULL;
+    m_latencyFrames.storeRelease(0);
+}
+
+void KNMusicFfmpegOutput::flush()
+{
+#ifdef ENABLE_PULSEAUDIO_OUTPUT
+    //Drop the samples in the server.
+    if(m_sink)
+    {
+        pa_simple_flush(m_sink, NULL);
+    }
+#endif
+    //There's nothing left in the device.
+    m_latencyFrames.storeRelease(0);
+}
+
+int KNMusicFfmpegOutput::playedFrames() const
+{
+    return m_playedFrames.loadAcquire();
+}
+
+int KNMusicFfmpegOutput::latencyFrames() const
+{
+    return m_latencyFrames.loadAcquire();
+}
+
+void KNMusicFfmpegOutput::resetPlayedFrames()
+{
+    m_playedFrames.storeRelease(0);
+}
+
+void KNMusicFfmpegOutput::setVolumeScale(const qreal &scale)
+{
+    //Save the scale in fixed point, it's read by the output thread.
+    m_volumeScale.storeRelease(qRound(scale*VolumeScaleUnit));
+}
+
+void KNMusicFfmpegOutput::setDspParameters(
+        const MusicUtil::KNMusicDspParameters &parameters)
+{
+    //The parameters are applied by the output thread.
+    m_dspChain.setParameters(parameters);
+}
+
+bool KNMusicFfmpegOutput::spectrum(QVector<float> &bands)
+{
+    return m_spectrumAnalyser.spectrum(bands);
+}
+
+void KNMusicFfmpegOutput::run()
+{
+    //Check the format.
+    if(m_channels<1 || m_sampleRate<1)
+    {
+        return;
+    }
+    //Prepare the chunk of samples.
+    QVector<float> chunk(OutputChunkFrames*m_channels);
+    //Keep playing until the thread is asked to stop.
+    while(!isInterruptionRequested())
+    {
+        //Read the samples, the decoder always writes whole frames.
+        int count=m_ringBuffer->read(chunk.data(), chunk.size());
+        //Check whether there's any sample.
+        if(count==0)
+        {
+            //Check whether the decoder finished.
+            if(m_ringBuffer->isClosed() && m_ringBuffer->available()==0)
+            {
+                //Wait for the last samples.
+                drain();
+                //The spectrum falls to silence.
+                m_spectrumAnalyser.reset();
+                //All the samples are played.
+                emit drained();
+                return;
+            }
+            //Wait for the decoder.
+            msleep(OutputWaitInterval);
+            continue;
+        }
+        //Scale the samples with the volume.
+        float scale=(float)m_volumeScale.loadAcquire()/(float)VolumeScaleUnit,
+              *samples=chunk.data();
+        for(int i=0; i<count; ++i)
+        {
+            samples[i]*=scale;
+        }
+        //Process the samples with the DSP chain.
+        m_dspChain.process(samples, count/m_channels);
+        //The gain and the equalizer might make the samples out of range, clip
+        //them.
+        for(int i=0; i<count; ++i)
+        {
+            samples[i]=qBound(-1.0f, samples[i], 1.0f);
+        }
+        //Analyse the samples which are going to be played.
+        m_spectrumAnalyser.addSamples(samples, count/m_channels);
+        //Write the samples to the device.
+        writeSamples(samples, count);
+        //Count the played frames.
+        m_playedFrames.fetchAndAddRelease(count/m_channels);
+    }
+    //The samples stop playing, the spectrum falls to silence.
+    m_spectrumAnalyser.reset();
+}
+
+inline void KNMusicFfmpegOutput::writeSamples(const float *samples,
+                                              const int &count)
+{
+#ifdef ENABLE_PULSEAUDIO_OUTPUT
+    //Write the samples to the server, it blocks until the server needs them.
+    if(m_sink &&
+            pa_simple_write(m_sink, samples, count*sizeof(float), NULL)>=0)
+    {
+        //Update the latency of the server.
+        int error;
+        pa_usec_t latency=pa_simple_get_latency(m_sink, &error);
+        if(latency!=(pa_usec_t)-1)
+        {
+            m_latencyFrames.storeRelease(
+                        (int)(latency*(pa_usec_t)m_sampleRate/1000000));
+        }
+        return;
+    }
+#else
+    Q_UNUSED(samples)
+#endif
+    //The null sink throws the samples away at the playing speed.
+    msleep((unsigned long)(count/m_channels)*1000/m_sampleRate);
+}
+
+inline void KNMusicFfmpegOutput::drain()
+{
+#ifdef ENABLE_PULSEAUDIO_OUTPUT
+    //Wait for the samples in the server, it's only called by the output
+    //thread.
+    if(m_sink)
+    {
+        pa_simple_drain(m_sink, NULL);
+    }
+#endif
+    //There's nothing left in the device.
+    m_latencyFrames.storeRelease(0);
+}
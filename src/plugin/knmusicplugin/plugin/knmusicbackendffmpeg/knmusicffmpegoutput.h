@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICFFMPEGOUTPUT_H
+#define KNMUSICFFMPEGOUTPUT_H
+
+#include <QAtomicInt>
+
+#include <QThread>
+
+#include "knmusicdspchain.h"
+#include "knmusicspectrumanalyser.h"
+
+struct pa_simple;
+class KNMusicSampleRingBuffer;
+/*!
+ * \brief The KNMusicFfmpegOutput class plays the samples in the ring buffer in
+ * its own thread. The samples are scaled by the volume and written to a
+ * PulseAudio playback stream. When PulseAudio is not enabled or not available,
+ * the samples are thrown away at the playing speed as a null sink.\n
+ * When the ring buffer is closed and all the samples are played, drained()
+ * will be emitted and the thread stops. Except the volume scale, the DSP
+ * parameters, the spectrum and the played frames, all the functions should only
+ * be called when the thread is not running.
+ */
+class KNMusicFfmpegOutput : public QThread
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicFfmpegOutput object.
+     * \param ringBuffer The ring buffer which provides the samples.
+     * \param parent The parent object.
+     */
+    explicit KNMusicFfmpegOutput(KNMusicSampleRingBuffer *ringBuffer,
+                                 QObject *parent = 0);
+    ~KNMusicFfmpegOutput();
+
+    /*!
+     * \brief Open the output device for the sample format. If the device is
+     * opened for the same format, it will be reused.
+     * \param sampleRate The sample rate of the samples.
+     * \param channels The channel count of the samples.
+     * \return If the output device is opened, return true. Or else the null
+     * sink is used.
+     */
+    bool open(int sampleRate, int channels);
+
+    /*!
+     * \brief Close the output device.
+     */
+    void close();
+
+    /*!
+     * \brief Drop all the samples which are written to the device but not
+     * played.
+     */
+    void flush();
+
+    /*!
+     * \brief Get the frame count which is written to the device since the last
+     * resetPlayedFrames(). This could be called in any thread.
+     * \return The written frame count.
+     */
+    int playedFrames() const;
+
+    /*!
+     * \brief Get the frame count which is written but not played yet. This
+     * could be called in any thread.
+     * \return The latency of the device in frames.
+     */
+    int latencyFrames() const;
+
+    /*!
+     * \brief Reset the played frame count to 0.
+     */
+    void resetPlayedFrames();
+
+    /*!
+     * \brief Set the scale of the samples. This could be called in any thread.
+     * \param scale The scale of the samples, it could be larger than 1.0.
+     */
+    void setVolumeScale(const qreal &scale);
+
+    /*!
+     * \brief Set the parameters of the DSP chain which processes the samples
+     * before they are written to the device. This could be called in any
+     * thread.
+     * \param parameters The DSP parameters.
+     */
+    void setDspParameters(const MusicUtil::KNMusicDspParameters &parameters);
+
+    /*!
+     * \brief Get the latest spectrum snapshot of the played samples. This
+     * could be called in one reader thread.
+     * \param bands The band levels.
+     * \return If there's a new snapshot since the last call, return true.
+     */
+    bool spectrum(QVector<float> &bands);
+
+signals:
+    /*!
+     * \brief When the ring buffer is closed and all the samples in it are
+     * played, this signal will be emitted.
+     */
+    void drained();
+
+protected:
+    /*!
+     * \brief Reimplemented from QThread::run().
+     */
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    inline void writeSamples(const float *samples, const int &count);
+    inline void drain();
+    KNMusicSampleRingBuffer *m_ringBuffer;
+    KNMusicDspChain m_dspChain;
+    KNMusicSpectrumAnalyser m_spectrumAnalyser;
+    pa_simple *m_sink;
+    QAtomicInt m_playedFrames, m_latencyFrames, m_volumeScale;
+    int m_sampleRate, m_channels;
+};
+
+#endif // KNMUSICFFMPEGOUTPUT_H
@@ -24,22 +24,26 @@
 KNMusicBackendGStreamer::KNMusicBackendGStreamer(QObject *parent) :
     KNMusicStandardBackend(parent),
     m_main(nullptr),
-    m_preview(nullptr)
+    m_preview(nullptr),
+    m_crossfade(nullptr)
 {
     //Initial the gstreamer first.
     gst_init(NULL, NULL);
-    //Initial the main and preview of the threads.
+    //Initial the main, preview and crossfade of the threads.
     m_main=new KNMusicBackendGStreamerThread;
     m_preview=new KNMusicBackendGStreamerThread;
-    //Set the main and preview threads.
+    m_crossfade=new KNMusicBackendGStreamerThread;
+    //Set the main, preview and crossfade threads.
     setMainThread(m_main);
     setPreviewThread(m_preview);
+    setCrossfadeThread(m_crossfade);
 }
 
 KNMusicBackendGStreamer::~KNMusicBackendGStreamer()
 {
     m_main->deleteLater();
     m_preview->deleteLater();
+    m_crossfade->deleteLater();
 }
 
 int KNMusicBackendGStreamer::volume() const
@@ -59,8 +63,10 @@ int KNMusicBackendGStreamer::maximumVolume() const
 
 void KNMusicBackendGStreamer::setGlobalVolume(const int &volume)
 {
-    //Set to the main thread.
+    //Set to the main thread and the crossfade thread, the main thread might be
+    //swapped with the crossfade thread after crossfading.
     m_main->setVolume(volume);
+    m_crossfade->setVolume(volume);
     //Emit the volume changed signal.
     emit volumeChanged(volume);
 }
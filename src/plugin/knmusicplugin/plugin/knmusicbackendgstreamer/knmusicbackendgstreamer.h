@@ -81,7 +81,7 @@ protected:
     qreal smartVolumeScale() const Q_DECL_OVERRIDE;
 
 private:
-    KNMusicBackendGStreamerThread *m_main, *m_preview;
+    KNMusicBackendGStreamerThread *m_main, *m_preview, *m_crossfade;
 };
 
 #endif // KNMUSICBACKENDGSTREAMER_H
@@ -22,6 +22,8 @@
 
 #include <QDebug>
 
+#define DurationTimeout 5000
+
 /* playbin2 flags */
 typedef enum {
   GST_PLAY_FLAG_VIDEO         = (1 << 0), /* We want video output */
@@ -32,21 +34,34 @@ typedef enum {
 KNMusicBackendGStreamerThread::KNMusicBackendGStreamerThread(QObject *parent) :
     KNMusicStandardBackendThread(parent),
     m_filePath(QString()),
+    m_nextFilePath(QString()),
+    m_queuedFilePath(QString()),
     m_startPosition(-1),
     m_endPosition(-1),
     m_duration(-1),
     m_totalDuration(-1),
+    m_nextStartPosition(-1),
+    m_nextDuration(-1),
+    m_pendingPosition(-1),
     m_savedPosition(-1),
-    m_tick(new QTimer(this)),
+    m_durationTimeout(new QTimer(this)),
     m_playbin(NULL),
     m_seekFlag((GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT)),
+    m_sectionSeekFlag((GstSeekFlags)(GST_SEEK_FLAG_FLUSH |
+                                     GST_SEEK_FLAG_ACCURATE |
+                                     GST_SEEK_FLAG_SEGMENT)),
+    m_fadeVolume(1.0),
+    m_gainVolume(1.0),
     m_state(MusicUtil::Stopped),
     m_volume(10000),
-    m_sectionSet(false)
+    m_sectionSet(false),
+    m_durationPending(false)
 {
-    //Configure the timer.
-    connect(m_tick, &QTimer::timeout,
-            this, &KNMusicBackendGStreamerThread::onActionTick);
+    //Configure the duration timeout timer.
+    m_durationTimeout->setInterval(DurationTimeout);
+    m_durationTimeout->setSingleShot(true);
+    connect(m_durationTimeout, &QTimer::timeout,
+            this, &KNMusicBackendGStreamerThread::onActionDurationTimeout);
     //Link the process event.
     connect(this, &KNMusicBackendGStreamerThread::requireProcessEvent,
             this, &KNMusicBackendGStreamerThread::processEvents,
@@ -61,8 +76,10 @@ KNMusicBackendGStreamerThread::~KNMusicBackendGStreamerThread()
 
 bool KNMusicBackendGStreamerThread::loadFile(const QString &filePath)
 {
+    //The next file is for the previous file.
+    clearNextFile();
     //Check out the file is loaded or not.
-    if(filePath==m_filePath)
+    if(filePath==m_filePath && !m_durationPending)
     {
         //Stop the thread first.
         stop();
@@ -74,10 +91,10 @@ bool KNMusicBackendGStreamerThread::loadFile(const QString &filePath)
         emit loadSuccess();
         return true;
     }
-    //Reset the pipeline.
-    if(!rebuildPipeline())
+    //Prepare the pipeline.
+    if(!preparePipeline())
     {
-        //If the pipeline cannot be reset, then failed.
+        //If the pipeline cannot be prepared, then failed.
         return false;
     }
     //Reset the total duration.
@@ -93,14 +110,27 @@ bool KNMusicBackendGStreamerThread::loadFile(const QString &filePath)
         //Set the uri to the playbin.
         g_object_set(m_playbin, "uri", localUrl.data(), NULL);
     }
+    //Wait for the duration, it will be queried when the bus reports it.
+    m_durationPending=true;
+    m_durationTimeout->start();
+    //Preroll the pipeline, the duration could be known after prerolling.
+    if(gst_element_set_state(m_playbin, GST_STATE_PAUSED)==
+            GST_STATE_CHANGE_FAILURE)
+    {
+        //Stop waiting for the duration.
+        stopWaitingDuration();
+        return false;
+    }
     //Load the file successfully.
     return true;
 }
 
 void KNMusicBackendGStreamerThread::reset()
 {
-    //Stop the ticker.
-    m_tick->stop();
+    //Stop waiting for the duration.
+    stopWaitingDuration();
+    //Clear the next file.
+    clearNextFile();
     //Clear up the pipeline.
     resetPipeline();
     //Reset the total duration.
@@ -119,14 +149,10 @@ void KNMusicBackendGStreamerThread::stop()
         //Set the state to be play.
         //And get the state changed result.
         gst_element_set_state(m_playbin, GST_STATE_PAUSED);
-        //Stop ticking.
-        m_tick->stop();
-        //Emit the position changed signal.
-        emit positionChanged(0);
-        //Reset the position.
-        setPosition(0);
         //Then the result is success, we can change the state.
         setPlayingState(MusicUtil::Stopped);
+        //Reset the position.
+        setPosition(0);
     }
 }
 
@@ -142,10 +168,10 @@ void KNMusicBackendGStreamerThread::play()
         //Check out the result.
         if (GST_STATE_CHANGE_FAILURE != stateResult)
         {
-            //Start ticking.
-            m_tick->start();
             //Then the result is success, we can change the state.
             setPlayingState(MusicUtil::Playing);
+            //The position starts moving.
+            updateCurrentPositionAnchor();
         }
     }
 }
@@ -164,8 +190,8 @@ void KNMusicBackendGStreamerThread::pause()
         {
             //Then the result is success, we can change the state.
             setPlayingState(MusicUtil::Paused);
-            //Stop ticking.
-            m_tick->stop();
+            //The position stops moving.
+            updateCurrentPositionAnchor();
         }
     }
 }
@@ -233,6 +259,34 @@ void KNMusicBackendGStreamerThread::setPlaySection(const qint64 &start,
     }
 }
 
+bool KNMusicBackendGStreamerThread::setNextFile(const QString &filePath,
+                                                const qint64 &start,
+                                                const qint64 &duration)
+{
+    //Clear the previous next file.
+    clearNextFile();
+    //Check the file path.
+    if(filePath.isEmpty())
+    {
+        return true;
+    }
+    //A whole file could only follow a whole file with the about-to-finish
+    //signal, and a section could only follow a section of the same file with
+    //the segment seek.
+    if((m_endPosition!=-1)!=(start!=-1) ||
+            (start!=-1 && filePath!=m_filePath))
+    {
+        return false;
+    }
+    //Save the next file, it will be used in the streaming thread.
+    m_nextFileLock.lock();
+    m_nextFilePath=filePath;
+    m_nextStartPosition=start;
+    m_nextDuration=duration;
+    m_nextFileLock.unlock();
+    return true;
+}
+
 GstElement *KNMusicBackendGStreamerThread::playbin()
 {
     return m_playbin;
@@ -240,8 +294,6 @@ GstElement *KNMusicBackendGStreamerThread::playbin()
 
 void KNMusicBackendGStreamerThread::save()
 {
-    //Stop the ticker.
-    m_tick->stop();
     //Save the position of the current thread.
     gst_element_query_position(m_playbin,
                                GST_FORMAT_TIME,
@@ -267,8 +319,8 @@ void KNMusicBackendGStreamerThread::restore(const QString &updatedFilePath)
     {
         return;
     }
-    //Rebuild the pipeline.
-    rebuildPipeline();
+    //Prepare the pipeline.
+    preparePipeline();
     //Check out the updated file path.
     QString restoreFilePath=
             updatedFilePath.isEmpty()?m_filePath:updatedFilePath;
@@ -281,18 +333,26 @@ void KNMusicBackendGStreamerThread::restore(const QString &updatedFilePath)
         g_object_set(m_playbin, "uri", localUrl.data(), NULL);
     }
     //Reset the position, seek the playbin pipeline.
-    gst_element_seek_simple(m_playbin,
-                            GST_FORMAT_TIME,
-                            m_seekFlag,
-                            m_savedPosition);
+    if(m_endPosition>0)
+    {
+        //Play the section again.
+        setPosition(m_savedPosition/GST_MSECOND - m_startPosition);
+    }
+    else
+    {
+        gst_element_seek_simple(m_playbin,
+                                GST_FORMAT_TIME,
+                                m_seekFlag,
+                                m_savedPosition);
+    }
     //Check out the state.
     if(m_state==Playing)
     {
-        //Start the updater.
-        m_tick->start();
         //Play the playbin.
         gst_element_set_state(m_playbin, GST_STATE_PLAYING);
     }
+    //Report the restored position.
+    updatePositionAnchor(m_savedPosition/GST_MSECOND - m_startPosition);
     //Reset the saved position.
     m_savedPosition=-1;
 }
@@ -304,85 +364,71 @@ void KNMusicBackendGStreamerThread::setVolume(const int &volume)
     //Check the playbin is null or not.
     if(m_playbin)
     {
-        //Translate the volume to gdouble.
-        gdouble playbinVolume=(gdouble)volume/10000.0;
+        //Translate the volume to gdouble, scale it with the fade volume and
+        //the gain volume.
+        gdouble playbinVolume=
+                (gdouble)volume/10000.0*m_fadeVolume*m_gainVolume;
         //Set the volume
         g_object_set(G_OBJECT(m_playbin), "volume", playbinVolume, NULL);
     }
 }
 
-void KNMusicBackendGStreamerThread::setPosition(const qint64 &position)
+void KNMusicBackendGStreamerThread::setFadeVolume(const qreal &scale)
 {
-    //Check the playbin pointer first
-    if(m_playbin && m_startPosition!=-1)
-    {
-        //Seek the playbin pipeline.
-        gst_element_seek_simple(m_playbin,
-                                GST_FORMAT_TIME,
-                                m_seekFlag,
-                                (m_startPosition + position) * GST_MSECOND);
-    }
+    //Save the fade volume scale.
+    m_fadeVolume=scale;
+    //Apply the scaled volume.
+    setVolume(m_volume);
 }
 
-void KNMusicBackendGStreamerThread::updateDuration()
+void KNMusicBackendGStreamerThread::setGainVolume(const qreal &scale)
 {
-    //Prepare the fake total duration.
-    gint64 totalDuration;
-    //Query the duration, because it can could be played, so it's 100% we could
-    //get the duration..
-    while(!gst_element_query_duration(m_playbin,
-                                      GST_FORMAT_TIME,
-                                      &totalDuration));
-    //Check out the total duration.
-    if(totalDuration==0)
-    {
-        //Ignore the invalid value.
-        return;
-    }
-    //Save the total duration, we are using millisecond while gstreamer is
-    //using nanosecond.
-    m_totalDuration=(qint64)(totalDuration)/1000000;
-    //Check if section has been set then update the position.
-    if(m_sectionSet)
-    {
-        //Check out the start and end position.
-        updateStartAndEndPosition();
-    }
-    //If we comes to here, that means the file is loaded.
-    emit loadSuccess();
+    //Save the gain volume scale.
+    m_gainVolume=scale;
+    //Apply the scaled volume.
+    setVolume(m_volume);
 }
 
-void KNMusicBackendGStreamerThread::onActionTick()
+void KNMusicBackendGStreamerThread::setPosition(const qint64 &position)
 {
-    //Check out the pipeline.
-    if(m_playbin)
+    //Check the playbin pointer first
+    if(m_playbin && m_startPosition!=-1)
     {
-        //Generate the gstreamer position.
-        gint64 position;
-        //Output the data.
-        gboolean result=gst_element_query_position(m_playbin,
-                                                   GST_FORMAT_TIME,
-                                                   &position);
-        //Check the result.
-        if(result)
+        //Check whether we are playing a section.
+        if(m_endPosition>0)
         {
-            //Give back the position data.
-            //Remember it will use nanosecond but not msecond.
-            qint64 totalPosition=position/1000000;
-            //Emit the position changed signal.
-            emit positionChanged(totalPosition-m_startPosition);
-            //Check the total position is greater than end position.
-            if(m_endPosition>0 && totalPosition>=m_endPosition)
-            {
-                //Stop the pipeline
-                stop();
-                //Emit finished signal.
-                emit finished();
-            }
+            //Seek the section with its stop position, the pipeline will stop
+            //at the end of the section exactly. If the pipeline is not ready
+            //for seeking, seek it after it's prerolled.
+            m_pendingPosition=
+                    seekSection(position, m_sectionSeekFlag)?-1:position;
+        }
+        else
+        {
+            //Seek the playbin pipeline.
+            gst_element_seek_simple(m_playbin,
+                                    GST_FORMAT_TIME,
+                                    m_seekFlag,
+                                    (m_startPosition + position) * GST_MSECOND);
         }
+        //The position jumps to the new position.
+        updatePositionAnchor(position);
     }
 }
 
+void KNMusicBackendGStreamerThread::onActionDurationTimeout()
+{
+    //Check whether we are still waiting for the duration.
+    if(!m_durationPending)
+    {
+        return;
+    }
+    //The duration never comes, the file cannot be played.
+    m_durationPending=false;
+    //Emit the load failed signal.
+    emit loadFailed();
+}
+
 void KNMusicBackendGStreamerThread::processEvents(int type)
 {
     //Check out the message type
@@ -399,10 +445,61 @@ void KNMusicBackendGStreamerThread::processEvents(int type)
     }
     case GST_MESSAGE_ERROR:
     {
+        //Stop waiting for the duration.
+        stopWaitingDuration();
         //File will be loaded failed.
         emit loadFailed();
         break;
     }
+    case GST_MESSAGE_SEGMENT_DONE:
+    {
+        //The section reaches its stop position. Continue to play the next
+        //section if there is one.
+        if(!startNextSection())
+        {
+            //Stop the pipeline
+            stop();
+            //Emit finished signal.
+            emit finished();
+        }
+        break;
+    }
+    case GST_MESSAGE_ASYNC_DONE:
+    {
+        //The pipeline is prerolled, the duration could be queried now.
+        updateDuration();
+        //Check the pending section seek.
+        if(m_pendingPosition!=-1)
+        {
+            setPosition(m_pendingPosition);
+            break;
+        }
+        //The seeking or prerolling is done, sync the position with the
+        //pipeline.
+        updateCurrentPositionAnchor();
+        break;
+    }
+    case GST_MESSAGE_STREAM_START:
+    {
+        //Check whether the queued next file starts to play.
+        startNextFile();
+        break;
+    }
+    case GST_MESSAGE_DURATION_CHANGED:
+    {
+        //Check whether we are waiting for the duration of the loaded file.
+        if(m_durationPending)
+        {
+            //Try to query the duration again.
+            updateDuration();
+        }
+        //The duration of the next file might be known after it starts.
+        else if(m_startPosition==0 && m_endPosition==-1)
+        {
+            updateWholeFileDuration();
+        }
+        break;
+    }
     default:
         //Ignore all the other messages.
         break;
@@ -416,41 +513,184 @@ gboolean KNMusicBackendGStreamerThread::busWatch(GstBus *bus,
     Q_UNUSED(bus)
     //Get the event.
     GstMessageType type=GST_MESSAGE_TYPE(message);
-    //Process the event.
-    switch(type)
+    //Retranslate the data to a gstreamer-thread.
+    //Emit the process event signal.
+    static_cast<KNMusicBackendGStreamerThread *>(data)->requireProcessEvent(
+                (int)type);
+    //Give back successful.
+    return TRUE;
+}
+
+void KNMusicBackendGStreamerThread::aboutToFinish(GstElement *playbin,
+                                                  gpointer data)
+{
+    //Get the thread. This function is called in the streaming thread.
+    KNMusicBackendGStreamerThread *thread=
+            static_cast<KNMusicBackendGStreamerThread *>(data);
+    //Check the next file.
+    thread->m_nextFileLock.lock();
+    if(!thread->m_nextFilePath.isEmpty() && thread->m_nextStartPosition==-1)
     {
-    case GST_MESSAGE_STATE_CHANGED:
+        //Get the file url from the file path.
+        QByteArray localUrl=
+                QUrl::fromLocalFile(thread->m_nextFilePath).toString().toUtf8();
+        //Set the uri to the playbin, it will be played right after the current
+        //file.
+        g_object_set(playbin, "uri", localUrl.data(), NULL);
+        //Move the next file to queued file.
+        thread->m_queuedFilePath=thread->m_nextFilePath;
+        thread->m_nextFilePath.clear();
+    }
+    thread->m_nextFileLock.unlock();
+}
+
+inline void KNMusicBackendGStreamerThread::clearNextFile()
+{
+    //Clear the next file and the queued file.
+    m_nextFileLock.lock();
+    m_nextFilePath.clear();
+    m_queuedFilePath.clear();
+    m_nextFileLock.unlock();
+}
+
+inline void KNMusicBackendGStreamerThread::startNextFile()
+{
+    //Get the queued file.
+    m_nextFileLock.lock();
+    QString queuedFilePath=m_queuedFilePath;
+    m_queuedFilePath.clear();
+    m_nextFileLock.unlock();
+    //Check whether a queued file starts.
+    if(queuedFilePath.isEmpty())
     {
-        //Target thread.
-        KNMusicBackendGStreamerThread *thread=
-                static_cast<KNMusicBackendGStreamerThread *>(data);
-        if(GST_MESSAGE_SRC(message)==GST_OBJECT(thread->playbin()))
-        {
-            //Get the threads.
-            GstState previousState, currentState, pendingState;
-            gst_message_parse_state_changed(message,
-                                            &previousState,
-                                            &currentState,
-                                            &pendingState);
-            //Check the previous state and current state.
-            if(previousState==GST_STATE_NULL &&
-                    currentState==GST_STATE_READY)
-            {
-                //Update the duration.
-                thread->updateDuration();
-            }
-        }
+        return;
     }
-    default:
-        //Retranslate the data to a gstreamer-thread.
-        //Emit the process event signal.
-        static_cast<KNMusicBackendGStreamerThread *>(data)->requireProcessEvent(
-                    (int)type);
+    //The queued file is the current file, play the whole file.
+    m_filePath=queuedFilePath;
+    m_totalDuration=-1;
+    resetParameter();
+    m_startPosition=0;
+    m_endPosition=-1;
+    //Update the duration of the new file.
+    updateWholeFileDuration();
+    //The position starts from the beginning of the new file.
+    updatePositionAnchor(0);
+    //Emit the next file started signal.
+    emit nextFileStarted();
+}
 
+inline bool KNMusicBackendGStreamerThread::startNextSection()
+{
+    //Get the next section.
+    m_nextFileLock.lock();
+    QString nextFilePath=m_nextFilePath;
+    qint64 nextStart=m_nextStartPosition, nextDuration=m_nextDuration;
+    m_nextFilePath.clear();
+    m_nextFileLock.unlock();
+    //Check whether the next section is in the current file.
+    if(nextFilePath!=m_filePath || nextStart==-1)
+    {
+        return false;
     }
-    //Give back successful.
-    return TRUE;
+    //Update the section.
+    m_startPosition=nextStart;
+    m_endPosition=(nextDuration==-1)?m_totalDuration:nextStart+nextDuration;
+    //Check out the positions.
+    if(m_endPosition>m_totalDuration)
+    {
+        m_endPosition=m_totalDuration;
+    }
+    if(m_startPosition>m_endPosition)
+    {
+        m_startPosition=m_endPosition;
+    }
+    m_duration=m_endPosition-m_startPosition;
+    //Seek without flushing, the data of the next section will be played right
+    //after the current one.
+    if(!seekSection(0, (GstSeekFlags)(GST_SEEK_FLAG_ACCURATE |
+                                      GST_SEEK_FLAG_SEGMENT)))
+    {
+        return false;
+    }
+    //The duration is changed.
+    emit durationChanged(m_duration);
+    //The position starts from the beginning of the next section.
+    updatePositionAnchor(0);
+    //Emit the next file started signal.
+    emit nextFileStarted();
+    return true;
+}
+
+inline bool KNMusicBackendGStreamerThread::seekSection(
+        const qint64 &position,
+        const GstSeekFlags &flags)
+{
+    //Seek the section, set the stop position to the end of the section.
+    return gst_element_seek(m_playbin,
+                            1.0,
+                            GST_FORMAT_TIME,
+                            flags,
+                            GST_SEEK_TYPE_SET,
+                            (m_startPosition + position) * GST_MSECOND,
+                            GST_SEEK_TYPE_SET,
+                            m_endPosition * GST_MSECOND);
+}
 
+inline void KNMusicBackendGStreamerThread::updateWholeFileDuration()
+{
+    //Query the duration, it might not be known yet.
+    gint64 totalDuration;
+    if(!gst_element_query_duration(m_playbin,
+                                   GST_FORMAT_TIME,
+                                   &totalDuration) ||
+            totalDuration<=0)
+    {
+        return;
+    }
+    //Save the total duration as the duration.
+    m_totalDuration=(qint64)(totalDuration)/1000000;
+    m_duration=m_totalDuration;
+    //The duration is changed.
+    emit durationChanged(m_duration);
+}
+
+inline void KNMusicBackendGStreamerThread::updateDuration()
+{
+    //Check whether we are waiting for the duration.
+    if(!m_durationPending)
+    {
+        return;
+    }
+    //Query the duration, it might not be known yet. Then wait for the next
+    //duration changed or async done message.
+    gint64 totalDuration;
+    if(!gst_element_query_duration(m_playbin,
+                                   GST_FORMAT_TIME,
+                                   &totalDuration) ||
+            totalDuration<=0)
+    {
+        return;
+    }
+    //The duration is found.
+    stopWaitingDuration();
+    //Save the total duration, we are using millisecond while gstreamer is
+    //using nanosecond.
+    m_totalDuration=(qint64)(totalDuration)/1000000;
+    //Check if section has been set then update the position.
+    if(m_sectionSet)
+    {
+        //Check out the start and end position.
+        updateStartAndEndPosition();
+    }
+    //If we comes to here, that means the file is loaded.
+    emit loadSuccess();
+}
+
+inline void KNMusicBackendGStreamerThread::stopWaitingDuration()
+{
+    //Reset the pending flag and stop the timeout timer.
+    m_durationPending=false;
+    m_durationTimeout->stop();
 }
 
 inline void KNMusicBackendGStreamerThread::resetPipeline()
@@ -478,12 +718,33 @@ inline void KNMusicBackendGStreamerThread::resetParameter()
     m_endPosition=m_duration;
     //Reset the section set flag.
     m_sectionSet=false;
+    //Clear the pending section seek.
+    m_pendingPosition=-1;
 }
 
-inline bool KNMusicBackendGStreamerThread::rebuildPipeline()
+inline bool KNMusicBackendGStreamerThread::preparePipeline()
 {
-    //Reset the playbin.
-    resetPipeline();
+    //Check whether the playbin could be reused.
+    if(m_playbin!=NULL)
+    {
+        //Set the playbin back to ready, the uri could be changed then. All the
+        //elements are kept, switching the file is much cheaper than building
+        //a new pipeline.
+        gst_element_set_state(m_playbin, GST_STATE_READY);
+        //Drop the messages of the previous file.
+        {
+            //Get the bus from playbin pipeline.
+            GstBus *bus=gst_pipeline_get_bus(GST_PIPELINE(m_playbin));
+            //Flush the bus.
+            gst_bus_set_flushing(bus, TRUE);
+            gst_bus_set_flushing(bus, FALSE);
+            //Remove the bus reference.
+            gst_object_unref(bus);
+        }
+        //Reset the state.
+        setPlayingState(MusicUtil::Stopped);
+        return true;
+    }
     //Initial the playbin.
     m_playbin=gst_element_factory_make("playbin", "playbin");
     //Check playbin.
@@ -514,6 +775,11 @@ inline bool KNMusicBackendGStreamerThread::rebuildPipeline()
         //Remove the bus reference.
         gst_object_unref(bus);
     }
+    //Link the about-to-finish signal for gapless playing.
+    g_signal_connect(m_playbin,
+                     "about-to-finish",
+                     G_CALLBACK(&KNMusicBackendGStreamerThread::aboutToFinish),
+                     (gpointer)this);
     //Reset the volume size.
     setVolume(m_volume);
     //Finished.
@@ -555,6 +821,17 @@ inline void KNMusicBackendGStreamerThread::updateStartAndEndPosition()
     setPosition(0);
 }
 
+inline void KNMusicBackendGStreamerThread::updateCurrentPositionAnchor()
+{
+    //Get the current position.
+    qint64 currentPosition=position();
+    //Report the anchor when the position is valid.
+    if(currentPosition>-1)
+    {
+        updatePositionAnchor(currentPosition);
+    }
+}
+
 inline void KNMusicBackendGStreamerThread::setPlayingState(const int &state)
 {
     //Save the state.
@@ -21,6 +21,8 @@
 
 #include <gst/gst.h>
 
+#include <QMutex>
+
 #include "knmusicglobal.h"
 
 #include "knmusicstandardbackendthread.h"
@@ -42,6 +44,15 @@
  *    them will give out a GST_MESSAGE_NEW_CLOCK message.
  * 4. If you want to change volume of a playbin, set the volume property of the
  *    playbin.
+ * 5. To play the next file without gap, the uri of the next file has to be set
+ *    in the about-to-finish signal handler. The signal is emitted from the
+ *    streaming thread, and a STREAM_START message will be posted when the next
+ *    file starts to play, no EOS message will be posted.
+ * 6. A seek with GST_SEEK_FLAG_SEGMENT and a stop position plays only the
+ *    section, a SEGMENT_DONE message will be posted at the stop position
+ *    instead of EOS. Another segment seek without the flush flag in that
+ *    message continues playing without any gap. The seek only works after the
+ *    pipeline is prerolled, which posts an ASYNC_DONE message.
  *
  * Oct 24th, 2015
  * There're playbin and playbin2 in GStreamer 0.10. But when it comes to 1.0
@@ -117,6 +128,13 @@ public:
     void setPlaySection(const qint64 &start=-1,
                         const qint64 &duration=-1) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setNextFile().
+     */
+    bool setNextFile(const QString &filePath,
+                     const qint64 &start=-1,
+                     const qint64 &duration=-1) Q_DECL_OVERRIDE;
+
     /*!
      * \brief Get the playbin of the playing thread. This function shouldn't be
      * called by any other class.
@@ -150,38 +168,57 @@ public slots:
     void setVolume(const int &volume) Q_DECL_OVERRIDE;
 
     /*!
-     * \brief Reimplemented from KNMusicStandardBackendThread::setPosition().
+     * \brief Reimplemented from KNMusicStandardBackendThread::setFadeVolume().
      */
-    void setPosition(const qint64 &position) Q_DECL_OVERRIDE;
+    void setFadeVolume(const qreal &scale) Q_DECL_OVERRIDE;
 
     /*!
-     * \brief This slot will be called from the call back function. It shouldn't
-     * be called by other classes.
+     * \brief Reimplemented from KNMusicStandardBackendThread::setGainVolume().
      */
-    void updateDuration();
+    void setGainVolume(const qreal &scale) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setPosition().
+     */
+    void setPosition(const qint64 &position) Q_DECL_OVERRIDE;
 
 private slots:
-    void onActionTick();
+    void onActionDurationTimeout();
     void processEvents(int type);
 
 private:
     static gboolean busWatch(GstBus *bus, GstMessage *message, gpointer data);
+    static void aboutToFinish(GstElement *playbin, gpointer data);
+    inline void clearNextFile();
+    inline void startNextFile();
+    inline bool startNextSection();
+    inline bool seekSection(const qint64 &position,
+                            const GstSeekFlags &flags);
+    inline void updateWholeFileDuration();
+    inline void updateDuration();
+    inline void stopWaitingDuration();
     inline void resetPipeline();
     inline void resetParameter();
-    inline bool rebuildPipeline();
+    inline bool preparePipeline();
     inline void updateStartAndEndPosition();
+    inline void updateCurrentPositionAnchor();
     inline void setPlayingState(const int &state);
-    QString m_filePath;
+    QString m_filePath, m_nextFilePath, m_queuedFilePath;
+    QMutex m_nextFileLock;
     qint64 m_startPosition,
            m_endPosition,
            m_duration,
            m_totalDuration;
+    qint64 m_nextStartPosition,
+           m_nextDuration,
+           m_pendingPosition;
     gint64 m_savedPosition;
-    QTimer *m_tick;
+    QTimer *m_durationTimeout;
     GstElement *m_playbin;
-    const GstSeekFlags m_seekFlag;
+    const GstSeekFlags m_seekFlag, m_sectionSeekFlag;
+    qreal m_fadeVolume, m_gainVolume;
     int m_state, m_volume;
-    bool m_sectionSet;
+    bool m_sectionSet, m_durationPending;
 };
 
 #endif // KNMUSICBACKENDGSTREAMERTHREAD_H
@@ -26,13 +26,12 @@ KNMusicBackendQtAVThread::KNMusicBackendQtAVThread(QObject *parent) :
     m_startPosition(-1),
     m_endPosition(-1),
     m_volumeSize(1.0),
+    m_gainVolume(1.0),
     m_status(MusicUtil::Stopped)
 {
-    //Change the notify interval.
-    m_player->setNotifyInterval(16);
     //Link the player to the signals.
-    connect(m_player, &QtAV::AVPlayer::positionChanged,
-            this, &KNMusicBackendQtAVThread::onActionPositionChanged);
+    connect(m_player, &QtAV::AVPlayer::stopped,
+            this, &KNMusicBackendQtAVThread::onActionStopped);
     connect(m_player, &QtAV::AVPlayer::mediaStatusChanged,
             this, &KNMusicBackendQtAVThread::onActionMediaStateChanged);
     connect(m_player, SIGNAL(loaded()), this, SLOT(onActionLoaded()));
@@ -71,10 +70,10 @@ void KNMusicBackendQtAVThread::stop()
 {
     //Stop the player.
     stopPlayer();
-    //Update the position as soon as possible.
-    emit positionChanged(m_startPosition);
     //Emit the state changed signal.
     emit stateChanged(m_status);
+    //Update the position as soon as possible.
+    updatePositionAnchor(0);
 }
 
 void KNMusicBackendQtAVThread::play()
@@ -100,6 +99,8 @@ void KNMusicBackendQtAVThread::play()
     m_status=MusicUtil::Playing;
     //Emit the state changed signal.
     emit stateChanged(m_status);
+    //The position starts moving.
+    updatePositionAnchor(qMax(position(), 0LL));
 }
 
 void KNMusicBackendQtAVThread::pause()
@@ -113,6 +114,8 @@ void KNMusicBackendQtAVThread::pause()
         m_status=MusicUtil::Paused;
         //Emit the state changed signal.
         emit stateChanged(m_status);
+        //The position stops moving.
+        updatePositionAnchor(position());
     }
 }
 
@@ -169,7 +172,19 @@ void KNMusicBackendQtAVThread::setVolume(const int &volume)
     if(m_player->audio())
     {
         //Set the volumn to the player.
-        m_player->audio()->setVolume(m_volumeSize);
+        m_player->audio()->setVolume(m_volumeSize*m_gainVolume);
+    }
+}
+
+void KNMusicBackendQtAVThread::setGainVolume(const qreal &scale)
+{
+    //Save the gain volume scale.
+    m_gainVolume=scale;
+    //Check out the audio pointer.
+    if(m_player->audio())
+    {
+        //Set the scaled volumn to the player.
+        m_player->audio()->setVolume(m_volumeSize*m_gainVolume);
     }
 }
 
@@ -180,24 +195,31 @@ void KNMusicBackendQtAVThread::setPosition(const qint64 &position)
     //Check the position and the duration is valid or not.
     if(m_player->duration() > 0 && m_status!=MusicUtil::Stopped)
     {
-        m_player->seek(preferPosition>=m_endPosition?
-                           m_endPosition:
-                           preferPosition);
+        //Limit the position in the section.
+        preferPosition=qMin(preferPosition, m_endPosition);
+        //Seek the player.
+        m_player->seek(preferPosition);
+        //The position jumps to the new position.
+        updatePositionAnchor(preferPosition-m_startPosition);
     }
 }
 
-void KNMusicBackendQtAVThread::onActionPositionChanged(const qint64 &position)
+void KNMusicBackendQtAVThread::onActionStopped()
 {
-    //Emit the position changed signal.
-    emit positionChanged(position-m_startPosition);
-    //Check whether the position reach the end position.
-    if(m_endPosition!=0 && position>=m_endPosition)
+    //Check whether the player is stopped by itself. It stops at the stop
+    //position of the section or the end of the file.
+    if(m_status!=MusicUtil::Playing)
     {
-        //Stop the player.
-        stopPlayer();
-        //Emit a finished signal.
-        emit finished();
+        return;
     }
+    //Reset the state data.
+    m_status=MusicUtil::Stopped;
+    //Emit the state changed signal.
+    emit stateChanged(m_status);
+    //Update the position.
+    updatePositionAnchor(0);
+    //Emit a finished signal.
+    emit finished();
 }
 
 void KNMusicBackendQtAVThread::onActionMediaStateChanged(
@@ -221,7 +243,7 @@ void KNMusicBackendQtAVThread::onActionLoaded()
     if(m_player->audio())
     {
         //Set the volume size.
-        m_player->audio()->setVolume(m_volumeSize);
+        m_player->audio()->setVolume(m_volumeSize*m_gainVolume);
     }
     //Set the start and end position.
     m_player->setStartPosition(m_startPosition);
@@ -241,8 +263,9 @@ void KNMusicBackendQtAVThread::onActionLoaded()
 
 inline void KNMusicBackendQtAVThread::stopPlayer()
 {
+    //Reset the state data first, the stopped signal of the player won't be
+    //treated as finished.
+    m_status=MusicUtil::Stopped;
     //Set the player to stop state.
     m_player->stop();
-    //Reset the state data.
-    m_status=MusicUtil::Stopped;
 }
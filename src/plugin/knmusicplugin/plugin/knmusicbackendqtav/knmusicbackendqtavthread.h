@@ -81,6 +81,11 @@ public:
      */
     void setPlaySection(const qint64 &start=-1,
                         const qint64 &duration=-1) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicStandardBackendThread::setGainVolume().
+     */
+    void setGainVolume(const qreal &scale) Q_DECL_OVERRIDE;
 signals:
 
 public slots:
@@ -95,7 +100,7 @@ public slots:
     void setPosition(const qint64 &position) Q_DECL_OVERRIDE;
 
 private slots:
-    void onActionPositionChanged(const qint64 &position);
+    void onActionStopped();
     void onActionMediaStateChanged(const QtAV::MediaStatus &status);
     void onActionLoaded();
 
@@ -104,7 +109,7 @@ private:
     QtAV::AVPlayer *m_player;
     qint64 m_startPosition,
            m_endPosition;
-    qreal m_volumeSize;
+    qreal m_volumeSize, m_gainVolume;
     int m_status;
 };
 
@@ -31,6 +31,7 @@
 #include "knmusicglobal.h"
 #include "knmusicparser.h"
 #include "knmusicmodel.h"
+#include "knmusicpositionclock.h"
 
 #include "knmusicdetailtooltip.h"
 
@@ -50,6 +51,7 @@ KNMusicDetailTooltip::KNMusicDetailTooltip(QWidget *parent) :
     m_albumArt(new KNMusicAlbumLabel(this)),
     m_playNPause(new KNOpacityButton(this)),
     m_progress(new KNProgressSlider(this)),
+    m_positionClock(new KNMusicPositionClock(this)),
     m_playIcon(QIcon(":/plugin/music/player/play_light.png")),
     m_pauseIcon(QIcon(":/plugin/music/player/pause_light.png")),
     m_isPlaying(false),
@@ -61,6 +63,10 @@ KNMusicDetailTooltip::KNMusicDetailTooltip(QWidget *parent) :
     setAutoFillBackground(true);
     setWindowFlags(Qt::ToolTip);
     setFixedSize(TooltipWidth, TooltipHeight);
+    //Configure the position clock, it only works when the tooltip is visible.
+    m_positionClock->addView(this);
+    connect(m_positionClock, &KNMusicPositionClock::positionChanged,
+            this, &KNMusicDetailTooltip::onActionPreviewPositionChanged);
 
     //Initial the main layout.
     QBoxLayout *mainLayout=new QBoxLayout(QBoxLayout::LeftToRight,
@@ -385,8 +391,8 @@ void KNMusicDetailTooltip::loadPreview()
         KNMusicBackend *backend=knMusicGlobal->backend();
         //Link the backend with the preview widget.
         m_backendHandler.append(
-          connect(backend, &KNMusicBackend::previewPositionChanged,
-                  this, &KNMusicDetailTooltip::onActionPreviewPositionChanged));
+          connect(backend, &KNMusicBackend::previewPositionAnchorChanged,
+                  m_positionClock, &KNMusicPositionClock::setAnchor));
         m_backendHandler.append(
           connect(backend, &KNMusicBackend::previewDurationChanged,
                   this, &KNMusicDetailTooltip::onActionPreviewDurationChanged));
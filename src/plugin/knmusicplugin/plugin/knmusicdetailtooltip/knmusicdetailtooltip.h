@@ -34,6 +34,7 @@ class KNOpacityButton;
 class KNProgressSlider;
 class KNMusicBackend;
 class KNMusicAlbumLabel;
+class KNMusicPositionClock;
 /*!
  * \brief The KNMusicDetailTooltip class is a default realization of the
  * KNMusicDetailTooltip class. It provides the basic information of a song and
@@ -112,6 +113,7 @@ private:
     KNScrollLabel *m_labels[ToolTipItemsCount];
     KNOpacityButton *m_playNPause;
     KNProgressSlider *m_progress;
+    KNMusicPositionClock *m_positionClock;
     QIcon m_playIcon, m_pauseIcon;
 
     bool m_isPlaying, m_progressPressed;
@@ -24,6 +24,8 @@ extern "C"
 #include <libavformat/avformat.h>
 }
 
+#include "knmusicloudnessmeter.h"
+
 #include "knmusicffmpeganalysiser.h"
 
 KNMusicFfmpegAnalysiser::KNMusicFfmpegAnalysiser(QObject *parent) :
@@ -125,3 +127,146 @@ bool KNMusicFfmpegAnalysiser::analysis(KNMusicDetailInfo &detailInfo)
     //Analysis complete.
     return true;
 }
+
+bool KNMusicFfmpegAnalysiser::scanLoudness(KNMusicDetailInfo &detailInfo)
+{
+    //Generate the format context pointer.
+    AVFormatContext *formatContext=NULL;
+    //Open the file with ffmpeg.
+    if(avformat_open_input(
+                &formatContext,
+                QDir::toNativeSeparators(
+                    detailInfo.filePath).toLocal8Bit().data(),
+                NULL,
+                NULL))
+    {
+        //Failed to open the file.
+        return false;
+    }
+    //Find the stream info from the context.
+    if(avformat_find_stream_info(formatContext, NULL)<0)
+    {
+        //Close the format context.
+        avformat_close_input(&formatContext);
+        //Failed to analysis the file.
+        return false;
+    }
+    //Find the best audio stream.
+    int streamIndex=av_find_best_stream(formatContext, AVMEDIA_TYPE_AUDIO,
+                                        -1, -1, NULL, 0);
+    if(streamIndex<0)
+    {
+        //Close the format context.
+        avformat_close_input(&formatContext);
+        //We can't find any audio stream in the file.
+        return false;
+    }
+    //Get the codec context of the stream.
+    AVCodecContext *codecContext=formatContext->streams[streamIndex]->codec;
+    //Find the decoder, and then open the codec context using the codec.
+    AVCodec *codec=avcodec_find_decoder(codecContext->codec_id);
+    if((!codec) || (avcodec_open2(codecContext, codec, NULL)<0) ||
+            codecContext->channels<1 || codecContext->sample_rate<1)
+    {
+        //Close the format context.
+        avformat_close_input(&formatContext);
+        //Failed to decode the file.
+        return false;
+    }
+    //Prepare the meter and the decoding frame.
+    int channels=codecContext->channels;
+    KNMusicLoudnessMeter meter(channels, codecContext->sample_rate);
+    QVector<qreal> frameSamples(channels);
+    AVFrame *frame=av_frame_alloc();
+    AVPacket packet;
+    av_init_packet(&packet);
+    //Decode all the packets of the audio stream.
+    while(av_read_frame(formatContext, &packet)>=0)
+    {
+        //Only the packet of the audio stream is used.
+        if(packet.stream_index==streamIndex)
+        {
+            //Backup the packet for decoding, a packet might contains several
+            //frames.
+            AVPacket decodingPacket=packet;
+            while(decodingPacket.size>0)
+            {
+                //Decode the packet.
+                int gotFrame=0,
+                    usedSize=avcodec_decode_audio4(codecContext, frame,
+                                                   &gotFrame, &decodingPacket);
+                //Check the result, skip the broken packet.
+                if(usedSize<0)
+                {
+                    break;
+                }
+                //Move to the rest data.
+                decodingPacket.data+=usedSize;
+                decodingPacket.size-=usedSize;
+                //Check whether a frame is decoded.
+                if(!gotFrame)
+                {
+                    continue;
+                }
+                //Add all the samples to the meter.
+                for(int i=0; i<frame->nb_samples; ++i)
+                {
+                    for(int j=0; j<channels; ++j)
+                    {
+                        frameSamples[j]=sampleValue(frame, j, i, channels);
+                    }
+                    meter.addFrame(frameSamples.constData());
+                }
+            }
+        }
+        //Free the packet.
+        av_free_packet(&packet);
+    }
+    //Free the frame.
+    av_frame_free(&frame);
+    //Close the the codec.
+    avcodec_close(codecContext);
+    //Close the format context.
+    avformat_close_input(&formatContext);
+    //Check the loudness, a silent file doesn't have a gain.
+    if(!meter.hasLoudness())
+    {
+        return false;
+    }
+    //Save the track gain and the track peak.
+    detailInfo.replayGain.trackGain=meter.replayGain();
+    detailInfo.replayGain.trackPeak=meter.peak();
+    detailInfo.replayGain.hasTrackGain=true;
+    //Scanning complete.
+    return true;
+}
+
+inline qreal KNMusicFfmpegAnalysiser::sampleValue(const AVFrame *frame,
+                                                  const int &channel,
+                                                  const int &index,
+                                                  const int &channels)
+{
+    //Get the sample format, for planar format, each channel has its own data
+    //plane, or else the samples are interleaved in the first plane.
+    AVSampleFormat format=(AVSampleFormat)frame->format;
+    bool planar=av_sample_fmt_is_planar(format);
+    const uint8_t *data=planar?frame->extended_data[channel]:
+                               frame->extended_data[0];
+    int position=planar?index:(index*channels+channel);
+    //Translate the sample to the range [-1.0, 1.0].
+    switch(av_get_packed_sample_fmt(format))
+    {
+    case AV_SAMPLE_FMT_U8:
+        return ((qreal)data[position]-128.0)/128.0;
+    case AV_SAMPLE_FMT_S16:
+        return (qreal)((const qint16 *)data)[position]/32768.0;
+    case AV_SAMPLE_FMT_S32:
+        return (qreal)((const qint32 *)data)[position]/2147483648.0;
+    case AV_SAMPLE_FMT_FLT:
+        return (qreal)((const float *)data)[position];
+    case AV_SAMPLE_FMT_DBL:
+        return (qreal)((const double *)data)[position];
+    default:
+        return 0.0;
+    }
+}
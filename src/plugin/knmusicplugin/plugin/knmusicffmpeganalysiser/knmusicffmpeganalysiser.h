@@ -21,6 +21,8 @@
 
 #include "knmusicanalysiser.h"
 
+struct AVFrame;
+
 /*
  * Aug 23th, 2015:
  *  This version is re-written under Mac OS X 10.9 with FFMpeg installed via
@@ -54,6 +56,17 @@ public:
      * \brief Reimplemented from KNMusicAnalysiser::analysis().
      */
     bool analysis(KNMusicDetailInfo &detailInfo) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicAnalysiser::scanLoudness().
+     */
+    bool scanLoudness(KNMusicDetailInfo &detailInfo) Q_DECL_OVERRIDE;
+
+private:
+    static inline qreal sampleValue(const AVFrame *frame,
+                                    const int &channel,
+                                    const int &index,
+                                    const int &channels);
 };
 
 #endif // KNMUSICFFMPEGANALYSISER_H
@@ -42,6 +42,7 @@
 #include "knmusicdetaildialog.h"
 #include "knmusiclyricsmanager.h"
 #include "knmusicbackend.h"
+#include "knmusicpositionclock.h"
 #include "knmusicnowplayingbase.h"
 #include "knmusicscrolllyrics.h"
 
@@ -99,6 +100,7 @@ KNMusicHeaderPlayer::KNMusicHeaderPlayer(QWidget *parent) :
     m_showAppend(generateAnime(m_appendPanel)),
     m_hideAppend(generateAnime(m_appendPanel)),
     m_backend(nullptr),
+    m_positionClock(new KNMusicPositionClock(this)),
     m_nowPlaying(nullptr),
     m_cacheConfigure(
         knGlobal->cacheConfigure()->getConfigure("MusicHeaderPlayer")),
@@ -437,7 +439,11 @@ void KNMusicHeaderPlayer::setBackend(KNMusicBackend *backend)
                 m_backend->play();
             });
     //Connect the response.
-    connect(m_backend, &KNMusicBackend::positionChanged,
+    //The position is only updated when the progress slider is visible.
+    m_positionClock->addView(m_progressSlider);
+    connect(m_backend, &KNMusicBackend::positionAnchorChanged,
+            m_positionClock, &KNMusicPositionClock::setAnchor);
+    connect(m_positionClock, &KNMusicPositionClock::positionChanged,
             [=](const qint64 &position)
             {
                 //Update the value of progress slider when the progress slider
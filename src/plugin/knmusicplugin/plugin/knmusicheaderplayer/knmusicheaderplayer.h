@@ -42,6 +42,7 @@ class KNScrollLabel;
 class KNProgressSlider;
 class KNVolumeSlider;
 class KNMusicScrollLyrics;
+class KNMusicPositionClock;
 /*!
  * \brief The KNMusicHeaderPlayer class is a default header player implemented
  * from the header player base. This is an example of the header player base.
@@ -186,6 +187,7 @@ private:
 
     //Plugins.
     KNMusicBackend *m_backend;
+    KNMusicPositionClock *m_positionClock;
     KNMusicNowPlayingBase *m_nowPlaying;
 
     //Configures.
@@ -25,6 +25,7 @@
 
 //Library SDK Plugins.
 #include "sdk/knmusiclibrarymodel.h"
+#include "sdk/knmusiclibraryimagemanager.h"
 #include "sdk/knmusiccategorymodel.h"
 #include "sdk/knmusicalbummodel.h"
 #include "sdk/knmusicgenremodel.h"
@@ -70,6 +71,11 @@ KNMusicLibrary::KNMusicLibrary(QObject *parent) :
             static_cast<KNMusicLibraryAlbumTab *>(m_libraryTabs[TabAlbums]);
     //Set the album art hash.
     albumTab->setImageManager(m_libraryModel->imageManager());
+    //Forward the style changed signal of the image manager.
+    connect(m_libraryModel->imageManager(),
+            &KNMusicLibraryImageManager::artworkStyleChanged,
+            this, &KNMusicLibrary::artworkStyleChanged,
+            Qt::QueuedConnection);
 
     //Generate the show in action list.
     QList<QAction *> showInActionList;
@@ -119,6 +125,12 @@ bool KNMusicLibrary::isWorking()
     return m_libraryModel->isWorking();
 }
 
+KNMusicArtworkStyle KNMusicLibrary::artworkStyle(const QString &hashKey)
+{
+    //The style is generated and cached by the image manager.
+    return m_libraryModel->imageManager()->artworkStyle(hashKey);
+}
+
 void KNMusicLibrary::showInSongTab()
 {
     //Check out now playing pointer.
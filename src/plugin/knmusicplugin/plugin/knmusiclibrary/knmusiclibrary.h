@@ -69,6 +69,11 @@ public:
      */
     bool isWorking() Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicLibraryBase::artworkStyle().
+     */
+    KNMusicArtworkStyle artworkStyle(const QString &hashKey) Q_DECL_OVERRIDE;
+
 signals:
 
 public slots:
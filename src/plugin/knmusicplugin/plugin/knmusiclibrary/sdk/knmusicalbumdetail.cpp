@@ -73,6 +73,7 @@ KNMusicAlbumDetail::KNMusicAlbumDetail(QWidget *parent, KNMusicTab *tab) :
     m_hideAlbumArtLabel(generateAnime(m_albumArt)),
     m_hideAlbumContent(generateAnime(m_albumContent)),
     m_imageManager(nullptr),
+    m_contentColor(QColor(255,255,255)),
     m_iconSize(0),
     m_panelSize(0),
     m_backgroundAnime(true),
@@ -90,9 +91,7 @@ KNMusicAlbumDetail::KNMusicAlbumDetail(QWidget *parent, KNMusicTab *tab) :
     //Configure the album content.
     m_albumContent->setAutoFillBackground(true);
     m_albumContent->setFocusPolicy(Qt::StrongFocus);
-    QPalette contentPalette=m_albumContent->palette();
-    contentPalette.setColor(QPalette::Window, QColor(255,255,255,240));
-    m_albumContent->setPalette(contentPalette);
+    updateContentColor(240);
     //Configure the album title label.
     m_albumTitle->setObjectName("MusicAlbumTitleLabel");
     m_albumTitle->setGlowRadius(4.0);
@@ -237,9 +236,7 @@ void KNMusicAlbumDetail::displayAlbumDetail(const QModelIndex &index)
                                          m_currentIndex.data(Qt::DisplayRole));
     m_albumListView->scrollToTop();
     //Initial the opacity effect.
-    QPalette contentPalette=m_albumContent->palette();
-    contentPalette.setColor(QPalette::Window, QColor(255,255,255,240));
-    m_albumContent->setPalette(contentPalette);
+    updateContentColor(240);
     //Set the position.
     QRect albumArtStartRect(m_animeStartRect.x(),
                             m_animeStartRect.y(),
@@ -338,6 +335,10 @@ void KNMusicAlbumDetail::setImageManager(
     connect(m_imageManager, &KNMusicLibraryImageManager::imageInserted,
             this, &KNMusicAlbumDetail::onActionImageInserted,
             Qt::QueuedConnection);
+    //The style of the album art is generated after the image is inserted.
+    connect(m_imageManager, &KNMusicLibraryImageManager::artworkStyleChanged,
+            this, &KNMusicAlbumDetail::onActionImageInserted,
+            Qt::QueuedConnection);
 }
 
 void KNMusicAlbumDetail::onActionAlbumArtUpdate(const QModelIndex &updatedIndex)
@@ -479,12 +480,7 @@ void KNMusicAlbumDetail::onActionExpandStep1(const QVariant &position)
         setPalette(pal);
     }
     //Set the opacity effect.
-    QPalette contentPalette=m_albumContent->palette();
-    contentPalette.setColor(QPalette::Window, QColor(255,
-                                                     255,
-                                                     255,
-                                                     progress*240.0));
-    m_albumContent->setPalette(contentPalette);
+    updateContentColor(progress*240.0);
 }
 
 void KNMusicAlbumDetail::onActionExpandStep1InFinished()
@@ -528,9 +524,7 @@ void KNMusicAlbumDetail::onActionFold(const QVariant &position)
     pal.setColor(QPalette::Window, QColor(0,0,0,progress*200));
     setPalette(pal);
     //Set the opacity effect.
-    pal=m_albumContent->palette();
-    pal.setColor(QPalette::Window, QColor(255,255,255,progress*240.0));
-    m_albumContent->setPalette(pal);
+    updateContentColor(progress*240.0);
 }
 
 void KNMusicAlbumDetail::onActionFlyAwayFinished()
@@ -552,9 +546,7 @@ void KNMusicAlbumDetail::onActionFlyAway(const QVariant &position)
     pal.setColor(QPalette::Window, QColor(0,0,0,progress*200));
     setPalette(pal);
     //Set the opacity effect.
-    pal=m_albumContent->palette();
-    pal.setColor(QPalette::Window, QColor(255,255,255,progress*240.0));
-    m_albumContent->setPalette(pal);
+    updateContentColor(progress*240.0);
 }
 
 void KNMusicAlbumDetail::onActionImageInserted(const QString &hashKey)
@@ -570,8 +562,8 @@ void KNMusicAlbumDetail::onActionImageInserted(const QString &hashKey)
         //Check album hash key.
         if(albumHashKey==hashKey)
         {
-            //Set the album art.
-            m_albumArt->setAlbumArt(m_imageManager->artwork(albumHashKey));
+            //Update the album art and its style.
+            updateAlbumArtwork();
         }
     }
 }
@@ -672,9 +664,33 @@ void KNMusicAlbumDetail::updateAlbumArtwork()
         m_albumArt->setAlbumArt(albumArtImage.isNull()?
                                     knMusicGlobal->noAlbumArt():
                                     albumArtImage);
+        //Get the precomputed style of the album art.
+        KNMusicArtworkStyle &&style=m_imageManager->artworkStyle(albumHashKey);
+        //Tint the content background with the dominant colour of the album
+        //art, or use white for no album art.
+        m_contentColor=style.isNull()?
+                    QColor(255,255,255):
+                    QColor(255-((255-style.dominantColor.red())>>3),
+                           255-((255-style.dominantColor.green())>>3),
+                           255-((255-style.dominantColor.blue())>>3));
+        //Update the content color, keep the current opacity.
+        updateContentColor(
+                    m_albumContent->palette().color(QPalette::Window).alpha());
     }
 }
 
+inline void KNMusicAlbumDetail::updateContentColor(int alpha)
+{
+    //Get the content color.
+    QColor contentColor=m_contentColor;
+    //Set the opacity.
+    contentColor.setAlpha(alpha);
+    //Set the palette.
+    QPalette contentPalette=m_albumContent->palette();
+    contentPalette.setColor(QPalette::Window, contentColor);
+    m_albumContent->setPalette(contentPalette);
+}
+
 inline void KNMusicAlbumDetail::updatePanelSize()
 {
     //Check the width and height of the widget.
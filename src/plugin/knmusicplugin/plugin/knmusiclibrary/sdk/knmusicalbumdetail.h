@@ -210,6 +210,7 @@ private:
     inline void updateShadowGeometries(const QRect &contentPosition);
     inline void updateExpandAlbumParameter();
     inline void updateFoldAlbumParameter();
+    inline void updateContentColor(int alpha);
     inline QPropertyAnimation *generateAnime(
             QObject *target,
             QEasingCurve::Type type=QEasingCurve::OutCubic);
@@ -235,6 +236,7 @@ private:
                        *m_hideAlbumArtLabel, *m_hideAlbumContent;
 
     KNMusicLibraryImageManager *m_imageManager;
+    QColor m_contentColor;
     int m_iconSize, m_panelSize;
     bool m_backgroundAnime, m_pressed;
 };
@@ -18,6 +18,7 @@
 #include "knlocalemanager.h"
 
 #include "knmusicglobal.h"
+#include "knmusiclibraryimagemanager.h"
 
 #include "knmusicalbummodel.h"
 
@@ -26,10 +27,11 @@
 KNMusicAlbumModel::KNMusicAlbumModel(QObject *parent) :
     KNMusicCategoryModelBase(parent),
     m_categoryList(QList<AlbumItem>()),
+    m_albumIndex(QHash<QString, int>()),
     m_nullData(QVariant()),
     m_noCategoryText(QString()),
     m_variousArtists(QString()),
-    m_hashAlbumArt(nullptr)
+    m_imageManager(nullptr)
 {
     //Link retranslate signal.
     knI18n->link(this, &KNMusicAlbumModel::retranslate);
@@ -62,6 +64,7 @@ void KNMusicAlbumModel::reset()
     beginRemoveRows(QModelIndex(), 0, m_categoryList.size()-1);
     //Remove all the data.
     m_categoryList.clear();
+    m_albumIndex.clear();
     //Insert the new no category item data to the item.
     m_categoryList.append(generateNoCategoryItem());
     //As the documentation said, called this after remove rows.
@@ -70,18 +73,10 @@ void KNMusicAlbumModel::reset()
 
 QModelIndex KNMusicAlbumModel::categoryIndex(const QVariant &categoryText)
 {
-    //Find through the list.
-    for(int i=0; i<m_categoryList.size(); ++i)
-    {
-        //If we find the text.
-        if(m_categoryList.at(i).title==categoryText)
-        {
-            //Give back the index.
-            return index(i, 0);
-        }
-    }
-    //Or else return a null index.
-    return QModelIndex();
+    //Find the row of the album.
+    int row=albumRow(categoryText);
+    //Give back the index, or a null index if the album doesn't exist.
+    return row==-1?QModelIndex():index(row, 0);
 }
 
 int KNMusicAlbumModel::rowCount(const QModelIndex &parent) const
@@ -108,16 +103,22 @@ QVariant KNMusicAlbumModel::data(const QModelIndex &index, int role) const
     case Qt::EditRole:
         return item.title;
     case Qt::DecorationRole:
-        return (m_hashAlbumArt==nullptr || item.albumArtHash.isEmpty())?
-                    m_nullData:
-                    m_hashAlbumArt->value(item.albumArtHash.first(),
-                                          m_nullData);
+    {
+        //Check out the album art hash.
+        if(m_imageManager==nullptr || item.albumArtHash.isEmpty())
+        {
+            return m_nullData;
+        }
+        //Get the album art from the image manager.
+        QPixmap albumArt=m_imageManager->albumArt(item.albumArtHash.cover);
+        return albumArt.isNull()?m_nullData:QVariant(albumArt);
+    }
     case Qt::SizeHintRole:
         return QSize(25, 25);
     case CategorySizeRole:
         return item.count;
     case CategoryArtworkKeyRole:
-        return item.albumArtHash.isEmpty()?QString():item.albumArtHash.first();
+        return item.albumArtHash.cover;
     case AlbumArtistRole:
         return item.artists.isEmpty()?
                     m_nullData:
@@ -167,6 +168,14 @@ bool KNMusicAlbumModel::setData(const QModelIndex &index,
     {
     case Qt::DisplayRole:
     case Qt::EditRole:
+        //Update the album index, the no category item is not indexed.
+        if(index.row()>0)
+        {
+            //Remove the previous title.
+            m_albumIndex.remove(albumItem.title.toString());
+            //Add the new title.
+            m_albumIndex.insert(value.toString(), index.row());
+        }
         //Change the display text.
         albumItem.title=value;
         //Replace the item.
@@ -192,9 +201,10 @@ int KNMusicAlbumModel::categoryColumn() const
     return Album;
 }
 
-void KNMusicAlbumModel::setHashAlbumArt(QHash<QString, QVariant> *hashAlbumArt)
+void KNMusicAlbumModel::setImageManager(
+        KNMusicLibraryImageManager *imageManager)
 {
-    m_hashAlbumArt=hashAlbumArt;
+    m_imageManager=imageManager;
 }
 
 void KNMusicAlbumModel::setCategoryColumn(int categoryColumn)
@@ -238,7 +248,6 @@ void KNMusicAlbumModel::onCategoryAdd(const KNMusicDetailInfo &detailInfo)
 {
     //Get the category text.
     QVariant titleText=detailInfo.textLists[Album];
-    QString artistText=detailInfo.textLists[Artist].toString();
     //Check if the category is blank.
     if(titleText.toString().isEmpty())
     {
@@ -252,44 +261,110 @@ void KNMusicAlbumModel::onCategoryAdd(const KNMusicDetailInfo &detailInfo)
         return;
     }
     //Find the category text.
-    for(int i=0; i<m_categoryList.size(); ++i)
+    int row=albumRow(titleText);
+    //If we could find the item.
+    if(row!=-1)
+    {
+        //Get the category list data.
+        AlbumItem item=m_categoryList.at(row);
+        //Add the detail info to the item.
+        countDetailInfo(item, detailInfo);
+        //Replace the item.
+        replaceItem(row, item);
+        //Mission complete.
+        return;
+    }
+    //We need to generate a new item for it.
+    AlbumItem item;
+    item.title=titleText;
+    //Add the detail info to the item.
+    countDetailInfo(item, detailInfo);
+    //Append the item.
+    appendItem(item);
+}
+
+void KNMusicAlbumModel::onCategoryAddBatch(
+        const QList<KNMusicDetailInfo> &detailInfos)
+{
+    //Check the list and the no category item.
+    if(detailInfos.isEmpty() || m_categoryList.isEmpty())
+    {
+        return;
+    }
+    //The range of the existing items which have been changed.
+    int changedTop=m_categoryList.size(), changedBottom=-1;
+    //The new albums which are not in the list, and their index in the new item
+    //list.
+    QList<AlbumItem> newItems;
+    QHash<QString, int> newItemIndex;
+    //Add all the detail info in one pass.
+    for(const auto &i : detailInfos)
     {
-        //If we could find the item.
-        if(m_categoryList.at(i).title==titleText)
+        //Get the album title.
+        QVariant titleText=i.textLists[Album];
+        QString titleKey=titleText.toString();
+        //Check if the category is blank.
+        bool noCategory=titleKey.isEmpty();
+        int row=noCategory?0:albumRow(titleText);
+        //Check whether the album exist in the list.
+        if(row!=-1)
         {
-            //Get the category list data.
-            AlbumItem item=m_categoryList.at(i);
-            //Increase the count.
-            ++(item.count);
-            //Check out the cover image hash.
-            if(!detailInfo.coverImageHash.isEmpty())
+            //Get the album item.
+            AlbumItem &item=m_categoryList[row];
+            //The no category item only needs the count.
+            if(noCategory)
             {
-                //Add the hash string to the category.
-                item.albumArtHash.append(detailInfo.coverImageHash);
+                ++(item.count);
             }
-            //Add the artist to the list.
-            item.artists.insert(artistText,
-                                item.artists.value(artistText, 0)+1);
-            //Replace the item.
-            replaceItem(i, item);
-            //Mission complete.
-            return;
+            else
+            {
+                //Add the detail info to the item.
+                countDetailInfo(item, i);
+            }
+            //Update the changed range.
+            changedTop=qMin(changedTop, row);
+            changedBottom=qMax(changedBottom, row);
+            continue;
         }
+        //Check whether the album is a new album of the batch.
+        int newRow=newItemIndex.value(titleKey, -1);
+        if(newRow==-1)
+        {
+            //Generate a new album.
+            AlbumItem item;
+            item.title=titleText;
+            //Append to the new item list.
+            newRow=newItems.size();
+            newItems.append(item);
+            newItemIndex.insert(titleKey, newRow);
+        }
+        //Add the detail info to the item.
+        countDetailInfo(newItems[newRow], i);
     }
-    //We need to generate a new item for it.
-    AlbumItem item;
-    item.title=titleText;
-    item.count=1;
-    //Check out the hash key.
-    if(!detailInfo.coverImageHash.isEmpty())
+    //Emit the data changed signal only once for all the existing items.
+    if(changedBottom!=-1)
     {
-        //Add the cover image hash to the category.
-        item.albumArtHash.append(detailInfo.coverImageHash);
+        emit dataChanged(index(changedTop), index(changedBottom));
+    }
+    //Insert all the new albums.
+    if(!newItems.isEmpty())
+    {
+        //Get the first row of the new items.
+        int firstRow=m_categoryList.size();
+        //Follow the documentation, we have to do this.
+        beginInsertRows(QModelIndex(),
+                        firstRow,
+                        firstRow+newItems.size()-1);
+        //Append the data at the end of the list.
+        m_categoryList.append(newItems);
+        //Add the new items to the index.
+        for(auto i=newItemIndex.constBegin(); i!=newItemIndex.constEnd(); ++i)
+        {
+            m_albumIndex.insert(i.key(), firstRow+i.value());
+        }
+        //End the insertation.
+        endInsertRows();
     }
-    //Add the artist to the list.
-    item.artists.insert(artistText, 1);
-    //Append the item.
-    appendItem(item);
 }
 
 void KNMusicAlbumModel::onCategoryRemove(const KNMusicDetailInfo &detailInfo)
@@ -319,47 +394,45 @@ void KNMusicAlbumModel::onCategoryRemove(const KNMusicDetailInfo &detailInfo)
         return;
     }
     //Find the category text.
-    for(int i=0, bound=m_categoryList.size(); i<bound; ++i)
+    int row=albumRow(titleText);
+    //If we can't find the item, there's something wrong, ignore it.
+    if(row==-1)
     {
-        //If we could find the item.
-        if(m_categoryList.at(i).title==titleText)
-        {
-            //Check out the counter.
-            if(m_categoryList.at(i).count==1)
-            {
-                //Emit the album removed signal.
-                emit albumRemoved(index(i));
-                //This is the last item, we will remove this category.
-                removeItem(i);
-                //Finished.
-                return;
-            }
-            //Get the category list data.
-            AlbumItem item=m_categoryList.at(i);
-            //Decrease the count.
-            --(item.count);
-            //Remove the artist from the list.
-            //Check the song count.
-            int artistSongCount=item.artists.value(artistText);
-            //If this the last one
-            if(artistSongCount<=1)
-            {
-                //Remove the artist from the has list.
-                item.artists.remove(artistText);
-            }
-            else
-            {
-                //Reduce the artist count.
-                item.artists.insert(artistText,
-                                    item.artists.value(artistText, 0)-1);
-            }
-            //Replace the item.
-            replaceItem(i, item);
-            //Mission complete.
-            return;
-        }
+        return;
     }
-    //If we can get here, there's something wrong, ignore it.
+    //Check out the counter.
+    if(m_categoryList.at(row).count==1)
+    {
+        //Emit the album removed signal.
+        emit albumRemoved(index(row));
+        //This is the last item, we will remove this category.
+        removeItem(row);
+        //Finished.
+        return;
+    }
+    //Get the category list data.
+    AlbumItem item=m_categoryList.at(row);
+    //Decrease the count.
+    --(item.count);
+    //Release the album art hash of the detail info.
+    item.albumArtHash.remove(detailInfo.coverImageHash);
+    //Remove the artist from the list.
+    //Check the song count.
+    int artistSongCount=item.artists.value(artistText);
+    //If this the last one
+    if(artistSongCount<=1)
+    {
+        //Remove the artist from the has list.
+        item.artists.remove(artistText);
+    }
+    else
+    {
+        //Reduce the artist count.
+        item.artists.insert(artistText,
+                            item.artists.value(artistText, 0)-1);
+    }
+    //Replace the item.
+    replaceItem(row, item);
 }
 
 void KNMusicAlbumModel::onCategoryUpdate(const KNMusicDetailInfo &before,
@@ -379,54 +452,52 @@ void KNMusicAlbumModel::onCategoryUpdate(const KNMusicDetailInfo &before,
             //Get the category text.
             QVariant albumText=after.textLists[Album];
             //Find the category item.
-            for(int i=0; i<m_categoryList.size(); ++i)
+            int row=albumRow(albumText);
+            //If we could find the item.
+            if(row!=-1)
             {
-                //If we could find the item.
-                if(m_categoryList.at(i).title==albumText)
+                //Get the category item.
+                AlbumItem item=m_categoryList.at(row);
+                //If the cover image update flag is on,
+                if(coverImageUpdate)
                 {
-                    //Get the category item.
-                    AlbumItem item=m_categoryList.at(i);
-                    //If the cover image update flag is on,
-                    if(coverImageUpdate)
+                    //Remove the original cover image hash from the item.
+                    item.albumArtHash.remove(before.coverImageHash);
+                    //Insert the new cover image.
+                    item.albumArtHash.add(after.coverImageHash);
+                }
+                //If the artist update flag is on,
+                if(artistUpdate)
+                {
+                    //Get the previous artist.
+                    QString artistText=before.textLists[Artist].toString();
+                    //Remove the previous artist from the list.
+                    //Check the song count.
+                    int artistSongCount=item.artists.value(artistText);
+                    //If this the last one
+                    if(artistSongCount<=1)
                     {
-                        //Remove the original cover image hash from the item.
-                        item.albumArtHash.removeOne(before.coverImageHash);
-                        //Insert the new cover image.
-                        item.albumArtHash.append(after.coverImageHash);
+                        //Remove the artist from the has list.
+                        item.artists.remove(artistText);
                     }
-                    //If the artist update flag is on,
-                    if(artistUpdate)
+                    else
                     {
-                        //Get the previous artist.
-                        QString artistText=before.textLists[Artist].toString();
-                        //Remove the previous artist from the list.
-                        //Check the song count.
-                        int artistSongCount=item.artists.value(artistText);
-                        //If this the last one
-                        if(artistSongCount<=1)
-                        {
-                            //Remove the artist from the has list.
-                            item.artists.remove(artistText);
-                        }
-                        else
-                        {
-                            //Reduce the artist count.
-                            item.artists.insert(artistText,
-                                                item.artists.value(artistText,
-                                                                   0)-1);
-                        }
-                        //Get the after artist.
-                        artistText=after.textLists[Artist].toString();
-                        //Add the artist to the list.
+                        //Reduce the artist count.
                         item.artists.insert(artistText,
                                             item.artists.value(artistText,
-                                                               0)+1);
+                                                               0)-1);
                     }
-                    //Replace the one.
-                    replaceItem(i, item);
-                    //Mission complete.
-                    return;
+                    //Get the after artist.
+                    artistText=after.textLists[Artist].toString();
+                    //Add the artist to the list.
+                    item.artists.insert(artistText,
+                                        item.artists.value(artistText,
+                                                           0)+1);
                 }
+                //Replace the one.
+                replaceItem(row, item);
+                //Mission complete.
+                return;
             }
         }
         //Nothing changed, we will do nothing.
@@ -456,22 +527,18 @@ void KNMusicAlbumModel::onCategoryAlbumArtUpdate(
         return;
     }
     //Find the category text.
-    for(int i=0; i<m_categoryList.size(); ++i)
+    int row=albumRow(albumTitle);
+    //If we could find the item.
+    if(row!=-1)
     {
-        //If we could find the item.
-        if(m_categoryList.at(i).title==albumTitle)
-        {
-            //Get the category list data.
-            AlbumItem item=m_categoryList.at(i);
-            //Add the hash string to the category.
-            item.albumArtHash.append(detailInfo.coverImageHash);
-            //Replace the item.
-            replaceItem(i, item);
-            //Emit cover image update signal.
-            emit albumArtUpdate(index(i));
-            //Mission complete.
-            return;
-        }
+        //Get the category list data.
+        AlbumItem item=m_categoryList.at(row);
+        //Add the hash string to the category.
+        item.albumArtHash.add(detailInfo.coverImageHash);
+        //Replace the item.
+        replaceItem(row, item);
+        //Emit cover image update signal.
+        emit albumArtUpdate(index(row));
     }
 }
 
@@ -491,6 +558,34 @@ void KNMusicAlbumModel::retranslate()
     m_variousArtists=tr("Various Artists");
 }
 
+inline void KNMusicAlbumModel::countDetailInfo(
+        AlbumItem &item,
+        const KNMusicDetailInfo &detailInfo)
+{
+    //Increase the count.
+    ++(item.count);
+    //Check out the cover image hash.
+    if(!detailInfo.coverImageHash.isEmpty())
+    {
+        //Add the hash string to the category.
+        item.albumArtHash.add(detailInfo.coverImageHash);
+    }
+    //Add the artist to the list.
+    QString artistText=detailInfo.textLists[Artist].toString();
+    item.artists.insert(artistText, item.artists.value(artistText, 0)+1);
+}
+
+inline int KNMusicAlbumModel::albumRow(const QVariant &albumTitle) const
+{
+    //The no category item is not in the album index, check it first.
+    if(!m_categoryList.isEmpty() && m_categoryList.at(0).title==albumTitle)
+    {
+        return 0;
+    }
+    //Find the album in the index.
+    return m_albumIndex.value(albumTitle.toString(), -1);
+}
+
 inline KNMusicAlbumModel::AlbumItem KNMusicAlbumModel::generateNoCategoryItem()
 {
     //Generate the no category item.
@@ -507,6 +602,11 @@ inline void KNMusicAlbumModel::appendItem(const AlbumItem &item)
     beginInsertRows(QModelIndex(),
                     m_categoryList.size(),
                     m_categoryList.size());
+    //Add the album to the index, except the no category item.
+    if(!m_categoryList.isEmpty())
+    {
+        m_albumIndex.insert(item.title.toString(), m_categoryList.size());
+    }
     //Append this data at the end of the list.
     m_categoryList.append(item);
     //End the insertation.
@@ -517,8 +617,18 @@ inline void KNMusicAlbumModel::removeItem(const int &row)
 {
     //As the documentation said, called this function first.
     beginRemoveRows(QModelIndex(), row, row);
+    //Remove the album from the index.
+    m_albumIndex.remove(m_categoryList.at(row).title.toString());
     //Remove the data in the category list.
     m_categoryList.removeAt(row);
+    //Move up all the albums after the row.
+    for(auto i=m_albumIndex.begin(); i!=m_albumIndex.end(); ++i)
+    {
+        if(i.value()>row)
+        {
+            --(i.value());
+        }
+    }
     //As the documentation said, called this after remove rows.
     endRemoveRows();
 }
@@ -90,9 +90,9 @@ public:
     int categoryColumn() const Q_DECL_OVERRIDE;
 
     /*!
-     * \brief Reimplemented from KNMusicCategoryModelBase::setHashAlbumArt().
+     * \brief Reimplemented from KNMusicCategoryModelBase::setImageManager().
      */
-    void setHashAlbumArt(QHash<QString, QVariant> *hashAlbumArt)
+    void setImageManager(KNMusicLibraryImageManager *imageManager)
     Q_DECL_OVERRIDE;
 
 signals:
@@ -119,6 +119,12 @@ public slots:
      */
     void onCategoryAdd(const KNMusicDetailInfo &detailInfo) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicCategoryModelBase::onCategoryAddBatch().
+     */
+    void onCategoryAddBatch(const QList<KNMusicDetailInfo> &detailInfos)
+    Q_DECL_OVERRIDE;
+
     /*!
      * \brief Reimplemented from KNMusicCategoryModelBase::onCategoryRemove().
      */
@@ -150,12 +156,12 @@ private:
     struct AlbumItem
     {
         QVariant title;
-        QStringList albumArtHash;
+        AlbumArtCounter albumArtHash;
         QHash<QString, int> artists;
         int count;
         AlbumItem() :
             title(QVariant()),
-            albumArtHash(QStringList()),
+            albumArtHash(AlbumArtCounter()),
             artists(QHash<QString, int>()),
             count(0)
         {
@@ -166,14 +172,18 @@ private:
         }
     };
 
+    inline void countDetailInfo(AlbumItem &item,
+                                const KNMusicDetailInfo &detailInfo);
+    inline int albumRow(const QVariant &albumTitle) const;
     inline AlbumItem generateNoCategoryItem();
     inline void appendItem(const AlbumItem &item);
     inline void removeItem(const int &row);
     inline void replaceItem(const int &row, const AlbumItem &item);
     QList<AlbumItem> m_categoryList;
+    QHash<QString, int> m_albumIndex;
     const QVariant m_nullData;
     QString m_noCategoryText, m_variousArtists;
-    QHash<QString, QVariant> *m_hashAlbumArt;
+    KNMusicLibraryImageManager *m_imageManager;
 };
 
 #endif // KNMUSICALBUMMODEL_H
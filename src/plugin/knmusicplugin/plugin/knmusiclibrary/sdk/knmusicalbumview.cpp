@@ -28,6 +28,7 @@
 #include "knmusicsearchbase.h"
 #include "knmusicalbummodel.h"
 #include "knmusicalbumdetail.h"
+#include "knmusiclibraryimagemanager.h"
 #include "knmusicglobal.h"
 
 #include "knmusicalbumview.h"
@@ -51,6 +52,7 @@ KNMusicAlbumView::KNMusicAlbumView(QWidget *parent) :
     m_proxyModel(nullptr),
     m_model(nullptr),
     m_albumDetail(nullptr),
+    m_imageManager(nullptr),
     m_itemWidth(135),
     m_itemMinimalSpacing(30),
     m_minimalWidth(m_itemMinimalSpacing+m_itemWidth),
@@ -607,9 +609,15 @@ inline void KNMusicAlbumView::paintAlbum(QPainter &painter,
                        m_albumArtShadow);
 
     //Render and draw the album art image.
-    QPixmap &&albumArtImage=
-            m_proxyModel->data(index,
-                               Qt::DecorationRole).value<QPixmap>();
+    QPixmap albumArtImage=
+            (m_imageManager==nullptr)?
+                m_proxyModel->data(index,
+                                   Qt::DecorationRole).value<QPixmap>():
+                m_imageManager->albumArt(
+                    index.data(
+                        KNMusicAlbumModel::CategoryArtworkKeyRole).toString(),
+                    m_itemWidth,
+                    devicePixelRatio());
     //Check out the album art is valid.
     if(albumArtImage.isNull())
     {
@@ -618,9 +626,12 @@ inline void KNMusicAlbumView::paintAlbum(QPainter &painter,
     }
     else
     {
+        //Calculate the logical size of the album art.
+        int artWidth=albumArtImage.width()/albumArtImage.devicePixelRatio(),
+            artHeight=albumArtImage.height()/albumArtImage.devicePixelRatio();
         //Draw the album art to the specific position.
-        painter.drawPixmap(QPoint(x+((m_itemWidth-albumArtImage.width())>>1),
-                                  y+((m_itemWidth-albumArtImage.height())>>1)),
+        painter.drawPixmap(QPoint(x+((m_itemWidth-artWidth)>>1),
+                                  y+((m_itemWidth-artHeight)>>1)),
                            albumArtImage);
     }
     //Set the pen as the text color.
@@ -761,6 +772,12 @@ KNMusicAlbumDetail *KNMusicAlbumView::albumDetail() const
     return m_albumDetail;
 }
 
+void KNMusicAlbumView::setImageManager(KNMusicLibraryImageManager *imageManager)
+{
+    //Save the image manager.
+    m_imageManager=imageManager;
+}
+
 void KNMusicAlbumView::setAlbumDetail(KNMusicAlbumDetail *albumDetail)
 {
     //Check we have set it before or not.
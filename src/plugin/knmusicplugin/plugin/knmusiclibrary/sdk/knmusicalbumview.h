@@ -25,6 +25,7 @@ class QTimeLine;
 class KNMusicCategoryProxyModel;
 class KNMusicAlbumModel;
 class KNMusicAlbumDetail;
+class KNMusicLibraryImageManager;
 /*!
  * \brief The KNMusicAlbumView class is a special category view for album
  * category. It can display all the album with a block. When you click on one
@@ -80,6 +81,13 @@ public:
 
     KNMusicAlbumDetail *albumDetail() const;
 
+    /*!
+     * \brief Set the image manager which provides the album art in the size of
+     * the album item.
+     * \param imageManager The image manager pointer.
+     */
+    void setImageManager(KNMusicLibraryImageManager *imageManager);
+
 signals:
 
 public slots:
@@ -182,6 +190,7 @@ private:
     KNMusicCategoryProxyModel *m_proxyModel;
     KNMusicAlbumModel *m_model;
     KNMusicAlbumDetail *m_albumDetail;
+    KNMusicLibraryImageManager *m_imageManager;
     const int m_itemWidth, m_itemMinimalSpacing, m_minimalWidth;
     int m_lineCount, m_textSpacing, m_itemHeight, m_spacing,
         m_itemSpacingHeight, m_itemSpacingWidth, m_maxColumnCount;
@@ -250,6 +250,12 @@ void KNMusicCategoryDisplay::onActionSearch()
         //Ignore the search request.
         return;
     }
+    //The search result could be applied later, update the detail info when
+    //the search is complete.
+    connect(m_categoryTreeView->proxyModel(),
+            &KNMusicProxyModel::searchComplete,
+            this, &KNMusicCategoryDisplay::onActionSearchComplete,
+            Qt::UniqueConnection);
     //Set the search rules to the proxy model.
     m_categoryTreeView->proxyModel()->setSearchBlocks(
                 knMusicGlobal->search()->rules());
@@ -258,6 +264,12 @@ void KNMusicCategoryDisplay::onActionSearch()
     updateDetailInfo();
 }
 
+void KNMusicCategoryDisplay::onActionSearchComplete()
+{
+    //Update the detail info with the search result.
+    updateDetailInfo();
+}
+
 inline void KNMusicCategoryDisplay::showAllStaffs()
 {
     //Show labels.
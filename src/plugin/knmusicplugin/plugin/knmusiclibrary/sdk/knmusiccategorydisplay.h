@@ -89,6 +89,7 @@ protected:
 private slots:
     void retranslate();
     void onActionSearch();
+    void onActionSearchComplete();
 
 private:
     inline void showAllStaffs();
@@ -16,6 +16,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 #include "knmusicglobal.h"
+#include "knmusiclibraryimagemanager.h"
 
 #include "knmusiccategorymodel.h"
 
@@ -24,9 +25,10 @@
 KNMusicCategoryModel::KNMusicCategoryModel(QObject *parent) :
     KNMusicCategoryModelBase(parent),
     m_categoryList(QList<CategoryItem>()),
+    m_categoryIndex(QHash<QString, int>()),
     m_noAlbumArt(QVariant()),
     m_noCategoryText(QString()),
-    m_hashAlbumArt(nullptr),
+    m_imageManager(nullptr),
     m_categoryColumn(0)
 {
     //Set the default no album art data.
@@ -59,6 +61,7 @@ void KNMusicCategoryModel::reset()
     beginRemoveRows(QModelIndex(), 0, m_categoryList.size()-1);
     //Remove all the data.
     m_categoryList.clear();
+    m_categoryIndex.clear();
     //Insert the new no category item data to the item.
     m_categoryList.append(generateNoCategoryItem());
     //As the documentation said, called this after remove rows.
@@ -67,18 +70,10 @@ void KNMusicCategoryModel::reset()
 
 QModelIndex KNMusicCategoryModel::categoryIndex(const QVariant &categoryText)
 {
-    //Find through the list.
-    for(int i=0; i<m_categoryList.size(); ++i)
-    {
-        //If we find the text.
-        if(m_categoryList.at(i).displayText==categoryText)
-        {
-            //Give back the index.
-            return index(i, 0);
-        }
-    }
-    //Or else return a null index.
-    return QModelIndex();
+    //Find the row of the category.
+    int row=categoryRow(categoryText);
+    //Give back the index, or a null index if the category doesn't exist.
+    return row==-1?QModelIndex():index(row, 0);
 }
 
 int KNMusicCategoryModel::rowCount(const QModelIndex &parent) const
@@ -104,16 +99,22 @@ QVariant KNMusicCategoryModel::data(const QModelIndex &index, int role) const
     case Qt::EditRole:
         return item.displayText;
     case Qt::DecorationRole:
-        return (m_hashAlbumArt==nullptr || item.albumArtHash.isEmpty())?
-                    m_noAlbumArt:
-                    m_hashAlbumArt->value(item.albumArtHash.first(),
-                                          m_noAlbumArt);
+    {
+        //Check out the album art hash.
+        if(m_imageManager==nullptr || item.albumArtHash.isEmpty())
+        {
+            return m_noAlbumArt;
+        }
+        //Get the album art from the image manager.
+        QPixmap albumArt=m_imageManager->albumArt(item.albumArtHash.cover);
+        return albumArt.isNull()?m_noAlbumArt:QVariant(albumArt);
+    }
     case Qt::SizeHintRole:
         return QSize(44, 44);
     case CategorySizeRole:
         return item.count;
     case CategoryArtworkKeyRole:
-        return item.albumArtHash.isEmpty()?QString():item.albumArtHash.first();
+        return item.albumArtHash.cover;
     default:
         return QVariant();
     }
@@ -163,6 +164,14 @@ bool KNMusicCategoryModel::setData(const QModelIndex &index,
     {
     case Qt::DisplayRole:
     case Qt::EditRole:
+        //Update the category index, the no category item is not indexed.
+        if(index.row()>0)
+        {
+            //Remove the previous text.
+            m_categoryIndex.remove(categoryItem.displayText.toString());
+            //Add the new text.
+            m_categoryIndex.insert(value.toString(), index.row());
+        }
         //Change the display text.
         categoryItem.displayText=value;
         //Replace the item.
@@ -225,40 +234,112 @@ void KNMusicCategoryModel::onCategoryAdd(const KNMusicDetailInfo &detailInfo)
         return;
     }
     //Find the category text.
-    for(int i=0; i<m_categoryList.size(); ++i)
+    int row=categoryRow(categoryText);
+    //If we could find the item.
+    if(row!=-1)
     {
-        //If we could find the item.
-        if(m_categoryList.at(i).displayText==categoryText)
+        //Get the category list data.
+        CategoryItem item=m_categoryList.at(row);
+        //Add the detail info to the item.
+        countDetailInfo(item, detailInfo);
+        //Replace the item.
+        replaceItem(row, item);
+        //Mission complete.
+        return;
+    }
+    //We have to add a new category.
+    CategoryItem item;
+    //Save the category data.
+    item.displayText=categoryText;
+    //Add the detail info to the item.
+    countDetailInfo(item, detailInfo);
+    //Append the item.
+    appendItem(item);
+}
+
+void KNMusicCategoryModel::onCategoryAddBatch(
+        const QList<KNMusicDetailInfo> &detailInfos)
+{
+    //Check the list and the no category item.
+    if(detailInfos.isEmpty() || m_categoryList.isEmpty())
+    {
+        return;
+    }
+    //The range of the existing items which have been changed.
+    int changedTop=m_categoryList.size(), changedBottom=-1;
+    //The new categories which are not in the list, and their index in the new
+    //item list.
+    QList<CategoryItem> newItems;
+    QHash<QString, int> newItemIndex;
+    //Add all the detail info in one pass.
+    for(const auto &i : detailInfos)
+    {
+        //Get the category text.
+        QVariant categoryText=i.textLists[m_categoryColumn];
+        QString categoryKey=categoryText.toString();
+        //Check if the category is blank.
+        bool noCategory=categoryKey.isEmpty();
+        int row=noCategory?0:categoryRow(categoryText);
+        //Check whether the category exist in the list.
+        if(row!=-1)
         {
             //Get the category list data.
-            CategoryItem item=m_categoryList.at(i);
-            //Increase the count.
-            ++(item.count);
-            //Check out the cover image hash.
-            if(!detailInfo.coverImageHash.isEmpty())
+            CategoryItem &item=m_categoryList[row];
+            //The no category item only needs the count.
+            if(noCategory)
             {
-                //Add the hash string to the category.
-                item.albumArtHash.append(detailInfo.coverImageHash);
+                ++(item.count);
             }
-            //Replace the item.
-            replaceItem(i, item);
-            //Mission complete.
-            return;
+            else
+            {
+                //Add the detail info to the item.
+                countDetailInfo(item, i);
+            }
+            //Update the changed range.
+            changedTop=qMin(changedTop, row);
+            changedBottom=qMax(changedBottom, row);
+            continue;
         }
+        //Check whether the category is a new category of the batch.
+        int newRow=newItemIndex.value(categoryKey, -1);
+        if(newRow==-1)
+        {
+            //Generate a new category.
+            CategoryItem item;
+            //Save the category data.
+            item.displayText=categoryText;
+            //Append to the new item list.
+            newRow=newItems.size();
+            newItems.append(item);
+            newItemIndex.insert(categoryKey, newRow);
+        }
+        //Add the detail info to the item.
+        countDetailInfo(newItems[newRow], i);
     }
-    //We have to add a new category.
-    CategoryItem item;
-    //Save the category data.
-    item.displayText=categoryText;
-    item.count=1;
-    //Check out the hash key.
-    if(!detailInfo.coverImageHash.isEmpty())
+    //Emit the data changed signal only once for all the existing items.
+    if(changedBottom!=-1)
     {
-        //Add the cover image hash to the category.
-        item.albumArtHash.append(detailInfo.coverImageHash);
+        emit dataChanged(index(changedTop), index(changedBottom));
+    }
+    //Insert all the new categories.
+    if(!newItems.isEmpty())
+    {
+        //Get the first row of the new items.
+        int firstRow=m_categoryList.size();
+        //Follow the documentation, we have to do this.
+        beginInsertRows(QModelIndex(),
+                        firstRow,
+                        firstRow+newItems.size()-1);
+        //Append the data at the end of the list.
+        m_categoryList.append(newItems);
+        //Add the new items to the index.
+        for(auto i=newItemIndex.constBegin(); i!=newItemIndex.constEnd(); ++i)
+        {
+            m_categoryIndex.insert(i.key(), firstRow+i.value());
+        }
+        //End the insertation.
+        endInsertRows();
     }
-    //Append the item.
-    appendItem(item);
 }
 
 void KNMusicCategoryModel::onCategoryRemove(const KNMusicDetailInfo &detailInfo)
@@ -274,23 +355,25 @@ void KNMusicCategoryModel::onCategoryRemove(const KNMusicDetailInfo &detailInfo)
         return;
     }
     //Find the category text.
-    for(int i=0, bound=m_categoryList.size(); i<bound; ++i)
+    int row=categoryRow(categoryText);
+    //If we could find the item.
+    if(row!=-1)
     {
-        //If we could find the item.
-        if(m_categoryList.at(i).displayText==categoryText)
+        //Check out the counter.
+        if(m_categoryList.at(row).count==1)
         {
-            //Check out the counter.
-            if(m_categoryList.at(i).count==1)
-            {
-                //This is the last item, we will remove this category.
-                removeItem(i);
-                return;
-            }
-            //Reduce count of row i.
-            reduceCount(i);
-            //Mission complete.
+            //This is the last item, we will remove this category.
+            removeItem(row);
             return;
         }
+        //Get the category list data.
+        CategoryItem item=m_categoryList.at(row);
+        //Remove the detail info from the item.
+        uncountDetailInfo(item, detailInfo);
+        //Replace the item.
+        replaceItem(row, item);
+        //Mission complete.
+        return;
     }
     //If we can get here...I mean WTF...
 }
@@ -312,22 +395,20 @@ void KNMusicCategoryModel::onCategoryUpdate(const KNMusicDetailInfo &before,
         //Get the category text.
         QVariant categoryText=after.textLists[m_categoryColumn];
         //Find the category item.
-        for(int i=0; i<m_categoryList.size(); ++i)
+        int row=categoryRow(categoryText);
+        //If we could find the item.
+        if(row!=-1)
         {
-            //If we could find the item.
-            if(m_categoryList.at(i).displayText==categoryText)
-            {
-                //Get the category item.
-                CategoryItem item=m_categoryList.at(i);
-                //Remove the original cover image hash from the item.
-                item.albumArtHash.removeOne(before.coverImageHash);
-                //Insert the new cover image.
-                item.albumArtHash.append(after.coverImageHash);
-                //Replace the one.
-                replaceItem(i, item);
-                //Mission complete.
-                return;
-            }
+            //Get the category item.
+            CategoryItem item=m_categoryList.at(row);
+            //Remove the original cover image hash from the item.
+            item.albumArtHash.remove(before.coverImageHash);
+            //Insert the new cover image.
+            item.albumArtHash.add(after.coverImageHash);
+            //Replace the one.
+            replaceItem(row, item);
+            //Mission complete.
+            return;
         }
     }
     //Or else, we have to remove the previous data.
@@ -353,22 +434,18 @@ void KNMusicCategoryModel::onCategoryAlbumArtUpdate(
         return;
     }
     //Find the category text.
-    for(int i=0; i<m_categoryList.size(); ++i)
+    int row=categoryRow(categoryText);
+    //If we could find the item.
+    if(row!=-1)
     {
-        //If we could find the item.
-        if(m_categoryList.at(i).displayText==categoryText)
-        {
-            //Get the category list data.
-            CategoryItem item=m_categoryList.at(i);
-            //Add the hash string to the category.
-            item.albumArtHash.append(detailInfo.coverImageHash);
-            //Replace the item.
-            replaceItem(i, item);
-            //Emit cover image update signal.
-            emit albumArtUpdate(index(i));
-            //Mission complete.
-            return;
-        }
+        //Get the category list data.
+        CategoryItem item=m_categoryList.at(row);
+        //Add the hash string to the category.
+        item.albumArtHash.add(detailInfo.coverImageHash);
+        //Replace the item.
+        replaceItem(row, item);
+        //Emit cover image update signal.
+        emit albumArtUpdate(index(row));
     }
 }
 
@@ -384,6 +461,41 @@ void KNMusicCategoryModel::onActionImageRecoverComplete()
     emit albumArtRecoverd();
 }
 
+void KNMusicCategoryModel::countDetailInfo(CategoryItem &item,
+                                           const KNMusicDetailInfo &detailInfo)
+{
+    //Increase the count.
+    ++(item.count);
+    //Check out the cover image hash.
+    if(!detailInfo.coverImageHash.isEmpty())
+    {
+        //Add the hash string to the category.
+        item.albumArtHash.add(detailInfo.coverImageHash);
+    }
+}
+
+void KNMusicCategoryModel::uncountDetailInfo(
+        CategoryItem &item,
+        const KNMusicDetailInfo &detailInfo)
+{
+    //Decrease the count.
+    --(item.count);
+    //Release the album art hash of the detail info.
+    item.albumArtHash.remove(detailInfo.coverImageHash);
+}
+
+int KNMusicCategoryModel::categoryRow(const QVariant &categoryText) const
+{
+    //The no category item is not in the index, check it first.
+    if(!m_categoryList.isEmpty() &&
+            m_categoryList.at(0).displayText==categoryText)
+    {
+        return 0;
+    }
+    //Find the category in the index.
+    return m_categoryIndex.value(categoryText.toString(), -1);
+}
+
 KNMusicCategoryModel::CategoryItem KNMusicCategoryModel::itemAt(
         const int &row) const
 {
@@ -407,6 +519,12 @@ void KNMusicCategoryModel::appendItem(const CategoryItem &item)
     beginInsertRows(QModelIndex(),
                     m_categoryList.size(),
                     m_categoryList.size());
+    //Add the item to the index, except the no category item.
+    if(!m_categoryList.isEmpty())
+    {
+        m_categoryIndex.insert(item.displayText.toString(),
+                               m_categoryList.size());
+    }
     //Append this data at the end of the list.
     m_categoryList.append(item);
     //End the insertation.
@@ -417,6 +535,16 @@ void KNMusicCategoryModel::removeItem(const int &row)
 {
     //As the documentation said, called this function first.
     beginRemoveRows(QModelIndex(), row, row);
+    //Remove the item from the index.
+    m_categoryIndex.remove(m_categoryList.at(row).displayText.toString());
+    //All the items after the row are moved up.
+    for(auto i=m_categoryIndex.begin(); i!=m_categoryIndex.end(); ++i)
+    {
+        if(i.value()>row)
+        {
+            --(i.value());
+        }
+    }
     //Remove the data in the category list.
     m_categoryList.removeAt(row);
     //As the documentation said, called this after remove rows.
@@ -457,10 +585,10 @@ QVariant KNMusicCategoryModel::noAlbumArt() const
     return m_noAlbumArt;
 }
 
-void KNMusicCategoryModel::setHashAlbumArt(
-        QHash<QString, QVariant> *hashAlbumArt)
+void KNMusicCategoryModel::setImageManager(
+        KNMusicLibraryImageManager *imageManager)
 {
-    m_hashAlbumArt=hashAlbumArt;
+    m_imageManager=imageManager;
 }
 
 int KNMusicCategoryModel::categoryColumn() const
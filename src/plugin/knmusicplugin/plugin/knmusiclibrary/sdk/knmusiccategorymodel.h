@@ -19,6 +19,7 @@
 #ifndef KNMUSICCATEGORYMODEL_H
 #define KNMUSICCATEGORYMODEL_H
 
+#include <QHash>
 #include <QList>
 
 #include "knmusiccategorymodelbase.h"
@@ -83,9 +84,9 @@ public:
     int categoryColumn() const Q_DECL_OVERRIDE;
 
     /*!
-     * \brief Reimplemented from KNMusicCategoryModelBase::setHashAlbumArt().
+     * \brief Reimplemented from KNMusicCategoryModelBase::setImageManager().
      */
-    void setHashAlbumArt(QHash<QString, QVariant> *hashAlbumArt)
+    void setImageManager(KNMusicLibraryImageManager *imageManager)
     Q_DECL_OVERRIDE;
 
 signals:
@@ -111,6 +112,12 @@ public slots:
      */
     void onCategoryAdd(const KNMusicDetailInfo &detailInfo) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicCategoryModelBase::onCategoryAddBatch().
+     */
+    void onCategoryAddBatch(const QList<KNMusicDetailInfo> &detailInfos)
+    Q_DECL_OVERRIDE;
+
     /*!
      * \brief Reimplemented from KNMusicCategoryModelBase::onCategoryRemove().
      */
@@ -139,11 +146,11 @@ protected:
     struct CategoryItem
     {
         QVariant displayText;
-        QStringList albumArtHash;
+        AlbumArtCounter albumArtHash;
         int count;
         CategoryItem() :
             displayText(QVariant()),
-            albumArtHash(QStringList()),
+            albumArtHash(AlbumArtCounter()),
             count(0)
         {
         }
@@ -152,6 +159,34 @@ protected:
             return displayText==value.displayText;
         }
     };
+    /*!
+     * \brief Add a detail info to a category item. The count of the item will
+     * be increased and the album art hash will be added. This function is
+     * used for both new and existing categories, except the no category item.
+     * \param item The category item. For a new category, only the display
+     * text is set.
+     * \param detailInfo The detail info which belongs to the category.
+     */
+    virtual void countDetailInfo(CategoryItem &item,
+                                 const KNMusicDetailInfo &detailInfo);
+
+    /*!
+     * \brief Remove a detail info from a category item. The count of the item
+     * will be decreased and the album art hash reference will be released.
+     * \param item The category item.
+     * \param detailInfo The detail info which is removed from the category.
+     */
+    virtual void uncountDetailInfo(CategoryItem &item,
+                                   const KNMusicDetailInfo &detailInfo);
+
+    /*!
+     * \brief Find the row of a category.
+     * \param categoryText The category text.
+     * \return The row of the category. If the category doesn't exist, return
+     * -1.
+     */
+    int categoryRow(const QVariant &categoryText) const;
+
     QVariant noAlbumArt() const;
     CategoryItem itemAt(const int &row) const;
     CategoryItem generateNoCategoryItem();
@@ -163,9 +198,10 @@ protected:
 private:
     inline void saveNoAlbumArt(const QPixmap &noAlbumArt);
     QList<CategoryItem> m_categoryList;
+    QHash<QString, int> m_categoryIndex;
     QVariant m_noAlbumArt;
     QString m_noCategoryText;
-    QHash<QString, QVariant> *m_hashAlbumArt;
+    KNMusicLibraryImageManager *m_imageManager;
     int m_categoryColumn;
 };
 
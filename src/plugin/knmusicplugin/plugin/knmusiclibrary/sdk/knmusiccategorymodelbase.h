@@ -22,9 +22,11 @@
 #include "knmusicutil.h"
 
 #include <QAbstractListModel>
+#include <QHash>
 
 using namespace MusicUtil;
 
+class KNMusicLibraryImageManager;
 class KNMusicCategoryModelBase : public QAbstractListModel
 {
     Q_OBJECT
@@ -66,10 +68,11 @@ public:
     virtual int categoryColumn() const=0;
 
     /*!
-     * \brief Set the library hash album art for the category model.
-     * \param hashAlbumArt The album art hash list.
+     * \brief Set the library image manager for the category model to provide
+     * the album art.
+     * \param imageManager The image manager pointer.
      */
-    virtual void setHashAlbumArt(QHash<QString, QVariant> *hashAlbumArt)=0;
+    virtual void setImageManager(KNMusicLibraryImageManager *imageManager)=0;
 
 signals:
     /*!
@@ -112,6 +115,16 @@ public slots:
      */
     virtual void onCategoryAdd(const KNMusicDetailInfo &detailInfo)=0;
 
+    /*!
+     * \brief When a list of detail info is adding to the library, called this
+     * function to add all of them to category model in one pass. The counts of
+     * the existing categories will be updated with only one data changed
+     * signal, and all the new categories will be inserted at once.
+     * \param detailInfos The detail info list added to library model.
+     */
+    virtual void onCategoryAddBatch(const QList<KNMusicDetailInfo> &detailInfos)
+    =0;
+
     /*!
      * \brief When a detail info is removing from the library, called this
      * function right before it's being removed to remove it from the category
@@ -145,6 +158,75 @@ public slots:
      * to update the category model.
      */
     virtual void onActionImageRecoverComplete()=0;
+
+protected:
+    /*!
+     * \brief The album art reference counter of a category. It saves the song
+     * count of each album art hash key and the representative cover of the
+     * category, both adding and removing a hash key cost O(1) unless the
+     * representative cover is removed.
+     */
+    struct AlbumArtCounter
+    {
+        QHash<QString, int> counts;
+        QString cover;
+        AlbumArtCounter() :
+            counts(QHash<QString, int>()),
+            cover(QString())
+        {
+        }
+        inline bool isEmpty() const
+        {
+            return cover.isEmpty();
+        }
+        inline void add(const QString &hashKey)
+        {
+            //Ignore the empty hash key.
+            if(hashKey.isEmpty())
+            {
+                return;
+            }
+            //Increase the song count of the hash key.
+            ++(counts[hashKey]);
+            //The first hash key will be used as the cover.
+            if(cover.isEmpty())
+            {
+                cover=hashKey;
+            }
+        }
+        inline void remove(const QString &hashKey)
+        {
+            //Find the hash key.
+            auto hashIterator=counts.find(hashKey);
+            if(hashIterator==counts.end())
+            {
+                return;
+            }
+            //Decrease the song count, check whether it's the last song.
+            if(--(hashIterator.value())>0)
+            {
+                return;
+            }
+            //Remove the hash key.
+            counts.erase(hashIterator);
+            //Check whether the cover is removed.
+            if(cover!=hashKey)
+            {
+                return;
+            }
+            //Use the hash key with the most songs as the new cover.
+            cover=QString();
+            int coverCount=0;
+            for(auto i=counts.constBegin(); i!=counts.constEnd(); ++i)
+            {
+                if(i.value()>coverCount)
+                {
+                    cover=i.key();
+                    coverCount=i.value();
+                }
+            }
+        }
+    };
 };
 
 #endif // KNMUSICCATEGORYMODELBASE_H
@@ -54,55 +54,13 @@ QVariant KNMusicGenreModel::data(const QModelIndex &index, int role) const
         //Check out the validation of the album art hash.
         return item.albumArtHash.isEmpty()?
                     knMusicGlobal->noAlbumArt():
-                    m_genreIconMap.value(item.albumArtHash.first(),
+                    m_genreIconMap.value(item.albumArtHash.cover,
                                          knMusicGlobal->noAlbumArt());
     }
     //Otherwise, do the original one.
     return KNMusicCategoryModel::data(index, role);
 }
 
-void KNMusicGenreModel::onCategoryAdd(const KNMusicDetailInfo &detailInfo)
-{
-    //Get the category text.
-    QVariant categoryText=detailInfo.textLists[categoryColumn()];
-    //Check if the category is blank.
-    if(categoryText.toString().isEmpty())
-    {
-        //Get the category list data.
-        CategoryItem item=itemAt(0);
-        //Increase the count.
-        ++(item.count);
-        //Add count of no category item.
-        replaceItem(0, item);
-        //Mission complete.
-        return;
-    }
-    //Find the category text.
-    for(int i=0, bound=rowCount(); i<bound; ++i)
-    {
-        //If we cound find the item.
-        if(itemAt(i).displayText==categoryText)
-        {
-            //Get the category list data.
-            CategoryItem item=itemAt(i);
-            //Increase the count.
-            ++(item.count);
-            //Replace the item.
-            replaceItem(i, item);
-            //Mission complete.
-            return;
-        }
-    }
-    //We have to add a new category.
-    CategoryItem item;
-    //Save the category data.
-    item.displayText=categoryText;
-    item.albumArtHash.append(categoryText.toString().toLower());
-    item.count=1;
-    //Append the item.
-    appendItem(item);
-}
-
 void KNMusicGenreModel::onCategoryUpdate(const KNMusicDetailInfo &before,
                                          const KNMusicDetailInfo &after)
 {
@@ -131,6 +89,28 @@ void KNMusicGenreModel::onActionImageRecoverComplete()
     //In genre model, we won't need to do anything.
 }
 
+void KNMusicGenreModel::countDetailInfo(CategoryItem &item,
+                                        const KNMusicDetailInfo &detailInfo)
+{
+    //Increase the count.
+    ++(item.count);
+    //The genre uses the genre icon instead of the album art, the key of the
+    //icon is the lower case genre name. Set the key for the new category.
+    if(item.albumArtHash.isEmpty())
+    {
+        item.albumArtHash.add(
+                    detailInfo.textLists[categoryColumn()].toString().toLower());
+    }
+}
+
+void KNMusicGenreModel::uncountDetailInfo(CategoryItem &item,
+                                          const KNMusicDetailInfo &detailInfo)
+{
+    //The genre icon key won't be changed, only decrease the count.
+    Q_UNUSED(detailInfo)
+    --(item.count);
+}
+
 inline void KNMusicGenreModel::loadGenreIcons(const QString &folderPath)
 {
     //Initial the genre directory.
@@ -39,11 +39,6 @@ public:
 signals:
 
 public slots:
-    /*!
-     * \brief Reimplemented from KNMusicCategoryModel::onCategoryAdd().
-     */
-    void onCategoryAdd(const KNMusicDetailInfo &detailInfo) Q_DECL_OVERRIDE;
-
     /*!
      * \brief Reimplemented from KNMusicCategoryModel::onCategoryUpdate().
      */
@@ -63,6 +58,19 @@ public slots:
      */
     void onActionImageRecoverComplete() Q_DECL_OVERRIDE;
 
+protected:
+    /*!
+     * \brief Reimplemented from KNMusicCategoryModel::countDetailInfo().
+     */
+    void countDetailInfo(CategoryItem &item,
+                         const KNMusicDetailInfo &detailInfo) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicCategoryModel::uncountDetailInfo().
+     */
+    void uncountDetailInfo(CategoryItem &item,
+                           const KNMusicDetailInfo &detailInfo) Q_DECL_OVERRIDE;
+
 private:
     inline void loadGenreIcons(const QString &folderPath);
     QHash<QString, QVariant> m_genreIconMap;
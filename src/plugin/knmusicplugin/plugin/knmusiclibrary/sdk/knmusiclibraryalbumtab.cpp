@@ -191,6 +191,8 @@ void KNMusicLibraryAlbumTab::setImageManager(
 {
     //Give the hash album art to album detail.
     m_albumDetail->setImageManager(imageManager);
+    //Give the image manager to album view for painting album arts.
+    m_albumView->setImageManager(imageManager);
 }
 
 void KNMusicLibraryAlbumTab::retranslate()
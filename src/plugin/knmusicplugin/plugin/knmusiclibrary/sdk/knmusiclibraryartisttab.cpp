@@ -45,6 +45,7 @@ KNMusicLibraryArtistTab::KNMusicLibraryArtistTab(QWidget *parent) :
     m_showInArtistTab(new QAction(this)),
     m_dropProxy(new KNDropProxyContainer(this)),
     m_artistList(new KNMusicCategoryListViewBase(m_dropProxy)),
+    m_artistDelegate(new KNMusicLibraryCategoryDelegate(m_artistList)),
     m_artistDisplay(new KNMusicCategoryDisplay(this, this)),
     m_categoryModel(nullptr),
     m_libraryModel(nullptr)
@@ -63,8 +64,7 @@ KNMusicLibraryArtistTab::KNMusicLibraryArtistTab(QWidget *parent) :
     //Configure the artist list.
     m_artistList->setTabOrder(m_artistList, m_artistDisplay);
     m_artistList->enabledSearch();
-    m_artistList->setItemDelegate(
-                new KNMusicLibraryCategoryDelegate(m_artistList));
+    m_artistList->setItemDelegate(m_artistDelegate);
     //Set the drop proxy widget to the content widget.
     setContentWidget(m_dropProxy);
     //Initial the layout for the container, only for auto resize splitter.
@@ -225,6 +225,8 @@ void KNMusicLibraryArtistTab::setLibraryModel(KNMusicLibraryModel *model)
             m_libraryModel, &KNMusicLibraryModel::appendUrls);
     //Set the model to display.
     m_artistDisplay->setLibraryModel(m_libraryModel);
+    //Paint the artist album art from the image manager.
+    m_artistDelegate->setImageManager(m_libraryModel->imageManager());
 }
 
 void KNMusicLibraryArtistTab::showEvent(QShowEvent *event)
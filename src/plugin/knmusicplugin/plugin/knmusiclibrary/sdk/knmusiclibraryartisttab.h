@@ -27,6 +27,7 @@ class KNDropProxyContainer;
 class KNCategoryTab;
 class KNMusicCategoryDisplay;
 class KNMusicCategoryListViewBase;
+class KNMusicLibraryCategoryDelegate;
 class KNMusicLibraryArtistTab : public KNMusicLibraryCategoryTab
 {
     Q_OBJECT
@@ -95,6 +96,7 @@ private:
     QAction *m_showInArtistTab;
     KNDropProxyContainer *m_dropProxy;
     KNMusicCategoryListViewBase *m_artistList;
+    KNMusicLibraryCategoryDelegate *m_artistDelegate;
     KNMusicCategoryDisplay *m_artistDisplay;
     KNMusicCategoryModelBase *m_categoryModel;
     KNMusicLibraryModel *m_libraryModel;
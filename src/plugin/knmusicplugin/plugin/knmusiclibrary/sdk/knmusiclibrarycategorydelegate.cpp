@@ -17,6 +17,9 @@
  */
 #include <QPainter>
 
+#include "knmusiccategorymodelbase.h"
+#include "knmusiclibraryimagemanager.h"
+
 #include "knmusiclibrarycategorydelegate.h"
 
 #define IconSize 40
@@ -24,8 +27,16 @@
 #define IconSizeWithSpacing 49
 
 KNMusicLibraryCategoryDelegate::KNMusicLibraryCategoryDelegate(QWidget *parent):
-    QStyledItemDelegate(parent)
+    QStyledItemDelegate(parent),
+    m_imageManager(nullptr)
+{
+}
+
+void KNMusicLibraryCategoryDelegate::setImageManager(
+        KNMusicLibraryImageManager *imageManager)
 {
+    //Save the image manager.
+    m_imageManager=imageManager;
 }
 
 void KNMusicLibraryCategoryDelegate::paint(QPainter *painter,
@@ -43,20 +54,39 @@ void KNMusicLibraryCategoryDelegate::paint(QPainter *painter,
         //Update the text color to highlighted color.
         textColor=option.palette.color(QPalette::HighlightedText);
     }
-    //Draw the decoration icon.
-    QPixmap &&categoryIcon=
-            (index.data(Qt::DecorationRole).value<QPixmap>()).scaled(
-                IconSize,
-                IconSize,
-                Qt::KeepAspectRatio,
-                Qt::SmoothTransformation);
+    //Get the album art from the image manager in the icon size.
+    QPixmap categoryIcon=
+            (m_imageManager==nullptr)?
+                QPixmap():
+                m_imageManager->albumArt(
+                    index.data(KNMusicCategoryModelBase::CategoryArtworkKeyRole
+                               ).toString(),
+                    IconSize,
+                    painter->device()->devicePixelRatio());
+    //Check out the album art.
+    if(categoryIcon.isNull())
+    {
+        //Use the decoration icon instead.
+        categoryIcon=index.data(Qt::DecorationRole).value<QPixmap>();
+        //Only scale the icon when it's larger than the icon size.
+        if(categoryIcon.width()>IconSize || categoryIcon.height()>IconSize)
+        {
+            categoryIcon=categoryIcon.scaled(IconSize,
+                                             IconSize,
+                                             Qt::KeepAspectRatio,
+                                             Qt::SmoothTransformation);
+        }
+    }
+    //Calculate the logical size of the icon.
+    int iconWidth=categoryIcon.width()/categoryIcon.devicePixelRatio(),
+        iconHeight=categoryIcon.height()/categoryIcon.devicePixelRatio();
     //Draw the pixmap data.
     painter->drawPixmap(option.rect.x()+Spacing+
-                        ((IconSize-categoryIcon.width())>>1),
+                        ((IconSize-iconWidth)>>1),
                         option.rect.y()+Spacing+
-                        ((IconSize-categoryIcon.height())>>1),
-                        categoryIcon.width(),
-                        categoryIcon.height(),
+                        ((IconSize-iconHeight)>>1),
+                        iconWidth,
+                        iconHeight,
                         categoryIcon);
     //Draw the text.
     painter->setPen(textColor);
@@ -21,12 +21,21 @@
 
 #include <QStyledItemDelegate>
 
+class KNMusicLibraryImageManager;
 class KNMusicLibraryCategoryDelegate : public QStyledItemDelegate
 {
     Q_OBJECT
 public:
     explicit KNMusicLibraryCategoryDelegate(QWidget *parent = 0);
 
+    /*!
+     * \brief Set the image manager which provides the album art in the icon
+     * size. If the image manager is not set, the decoration data of the model
+     * will be used.
+     * \param imageManager The image manager pointer.
+     */
+    void setImageManager(KNMusicLibraryImageManager *imageManager);
+
     /*!
      * \brief Reimplemented from QStyledItemDelegate::paint().
      */
@@ -37,6 +46,9 @@ public:
 signals:
 
 public slots:
+
+private:
+    KNMusicLibraryImageManager *m_imageManager;
 };
 
 #endif // KNMUSICLIBRARYCATEGORYDELEGATE_H
@@ -0,0 +1,437 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QPixmapCache>
+#include <QtMath>
+
+#include "knmusiclibraryimagecache.h"
+
+#define ArtworkSize 138
+#define MinimumMipmapSize 16
+#define ArtworkPixmapCacheLimit 65536
+#define MipmapCacheSize 67108864
+
+KNMusicLibraryImageCache::KNMusicLibraryImageCache() :
+    m_imageFolderPath(QString()),
+    m_hashKeys(QSet<QString>()),
+    m_mipmaps(MipmapCacheSize),
+    m_artworkStyles(QHash<QString, KNMusicArtworkStyle>()),
+    m_hitCount(0),
+    m_missCount(0),
+    m_residentBytes(0),
+    m_decodeCount(0),
+    m_decodeTime(0),
+    m_queueDepth(0),
+    m_mipmapBaseSize(ArtworkSize*qCeil(qGuiApp->devicePixelRatio()))
+{
+    //The album view could show a whole screen of album arts, the pixmap cache
+    //has to hold at least all of them.
+    if(QPixmapCache::cacheLimit()<ArtworkPixmapCacheLimit)
+    {
+        QPixmapCache::setCacheLimit(ArtworkPixmapCacheLimit);
+    }
+}
+
+QString KNMusicLibraryImageCache::imageFolderPath() const
+{
+    return m_imageFolderPath;
+}
+
+void KNMusicLibraryImageCache::setImageFolderPath(
+        const QString &imageFolderPath)
+{
+    //Save the image folder path.
+    m_imageFolderPath = imageFolderPath;
+}
+
+QString KNMusicLibraryImageCache::hashKey(const QImage &image)
+{
+    //Calculate the meta data of the image(MD4 of image content).
+    QByteArray hashResult=
+            QCryptographicHash::hash(QByteArray((char *)image.bits(),
+                                                image.byteCount()),
+                                     QCryptographicHash::Md4);
+    //Get the image key of the image.
+    QString imageHashKey;
+    //Add hash result data to image hash key.
+    for(int i=0; i<hashResult.size(); ++i)
+    {
+        //Get the text string of the current number.
+        QString currentByteText=QString::number((quint8)hashResult.at(i), 16);
+        //Check out the data of image hash key.
+        imageHashKey.append(hashResult.at(i)<16?"0"+currentByteText:
+                                                currentByteText);
+    }
+    return imageHashKey;
+}
+
+bool KNMusicLibraryImageCache::contains(const QString &hashKey)
+{
+    //Lock the mipmap cache.
+    QMutexLocker mipmapLocker(&m_mipmapLock);
+    //Check the hash key.
+    return m_hashKeys.contains(hashKey);
+}
+
+void KNMusicLibraryImageCache::insert(const QString &hashKey,
+                                      const QImage &image)
+{
+    //Generate the mipmap chain of the image.
+    QList<QImage> mipmap=generateMipmap(image, m_mipmapBaseSize);
+    //Lock the mipmap cache, it could be read from the GUI thread.
+    QMutexLocker mipmapLocker(&m_mipmapLock);
+    //Save the hash key.
+    m_hashKeys.insert(hashKey);
+    //Save the mipmap chain.
+    cacheMipmap(hashKey, mipmap);
+}
+
+void KNMusicLibraryImageCache::remove(const QString &hashKey)
+{
+    //Lock the mipmap cache.
+    QMutexLocker mipmapLocker(&m_mipmapLock);
+    //Remove the hash key.
+    m_hashKeys.remove(hashKey);
+    //Remove the mipmap chain of the image.
+    m_mipmaps.remove(hashKey);
+    m_residentBytes.storeRelease(m_mipmaps.totalCost());
+    //Remove the style of the image.
+    m_artworkStyles.remove(hashKey);
+}
+
+QStringList KNMusicLibraryImageCache::recover(const QStringList &hashList)
+{
+    //Prepare the recovered hash keys.
+    QStringList recoveredList;
+    //Get the image folder path information.
+    QFileInfo pathChecker(m_imageFolderPath);
+    //Check is the path exist or it's a file
+    if(pathChecker.exists() && pathChecker.isFile())
+    {
+        //Delete the file.
+        QFile::remove(pathChecker.absoluteFilePath());
+    }
+    //Generate the image directory.
+    QDir imageDir(m_imageFolderPath);
+    //Check if it's not exist, simply generate the folder.
+    if(!pathChecker.exists())
+    {
+        //Generate the folder.
+        imageDir.mkpath(imageDir.absolutePath());
+        //Do nothing, return. Because the folder is just created.
+        return recoveredList;
+    }
+    //Check the existance again, if the path is still not exist, then failed.
+    if(!pathChecker.isDir() || !pathChecker.exists())
+    {
+        return recoveredList;
+    }
+    //Get the entry info list.
+    QFileInfoList contentInfos=imageDir.entryInfoList();
+    //Check each file.
+    for(const auto &i : contentInfos)
+    {
+        //Check the information of all the file and the suffix.
+        if(i.isFile() && i.suffix().toLower()=="png")
+        {
+            //Get the hash key, which is the base name.
+            QString hashKey=i.completeBaseName();
+            //Check whether the file is in the hash list.
+            if(hashList.contains(hashKey))
+            {
+                //Load the image.
+                QImage currentImage=loadImage(hashKey);
+                //If there's image data is not null.
+                if(!currentImage.isNull())
+                {
+                    //Insert the image to the cache.
+                    insert(hashKey, currentImage);
+                    recoveredList.append(hashKey);
+                    //Continue to next file.
+                    continue;
+                }
+            }
+        }
+        //Remove the no use file.
+        QFile::remove(i.absoluteFilePath());
+    }
+    //Give back the recovered hash keys.
+    return recoveredList;
+}
+
+QPixmap KNMusicLibraryImageCache::albumArt(const QString &hashKey,
+                                           int logicalSize,
+                                           qreal devicePixelRatio)
+{
+    //Calculate the real pixel size of the request.
+    int pixelSize=qCeil(logicalSize*devicePixelRatio);
+    //The image is named by its content hash, so the scaled pixmap of the same
+    //key and size will never be changed.
+    QString cacheKey=hashKey + "@" + QString::number(pixelSize);
+    //Find the pixmap in the pixmap cache.
+    QPixmap artworkPixmap;
+    if(QPixmapCache::find(cacheKey, &artworkPixmap))
+    {
+        //Count the hit.
+        m_hitCount.fetchAndAddRelaxed(1);
+        //Give back the cached pixmap.
+        return artworkPixmap;
+    }
+    //Count the miss.
+    m_missCount.fetchAndAddRelaxed(1);
+    //Find the level of the request size.
+    QImage level;
+    {
+        //Lock the mipmap cache.
+        QMutexLocker mipmapLocker(&m_mipmapLock);
+        //Check whether the image exist.
+        if(!m_hashKeys.contains(hashKey))
+        {
+            //There's no image for the hash key.
+            return QPixmap();
+        }
+        //Find the mipmap chain, it might be evicted from the cache.
+        QList<QImage> *mipmap=m_mipmaps.object(hashKey);
+        if(mipmap!=nullptr)
+        {
+            level=mipmapLevel(*mipmap, pixelSize);
+        }
+    }
+    //When the chain is evicted or the base level is smaller than the request,
+    //e.g. the window is moved to a screen with higher device pixel ratio,
+    //regenerate the chain from the saved image in the request size.
+    if(level.isNull() || qMax(level.width(), level.height())<pixelSize)
+    {
+        //Load the chain.
+        QList<QImage> mipmap=loadMipmap(hashKey,
+                                        qMax(pixelSize, m_mipmapBaseSize));
+        //Check the chain.
+        if(mipmap.isEmpty())
+        {
+            return QPixmap();
+        }
+        level=mipmapLevel(mipmap, pixelSize);
+    }
+    //Scale the level to the exact size, it will only be done once for a size.
+    if(qMax(level.width(), level.height())>pixelSize)
+    {
+        level=level.scaled(pixelSize,
+                           pixelSize,
+                           Qt::KeepAspectRatio,
+                           Qt::SmoothTransformation);
+    }
+    //Generate the pixmap.
+    artworkPixmap=QPixmap::fromImage(level);
+    artworkPixmap.setDevicePixelRatio(devicePixelRatio);
+    //Insert the pixmap to cache.
+    QPixmapCache::insert(cacheKey, artworkPixmap);
+    //Give back the pixmap.
+    return artworkPixmap;
+}
+
+QImage KNMusicLibraryImageCache::styleSource(const QString &hashKey)
+{
+    {
+        //Lock the mipmap cache.
+        QMutexLocker mipmapLocker(&m_mipmapLock);
+        //The style is generated only once for a hash key. The image might also
+        //be removed before the request arrives.
+        if(m_artworkStyles.contains(hashKey) || !m_hashKeys.contains(hashKey))
+        {
+            return QImage();
+        }
+        //Copy the base level, the style only needs a small sample of it.
+        QList<QImage> *mipmap=m_mipmaps.object(hashKey);
+        if(mipmap!=nullptr)
+        {
+            return mipmap->first();
+        }
+    }
+    //The chain might be evicted before the style is generated, e.g. while
+    //recovering a large library. Scale the saved image directly instead of
+    //putting the chain back to the cache.
+    return loadImage(hashKey).scaled(m_mipmapBaseSize,
+                                     m_mipmapBaseSize,
+                                     Qt::KeepAspectRatio,
+                                     Qt::SmoothTransformation);
+}
+
+KNMusicArtworkStyle KNMusicLibraryImageCache::artworkStyle(
+        const QString &hashKey)
+{
+    //Lock the mipmap cache, the style is saved in the image thread.
+    QMutexLocker mipmapLocker(&m_mipmapLock);
+    //Give back the style.
+    return m_artworkStyles.value(hashKey);
+}
+
+bool KNMusicLibraryImageCache::setArtworkStyle(const QString &hashKey,
+                                               const KNMusicArtworkStyle &style)
+{
+    //Lock the mipmap cache.
+    QMutexLocker mipmapLocker(&m_mipmapLock);
+    //Check whether the image is removed while generating the style.
+    if(!m_hashKeys.contains(hashKey))
+    {
+        return false;
+    }
+    //Save the style.
+    m_artworkStyles.insert(hashKey, style);
+    return true;
+}
+
+KNMusicLibraryImageCache::Statistics KNMusicLibraryImageCache::statistics()
+const
+{
+    //Read all the counters without locking, each of them is consistent.
+    Statistics statistics;
+    statistics.hitCount=m_hitCount.loadAcquire();
+    statistics.missCount=m_missCount.loadAcquire();
+    statistics.residentBytes=m_residentBytes.loadAcquire();
+    statistics.decodeCount=m_decodeCount.loadAcquire();
+    statistics.decodeTime=m_decodeTime.loadAcquire()/1000;
+    statistics.queueDepth=m_queueDepth.loadAcquire();
+    return statistics;
+}
+
+void KNMusicLibraryImageCache::resetStatistics()
+{
+    //Reset the counters and the times.
+    m_hitCount.storeRelease(0);
+    m_missCount.storeRelease(0);
+    m_decodeCount.storeRelease(0);
+    m_decodeTime.storeRelease(0);
+}
+
+void KNMusicLibraryImageCache::addDecodeTime(qint64 nsecs)
+{
+    //Count the decoding.
+    m_decodeCount.fetchAndAddRelaxed(1);
+    m_decodeTime.fetchAndAddRelaxed(nsecs);
+}
+
+void KNMusicLibraryImageCache::setQueueDepth(int queueDepth)
+{
+    m_queueDepth.storeRelease(queueDepth);
+}
+
+inline QImage KNMusicLibraryImageCache::loadImage(const QString &hashKey)
+{
+    //Combine the folder path with the hash key to load the image.
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+    QImage image(m_imageFolderPath + "/" + hashKey + ".png", "png");
+    //Count the decoding.
+    addDecodeTime(decodeTimer.nsecsElapsed());
+    return image;
+}
+
+inline QList<QImage> KNMusicLibraryImageCache::loadMipmap(
+        const QString &hashKey,
+        int baseSize)
+{
+    //Load the saved image.
+    QImage image=loadImage(hashKey);
+    //Check the image.
+    if(image.isNull())
+    {
+        return QList<QImage>();
+    }
+    //Generate the mipmap chain from the saved image.
+    QList<QImage> mipmap=generateMipmap(image, baseSize);
+    {
+        //Lock the mipmap cache.
+        QMutexLocker mipmapLocker(&m_mipmapLock);
+        //Check whether the image is removed while loading.
+        if(m_hashKeys.contains(hashKey))
+        {
+            //Replace the chain in the cache.
+            cacheMipmap(hashKey, mipmap);
+        }
+    }
+    //Give back the chain.
+    return mipmap;
+}
+
+inline void KNMusicLibraryImageCache::cacheMipmap(const QString &hashKey,
+                                                  const QList<QImage> &mipmap)
+{
+    //The cost of a chain is the bytes of all its levels.
+    int cost=0;
+    for(const auto &i : mipmap)
+    {
+        cost+=i.byteCount();
+    }
+    //Save the mipmap chain, the least recently used chains will be evicted.
+    m_mipmaps.insert(hashKey, new QList<QImage>(mipmap), cost);
+    m_residentBytes.storeRelease(m_mipmaps.totalCost());
+}
+
+inline QList<QImage> KNMusicLibraryImageCache::generateMipmap(
+        const QImage &image,
+        int baseSize)
+{
+    //Prepare the mipmap chain.
+    QList<QImage> mipmap;
+    //Scale the image to the base level size.
+    QImage level=image.scaled(baseSize,
+                              baseSize,
+                              Qt::KeepAspectRatio,
+                              Qt::SmoothTransformation);
+    //Add the base level to the chain.
+    mipmap.append(level);
+    //Each level is the half size of the previous level.
+    while(qMax(level.width(), level.height())>(MinimumMipmapSize<<1))
+    {
+        //Scale the previous level to generate the next level.
+        level=level.scaled(level.width()>>1,
+                           level.height()>>1,
+                           Qt::KeepAspectRatio,
+                           Qt::SmoothTransformation);
+        //Add the level to the chain.
+        mipmap.append(level);
+    }
+    //Give back the chain.
+    return mipmap;
+}
+
+inline QImage KNMusicLibraryImageCache::mipmapLevel(
+        const QList<QImage> &mipmap,
+        int pixelSize)
+{
+    //Find the smallest level which is not smaller than the pixel size.
+    QImage level;
+    //Check all the levels from the base level.
+    for(const auto &i : mipmap)
+    {
+        //Check the level size.
+        if(level.isNull() || qMax(i.width(), i.height())>=pixelSize)
+        {
+            //Save the level.
+            level=i;
+            continue;
+        }
+        //The rest levels are all smaller than the size.
+        break;
+    }
+    //Give back the level.
+    return level;
+}
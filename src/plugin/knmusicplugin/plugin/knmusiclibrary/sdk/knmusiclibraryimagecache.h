@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICLIBRARYIMAGECACHE_H
+#define KNMUSICLIBRARYIMAGECACHE_H
+
+#include <QAtomicInteger>
+#include <QCache>
+#include <QMutex>
+#include <QPixmap>
+#include <QSet>
+#include <QStringList>
+
+#include "knmusicutil.h"
+
+using namespace MusicUtil;
+
+/*!
+ * \brief The KNMusicLibraryImageCache class keeps the album arts of the library
+ * which are saved in the image folder. The mipmap chains of the images are
+ * kept in a cache which is bounded by the image bytes, an evicted chain will be
+ * regenerated from the saved image when it's used again.\n
+ * All the functions are thread-safe, except albumArt() which should only be
+ * called in the GUI thread. The statistics are counted without any lock, so
+ * they could be read at any time.
+ */
+class KNMusicLibraryImageCache
+{
+public:
+    /*!
+     * \brief The Statistics struct describes the memory usage and the
+     * performance of the cache. All the times are in microseconds.
+     */
+    struct Statistics
+    {
+        //The pixmap cache results of albumArt().
+        qint64 hitCount;
+        qint64 missCount;
+        //The bytes of the mipmap chains in the cache.
+        qint64 residentBytes;
+        //The album arts decoded from the music files and the saved images.
+        qint64 decodeCount;
+        qint64 decodeTime;
+        //The length of the album art analysis queue.
+        int queueDepth;
+        Statistics() :
+            hitCount(0),
+            missCount(0),
+            residentBytes(0),
+            decodeCount(0),
+            decodeTime(0),
+            queueDepth(0)
+        {
+        }
+    };
+
+    /*!
+     * \brief Construct a KNMusicLibraryImageCache.
+     */
+    KNMusicLibraryImageCache();
+
+    /*!
+     * \brief Get the image folder path.
+     * \return The image folder path. It will be empty if you never set it.
+     */
+    QString imageFolderPath() const;
+
+    /*!
+     * \brief Set the image folder path. It should be set before using the
+     * cache.
+     * \param imageFolderPath The folder which saved all the images. The name of
+     * the image file should be its MD4 hash result.
+     */
+    void setImageFolderPath(const QString &imageFolderPath);
+
+    /*!
+     * \brief Calculate the hash key of an image.
+     * \param image The image.
+     * \return The MD4 hash of the image content in hex.
+     */
+    static QString hashKey(const QImage &image);
+
+    /*!
+     * \brief Check whether an image is in the cache.
+     * \param hashKey The image hash key.
+     * \return If the image is inserted or recovered, return true.
+     */
+    bool contains(const QString &hashKey);
+
+    /*!
+     * \brief Insert an image to the cache. The image won't be saved to the
+     * image folder.
+     * \param hashKey The image hash key.
+     * \param image The image.
+     */
+    void insert(const QString &hashKey, const QImage &image);
+
+    /*!
+     * \brief Remove an image from the cache. The saved image won't be removed.
+     * \param hashKey The image hash key.
+     */
+    void remove(const QString &hashKey);
+
+    /*!
+     * \brief Load the images in the hash list from the image folder, the other
+     * files in the image folder will be removed.
+     * \param hashList The hash keys of the images.
+     * \return The hash keys of the loaded images.
+     */
+    QStringList recover(const QStringList &hashList);
+
+    /*!
+     * \brief Get the album art in a specific display size. If the mipmap chain
+     * is evicted from the cache or it is smaller than the request size, it
+     * will be regenerated from the saved image. This function should only be
+     * called in the GUI thread.
+     * \param hashKey The artwork hash key.
+     * \param logicalSize The logical size of the longer edge.
+     * \param devicePixelRatio The device pixel ratio of the painting device.
+     * \return The album art pixmap with the device pixel ratio set. If there's
+     * no album art for the hash key, it will be a null pixmap.
+     */
+    QPixmap albumArt(const QString &hashKey,
+                     int logicalSize,
+                     qreal devicePixelRatio);
+
+    /*!
+     * \brief Get the base level of the image for generating the style.
+     * \param hashKey The image hash key.
+     * \return The base level of the image. If the image is removed or the
+     * style is already generated, it will be a null image.
+     */
+    QImage styleSource(const QString &hashKey);
+
+    /*!
+     * \brief Get the style of an image.
+     * \param hashKey The image hash key.
+     * \return The artwork style. If the style is not generated, it will be a
+     * null style.
+     */
+    KNMusicArtworkStyle artworkStyle(const QString &hashKey);
+
+    /*!
+     * \brief Save the style of an image.
+     * \param hashKey The image hash key.
+     * \param style The artwork style.
+     * \return If the image is removed while generating the style, return
+     * false.
+     */
+    bool setArtworkStyle(const QString &hashKey,
+                         const KNMusicArtworkStyle &style);
+
+    /*!
+     * \brief Get the statistics of the cache.
+     * \return The statistics snapshot.
+     */
+    Statistics statistics() const;
+
+    /*!
+     * \brief Reset the counters and the times of the statistics. The resident
+     * bytes and the queue depth won't be reset.
+     */
+    void resetStatistics();
+
+    /*!
+     * \brief Count an album art which is decoded outside the cache.
+     * \param nsecs The decoding time in nanoseconds.
+     */
+    void addDecodeTime(qint64 nsecs);
+
+    /*!
+     * \brief Update the length of the album art analysis queue.
+     * \param queueDepth The queue length.
+     */
+    void setQueueDepth(int queueDepth);
+
+private:
+    inline QImage loadImage(const QString &hashKey);
+    inline QList<QImage> loadMipmap(const QString &hashKey, int baseSize);
+    inline void cacheMipmap(const QString &hashKey,
+                            const QList<QImage> &mipmap);
+    static inline QList<QImage> generateMipmap(const QImage &image,
+                                               int baseSize);
+    static inline QImage mipmapLevel(const QList<QImage> &mipmap,
+                                     int pixelSize);
+    QString m_imageFolderPath;
+    QSet<QString> m_hashKeys;
+    QCache<QString, QList<QImage>> m_mipmaps;
+    QHash<QString, KNMusicArtworkStyle> m_artworkStyles;
+    QMutex m_mipmapLock;
+    QAtomicInteger<qint64> m_hitCount, m_missCount, m_residentBytes,
+                           m_decodeCount, m_decodeTime;
+    QAtomicInt m_queueDepth;
+    int m_mipmapBaseSize;
+};
+
+#endif // KNMUSICLIBRARYIMAGECACHE_H
@@ -15,9 +15,9 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
-#include <QCryptographicHash>
-#include <QDir>
-#include <QIcon>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
 
 #include "knutil.h"
 #include "knmusicglobal.h"
@@ -27,18 +27,22 @@
 
 #include <QDebug>
 
+#define ArtworkSize 138
+
 KNMusicLibraryImageManager::KNMusicLibraryImageManager(QObject *parent) :
     QObject(parent),
     m_analysisQueue(QLinkedList<AnalysisQueueItem>()),
-    m_imageFolderPath(QString()),
-    m_hashAlbumArt(nullptr),
-    m_scaledHashAlbumArt(nullptr),
     m_isWorking(false)
 {
     //Link the analysis request signal and response slot in queue connection.
     connect(this, &KNMusicLibraryImageManager::requireAnalysisNext,
             this, &KNMusicLibraryImageManager::analysisNext,
             Qt::QueuedConnection);
+    //The style is always generated in the thread of the image manager, no
+    //matter which thread inserts the image.
+    connect(this, &KNMusicLibraryImageManager::requireGenerateStyle,
+            this, &KNMusicLibraryImageManager::generateStyle,
+            Qt::QueuedConnection);
 }
 
 void KNMusicLibraryImageManager::analysisAlbumArt(
@@ -64,70 +68,42 @@ void KNMusicLibraryImageManager::analysisAlbumArt(
     queueItem.item=item;
     //Add the item to queue.
     m_analysisQueue.append(queueItem);
+    m_cache.setQueueDepth(m_analysisQueue.size());
     //And of course, ask to analysis the next item, start looping.
     emit requireAnalysisNext();
 }
 
 void KNMusicLibraryImageManager::recoverAlbumArt(const QStringList &hashList)
 {
-    //Check out the image hash list has been set or not.
-    if(m_scaledHashAlbumArt==nullptr)
-    {
-        return;
-    }
-    //Get the image folder path information.
-    QFileInfo pathChecker(m_imageFolderPath);
-    //Check is the path exist or it's a file
-    if(pathChecker.exists() && pathChecker.isFile())
-    {
-        //Delete the file.
-        QFile::remove(pathChecker.absoluteFilePath());
-    }
-    //Generate the image directory.
-    QDir imageDir(m_imageFolderPath);
-    //Check if it's not exist, simply generate the folder.
-    if(!pathChecker.exists())
+    //Load the images from the image folder.
+    QStringList recoveredList=m_cache.recover(hashList);
+    //Ask to generate the style of the images.
+    for(const auto &i : recoveredList)
     {
-        //Generate the folder.
-        imageDir.mkpath(imageDir.absolutePath());
-        //Do nothing, return. Because the folder is just created.
-        return;
+        emit requireGenerateStyle(i);
     }
-    //Check the existance again, if the path is still not exist, then failed.
-    if(!pathChecker.isDir() || !pathChecker.exists())
+    //After loading the images, emit recover signal.
+    emit recoverImageComplete();
+}
+
+void KNMusicLibraryImageManager::generateStyle(const QString &hashKey)
+{
+    //Get the base level of the image.
+    QImage baseLevel=m_cache.styleSource(hashKey);
+    //The style is generated only once for a hash key. The image might also be
+    //removed before the request arrives.
+    if(baseLevel.isNull())
     {
         return;
     }
-    //Get the entry info list.
-    QFileInfoList contentInfos=imageDir.entryInfoList();
-    //Check each file.
-    for(auto i : contentInfos)
+    //Generate the style and save it, the image might be removed while
+    //generating the style.
+    if(m_cache.setArtworkStyle(hashKey,
+                               KNMusicUtil::generateArtworkStyle(baseLevel)))
     {
-        //Check the information of all the file and the suffix.
-        if(i.isFile() && i.suffix().toLower()=="png")
-        {
-            //Get the hash key, which is the base name.
-            QString hashKey=i.completeBaseName();
-            //Check whether the file is in the hash list.
-            if(hashList.contains(hashKey))
-            {
-                //Load the image.
-                QPixmap currentPixmap=QPixmap(i.absoluteFilePath(), "png");
-                //If there's image data is not null.
-                if(!currentPixmap.isNull())
-                {
-                    //Insert the image to the hash list.
-                    insertImage(i.completeBaseName(), currentPixmap);
-                    //Continue to next file.
-                    continue;
-                }
-            }
-        }
-        //Remove the no use file.
-        QFile::remove(i.absoluteFilePath());
+        //Emit the style changed signal.
+        emit artworkStyleChanged(hashKey);
     }
-    //After loading the images, emit recover signal.
-    emit recoverImageComplete();
 }
 
 void KNMusicLibraryImageManager::analysisNext()
@@ -142,12 +118,16 @@ void KNMusicLibraryImageManager::analysisNext()
     }
     //Get the first item from the queue.
     AnalysisQueueItem currentItem=m_analysisQueue.takeFirst();
+    m_cache.setQueueDepth(m_analysisQueue.size());
     //Get the analysis item.
     KNMusicAnalysisItem &analysisItem=currentItem.item;
     //Use the parser to parse the analysis item.
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
     knMusicGlobal->parser()->parseAlbumArt(analysisItem);
+    m_cache.addDecodeTime(decodeTimer.nsecsElapsed());
     //Check the result of the cover image.
-    if(!analysisItem.coverImage.isNull() && m_scaledHashAlbumArt!=nullptr)
+    if(!analysisItem.coverImage.isNull())
     {
         //The cover image is not null, get the hash key.
         analysisItem.detailInfo.coverImageHash=
@@ -164,51 +144,50 @@ void KNMusicLibraryImageManager::analysisNext()
     emit requireAnalysisNext();
 }
 
-inline void KNMusicLibraryImageManager::insertImage(const QString &hashKey,
-                                                    const QPixmap &pixmap)
+QPixmap KNMusicLibraryImageManager::albumArt(const QString &hashKey,
+                                             int logicalSize,
+                                             qreal devicePixelRatio)
+{
+    return m_cache.albumArt(hashKey, logicalSize, devicePixelRatio);
+}
+
+QPixmap KNMusicLibraryImageManager::albumArt(const QString &hashKey)
 {
-    //We won't do pointer check here, for speed reason.
-    //We will only saved the scaled album art.
-    m_scaledHashAlbumArt->insert(hashKey,
-                                 QVariant(pixmap.scaled(
-                                     138,
-                                     138,
-                                     Qt::KeepAspectRatio,
-                                     Qt::SmoothTransformation)));
+    //Use the artwork size of the application device pixel ratio.
+    return m_cache.albumArt(hashKey, ArtworkSize, qApp->devicePixelRatio());
 }
 
-QHash<QString, QVariant> *KNMusicLibraryImageManager::scaledHashAlbumArt() const
+KNMusicArtworkStyle KNMusicLibraryImageManager::artworkStyle(
+        const QString &hashKey)
 {
-    return m_scaledHashAlbumArt;
+    return m_cache.artworkStyle(hashKey);
+}
+
+KNMusicLibraryImageCache::Statistics
+KNMusicLibraryImageManager::statistics() const
+{
+    return m_cache.statistics();
+}
+
+void KNMusicLibraryImageManager::resetStatistics()
+{
+    m_cache.resetStatistics();
 }
 
 QString KNMusicLibraryImageManager::insertArtwork(const QImage &image)
 {
     //Calculate the meta data of the image(MD4 of image content).
-    QByteArray hashResult=
-            QCryptographicHash::hash(QByteArray((char *)image.bits(),
-                                                image.byteCount()),
-                                     QCryptographicHash::Md4);
-    //Get the image key of the image.
-    QString imageHashKey;
-    //Add hash result data to image hash key.
-    for(int i=0; i<hashResult.size(); ++i)
-    {
-        //Get the text string of the current number.
-        QString currentByteText=QString::number((quint8)hashResult.at(i), 16);
-        //Check out the data of image hash key.
-        imageHashKey.append(hashResult.at(i)<16?"0"+currentByteText:
-                                                currentByteText);
-    }
+    QString imageHashKey=KNMusicLibraryImageCache::hashKey(image);
     //Check whether the hash is already exists in image list.
-    if(m_scaledHashAlbumArt!=nullptr &&
-            !m_scaledHashAlbumArt->contains(imageHashKey))
+    if(!m_cache.contains(imageHashKey))
     {
         //If this image is first time exist in the hash list, save the image
         //first.
-        insertImage(imageHashKey, QPixmap::fromImage(image));
+        m_cache.insert(imageHashKey, image);
+        //Ask to generate the style of the image.
+        emit requireGenerateStyle(imageHashKey);
         //Save the image.
-        image.save(KNUtil::ensurePathValid(m_imageFolderPath) +
+        image.save(KNUtil::ensurePathValid(m_cache.imageFolderPath()) +
                    "/" + imageHashKey + ".png",
                    "PNG");
         //Emit the inserted signal.
@@ -224,31 +203,26 @@ bool KNMusicLibraryImageManager::isWorking() const
 
 void KNMusicLibraryImageManager::removeHashImage(const QString &hashKey)
 {
+    //Remove the image from the cache.
+    m_cache.remove(hashKey);
     //Remove the file, simply combine the path.
-    QFile::remove(m_imageFolderPath + "/" + hashKey + ".png");
+    QFile::remove(m_cache.imageFolderPath() + "/" + hashKey + ".png");
 }
 
 QString KNMusicLibraryImageManager::imageFolderPath() const
 {
-    return m_imageFolderPath;
+    return m_cache.imageFolderPath();
 }
 
 void KNMusicLibraryImageManager::setImageFolderPath(
         const QString &imageFolderPath)
 {
     //Save the image folder path.
-    m_imageFolderPath = imageFolderPath;
+    m_cache.setImageFolderPath(imageFolderPath);
 }
 
 QPixmap KNMusicLibraryImageManager::artwork(const QString &hashKey)
 {
     //Combine the folder path with the hash key to load the image.
-    return QPixmap(m_imageFolderPath + "/" + hashKey + ".png");
-}
-
-void KNMusicLibraryImageManager::setHashAlbumArt(
-        QHash<QString, QVariant> *scaledHashAlbumArt)
-{
-    //Save the two pointer.
-    m_scaledHashAlbumArt = scaledHashAlbumArt;
+    return QPixmap(m_cache.imageFolderPath() + "/" + hashKey + ".png");
 }
@@ -22,16 +22,16 @@
 #include <QLinkedList>
 #include <QPersistentModelIndex>
 
-#include "knmusicutil.h"
+#include "knmusiclibraryimagecache.h"
 
 #include <QObject>
 
 using namespace MusicUtil;
 
 /*!
- * \brief The KNMusicLibraryImageManager class provides a black box image hash
- * map management interface. Give the hash map object to image manager, and set
- * a library image.
+ * \brief The KNMusicLibraryImageManager class provides a black box album art
+ * management interface. The images are saved in the image folder, and kept in
+ * a KNMusicLibraryImageCache for painting.
  */
 class KNMusicLibraryImageManager : public QObject
 {
@@ -43,21 +43,6 @@ public:
      */
     explicit KNMusicLibraryImageManager(QObject *parent = 0);
 
-    /*!
-     * \brief Get the scaled album art hash map. This will automatically scaled
-     * the parsed image into a smaller one for album art view to paint up.
-     * \return The scaled hash map pointer. It will return a nullptr if you
-     * never set it before.
-     */
-    QHash<QString, QVariant> *scaledHashAlbumArt() const;
-
-    /*!
-     * \brief Set the album art hash map for manager to manage.
-     * \param scaledHashAlbumArt The scaled image hash map. It will store the
-     * scaled image hash map.
-     */
-    void setHashAlbumArt(QHash<QString, QVariant> *scaledHashAlbumArt);
-
     /*!
      * \brief Get the image folder path.
      * \return The image folder path. It will be empty if you never set it.
@@ -78,6 +63,56 @@ public:
      */
     QPixmap artwork(const QString &hashKey);
 
+    /*!
+     * \brief Get the album art in a specific display size. The album art is
+     * taken from the mipmap chain which is generated once when the image is
+     * inserted or recovered, so the views never need to scale the pixmap when
+     * painting. If the chain is evicted from the cache or it is smaller than
+     * the request size, it will be regenerated from the saved image. This
+     * function should only be called in the GUI thread.
+     * \param hashKey The artwork hash key.
+     * \param logicalSize The logical size of the longer edge.
+     * \param devicePixelRatio The device pixel ratio of the painting device.
+     * \return The album art pixmap with the device pixel ratio set. If there's
+     * no album art for the hash key, it will be a null pixmap.
+     */
+    QPixmap albumArt(const QString &hashKey,
+                     int logicalSize,
+                     qreal devicePixelRatio);
+
+    /*!
+     * \brief Get the album art in the default artwork size for the device
+     * pixel ratio of the application. This function should only be called in
+     * the GUI thread.
+     * \param hashKey The artwork hash key.
+     * \return The album art pixmap. If there's no album art for the hash key,
+     * it will be a null pixmap.
+     */
+    QPixmap albumArt(const QString &hashKey);
+
+    /*!
+     * \brief Get the precomputed colours and blurred background of an album
+     * art. The style is generated once for each hash key in the image thread
+     * after the image is inserted or recovered, artworkStyleChanged() will be
+     * emitted when it's ready. This function is thread-safe.
+     * \param hashKey The artwork hash key.
+     * \return The artwork style. If the image is not loaded, it will be a null
+     * style.
+     */
+    KNMusicArtworkStyle artworkStyle(const QString &hashKey);
+
+    /*!
+     * \brief Get the statistics of the album art cache, it could be called at
+     * any time from any thread without blocking the image thread.
+     * \return The cache statistics.
+     */
+    KNMusicLibraryImageCache::Statistics statistics() const;
+
+    /*!
+     * \brief Reset the counters and the times of the statistics.
+     */
+    void resetStatistics();
+
     /*!
      * \brief Insert album art image to image manager.
      * \param image The album art image.
@@ -99,6 +134,13 @@ signals:
      */
     void requireAnalysisNext();
 
+    /*!
+     * \brief This signal is actually private, it is used for generating the
+     * style of an image in the image thread.
+     * \param hashKey The image hash key.
+     */
+    void requireGenerateStyle(const QString &hashKey);
+
     /*!
      * \brief This signal is asking the music model to update the specific row
      * with the new image hash data.
@@ -119,6 +161,13 @@ signals:
      */
     void imageInserted(const QString &hashKey);
 
+    /*!
+     * \brief When the style of an image is generated, this signal will be
+     * emitted.
+     * \param hashKey The image hash key.
+     */
+    void artworkStyleChanged(const QString &hashKey);
+
 public slots:
     /*!
      * \brief When there's a new item finished analysised, this slot will be
@@ -143,6 +192,7 @@ public slots:
     void removeHashImage(const QString &hashKey);
 
 private slots:
+    void generateStyle(const QString &hashKey);
     void analysisNext();
 
 private:
@@ -151,10 +201,8 @@ private:
         QPersistentModelIndex itemIndex;
         KNMusicAnalysisItem item;
     };
-    inline void insertImage(const QString &hashKey, const QPixmap &pixmap);
     QLinkedList<AnalysisQueueItem> m_analysisQueue;
-    QString m_imageFolderPath;
-    QHash<QString, QVariant> *m_hashAlbumArt, *m_scaledHashAlbumArt;
+    KNMusicLibraryImageCache m_cache;
     bool m_isWorking;
 };
 
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "knmusicglobal.h"
+#include "knmusicparser.h"
+
+#include "knmusiclibraryloudnessscanner.h"
+
+KNMusicLibraryLoudnessScanner::KNMusicLibraryLoudnessScanner(QObject *parent) :
+    QObject(parent),
+    m_scanQueue(QLinkedList<KNMusicDetailInfo>()),
+    m_isWorking(false)
+{
+    //Link the scanning request signal and response slot in queue connection.
+    connect(this, &KNMusicLibraryLoudnessScanner::requireScanNext,
+            this, &KNMusicLibraryLoudnessScanner::scanNext,
+            Qt::QueuedConnection);
+}
+
+bool KNMusicLibraryLoudnessScanner::isWorking() const
+{
+    return m_isWorking;
+}
+
+void KNMusicLibraryLoudnessScanner::scanLoudness(KNMusicDetailInfo detailInfo)
+{
+    //Check scanning queue is empty before.
+    if(m_scanQueue.isEmpty())
+    {
+        //Set working flag.
+        m_isWorking=true;
+    }
+    //Add the file to queue.
+    m_scanQueue.append(detailInfo);
+    //Ask to scan the next file, start looping.
+    emit requireScanNext();
+}
+
+void KNMusicLibraryLoudnessScanner::scanNext()
+{
+    //Check is there no file in the queue.
+    if(m_scanQueue.isEmpty())
+    {
+        //Reset the working flag.
+        m_isWorking=false;
+        //Mission complete.
+        return;
+    }
+    //Get the first file from the queue.
+    KNMusicDetailInfo detailInfo=m_scanQueue.takeFirst();
+    //Decode the file to measure the loudness.
+    if(knMusicGlobal->parser()->scanLoudness(detailInfo))
+    {
+        //Give back the measured result.
+        emit scanComplete(detailInfo);
+    }
+    //Ask to scan the next file.
+    emit requireScanNext();
+}
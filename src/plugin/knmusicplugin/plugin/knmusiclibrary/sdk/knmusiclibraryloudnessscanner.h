@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICLIBRARYLOUDNESSSCANNER_H
+#define KNMUSICLIBRARYLOUDNESSSCANNER_H
+
+#include <QLinkedList>
+
+#include "knmusicutil.h"
+
+#include <QObject>
+
+using namespace MusicUtil;
+
+/*!
+ * \brief The KNMusicLibraryLoudnessScanner class measures the loudness of the
+ * files which don't have any loudness tag. Measuring needs to decode the whole
+ * file, so it is done after the file is added to the library, in a low
+ * priority thread, one file at a time.
+ */
+class KNMusicLibraryLoudnessScanner : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicLibraryLoudnessScanner object.
+     * \param parent The parent object.
+     */
+    explicit KNMusicLibraryLoudnessScanner(QObject *parent = 0);
+
+    /*!
+     * \brief Get whether the scanner is measuring files.
+     * \return If there's any file in the queue, return true.
+     */
+    bool isWorking() const;
+
+signals:
+    /*!
+     * \brief This signal is actually private, it is used for inner processing
+     * loop.
+     */
+    void requireScanNext();
+
+    /*!
+     * \brief When the loudness of a file is measured, this signal will be
+     * emitted.
+     * \param detailInfo The detail info of the file with the measured replay
+     * gain.
+     */
+    void scanComplete(KNMusicDetailInfo detailInfo);
+
+public slots:
+    /*!
+     * \brief Add a file to the scanning queue.
+     * \param detailInfo The detail info of the file.
+     */
+    void scanLoudness(KNMusicDetailInfo detailInfo);
+
+private slots:
+    void scanNext();
+
+private:
+    QLinkedList<KNMusicDetailInfo> m_scanQueue;
+    bool m_isWorking;
+};
+
+#endif // KNMUSICLIBRARYLOUDNESSSCANNER_H
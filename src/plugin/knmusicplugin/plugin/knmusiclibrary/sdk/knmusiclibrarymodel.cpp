@@ -19,10 +19,14 @@
 #include "knutil.h"
 #include "knnotification.h"
 
+#include "knmusicglobal.h"
+#include "knmusicparser.h"
+
 #include "knmusiccategorymodelbase.h"
 #include "knmusicsearcher.h"
 #include "knmusicanalysisqueue.h"
 #include "knmusiclibraryimagemanager.h"
+#include "knmusiclibraryloudnessscanner.h"
 
 #include "knmusiclibrarymodel.h"
 
@@ -30,16 +34,18 @@
 
 #define MajorVersion 4
 #define MinorVersion 0
+#define InlineReplayGainMinorVersion 1
+#define ReplayGainBlockTag 0x52474149
 #define MaxOperateCount 900
 
 KNMusicLibraryModel::KNMusicLibraryModel(QObject *parent) :
     KNMusicModel(parent),
-    m_scaledHashAlbumArt(QHash<QString, QVariant>()),
     m_databasePath(QString()),
     m_operateCounter(0),
     m_searcher(new KNMusicSearcher),
     m_analysisQueue(new KNMusicAnalysisQueue),
-    m_imageManager(new KNMusicLibraryImageManager)
+    m_imageManager(new KNMusicLibraryImageManager),
+    m_loudnessScanner(new KNMusicLibraryLoudnessScanner)
 {
     //Move the searcher to working thread.
     m_searcher->moveToThread(&m_searchThread);
@@ -56,6 +62,10 @@ KNMusicLibraryModel::KNMusicLibraryModel(QObject *parent) :
                                 QString::number(count)));
             });
 
+    //The album art will be parsed by the image manager, the analysis queue
+    //only needs to record the position of the album art, the image manager
+    //will read the data from the file.
+    m_analysisQueue->setDeferAlbumArt(true);
     //Move the analysis queue to working thread.
     m_analysisQueue->moveToThread(&m_analysisThread);
     //Link the searcher with the analysis queue.
@@ -67,7 +77,6 @@ KNMusicLibraryModel::KNMusicLibraryModel(QObject *parent) :
             Qt::QueuedConnection);
 
     //Move the image manager to working thread.
-    m_imageManager->setHashAlbumArt(&m_scaledHashAlbumArt);
     m_imageManager->moveToThread(&m_imageThread);
     //Link the signal from the library model.
     connect(this, &KNMusicLibraryModel::requireRecoverImage,
@@ -80,10 +89,25 @@ KNMusicLibraryModel::KNMusicLibraryModel(QObject *parent) :
             this, &KNMusicLibraryModel::onActionImageUpdateRow,
             Qt::QueuedConnection);
 
+    //The files without loudness tags are measured after they are added to the
+    //library, the result is saved in the database. Move the loudness scanner
+    //to working thread.
+    m_loudnessScanner->moveToThread(&m_loudnessThread);
+    //Link the loudness scanner with the library model.
+    connect(this, &KNMusicLibraryModel::requireScanLoudness,
+            m_loudnessScanner, &KNMusicLibraryLoudnessScanner::scanLoudness,
+            Qt::QueuedConnection);
+    connect(m_loudnessScanner, &KNMusicLibraryLoudnessScanner::scanComplete,
+            this, &KNMusicLibraryModel::onActionLoudnessScanComplete,
+            Qt::QueuedConnection);
+
     //Start working threads.
     m_searchThread.start();
     m_analysisThread.start();
     m_imageThread.start();
+    //Decoding the whole file is much slower than parsing, it shouldn't take
+    //the processor from the other threads.
+    m_loudnessThread.start(QThread::LowestPriority);
 }
 
 KNMusicLibraryModel::~KNMusicLibraryModel()
@@ -92,10 +116,12 @@ KNMusicLibraryModel::~KNMusicLibraryModel()
     m_searchThread.quit();
     m_analysisThread.quit();
     m_imageThread.quit();
+    m_loudnessThread.quit();
     //Wait for thread quit.
     m_searchThread.wait();
     m_analysisThread.wait();
     m_imageThread.wait();
+    m_loudnessThread.wait();
 
     //Write all the database data to the hard disk.
     writeDatabase();
@@ -103,6 +129,7 @@ KNMusicLibraryModel::~KNMusicLibraryModel()
     m_searcher->deleteLater();
     m_analysisQueue->deleteLater();
     m_imageManager->deleteLater();
+    m_loudnessScanner->deleteLater();
 }
 
 void KNMusicLibraryModel::appendRow(const KNMusicDetailInfo &detailInfo)
@@ -133,7 +160,7 @@ void KNMusicLibraryModel::appendRows(
         const QList<KNMusicDetailInfo> &detailInfos)
 {
     //Append all the data to the databases.
-    for(auto i : detailInfos)
+    for(const auto &i : detailInfos)
     {
         //Check the image cover image hash.
         if(!i.coverImageHash.isEmpty())
@@ -143,9 +170,9 @@ void KNMusicLibraryModel::appendRows(
                         i.coverImageHash,
                         m_hashAlbumArtCounter.value(i.coverImageHash)+1);
         }
-        //Add the detail info to category models.
-        addCategoryDetailInfo(i);
     }
+    //Add all the detail info to category models at once.
+    addCategoryDetailInfos(detailInfos);
     //Do the original append operations.
     KNMusicModel::appendRows(detailInfos);
     //Check out the row count.
@@ -203,9 +230,9 @@ bool KNMusicLibraryModel::insertMusicRows(
                         m_hashAlbumArtCounter.value(
                             detailInfo.coverImageHash)+1);
         }
-        //Add the detail info to category models.
-        addCategoryDetailInfo(detailInfo);
     }
+    //Add all the detail info to category models at once.
+    addCategoryDetailInfos(detailInfos);
     //Check out the database size.
     if(rowCount()==0)
     {
@@ -307,6 +334,9 @@ void KNMusicLibraryModel::clear()
     }
     //Do the model clear.
     KNMusicModel::clear();
+    //Release the cached directory covers, they won't be used until the music
+    //is added again.
+    knMusicGlobal->parser()->clearCoverCache();
     //The library is empty, emit the signal.
     emit libraryEmpty();
     //Actually, we can simply write the database here.
@@ -339,7 +369,7 @@ QPixmap KNMusicLibraryModel::artwork(const int &row)
 QPixmap KNMusicLibraryModel::artwork(const QString &hashKey)
 {
     //Give back the hash key image from the pixmap.
-    return m_scaledHashAlbumArt.contains(hashKey)?
+    return m_hashAlbumArtCounter.contains(hashKey)?
                 m_imageManager->artwork(hashKey):
                 knMusicGlobal->noAlbumArt();
 }
@@ -375,13 +405,19 @@ void KNMusicLibraryModel::recoverModel()
      * |rowCount() (unsigned 64-bit int)   |
      * |Detail Info Data Block 0           |
      * | ...                               |
+     * |Replay Gain Tag (unsigned 32-bit)  | (Optional)
+     * |Replay Gain Data Block 0           |
+     * | ...                               |
+     * The replay gains are at the end of the file, so the old version which
+     * only knows the detail infos could still read it. The files of minor
+     * version 1 have the replay gain after each detail info.
      */
     //Initial the version data.
     quint32 major, minor;
     //Read the version data.
     databaseStream >> major >> minor;
     //Check the major and minor version.
-    if(major!=MajorVersion && minor!=MinorVersion)
+    if(major!=MajorVersion || minor>InlineReplayGainMinorVersion)
     {
         //Close the file, the database file version is not correct.
         databaseFile.close();
@@ -401,23 +437,55 @@ void KNMusicLibraryModel::recoverModel()
         //Mission complete.
         return;
     }
+    //Read all the detail infos.
+    QList<KNMusicDetailInfo> categoryDetailInfos;
+    categoryDetailInfos.reserve(listSize);
+    while(listSize--)
+    {
+        //Read the detail info, the replay gain is reset.
+        KNMusicDetailInfo detailInfo;
+        databaseStream >> detailInfo;
+        //Read the inline replay gain of minor version 1.
+        if(minor==InlineReplayGainMinorVersion)
+        {
+            databaseStream >> detailInfo.replayGain;
+        }
+        //Save the detail info.
+        categoryDetailInfos.append(detailInfo);
+    }
+    //Read the replay gain block at the end of the file.
+    quint32 replayGainTag=0;
+    if(minor==MinorVersion && !databaseStream.atEnd())
+    {
+        databaseStream >> replayGainTag;
+    }
+    if(replayGainTag==ReplayGainBlockTag)
+    {
+        //Read the replay gain of each detail info in order.
+        for(auto &i : categoryDetailInfos)
+        {
+            databaseStream >> i.replayGain;
+        }
+        //Ignore the broken block.
+        if(databaseStream.status()!=QDataStream::Ok)
+        {
+            for(auto &i : categoryDetailInfos)
+            {
+                i.replayGain=KNMusicReplayGain();
+            }
+        }
+    }
     //Initial the total duration.
     quint64 totalDuration=0;
     //Start to insert data to the model.
     beginInsertRows(QModelIndex(),
                     0,
-                    listSize - 1);
-    //Generate a detail info.
-    KNMusicDetailInfo turboDetailInfo;
-    //Read the data through the database.
-    while(listSize--)
+                    categoryDetailInfos.size() - 1);
+    //Append the detail infos to the model.
+    for(const auto &turboDetailInfo : categoryDetailInfos)
     {
-        //Read the detail info.
-        databaseStream >> turboDetailInfo;
         //Append it to the model.
         appendDetailInfo(turboDetailInfo);
-        //Add to category models.
-        addCategoryDetailInfo(turboDetailInfo);
         //Calcualte the total duration.
         totalDuration+=turboDetailInfo.duration;
         //Add hash list to image hash list counter.
@@ -428,6 +496,8 @@ void KNMusicLibraryModel::recoverModel()
     }
     //Close the database file.
     databaseFile.close();
+    //Add all the detail info to category models at once.
+    addCategoryDetailInfos(categoryDetailInfos);
     //Set the total duration.
     initialTotalDuration(totalDuration);
     //End to insert data.
@@ -447,8 +517,8 @@ void KNMusicLibraryModel::recoverModel()
 
 void KNMusicLibraryModel::installCategoryModel(KNMusicCategoryModelBase *model)
 {
-    //Set hash list to category model.
-    model->setHashAlbumArt(&m_scaledHashAlbumArt);
+    //Set the image manager to category model.
+    model->setImageManager(m_imageManager);
     //Append the model to the category models.
     m_categoryModels.append(model);
 }
@@ -485,6 +555,11 @@ void KNMusicLibraryModel::onActionAnalysisComplete(
     //Emit the analysis signal.
     m_imageManager->analysisAlbumArt(index(rowCount()-1, 0),
                                      analysisItem);
+    //Measure the loudness when the file doesn't have the loudness tag.
+    if(analysisItem.detailInfo.replayGain.isNull())
+    {
+        emit requireScanLoudness(analysisItem.detailInfo);
+    }
 }
 
 void KNMusicLibraryModel::onActionImageUpdateRow(
@@ -505,6 +580,23 @@ void KNMusicLibraryModel::onActionImageUpdateRow(
     }
 }
 
+void KNMusicLibraryModel::onActionLoudnessScanComplete(
+        const KNMusicDetailInfo &detailInfo)
+{
+    //The file might be moved or removed while scanning, find it again.
+    int row=detailInfoRow(detailInfo);
+    if(row==-1)
+    {
+        return;
+    }
+    //Only update the replay gain, the other data of the row might be changed
+    //while scanning.
+    KNMusicDetailInfo updatedDetailInfo=rowDetailInfo(row);
+    updatedDetailInfo.replayGain=detailInfo.replayGain;
+    //Replace the row, the database will be written with the gain.
+    replaceRow(row, updatedDetailInfo);
+}
+
 void KNMusicLibraryModel::onActionImageRecoverComplete()
 {
     //Called all the category model to udpate their data.
@@ -526,6 +618,17 @@ inline void KNMusicLibraryModel::addCategoryDetailInfo(
     }
 }
 
+inline void KNMusicLibraryModel::addCategoryDetailInfos(
+        const QList<KNMusicDetailInfo> &detailInfos)
+{
+    //For all the category models,
+    for(auto i=m_categoryModels.begin(); i!=m_categoryModels.end(); ++i)
+    {
+        //Called the on action add batch slot.
+        (*i)->onCategoryAddBatch(detailInfos);
+    }
+}
+
 bool KNMusicLibraryModel::updateModelRow(
         int row,
         const KNMusicAnalysisItem &analysisItem)
@@ -578,9 +681,7 @@ inline void KNMusicLibraryModel::reduceHashImage(const QString &imageKey)
     case 1:
         //Remove the count.
         m_hashAlbumArtCounter.remove(imageKey);
-        //Remove the image.
-        m_scaledHashAlbumArt.remove(imageKey);
-        //Delete the file.
+        //Remove the image and delete the file.
         m_imageManager->removeHashImage(imageKey);
         break;
     default:
@@ -629,11 +730,20 @@ inline void KNMusicLibraryModel::writeDatabase()
                    //Write the row count.
                    << (quint64)rowCount();
     //Write all the detail infos.
-    for(int i=0, rows=rowCount(); i<rows; ++i)
+    int rows=rowCount();
+    for(int i=0; i<rows; ++i)
     {
         //Write the detail info data.
         databaseStream << rowDetailInfo(i);
     }
+    //Write the replay gains after all the detail infos, the old version will
+    //never read them.
+    databaseStream << (quint32)ReplayGainBlockTag;
+    for(int i=0; i<rows; ++i)
+    {
+        //Write the replay gain data.
+        databaseStream << rowDetailInfo(i).replayGain;
+    }
     //Close the file.
     databaseFile.close();
 }
@@ -38,6 +38,7 @@ class KNMusicSearcher;
 class KNMusicCategoryModelBase;
 class KNMusicAnalysisQueue;
 class KNMusicLibraryImageManager;
+class KNMusicLibraryLoudnessScanner;
 /*!
  * \brief The KNMusicLibraryModel class is the standard library model. It can
  * holds a image manager to read cached album art from the library folder, and
@@ -132,12 +133,6 @@ public:
      */
     void installCategoryModel(KNMusicCategoryModelBase *model);
 
-    /*!
-     * \brief Get the album art hash map pointer.
-     * \return The album art hash map pointer.
-     */
-    QHash<QString, QVariant> *hashAlbumArt();
-
     /*!
      * \brief Get the image manager, the image manager could provide the
      * original quality image which is read from hard disk.
@@ -170,6 +165,13 @@ signals:
      */
     void requireRecoverImage(QStringList imageHashList);
 
+    /*!
+     * \brief Ask the loudness scanner to measure a file which doesn't have any
+     * loudness tag. You won't need to use this signal to do anything.
+     * \param detailInfo The detail info of the file.
+     */
+    void requireScanLoudness(KNMusicDetailInfo detailInfo);
+
 public slots:
     /*!
      * \brief Set the database file path of the library model.
@@ -193,10 +195,13 @@ private slots:
     void onActionAnalysisComplete(const KNMusicAnalysisItem &analysisItem);
     void onActionImageUpdateRow(const int &row,
                                 const KNMusicDetailInfo &detailInfo);
+    void onActionLoudnessScanComplete(const KNMusicDetailInfo &detailInfo);
     void onActionImageRecoverComplete();
 
 private:
     inline void addCategoryDetailInfo(const KNMusicDetailInfo &detailInfo);
+    inline void addCategoryDetailInfos(
+            const QList<KNMusicDetailInfo> &detailInfos);
     inline bool updateModelRow(int row,
                                const KNMusicAnalysisItem &analysisItem);
     inline void updateCategoryDetailInfo(const KNMusicDetailInfo &before,
@@ -206,14 +211,14 @@ private:
     inline void count(int counts=1);
     inline void writeDatabase();
     QLinkedList<KNMusicCategoryModelBase *> m_categoryModels;
-    QHash<QString, QVariant> m_scaledHashAlbumArt;
     QHash<QString, int> m_hashAlbumArtCounter;
-    QThread m_searchThread, m_analysisThread, m_imageThread;
+    QThread m_searchThread, m_analysisThread, m_imageThread, m_loudnessThread;
     QString m_databasePath;
     int m_operateCounter;
     KNMusicSearcher *m_searcher;
     KNMusicAnalysisQueue *m_analysisQueue;
     KNMusicLibraryImageManager *m_imageManager;
+    KNMusicLibraryLoudnessScanner *m_loudnessScanner;
 };
 
 #endif // KNMUSICLIBRARYMODEL_H
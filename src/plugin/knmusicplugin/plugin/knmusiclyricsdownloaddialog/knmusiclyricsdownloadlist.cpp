@@ -31,6 +31,7 @@
 #include "knmusicbackend.h"
 #include "knmusiclrcparser.h"
 #include "knmusiclyricsbackend.h"
+#include "knmusicpositionclock.h"
 #include "knmusicscrolllyrics.h"
 #include "knmusiclyricsdetaillistmodel.h"
 
@@ -50,6 +51,7 @@ KNMusicLyricsDownloadList::KNMusicLyricsDownloadList(QWidget *parent) :
     m_lrcParser(new KNMusicLrcParser(this)),
     m_lyricsDetailListModel(new KNMusicLyricsDetailListModel(this)),
     m_previewBackend(new KNMusicLyricsBackend(this)),
+    m_positionClock(new KNMusicPositionClock(this)),
     m_scrollLyrics(new KNMusicScrollLyrics(this)),
     m_playNPause(new KNOpacityButton(this)),
     m_progress(new KNProgressSlider(this)),
@@ -81,6 +83,12 @@ KNMusicLyricsDownloadList::KNMusicLyricsDownloadList(QWidget *parent) :
     knTheme->registerWidget(m_scrollLyrics);
     m_scrollLyrics->setBackend(m_previewBackend);
     m_scrollLyrics->hide();
+    //Configure the position clock, it only works when the player is visible.
+    m_positionClock->addView(m_previewPlayer);
+    connect(m_positionClock, &KNMusicPositionClock::positionChanged,
+            m_previewBackend, &KNMusicLyricsBackend::setPosition);
+    connect(m_positionClock, &KNMusicPositionClock::positionChanged,
+            this, &KNMusicLyricsDownloadList::onActionPositionChanged);
     //Configure the player.
     QLinearGradient previewPlayerBase(0,0,0,16);
     previewPlayerBase.setColorAt(0, QColor(0x5d, 0x5d, 0x5d));
@@ -304,16 +312,12 @@ inline void KNMusicLyricsDownloadList::linkBackend()
         //Link the backend with the preview backend.
         //Connect response.
         m_previewLinker.append(
-                 connect(backend, &KNMusicBackend::previewPositionChanged,
-                         m_previewBackend, &KNMusicLyricsBackend::setPosition));
+                 connect(backend, &KNMusicBackend::previewPositionAnchorChanged,
+                         m_positionClock, &KNMusicPositionClock::setAnchor));
         m_previewLinker.append(
                  connect(backend, &KNMusicBackend::previewPlayingStateChanged,
                          this,
                          &KNMusicLyricsDownloadList::onActionPlayStateChanged));
-        m_previewLinker.append(
-                connect(backend, &KNMusicBackend::previewPositionChanged,
-                        this,
-                        &KNMusicLyricsDownloadList::onActionPositionChanged));
         //Connect controls.
         m_previewLinker.append(
                 connect(m_playNPause, &KNOpacityButton::clicked,
@@ -37,6 +37,7 @@ class KNProgressSlider;
 class KNMusicLrcParser;
 class KNMusicScrollLyrics;
 class KNMusicLyricsBackend;
+class KNMusicPositionClock;
 class KNMusicLyricsDetailListModel;
 /*!
  * \brief The KNMusicLyricsDownloadList class is a content widget which could
@@ -129,6 +130,7 @@ private:
     KNMusicLrcParser *m_lrcParser;
     KNMusicLyricsDetailListModel *m_lyricsDetailListModel;
     KNMusicLyricsBackend *m_previewBackend;
+    KNMusicPositionClock *m_positionClock;
     KNMusicScrollLyrics *m_scrollLyrics;
     KNOpacityButton *m_playNPause;
     KNProgressSlider *m_progress;
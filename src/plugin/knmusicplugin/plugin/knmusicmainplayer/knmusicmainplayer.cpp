@@ -18,6 +18,7 @@
 #include <QBoxLayout>
 #include <QFileInfo>
 #include <QLabel>
+#include <QPainter>
 
 #include "kneditablelabel.h"
 #include "knthememanager.h"
@@ -29,7 +30,10 @@
 
 #include "knmusiclyricsmanager.h"
 #include "knmusiccodeclabel.h"
+#include "knmusicspectrumview.h"
 #include "knmusicbackend.h"
+#include "knmusiclibrarybase.h"
+#include "knmusicpositionclock.h"
 #include "knmusicproxymodel.h"
 #include "knmusicscrolllyrics.h"
 #include "knmusicmainplayerpanel.h"
@@ -39,15 +43,21 @@
 
 #include "knmusicmainplayer.h"
 
+#define BackgroundOpacity 0.35
+#define SpectrumHeight 32
+
 #include <QDebug>
 
 KNMusicMainPlayer::KNMusicMainPlayer(QWidget *parent) :
     KNMusicMainPlayerBase(parent),
     m_playIcon(QPixmap(":/plugin/music/player/play_dark.png")),
     m_pauseIcon(QPixmap(":/plugin/music/player/pause_dark.png")),
+    m_background(QPixmap()),
     m_buttonLeftLayout(nullptr),
     m_buttonRightLayout(nullptr),
     m_backend(nullptr),
+    m_library(nullptr),
+    m_positionClock(new KNMusicPositionClock(this)),
     m_hideMainPlayer(new KNOpacityAnimeButton(this)),
     m_detailInfoPanel(new KNMusicMainPlayerPanel(this)),
     m_lyricsPanel(new KNMusicScrollLyrics(this)),
@@ -58,11 +68,13 @@ KNMusicMainPlayer::KNMusicMainPlayer(QWidget *parent) :
     m_duration(new QLabel(this)),
     m_position(new KNEditableLabel(this)),
     m_codecLabel(new KNMusicCodecLabel(this)),
+    m_spectrumView(new KNMusicSpectrumView(this)),
     m_loopMode(new KNOpacityAnimeButton(this)),
     m_volumeIcon(new KNOpacityButton(this)),
     m_volumeSlider(new KNVolumeSlider(this)),
     m_firstStageVolume(-1),
     m_secondStageVolume(-1),
+    m_backgroundHashKey(QString()),
     m_progressPressed(false)
 {
     setObjectName("MainPlayer");
@@ -169,6 +181,10 @@ KNMusicMainPlayer::KNMusicMainPlayer(QWidget *parent) :
     //Configure position label.
     connect(m_position, &KNEditableLabel::contentChanged,
             this, &KNMusicMainPlayer::onActionPositionEdited);
+    // Configure the spectrum view, it uses the color of the labels.
+    m_spectrumView->setObjectName("MainPlayerLabel");
+    m_spectrumView->setFixedHeight(SpectrumHeight);
+    knTheme->registerWidget(m_spectrumView);
 
     //Register the widget to the theme manager.
     knTheme->registerWidget(this);
@@ -206,6 +222,7 @@ KNMusicMainPlayer::KNMusicMainPlayer(QWidget *parent) :
     controlLayout->setSpacing(0);
     m_controlPanel->setLayout(controlLayout);
     //Add widgets to control panels.
+    controlLayout->addWidget(m_spectrumView);
     controlLayout->addWidget(m_progressSlider);
     //Add to main playout.
     mainLayout->addWidget(m_controlPanel);
@@ -259,6 +276,8 @@ void KNMusicMainPlayer::setBackend(KNMusicBackend *backend)
     {
         return;
     }
+    //Give the backend to the spectrum view.
+    m_spectrumView->setBackend(m_backend);
     //Link to the backend.
     connect(m_volumeSlider, &KNVolumeSlider::valueChanged,
             m_backend, &KNMusicBackend::setVolume);
@@ -267,7 +286,11 @@ void KNMusicMainPlayer::setBackend(KNMusicBackend *backend)
             this, &KNMusicMainPlayer::onActionVolumeChanged);
     connect(m_backend, &KNMusicBackend::durationChanged,
             this, &KNMusicMainPlayer::updateDuration);
-    connect(m_backend, &KNMusicBackend::positionChanged,
+    //The position is only updated when the progress slider is visible.
+    m_positionClock->addView(m_progressSlider);
+    connect(m_backend, &KNMusicBackend::positionAnchorChanged,
+            m_positionClock, &KNMusicPositionClock::setAnchor);
+    connect(m_positionClock, &KNMusicPositionClock::positionChanged,
             [=](const qint64 &position)
             {
                 //Update the value of progress slider when the progress slider
@@ -327,6 +350,18 @@ void KNMusicMainPlayer::setNowPlaying(KNMusicNowPlayingBase *nowPlaying)
     onActionLoopStateChanged(nowPlaying->loopState());
 }
 
+void KNMusicMainPlayer::setLibrary(KNMusicLibraryBase *library)
+{
+    //Save the library pointer.
+    m_library=library;
+    //The album art style is generated later than the album art is inserted,
+    //update the background when the style is ready.
+    connect(m_library, &KNMusicLibraryBase::artworkStyleChanged,
+            this, &KNMusicMainPlayer::onActionArtworkStyleChanged);
+    //Sync the background of the current song.
+    updateBackground();
+}
+
 void KNMusicMainPlayer::resizeEvent(QResizeEvent *event)
 {
     //Do the resize.
@@ -378,15 +413,53 @@ void KNMusicMainPlayer::resizeEvent(QResizeEvent *event)
     m_buttonRightLayout->setSpacing(controlLayoutSpacing);
 }
 
+void KNMusicMainPlayer::paintEvent(QPaintEvent *event)
+{
+    //Paint the original background.
+    KNMusicMainPlayerBase::paintEvent(event);
+    //Check the artwork background.
+    if(m_background.isNull())
+    {
+        return;
+    }
+    //Initial the painter.
+    QPainter painter(this);
+    painter.setRenderHints(QPainter::Antialiasing |
+                           QPainter::SmoothPixmapTransform);
+    painter.setOpacity(BackgroundOpacity);
+    //The background is already blurred, simply stretch it to cover the whole
+    //widget.
+    int backgroundSize=qMax(width(), height());
+    painter.drawPixmap(QRect((width()-backgroundSize)>>1,
+                             (height()-backgroundSize)>>1,
+                             backgroundSize,
+                             backgroundSize),
+                       m_background);
+}
+
 void KNMusicMainPlayer::onActionAnalysisItemChanged(
         const KNMusicAnalysisItem &item)
 {
     //Update the panel data.
     m_detailInfoPanel->setAnalysisItem(item);
+    //Update the background, the background is generated and blurred by the
+    //library once for each album art.
+    m_backgroundHashKey=item.detailInfo.coverImageHash;
+    updateBackground();
     //Give the suffix to the codec label.
     m_codecLabel->setSuffix(QFileInfo(item.detailInfo.filePath).suffix());
 }
 
+void KNMusicMainPlayer::onActionArtworkStyleChanged(const QString &hashKey)
+{
+    //Check whether the style belongs to the current song.
+    if(hashKey==m_backgroundHashKey)
+    {
+        //Update the background.
+        updateBackground();
+    }
+}
+
 void KNMusicMainPlayer::onActionPlayNPauseClicked()
 {
     //Check the backend pointer.
@@ -523,3 +596,15 @@ void KNMusicMainPlayer::setPosition(const qint64 &position)
         m_backend->setPosition(position);
     }
 }
+
+inline void KNMusicMainPlayer::updateBackground()
+{
+    //Get the style of the album art from the library, only the songs in the
+    //library have the album art hash key.
+    m_background=(m_library==nullptr || m_backgroundHashKey.isEmpty())?
+                QPixmap():
+                QPixmap::fromImage(
+                    m_library->artworkStyle(m_backgroundHashKey).background);
+    //Update the widget.
+    update();
+}
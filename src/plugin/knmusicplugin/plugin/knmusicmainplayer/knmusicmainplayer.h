@@ -36,7 +36,9 @@ class KNOpacityAnimeButton;
 class KNProgressSlider;
 class KNGlassAnimeButton;
 class KNMusicCodecLabel;
+class KNMusicSpectrumView;
 class KNMusicScrollLyrics;
+class KNMusicPositionClock;
 class KNMusicMainPlayerPanel;
 class KNMusicNowPlayingListView;
 class KNMusicMainPlayerContent;
@@ -66,6 +68,11 @@ public:
      */
     void setNowPlaying(KNMusicNowPlayingBase *nowPlaying) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicMainPlayerBase::setLibrary().
+     */
+    void setLibrary(KNMusicLibraryBase *library) Q_DECL_OVERRIDE;
+
 signals:
 
 public slots:
@@ -76,8 +83,14 @@ protected:
      */
     void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicPlayerBase::paintEvent().
+     */
+    void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE;
+
 private slots:
     void onActionAnalysisItemChanged(const KNMusicAnalysisItem &item);
+    void onActionArtworkStyleChanged(const QString &hashKey);
     void onActionPlayNPauseClicked();
     void onActionVolumeChanged(const int &volumeSize);
     void onActionLoopStateChanged(const int &state);
@@ -104,15 +117,18 @@ private:
         VolumeSizeCount
     };
     inline void setPosition(const qint64 &position);
+    inline void updateBackground();
     //Resources.
     QPixmap m_playIcon, m_pauseIcon, m_loopStateIcon[LoopCount],
-            m_volumeSizeIcon[VolumeSizeCount];
+            m_volumeSizeIcon[VolumeSizeCount], m_background;
 
     //Layouts.
     QBoxLayout *m_buttonLeftLayout, *m_buttonRightLayout;
 
     //Backends.
     KNMusicBackend *m_backend;
+    KNMusicLibraryBase *m_library;
+    KNMusicPositionClock *m_positionClock;
 
     //Global Controls/Panels.
     KNOpacityAnimeButton *m_hideMainPlayer;
@@ -127,6 +143,7 @@ private:
     QLabel *m_duration;
     KNEditableLabel *m_position;
     KNMusicCodecLabel *m_codecLabel;
+    KNMusicSpectrumView *m_spectrumView;
     KNOpacityAnimeButton *m_loopMode;
     KNOpacityButton *m_volumeIcon;
     KNVolumeSlider *m_volumeSlider;
@@ -135,6 +152,7 @@ private:
     //Volume stage data.
     int m_firstStageVolume, m_secondStageVolume;
     //Status.
+    QString m_backgroundHashKey;
     bool m_progressPressed;
 };
 
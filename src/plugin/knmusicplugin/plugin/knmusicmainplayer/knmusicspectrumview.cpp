@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QPainter>
+#include <QTimer>
+
+#include "knmusicbackend.h"
+
+#include "knmusicspectrumview.h"
+
+#define TickInterval 33
+#define FallStep 0.04f
+#define BarSpacing 2
+#define BarOpacity 100
+
+using namespace MusicUtil;
+
+KNMusicSpectrumView::KNMusicSpectrumView(QWidget *parent) :
+    QWidget(parent),
+    m_bands(QVector<float>()),
+    m_levels(QVector<float>()),
+    m_ticker(new QTimer(this)),
+    m_backend(nullptr)
+{
+    //Configure the ticker.
+    m_ticker->setInterval(TickInterval);
+    connect(m_ticker, &QTimer::timeout,
+            this, &KNMusicSpectrumView::onActionTick);
+}
+
+void KNMusicSpectrumView::setBackend(KNMusicBackend *backend)
+{
+    //Save the backend pointer.
+    m_backend=backend;
+    //Check the backend.
+    if(m_backend==nullptr)
+    {
+        return;
+    }
+    //The snapshot is only polled when the music is playing.
+    connect(m_backend, &KNMusicBackend::playingStateChanged,
+            this, &KNMusicSpectrumView::onActionPlayingStateChanged);
+    //Update the ticker.
+    updateTicker();
+}
+
+void KNMusicSpectrumView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    //Check the levels.
+    if(m_levels.isEmpty())
+    {
+        return;
+    }
+    //Initial the painter.
+    QPainter painter(this);
+    //Use the text color of the theme for the bars.
+    QColor barColor=palette().color(QPalette::WindowText);
+    barColor.setAlpha(BarOpacity);
+    //Paint the bars from the bottom.
+    int barCount=m_levels.size(),
+        barWidth=qMax(1, (width()-BarSpacing*(barCount-1))/barCount),
+        left=(width()-barWidth*barCount-BarSpacing*(barCount-1))>>1;
+    for(int i=0; i<barCount; ++i)
+    {
+        //Calculate the bar height.
+        int barHeight=(int)(m_levels.at(i)*(float)height());
+        if(barHeight>0)
+        {
+            painter.fillRect(left, height()-barHeight, barWidth, barHeight,
+                             barColor);
+        }
+        //Move to the next bar.
+        left+=barWidth+BarSpacing;
+    }
+}
+
+void KNMusicSpectrumView::showEvent(QShowEvent *event)
+{
+    //Show the widget.
+    QWidget::showEvent(event);
+    //Start to poll the snapshot.
+    updateTicker();
+}
+
+void KNMusicSpectrumView::hideEvent(QHideEvent *event)
+{
+    //Hide the widget.
+    QWidget::hideEvent(event);
+    //Stop polling the snapshot.
+    updateTicker();
+}
+
+void KNMusicSpectrumView::onActionTick()
+{
+    //Get the latest snapshot, ignore the tick when there's no new one.
+    if(!m_backend->spectrum(m_bands))
+    {
+        return;
+    }
+    //Check the band count of the levels.
+    if(m_levels.size()!=m_bands.size())
+    {
+        m_levels.fill(0.0f, m_bands.size());
+    }
+    //The bars rise to the new levels at once, but fall slowly.
+    for(int i=0; i<m_bands.size(); ++i)
+    {
+        m_levels[i]=qMax(m_bands.at(i), m_levels.at(i)-FallStep);
+    }
+    //Update the bars.
+    update();
+}
+
+void KNMusicSpectrumView::onActionPlayingStateChanged(int state)
+{
+    //Clear the bars when the music is not playing.
+    if(state!=Playing)
+    {
+        m_levels.clear();
+        update();
+    }
+    //Update the ticker.
+    updateTicker();
+}
+
+inline void KNMusicSpectrumView::updateTicker()
+{
+    //The ticker only runs when the music is playing and the view is visible.
+    if(m_backend!=nullptr && m_backend->state()==Playing && isVisible())
+    {
+        //Start the ticker.
+        if(!m_ticker->isActive())
+        {
+            m_ticker->start();
+        }
+        return;
+    }
+    //Stop the ticker.
+    m_ticker->stop();
+}
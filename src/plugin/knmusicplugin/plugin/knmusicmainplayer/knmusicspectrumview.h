@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICSPECTRUMVIEW_H
+#define KNMUSICSPECTRUMVIEW_H
+
+#include <QVector>
+
+#include <QWidget>
+
+class QTimer;
+class KNMusicBackend;
+/*!
+ * \brief The KNMusicSpectrumView class displays the spectrum snapshot of the
+ * backend as bars. It polls the snapshot about 30 times per second, only when
+ * the music is playing and the view is visible. The bars fall slowly instead
+ * of jumping down.
+ */
+class KNMusicSpectrumView : public QWidget
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicSpectrumView widget.
+     * \param parent The parent widget.
+     */
+    explicit KNMusicSpectrumView(QWidget *parent = 0);
+
+    /*!
+     * \brief Set the backend which provides the spectrum snapshot.
+     * \param backend The backend object.
+     */
+    void setBackend(KNMusicBackend *backend);
+
+protected:
+    /*!
+     * \brief Reimplemented from QWidget::paintEvent().
+     */
+    void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from QWidget::showEvent().
+     */
+    void showEvent(QShowEvent *event) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from QWidget::hideEvent().
+     */
+    void hideEvent(QHideEvent *event) Q_DECL_OVERRIDE;
+
+private slots:
+    void onActionTick();
+    void onActionPlayingStateChanged(int state);
+
+private:
+    inline void updateTicker();
+    QVector<float> m_bands, m_levels;
+    QTimer *m_ticker;
+    KNMusicBackend *m_backend;
+};
+
+#endif // KNMUSICSPECTRUMVIEW_H
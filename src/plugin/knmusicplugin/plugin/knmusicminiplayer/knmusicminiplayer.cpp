@@ -33,6 +33,7 @@
 #include "knconfigure.h"
 
 #include "knmusicbackend.h"
+#include "knmusicpositionclock.h"
 #include "knmusicnowplayingbase.h"
 #include "knmusichscrolllyrics.h"
 #include "knmusicglobal.h"
@@ -63,6 +64,7 @@ KNMusicMiniPlayer::KNMusicMiniPlayer(QWidget *parent) :
     m_lyrics(new KNMusicHScrollLyrics(this)),
     m_moving(new QTimeLine(200, this)),
     m_backend(nullptr),
+    m_positionClock(new KNMusicPositionClock(this)),
     m_nowPlaying(nullptr),
     m_cacheConfigure(knGlobal->cacheConfigure()->getConfigure("MiniPlayer")),
     m_minimalX(0),
@@ -242,7 +244,11 @@ void KNMusicMiniPlayer::setBackend(KNMusicBackend *backend)
                 }
             });
     //Connect the response.
-    connect(m_backend, &KNMusicBackend::positionChanged,
+    //The position is only updated when the progress slider is visible.
+    m_positionClock->addView(m_progressSlider);
+    connect(m_backend, &KNMusicBackend::positionAnchorChanged,
+            m_positionClock, &KNMusicPositionClock::setAnchor);
+    connect(m_positionClock, &KNMusicPositionClock::positionChanged,
             [=](const qint64 &position)
             {
                 //Update the value of progress slider when the progress slider
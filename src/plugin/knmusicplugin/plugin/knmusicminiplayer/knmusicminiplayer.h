@@ -34,6 +34,7 @@ class KNOpacityAnimeButton;
 class KNOpacityButton;
 class KNLoopScrollLabel;
 class KNMusicHScrollLyrics;
+class KNMusicPositionClock;
 /*!
  * \brief The KNMusicMiniPlayer class provide the offical mini desktop player.
  * It will use all the default widget provided via SDK.
@@ -134,6 +135,7 @@ private:
     QTimeLine *m_moving;
 
     KNMusicBackend *m_backend;
+    KNMusicPositionClock *m_positionClock;
     KNMusicNowPlayingBase *m_nowPlaying;
     KNConfigure *m_cacheConfigure;
 
@@ -15,6 +15,8 @@
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
+#include "knconfigure.h"
+
 #include "knmusicproxymodel.h"
 #include "knmusicmodel.h"
 #include "knmusicbackend.h"
@@ -26,6 +28,11 @@
 
 #include <QDebug>
 
+#define CrossfadeDuration QString("CrossfadeDuration")
+#define CrossfadeCurve QString("CrossfadeCurve")
+#define ReplayGainMode QString("ReplayGainMode")
+#define ReplayGainPreamp QString("ReplayGainPreamp")
+
 KNMusicNowPlaying::KNMusicNowPlaying(QObject *parent) :
     KNMusicNowPlayingBase(parent),
     m_backend(nullptr),
@@ -35,7 +42,11 @@ KNMusicNowPlaying::KNMusicNowPlaying(QObject *parent) :
     m_temporaryPlaylist(new KNMusicTemporaryPlaylistModel(this)),
     m_playingTab(nullptr),
     m_loopState(NoRepeat),
+    m_replayGainMode(ReplayGainTrack),
+    m_replayGainPreamp(0.0),
     m_playingIndex(QPersistentModelIndex()),
+    m_nextIndex(QPersistentModelIndex()),
+    m_prefetchIndex(QPersistentModelIndex()),
     m_playingAnalysisItem(KNMusicAnalysisItem()),
     m_manualPlayed(false)
 {
@@ -75,6 +86,10 @@ void KNMusicNowPlaying::setBackend(KNMusicBackend *backend)
         m_backendConnections.append(
                     connect(m_backend, &KNMusicBackend::finished,
                             this, &KNMusicNowPlaying::onActionBackendFinished));
+        m_backendConnections.append(
+                    connect(m_backend, &KNMusicBackend::nextMusicStarted,
+                            this,
+                            &KNMusicNowPlaying::onActionNextMusicStarted));
         //Link the load success and failed to load signal.
         m_backendConnections.append(
                     connect(m_backend, &KNMusicBackend::loadFailed,
@@ -132,7 +147,22 @@ void KNMusicNowPlaying::reset()
 
 void KNMusicNowPlaying::loadConfigure()
 {
-    //Get the loop state from the cache data.
+    //--From music configure--
+    KNConfigure *musicConfigure=knMusicGlobal->configure();
+    //Get the replay gain settings.
+    m_replayGainMode=
+            musicConfigure->data(ReplayGainMode, ReplayGainTrack).toInt();
+    m_replayGainPreamp=musicConfigure->data(ReplayGainPreamp, 0.0).toDouble();
+    if(m_backend)
+    {
+        //Apply the replay gain settings to the playing music.
+        updateMusicGain();
+        //Set the crossfade parameters to the backend.
+        m_backend->setCrossfade(
+                    musicConfigure->data(CrossfadeDuration, 0).toInt(),
+                    musicConfigure->data(CrossfadeCurve,
+                                         CrossfadeEqualPower).toInt());
+    }
 }
 
 void KNMusicNowPlaying::saveConfigure()
@@ -333,6 +363,8 @@ void KNMusicNowPlaying::setLoopState(const int &state)
 {
     //Save the new state.
     m_loopState=state % LoopCount;
+    //The next row is changed with the loop state.
+    queueNextRow();
     //Emit the loop state changed signal.
     emit loopStateChanged(m_loopState);
 }
@@ -400,6 +432,49 @@ void KNMusicNowPlaying::onActionBackendFinished()
     playNextRow(false);
 }
 
+void KNMusicNowPlaying::onActionNextMusicStarted()
+{
+    //Add play times on the previous row.
+    if(playingMusicModel() && m_playingIndex.isValid())
+    {
+        //Add play times on the playing index.
+        playingMusicModel()->addPlayingTimes(m_playingIndex);
+    }
+    //Set the manual playing flag to become false.
+    m_manualPlayed=false;
+    //Check the next index is still in the playing model.
+    if(m_playingProxyModel==nullptr || !m_nextIndex.isValid() ||
+            m_nextIndex.model()!=m_playingProxyModel->sourceModel())
+    {
+        //Play the next row in the normal way.
+        playNextRow(false);
+        return;
+    }
+    //Get the music model.
+    KNMusicModel *musicModel=playingMusicModel();
+    //The next row is the playing row now.
+    m_playingIndex=m_nextIndex;
+    m_nextIndex=QPersistentModelIndex();
+    //Set the playing index.
+    musicModel->setPlayingIndex(m_playingIndex);
+    //Reanalysis the row, the backend has already played it.
+    KNMusicAnalysisItem reanalysisItem;
+    reanalysisItem.detailInfo=musicModel->rowDetailInfo(m_playingIndex.row());
+    if(knMusicGlobal->parser()->reanalysisItem(reanalysisItem))
+    {
+        //Update the music model row.
+        musicModel->updateRow(m_playingIndex.row(), reanalysisItem);
+    }
+    //Save the current reanlaysis item.
+    m_playingAnalysisItem=reanalysisItem;
+    //Apply the replay gain of the next music.
+    updateMusicGain();
+    //The next music is loaded successfully.
+    onActionLoadSuccess();
+    //Set the row after it to the backend.
+    queueNextRow();
+}
+
 void KNMusicNowPlaying::onActionPlayingItemRemoved()
 {
     //Reset current playing.
@@ -508,8 +583,12 @@ void KNMusicNowPlaying::playRow(const int &proxyRow)
                                  detailInfo.startPosition,
                                  detailInfo.duration);
         }
+        //Apply the replay gain of the music.
+        updateMusicGain();
         //Play the main thread.
         m_backend->play();
+        //Set the next row to the backend, it could be played without gap.
+        queueNextRow();
         //Mission complete.
         return;
     }
@@ -532,6 +611,8 @@ inline void KNMusicNowPlaying::resetCurrentPlaying()
     resetCurrentPlayingModelData();
     //Clear the current playing index and the analysis item.
     m_playingIndex=QPersistentModelIndex();
+    m_nextIndex=QPersistentModelIndex();
+    m_prefetchIndex=QPersistentModelIndex();
     m_playingAnalysisItem=KNMusicAnalysisItem();
 }
 
@@ -558,6 +639,34 @@ inline void KNMusicNowPlaying::playNextRow(bool noLoopMode)
     {
         return;
     }
+    //Get the next row. In shuffle mode, the next row is randomly picked when
+    //it's prefetched, use the prefetched row.
+    int nextRow=-1;
+    if(Shuffle==m_loopState && m_prefetchIndex.isValid() &&
+            m_prefetchIndex.model()==m_playingProxyModel->sourceModel())
+    {
+        nextRow=m_playingProxyModel->mapFromSource(m_prefetchIndex).row();
+    }
+    //The prefetched row is only used once.
+    m_prefetchIndex=QPersistentModelIndex();
+    if(nextRow==-1)
+    {
+        nextRow=nextProxyRow(noLoopMode);
+    }
+    //Check if the row is available.
+    if(nextRow==-1)
+    {
+        //Clear the current playing.
+        resetCurrentPlaying();
+        //Everything is done.
+        return;
+    }
+    //Play the new row.
+    playRow(nextRow);
+}
+
+inline int KNMusicNowPlaying::nextProxyRow(bool noLoopMode)
+{
     //Check the current index is valid or not.
     //If the current index is not valid, then ask to play the first song in the
     //model.
@@ -568,9 +677,7 @@ inline void KNMusicNowPlaying::playNextRow(bool noLoopMode)
             m_playingIndex.model()!=m_playingProxyModel->sourceModel())
     {
         //Play the first row.
-        playRow(0);
-        //Finished.
-        return;
+        return 0;
     }
     //Check the loop state, if it's shuffle mode, use a specfic way to get the
     //index.
@@ -598,43 +705,136 @@ inline void KNMusicNowPlaying::playNextRow(bool noLoopMode)
             //To fix it, it's simple, reduce row count.
             preferRowGap-=(m_playingProxyModel->rowCount()-1);
         }
-        //Play the row.
-        playRow(preferRowGap);
-        //Check out the prefer row is empty or not.
-        return;
+        //Give back the shuffle row.
+        return preferRowGap;
     }
-    //Get the next row.
-    int proxyRow=m_playingProxyModel->mapFromSource(m_playingIndex).row(),
-        nextProxyRow;
+    //Get the current row.
+    int proxyRow=m_playingProxyModel->mapFromSource(m_playingIndex).row();
     //If the row is the last row in the model,
     if(proxyRow==m_playingProxyModel->rowCount()-1)
     {
-        //If it doesn't in a loop mode,
-        if(noLoopMode)
-        {
-            //then reach the end of the model.
-            nextProxyRow=-1;
-        }
-        else
-        {
-            //Now, according to the loop mode, give out the row.
-            //Only Repeat All can go back from the first line of the proxy model.
-            nextProxyRow=((m_loopState==RepeatAll)?0:-1);
-        }
+        //If it doesn't in a loop mode, then reach the end of the model.
+        //Or else, according to the loop mode, give out the row.
+        //Only Repeat All can go back from the first line of the proxy model.
+        return (noLoopMode || m_loopState!=RepeatAll)?-1:0;
+    }
+    //Normal case: return the next row of the current row.
+    return proxyRow+1;
+}
+
+inline void KNMusicNowPlaying::queueNextRow()
+{
+    //Check the backend first.
+    if(m_backend==nullptr)
+    {
+        return;
+    }
+    //Clear the previous next index and the prefetched index.
+    m_nextIndex=QPersistentModelIndex();
+    m_prefetchIndex=QPersistentModelIndex();
+    //Check the playing model and the playing index.
+    if(m_playingProxyModel==nullptr ||
+            m_playingProxyModel->rowCount()==0 ||
+            !m_playingIndex.isValid() ||
+            m_playingIndex.model()!=m_playingProxyModel->sourceModel())
+    {
+        //Clear the next music and the prefetched music.
+        m_backend->setNextMusic(QString());
+        m_backend->prefetchMusic(QString());
+        return;
+    }
+    //Get the next row, repeat the track will play the same row again.
+    int nextRow=(RepeatTrack==m_loopState)?
+                m_playingProxyModel->mapFromSource(m_playingIndex).row():
+                nextProxyRow(false);
+    //Check the next row.
+    if(nextRow==-1)
+    {
+        //Clear the next music and the prefetched music.
+        m_backend->setNextMusic(QString());
+        m_backend->prefetchMusic(QString());
+        return;
+    }
+    //Get the source index of the next row.
+    QModelIndex nextIndex=m_playingProxyModel->mapToSource(
+                m_playingProxyModel->index(nextRow, 0));
+    //Get the detail info of the next row.
+    KNMusicDetailInfo &&detailInfo=
+            playingMusicModel()->rowDetailInfo(nextIndex.row());
+    //Prefetch the next row, so it could start at once even if it's played
+    //manually. The repeated track doesn't need to be prefetched.
+    m_prefetchIndex=QPersistentModelIndex(nextIndex);
+    if(nextIndex==m_playingIndex)
+    {
+        m_backend->prefetchMusic(QString());
+    }
+    else if(detailInfo.trackFilePath.isEmpty())
+    {
+        m_backend->prefetchMusic(detailInfo.filePath);
     }
     else
     {
-        //Normal case: return the next row of the current row.
-        nextProxyRow=proxyRow+1;
+        m_backend->prefetchMusic(detailInfo.filePath,
+                                 detailInfo.startPosition,
+                                 detailInfo.duration);
     }
-    //Check if the row is available.
-    if(nextProxyRow==-1)
+    //Crossfade the next music when it's not the next track of the same album,
+    //the tracks of an album should follow each other without gap.
+    if(m_backend->crossfadeDuration()>0 &&
+            !isSameAlbum(m_playingAnalysisItem.detailInfo, detailInfo) &&
+            (detailInfo.trackFilePath.isEmpty()?
+                 m_backend->setCrossfadeMusic(detailInfo.filePath):
+                 m_backend->setCrossfadeMusic(detailInfo.filePath,
+                                              detailInfo.startPosition,
+                                              detailInfo.duration)))
     {
-        //Clear the current playing.
-        resetCurrentPlaying();
-        //Everything is done.
+        //Save the next index.
+        m_nextIndex=QPersistentModelIndex(nextIndex);
         return;
     }
-    //Play the new row.
-    playRow(nextProxyRow);
+    //Set the next music to the backend, the track of a cue sheet is a section
+    //of the file. The backend will check whether it could follow the current
+    //one.
+    if(detailInfo.trackFilePath.isEmpty()?
+            m_backend->setNextMusic(detailInfo.filePath):
+            m_backend->setNextMusic(detailInfo.filePath,
+                                    detailInfo.startPosition,
+                                    detailInfo.duration))
+    {
+        //Save the next index.
+        m_nextIndex=QPersistentModelIndex(nextIndex);
+    }
+}
+
+inline bool KNMusicNowPlaying::isSameAlbum(
+        const KNMusicDetailInfo &detailInfo,
+        const KNMusicDetailInfo &nextDetailInfo)
+{
+    //Get the album of the two music.
+    QString album=detailInfo.textLists[Album].toString();
+    //The music without album won't be treated as the same album.
+    if(album.isEmpty() ||
+            album!=nextDetailInfo.textLists[Album].toString())
+    {
+        return false;
+    }
+    //Check the album artist first, if there's no album artist, use the artist.
+    QString albumArtist=detailInfo.textLists[AlbumArtist].toString(),
+            nextAlbumArtist=nextDetailInfo.textLists[AlbumArtist].toString();
+    if(albumArtist.isEmpty() && nextAlbumArtist.isEmpty())
+    {
+        return detailInfo.textLists[Artist].toString()==
+                nextDetailInfo.textLists[Artist].toString();
+    }
+    return albumArtist==nextAlbumArtist;
+}
+
+inline void KNMusicNowPlaying::updateMusicGain()
+{
+    //Set the replay gain of the playing music to the backend.
+    m_backend->setMusicGain(
+                KNMusicUtil::replayGainScale(
+                    m_playingAnalysisItem.detailInfo.replayGain,
+                    m_replayGainMode,
+                    m_replayGainPreamp));
 }
@@ -143,6 +143,7 @@ public slots:
 
 private slots:
     void onActionBackendFinished();
+    void onActionNextMusicStarted();
     void onActionPlayingItemRemoved();
     void onActionLoadSuccess();
     void onActionLoadFailed();
@@ -155,6 +156,11 @@ private:
     inline void resetCurrentPlaying();
     inline void resetCurrentPlayingModelData();
     inline void playNextRow(bool noLoopMode=false);
+    inline int nextProxyRow(bool noLoopMode);
+    inline void queueNextRow();
+    inline bool isSameAlbum(const KNMusicDetailInfo &detailInfo,
+                            const KNMusicDetailInfo &nextDetailInfo);
+    inline void updateMusicGain();
 
     KNMusicBackend *m_backend;
     KNMusicProxyModel *m_playingProxyModel,
@@ -162,9 +168,10 @@ private:
                       *m_temporaryProxyPlaylist;
     KNMusicTemporaryPlaylistModel *m_temporaryPlaylist;
     KNMusicTab *m_playingTab;
-    int m_loopState;
+    int m_loopState, m_replayGainMode;
+    qreal m_replayGainPreamp;
 
-    QPersistentModelIndex m_playingIndex;
+    QPersistentModelIndex m_playingIndex, m_nextIndex, m_prefetchIndex;
     KNMusicAnalysisItem m_playingAnalysisItem;
 
     std::mt19937 m_mersenneSeed;
@@ -242,9 +242,18 @@ void KNMusicPlaylistViewer::onActionSearch()
         //Ignore the search request.
         return;
     }
+    //The search result could be applied later, update the title and detail
+    //info when the search is complete.
+    connect(m_treeView->proxyModel(), &KNMusicProxyModel::searchComplete,
+            this, &KNMusicPlaylistViewer::onActionSearchComplete,
+            Qt::UniqueConnection);
     //Set the search rules to the proxy model.
     m_treeView->proxyModel()->setSearchBlocks(knMusicGlobal->search()->rules());
-    //Update the title and detail info.
+}
+
+void KNMusicPlaylistViewer::onActionSearchComplete()
+{
+    //Update the title and detail info with the search result.
     updateTitle();
     updateDetailInfo();
 }
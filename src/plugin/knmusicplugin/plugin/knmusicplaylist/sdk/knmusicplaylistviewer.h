@@ -54,6 +54,7 @@ private slots:
     void retranslate();
     void onActionModelRowCountChanged();
     void onActionSearch();
+    void onActionSearchComplete();
     void onActionPlayCurrent();
     void onActionShuffle();
     void onActionAddToPlaylist();
@@ -18,6 +18,7 @@
 #include <QCoreApplication>
 #include <QInputMethodEvent>
 #include <QTextLayout>
+#include <QTimer>
 
 #include "knsearchbox.h"
 #include "knlocalemanager.h"
@@ -29,13 +30,22 @@
 
 #include <QDebug>
 
+#define SearchDelay 120
+
 KNMusicSearch::KNMusicSearch(QObject *parent) :
     KNMusicSearchBase(parent),
     m_searchBox(new KNSearchBox()),
+    m_searchTimer(new QTimer(this)),
     m_engine(new KNMusicSearchSyntaxEngine(this))
 {
     //Configure the search box.
     m_searchBox->setMinimumWidth(220);
+    //Configure the search timer. The search will be done after the user stop
+    //typing for a while, a new key press will cancel the pending search.
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(SearchDelay);
+    connect(m_searchTimer, &QTimer::timeout,
+            this, &KNMusicSearch::requireSearch);
 
     //Link the search box to the search actions.
     connect(m_searchBox, &KNSearchBox::textChanged,
@@ -72,6 +82,8 @@ QString KNMusicSearch::rawText() const
 
 void KNMusicSearch::clear()
 {
+    //Cancel the pending search.
+    m_searchTimer->stop();
     //Clear up the search block list.
     m_searchBlockList.clear();
     //Block the signal of the search box.
@@ -86,6 +98,8 @@ void KNMusicSearch::clear()
 
 void KNMusicSearch::search(const QList<KNMusicSearchBlock> &blocks)
 {
+    //Cancel the pending search.
+    m_searchTimer->stop();
     //Save the new blocks.
     m_searchBlockList=blocks;
     //Block the signal of the search box.
@@ -116,6 +130,7 @@ void KNMusicSearch::onActionSearch(const QString &text)
 {
     //Use the engin to parse the search box text, save the result to the list.
     m_searchBlockList=m_engine->parseSearch(text);
-    //Ask to search the data.
-    emit requireSearch();
+    //Restart the search timer, it will ask to search the data when the user
+    //stop typing.
+    m_searchTimer->start();
 }
@@ -21,6 +21,7 @@
 
 #include "knmusicsearchbase.h"
 
+class QTimer;
 class KNSearchBox;
 class KNMusicSearchSyntaxEngine;
 /*!
@@ -78,6 +79,7 @@ private slots:
 
 private:
     KNSearchBox *m_searchBox;
+    QTimer *m_searchTimer;
     KNMusicSearchSyntaxEngine *m_engine;
 
     QList<KNMusicSearchBlock> m_searchBlockList;
@@ -15,14 +15,18 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
-#include <QStringList>
+#include <QDate>
 
 #include "knlocalemanager.h"
 
 #include "knmusicglobal.h"
 
+#include "knmusicsearchplan.h"
+
 #include "knmusicsearchsyntaxengine.h"
 
+#define RangeSplitter ".."
+
 KNMusicSearchSyntaxEngine::KNMusicSearchSyntaxEngine(QObject *parent) :
     QObject(parent)
 {
@@ -43,55 +47,26 @@ QList<KNMusicSearchBlock> KNMusicSearchSyntaxEngine::parseSearch(
     }
 
     //Split the text with the split word to get all the possible blocks.
-    QStringList blockDataList=text.split(m_splitter, QString::SkipEmptyParts);
+    QStringList blockDataList=splitText(text, m_splitter);
+    //Prepare the group number of the OR blocks.
+    int group=0;
     //Check all the blocks.
     for(auto i=blockDataList.begin(); i!=blockDataList.end(); ++i)
     {
-        //Generate a search block.
-        KNMusicSearchBlock block;
-        //Find the '|' character(splitter) in the text.
-        int splitterPosition=(*i).indexOf('|');
-        //If we cannot find the splitter, then means this is not a block.
-        if(splitterPosition==-1)
+        //Split the block with the OR word.
+        QStringList termList=splitText(*i, m_orSplitter);
+        //When there's more than one term, they are in the same group.
+        int termGroup=(termList.size()>1)?group++:-1;
+        //Parse all the terms.
+        for(auto j : termList)
         {
-            //Add the code as a normal block.
-            block.index=-1;
-            block.value=(*i).simplified();
-            //Add the block to block list.
+            //Parse the block.
+            KNMusicSearchBlock block=parseBlock(j);
+            //Set the group.
+            block.group=termGroup;
+            //Add this block to the block list.
             blockList.append(block);
-            //Continue to next block.
-            continue;
-        }
-        //If there's a splitter, get the column or the property(we are calling
-        //it target) first, tried to find it in the hash list.
-        QString target=(*i).left(splitterPosition).simplified().toLower();
-        int targetIndex=m_columnMap.value(target, -1);
-        bool columnFind=(targetIndex!=-1);
-        //Check the result, if we cannot find it in the column map, then tried
-        //to find it in the property map.
-        if(!columnFind)
-        {
-            //Search the target in the property map.
-            targetIndex=m_propertyMap.value(target, -1);
-            //Check the result again.
-            if(targetIndex==-1)
-            {
-                //Add the code as a normal block.
-                block.index=-1;
-                block.value=(*i).simplified();
-                //Add the block to block list.
-                blockList.append(block);
-                //Continue to next block.
-                continue;
-            }
         }
-        //Set the index, isColumn data.
-        block.index=targetIndex;
-        block.isColumn=columnFind;
-        //Now parse the search value data.
-        block.value=textToVariant(targetIndex, (*i).mid(splitterPosition+1));
-        //Add this block to the block list.
-        blockList.append(block);
     }
     //Give back the block list.
     return blockList;
@@ -100,36 +75,35 @@ QList<KNMusicSearchBlock> KNMusicSearchSyntaxEngine::parseSearch(
 QString KNMusicSearchSyntaxEngine::generateSearchText(
         const QList<KNMusicSearchBlock> &blocks)
 {
-    //Generate a text cache.
-    QString searchText;
+    //Generate a text list cache.
+    QStringList blockTextList;
+    //Prepare the position of the group in the text list.
+    QHash<int, int> groupPosition;
     //Check all the blocks.
     for(auto i=blocks.constBegin();
         i!=blocks.constEnd();
         ++i)
     {
-        //Check the block type.
-        if((*i).isColumn)
+        //Translate the block.
+        QString &&blockText=blockToText(*i);
+        //Check whether the group has been added.
+        if((*i).group!=-1 && groupPosition.contains((*i).group))
         {
-            //Add captions.
-            searchText.append(knMusicGlobal->treeViewHeaderText((*i).index));
-        }
-        else
-        {
-            //Add captions from the property map.
-            searchText.append(m_propertyMap.key((*i).index));
+            //Append the block to its group with the OR word.
+            blockTextList[groupPosition.value((*i).group)].append(
+                        tr(" OR ")+blockText);
+            continue;
         }
-        //Add key-value spliter.
-        searchText.append("|");
-        //Translate the value.
-        searchText.append((*i).value.toString());
-        //Add spliter if it isn't the last block.
-        if((i+1)!=blocks.end())
+        //Save the position of the group.
+        if((*i).group!=-1)
         {
-            searchText.append(", ");
+            groupPosition.insert((*i).group, blockTextList.size());
         }
+        //Add the block text.
+        blockTextList.append(blockText);
     }
-    //Give back the search text.
-    return searchText;
+    //Join the blocks with the spliter.
+    return blockTextList.join(tr(", "));
 }
 
 void KNMusicSearchSyntaxEngine::retranslate()
@@ -147,22 +121,397 @@ void KNMusicSearchSyntaxEngine::retranslate()
     m_propertyMap.insert(tr("File Name").toLower(), FileNameRole);
     //Update the splitter.
     m_splitter.setPattern(tr(", "));
+    m_orSplitter.setPattern(tr(" OR "));
+}
+
+inline KNMusicSearchBlock KNMusicSearchSyntaxEngine::parseBlock(QString text)
+{
+    //Remove the spaces around the block.
+    text=text.trimmed();
+    //Check whether the block is reversed.
+    bool isNegative=false;
+    if(text.size()>1 && text.at(0)=='-')
+    {
+        //Remove the reverse mark.
+        isNegative=true;
+        text=text.mid(1).trimmed();
+    }
+    //Generate a search block.
+    KNMusicSearchBlock block;
+    //Find the comparison in the text.
+    int comparison, comparisonLength,
+            comparisonPosition=findComparison(text,
+                                              comparison,
+                                              comparisonLength);
+    //If we cannot find the comparison, then means this is not a block.
+    if(comparisonPosition==-1)
+    {
+        //Add the code as a normal block.
+        block=textBlock(text);
+        block.isNegative=isNegative;
+        return block;
+    }
+    //If there's a comparison, get the column or the property(we are calling it
+    //target) first, tried to find it in the hash list.
+    QString target=text.left(comparisonPosition).simplified().toLower();
+    int targetIndex=m_columnMap.value(target, -1);
+    bool columnFind=(targetIndex!=-1);
+    //Check the result, if we cannot find it in the column map, then tried to
+    //find it in the property map.
+    if(!columnFind)
+    {
+        //Search the target in the property map.
+        targetIndex=m_propertyMap.value(target, -1);
+    }
+    //Get the value text.
+    QString valueText=
+            text.mid(comparisonPosition+comparisonLength).trimmed();
+    //Check whether the value could be compared as a number.
+    bool numeric=columnFind && KNMusicSearchPlan::isNumericColumn(targetIndex)
+            && !isQuoted(valueText);
+    //Check the result again, the text cannot be compared by order.
+    if(targetIndex==-1 ||
+            (!numeric && comparison!=SearchContains &&
+             comparison!=SearchEqual))
+    {
+        //Add the code as a normal block.
+        block=textBlock(text);
+        block.isNegative=isNegative;
+        return block;
+    }
+    //Set the index, isColumn data.
+    block.index=targetIndex;
+    block.isColumn=columnFind;
+    block.isNegative=isNegative;
+    //Check the numeric value.
+    if(numeric)
+    {
+        //Check the range.
+        int rangePosition=valueText.indexOf(RangeSplitter);
+        if(rangePosition!=-1 &&
+                (comparison==SearchContains || comparison==SearchEqual))
+        {
+            //Parse the minimum and the maximum.
+            QVariant &&minimum=textToVariant(targetIndex,
+                                             valueText.left(rangePosition));
+            QVariant &&maximum=textToVariant(
+                        targetIndex,
+                        valueText.mid(rangePosition+
+                                      QString(RangeSplitter).size()));
+            //Check the result, a range could miss one side.
+            if(minimum.isValid() && maximum.isValid())
+            {
+                block.comparison=SearchRange;
+                block.value=minimum;
+                block.maximum=maximum;
+                return block;
+            }
+            if(minimum.isValid() || maximum.isValid())
+            {
+                block.comparison=minimum.isValid()?
+                            SearchGreaterEqual:SearchLessEqual;
+                block.value=minimum.isValid()?minimum:maximum;
+                return block;
+            }
+        }
+        //Parse the value.
+        QVariant &&value=textToVariant(targetIndex, valueText);
+        //Check the result, the equal comparison is a range of one value.
+        if(value.isValid() && comparison!=SearchContains)
+        {
+            block.comparison=(comparison==SearchEqual)?
+                        SearchRange:comparison;
+            block.value=value;
+            block.maximum=value;
+            return block;
+        }
+        //The value which is not a number cannot be compared by order.
+        if(comparison!=SearchContains)
+        {
+            block=textBlock(text);
+            block.isNegative=isNegative;
+            return block;
+        }
+    }
+    //Now parse the search text.
+    block.comparison=comparison;
+    block.value=isQuoted(valueText)?
+                valueText.mid(1, valueText.size()-2):
+                valueText.simplified();
+    //Ignore the empty data.
+    if(block.value.toString().isEmpty())
+    {
+        block.value=QVariant();
+    }
+    return block;
+}
+
+inline KNMusicSearchBlock KNMusicSearchSyntaxEngine::textBlock(
+        const QString &text)
+{
+    //Generate a search block.
+    KNMusicSearchBlock block;
+    //Add the code as a normal block, the text in quotes is used as it is.
+    block.index=-1;
+    block.value=isQuoted(text)?text.mid(1, text.size()-2):text.simplified();
+    return block;
+}
+
+inline QString KNMusicSearchSyntaxEngine::blockToText(
+        const KNMusicSearchBlock &block)
+{
+    //Generate the text cache, add the reverse mark.
+    QString blockText=block.isNegative?"-":"";
+    //Check the normal block.
+    if(block.index==-1)
+    {
+        return blockText+quoteText(block.value.toString());
+    }
+    //Check the block type.
+    if(block.isColumn)
+    {
+        //Add captions.
+        blockText.append(knMusicGlobal->treeViewHeaderText(block.index));
+    }
+    else
+    {
+        //Add captions from the property map.
+        blockText.append(m_propertyMap.key(block.index));
+    }
+    //Add the comparison and translate the value.
+    switch(block.comparison)
+    {
+    case SearchEqual:
+        return blockText+"="+quoteText(block.value.toString());
+    case SearchLess:
+        return blockText+"<"+variantToText(block.index, block.value);
+    case SearchLessEqual:
+        return blockText+"<="+variantToText(block.index, block.value);
+    case SearchGreater:
+        return blockText+">"+variantToText(block.index, block.value);
+    case SearchGreaterEqual:
+        return blockText+">="+variantToText(block.index, block.value);
+    case SearchRange:
+        //The range of one value is an equal comparison.
+        return (block.value==block.maximum)?
+                    blockText+"="+variantToText(block.index, block.value):
+                    blockText+"|"+variantToText(block.index, block.value)+
+                    RangeSplitter+
+                    variantToText(block.index, block.maximum);
+    default:
+        //Add key-value spliter.
+        return blockText+"|"+quoteText(block.value.toString());
+    }
+}
+
+inline QStringList KNMusicSearchSyntaxEngine::splitText(
+        const QString &text,
+        const QRegularExpression &splitter)
+{
+    //Generate the text list.
+    QStringList textList;
+    //Find all the splitters.
+    int partStart=0;
+    QRegularExpressionMatchIterator matches=splitter.globalMatch(text);
+    while(matches.hasNext())
+    {
+        //Get the splitter.
+        QRegularExpressionMatch match=matches.next();
+        //When there are odd quotes before the splitter, the splitter is in the
+        //quotes, ignore it.
+        if(text.left(match.capturedStart()).count('"') % 2==1)
+        {
+            continue;
+        }
+        //Add the part before the splitter.
+        textList.append(text.mid(partStart,
+                                 match.capturedStart()-partStart));
+        //Move to the next part.
+        partStart=match.capturedEnd();
+    }
+    //Add the last part.
+    textList.append(text.mid(partStart));
+    //Remove the empty parts.
+    textList.removeAll(QString());
+    return textList;
+}
+
+inline int KNMusicSearchSyntaxEngine::findComparison(const QString &text,
+                                                     int &comparison,
+                                                     int &length)
+{
+    //Check all the characters outside the quotes.
+    bool inQuote=false;
+    for(int i=0; i<text.size(); ++i)
+    {
+        //Get the character.
+        QChar character=text.at(i);
+        //Check the quote.
+        if(character=='"')
+        {
+            inQuote=!inQuote;
+            continue;
+        }
+        if(inQuote)
+        {
+            continue;
+        }
+        //Check whether the next character is an equal mark.
+        bool withEqual=(i+1<text.size() && text.at(i+1)=='=');
+        //Check the comparison.
+        switch(character.unicode())
+        {
+        case '|':
+            comparison=SearchContains;
+            length=1;
+            return i;
+        case '=':
+            comparison=SearchEqual;
+            length=1;
+            return i;
+        case '<':
+            comparison=withEqual?SearchLessEqual:SearchLess;
+            length=withEqual?2:1;
+            return i;
+        case '>':
+            comparison=withEqual?SearchGreaterEqual:SearchGreater;
+            length=withEqual?2:1;
+            return i;
+        default:
+            break;
+        }
+    }
+    //Cannot find any comparison.
+    return -1;
+}
+
+inline bool KNMusicSearchSyntaxEngine::isQuoted(const QString &text)
+{
+    return text.size()>1 && text.startsWith('"') && text.endsWith('"');
+}
+
+inline QString KNMusicSearchSyntaxEngine::quoteText(const QString &text)
+{
+    //Check whether the text could be parsed as a syntax block.
+    if(text.contains(m_splitter) || text.contains(m_orSplitter) ||
+            text.contains(QRegularExpression("[|=<>]")) ||
+            text.startsWith('-'))
+    {
+        //Add the quotes around the text.
+        return "\""+text+"\"";
+    }
+    return text;
 }
 
 QVariant KNMusicSearchSyntaxEngine::textToVariant(const int &column,
                                                   QString text)
 {
+    //Remove the spaces around the text.
+    text=text.simplified();
     //Ignore the empty data.
     if(text.isEmpty())
     {
         return QVariant();
     }
     //Process the column.
+    bool ok;
     switch(column)
     {
+    case Time:
+    {
+        //The time is written as h:mm:ss, m:ss or seconds.
+        qint64 seconds=0;
+        for(auto i : text.split(':'))
+        {
+            //Translate the part.
+            qint64 part=i.toLongLong(&ok);
+            if(!ok)
+            {
+                return QVariant();
+            }
+            seconds=seconds*60+part;
+        }
+        //The duration is in milliseconds.
+        return QVariant(seconds*1000);
+    }
+    case Size:
+    {
+        //The size is written as a number with a storage unit.
+        QRegularExpressionMatch &&match=
+                QRegularExpression("^(\\d+(?:\\.\\d+)?)\\s*([KMGT]?)B?$",
+                                   QRegularExpression::CaseInsensitiveOption)
+                .match(text);
+        if(!match.hasMatch())
+        {
+            return QVariant();
+        }
+        //Calculate the bytes, each unit is 1024 times of the previous one.
+        qreal size=match.captured(1).toDouble();
+        QString &&unit=match.captured(2).toUpper();
+        int unitPointer=unit.isEmpty()?0:QString("KMGT").indexOf(unit)+1;
+        while(unitPointer-- > 0)
+        {
+            size*=1024.0;
+        }
+        return QVariant((qint64)size);
+    }
+    case SampleRate:
+    {
+        //The sample rate could be written in kHz, the small number must be in
+        //kHz as well.
+        bool kiloHertz=text.endsWith("khz", Qt::CaseInsensitive);
+        qreal sampleRate=text.remove(QRegularExpression(
+                                         "\\s*k?hz$",
+                                         QRegularExpression::
+                                         CaseInsensitiveOption)).toDouble(&ok);
+        if(!ok)
+        {
+            return QVariant();
+        }
+        return QVariant((qint64)((kiloHertz || sampleRate<1000.0)?
+                                     sampleRate*1000:sampleRate));
+    }
+    case DateAdded:
+    case DateModified:
+    case LastPlayed:
+    {
+        //The date is written as yyyy-MM-dd.
+        QDate &&date=QDate::fromString(text, Qt::ISODate);
+        return date.isValid()?QVariant(date.toJulianDay()):QVariant();
+    }
+    case BitRate:
+    {
+        //The bit rate is in Kbps.
+        qint64 bitRate=text.remove(QRegularExpression(
+                                       "\\s*kbps$",
+                                       QRegularExpression::
+                                       CaseInsensitiveOption)).toLongLong(&ok);
+        return ok?QVariant(bitRate):QVariant();
+    }
     default:
-        //Simply treat it as variant.
-        return QVariant(text.simplified());
+    {
+        //Simply translate the integer.
+        qint64 value=text.toLongLong(&ok);
+        return ok?QVariant(value):QVariant();
+    }
     }
 }
 
+QString KNMusicSearchSyntaxEngine::variantToText(const int &column,
+                                                 const QVariant &value)
+{
+    //Process the column.
+    switch(column)
+    {
+    case Time:
+        //Translate the duration, the minutes could be more than 60.
+        return KNMusicUtil::msecondToString(value.toLongLong());
+    case DateAdded:
+    case DateModified:
+    case LastPlayed:
+        //Translate the Julian day.
+        return QDate::fromJulianDay(value.toLongLong()).toString(Qt::ISODate);
+    default:
+        return value.toString();
+    }
+}
@@ -21,6 +21,7 @@
 
 #include <QHash>
 #include <QRegularExpression>
+#include <QStringList>
 
 #include "knmusicutil.h"
 
@@ -38,7 +39,13 @@ using namespace MusicUtil;
  * match the column or property. And then get the key word.\n
  * To match the column, first find the char '|', if we cannot find '|', then
  * this cannot be a syntax block. And tried to find the previous part in a hash
- * list.
+ * list.\n
+ * Besides '|', a column could be compared with '=', '<', '<=', '>' and '>='.
+ * The numeric columns could use a range like 'Year|1990..1999', the time could
+ * be written as 'Time<3:00' and the dates are written as yyyy-MM-dd.\n
+ * A syntax block starts with '-' will be reversed, the syntax blocks split by
+ * the Or Text(e.g. in English it will be ' OR ') matches when any of them
+ * matches, and the text in the quotes is used as it is.
  */
 class KNMusicSearchSyntaxEngine : public QObject
 {
@@ -72,9 +79,20 @@ private slots:
     void retranslate();
 
 private:
+    inline KNMusicSearchBlock parseBlock(QString text);
+    inline KNMusicSearchBlock textBlock(const QString &text);
+    inline QString blockToText(const KNMusicSearchBlock &block);
+    inline QStringList splitText(const QString &text,
+                                 const QRegularExpression &splitter);
+    inline int findComparison(const QString &text,
+                              int &comparison,
+                              int &length);
+    inline bool isQuoted(const QString &text);
+    inline QString quoteText(const QString &text);
     QVariant textToVariant(const int &column, QString text);
+    QString variantToText(const int &column, const QVariant &value);
     QHash<QString, int> m_columnMap, m_propertyMap;
-    QRegularExpression m_splitter;
+    QRegularExpression m_splitter, m_orSplitter;
 };
 
 #endif // KNMUSICSEARCHSYNTAXENGINE_H
@@ -153,9 +153,13 @@ bool KNMusicTagApev2::parseTag(QFile &musicFile,
     {
         //Get the frame index from the hash list.
         int frameIndex=m_keyIndex.value((*i).key, -1);
-        //If we cannot map the key to the index, then ignore the current frame.
+        //If we cannot map the key to the index, then try to parse it as a
+        //loudness tag.
         if(frameIndex==-1)
         {
+            KNMusicUtil::parseReplayGain((*i).key,
+                                         QString((*i).value),
+                                         detailInfo.replayGain);
             continue;
         }
         switch(frameIndex)
@@ -54,7 +54,6 @@ bool KNMusicTagFlac::parseTag(QFile &musicFile,
                               QDataStream &musicDataStream,
                               KNMusicAnalysisItem &analysisItem)
 {
-    Q_UNUSED(musicFile)
     //Generate the header cache.
     char blockHeader[5];
     //Check the header of the music file.
@@ -106,6 +105,18 @@ bool KNMusicTagFlac::parseTag(QFile &musicFile,
             //Go to the next block.
             continue;
         }
+        //When the album art is deferred, only record the position of the
+        //picture block.
+        if(blockType==6 && analysisItem.deferAlbumArt)
+        {
+            //Save the position and size of the block.
+            analysisItem.imageLocations["FLAC"].append(
+                        KNMusicArtworkLocation(musicFile.pos(), blockSize));
+            //Skip the data.
+            musicDataStream.skipRawData(blockSize);
+            //Go to the next block.
+            continue;
+        }
         //Read the raw metadata block data.
         rawTagData=new char[blockSize];
         musicDataStream.readRawData(rawTagData, blockSize);
@@ -133,7 +144,12 @@ bool KNMusicTagFlac::parseTag(QFile &musicFile,
                     //Set the text data.
                     setTextData(detailInfo.textLists[fieldNameIndex],
                                 (*i).data);
+                    continue;
                 }
+                //Try to parse the field as a loudness tag.
+                KNMusicUtil::parseReplayGain((*i).fieldName,
+                                             (*i).data,
+                                             detailInfo.replayGain);
             }
         }
         else //Block type should be 6, image.
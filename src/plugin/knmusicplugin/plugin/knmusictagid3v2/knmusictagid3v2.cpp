@@ -183,8 +183,9 @@ bool KNMusicTagId3v2::parseTag(QFile &musicFile,
     if(parseID3v2RawData(rawTagData, header, functionSet, frames) &&
             !frames.isEmpty())
     {
-        //Write the tag to analysis info.
-        writeFrameToDetails(frames, functionSet, analysisItem);
+        //Write the tag to analysis info, the raw tag data is right after the
+        //header.
+        writeFrameToDetails(frames, functionSet, analysisItem, rawTagData, 10);
     }
     //Recover the memeory.
     delete[] rawTagData;
@@ -675,17 +676,53 @@ bool KNMusicTagId3v2::parseID3v2RawData(char *rawTagData,
 
 void KNMusicTagId3v2::writeFrameToDetails(const QLinkedList<ID3v2Frame> &frames,
                                           const ID3v2FunctionSet &property,
-                                          KNMusicAnalysisItem &analysisItem)
+                                          KNMusicAnalysisItem &analysisItem,
+                                          const char *rawTagData,
+                                          qint64 rawTagOffset)
 {
     //Get the detail info of the analysis item.
     KNMusicDetailInfo &detailInfo=analysisItem.detailInfo;
     //Prepare the image type list.
     QByteArray imageTypeList;
+    //Check whether we could only record the position of the album art.
+    bool deferImage=analysisItem.deferAlbumArt && rawTagData!=nullptr &&
+            rawTagOffset>-1;
+    //The images and the image type list must be in the same order, if any of
+    //the image frame need to be processed, copy all the image data.
+    for(QLinkedList<ID3v2Frame>::const_iterator i=frames.constBegin();
+        deferImage && i!=frames.constEnd();
+        ++i)
+    {
+        //Get the frame ID.
+        QString frameID=QString((*i).frameID).toUpper();
+        //Check the image frame flags.
+        if((frameID=="APIC" || frameID=="PIC") &&
+                ((*i).flags[1] & (FrameDataLengthIndicator |
+                                  FrameUnsynchronisation)))
+        {
+            //Copy the image data.
+            deferImage=false;
+        }
+    }
     //Try to parse all the raw frame data in the analysis list.
     for(QLinkedList<ID3v2Frame>::const_iterator i=frames.constBegin();
         i!=frames.constEnd();
         ++i)
     {
+        //For the deferred album art, save the position of the frame instead of
+        //copying the frame data.
+        QString imageFrameID=QString((*i).frameID).toUpper();
+        if(deferImage && (imageFrameID=="APIC" || imageFrameID=="PIC"))
+        {
+            //Add the image type to the list.
+            imageTypeList.append((int)(imageFrameID=="APIC"));
+            //Save the image frame position.
+            analysisItem.imageLocations["ID3v2_Images"].append(
+                        KNMusicArtworkLocation(
+                            rawTagOffset+((*i).start-rawTagData),
+                            (*i).size));
+            continue;
+        }
         //Process the data according to the flag before we use it.
         //Check if it contains a data length indicator, if so, use the size
         //calculator to calculate the size of data.
@@ -716,6 +753,13 @@ void KNMusicTagId3v2::writeFrameToDetails(const QLinkedList<ID3v2Frame> &frames,
             analysisItem.imageData["ID3v2_Images"].append(frameData);
             continue;
         }
+        //For TXXX and TXX frame(The user defined text), the ReplayGain tags are
+        //saved in it.
+        if(frameID=="TXXX" || frameID=="TXX")
+        {
+            parseUserTextData(frameData, detailInfo.replayGain);
+            continue;
+        }
         //Get the frame index.
         int frameIndex=m_frameIDIndex.value((*i).frameID, -1);
         //If the frame index is invalid, continue to check the next frame.
@@ -1038,6 +1082,56 @@ void KNMusicTagId3v2::parsePICImageData(
     }
 }
 
+inline void KNMusicTagId3v2::parseUserTextData(const QByteArray &frameData,
+                                               KNMusicReplayGain &replayGain)
+{
+    //The user defined text frame is:
+    // |Encoding|Description|Terminator|Value|
+    //Check the size of the frame data.
+    if(frameData.size()<2)
+    {
+        return;
+    }
+    //Get the encoding, the terminator of UTF-16 is two bytes.
+    char encoding=frameData.at(0);
+    bool wideEncoding=(encoding==EncodeUTF16BELE || encoding==EncodeUTF16);
+    //Find the terminator of the description.
+    int terminatorPosition=-1;
+    if(wideEncoding)
+    {
+        //Find the aligned two zero bytes.
+        for(int i=1; i+1<frameData.size(); i+=2)
+        {
+            if(frameData.at(i)==0 && frameData.at(i+1)==0)
+            {
+                terminatorPosition=i;
+                break;
+            }
+        }
+    }
+    else
+    {
+        terminatorPosition=frameData.indexOf('\0', 1);
+    }
+    //If we cannot find the terminator, it's not a valid frame.
+    if(terminatorPosition==-1)
+    {
+        return;
+    }
+    //Decode the description and the value with the same encoding.
+    QByteArray encodingData(1, encoding);
+    QString description=contentToString(
+                encodingData+frameData.mid(1, terminatorPosition-1)),
+            value=contentToString(
+                encodingData+frameData.mid(terminatorPosition+
+                                           (wideEncoding?2:1)));
+    //Remove the byte order mark which is left by the UTF-16 codec.
+    description.remove(QChar(0xFEFF));
+    value.remove(QChar(0xFEFF));
+    //Parse the loudness tag.
+    KNMusicUtil::parseReplayGain(description, value, replayGain);
+}
+
 QByteArray KNMusicTagId3v2::frameToRawData(const QString frameID,
                                            const ID3v2FunctionSet &toolset,
                                            const ID3v2DataFrame &frame)
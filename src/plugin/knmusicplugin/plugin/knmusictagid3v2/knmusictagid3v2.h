@@ -284,10 +284,15 @@ protected:
      * \param frames The raw frame list.
      * \param property The ID3v2 function tool set.
      * \param analysisItem The target analysis item.
+     * \param rawTagData The raw tag data which the frames point to.
+     * \param rawTagOffset The position of the raw tag data in the music file.
+     * If it's -1, the album art data will always be copied to the item.
      */
     void writeFrameToDetails(const QLinkedList<ID3v2Frame> &frames,
                              const ID3v2FunctionSet &property,
-                             KNMusicAnalysisItem &analysisItem);
+                             KNMusicAnalysisItem &analysisItem,
+                             const char *rawTagData=nullptr,
+                             qint64 rawTagOffset=-1);
 
     /*!
      * \brief Because the ID3v2 has so many version and the standard has been
@@ -443,6 +448,9 @@ private:
                                    QHash<int, ID3v2PictureFrame> &imageMap);
     inline void parsePICImageData(QByteArray imageData,
                                   QHash<int, ID3v2PictureFrame> &imageMap);
+    //TXXX frame and TXX frame parser, only the loudness tags are used.
+    inline void parseUserTextData(const QByteArray &frameData,
+                                  KNMusicReplayGain &replayGain);
 
     //Translate a ID3v2DataFrame to raw bytes.
     inline QByteArray frameToRawData(const QString frameID,
@@ -161,6 +161,16 @@ bool KNMusicTagWma::parseTag(QFile &musicFile,
         //If it's album art frame, save the image data.
         if((*i).name=="WM/Picture")
         {
+            //Check whether the album art is deferred.
+            if(analysisItem.deferAlbumArt && (*i).start!=nullptr)
+            {
+                //The raw tag data starts after the header and the tag size,
+                //save the position of the image data in the file.
+                analysisItem.imageLocations["WMA"].append(
+                            KNMusicArtworkLocation(
+                                30+((*i).start-rawTagData), (*i).size));
+                continue;
+            }
             analysisItem.imageData["WMA"].append((*i).data);
             continue;
         }
@@ -172,7 +182,13 @@ bool KNMusicTagWma::parseTag(QFile &musicFile,
             //Set the data to detail info, use UTF-16LE to decode the data.
             setTextData(detailInfo.textLists[frameIndex],
                         m_utf16LECodec->toUnicode((*i).data));
+            continue;
         }
+        //Try to parse the attribute as a loudness tag.
+        KNMusicUtil::parseReplayGain(
+                    (*i).name,
+                    m_utf16LECodec->toUnicode((*i).data).remove(QChar('\0')),
+                    detailInfo.replayGain);
     }
     //Recover memory.
     delete[] rawTagData;
@@ -306,6 +322,9 @@ inline void KNMusicTagWma::parseExtendFrame(char *frameStart,
         quint16 valueLength=(((quint16)dataPointer[1]<<8) & 0xFF00)+
                             (((quint16)dataPointer[0])    & 0x00FF);
         currentFrame.data=QByteArray(dataPointer+2, valueLength);
+        //Save the position of the value in the raw data.
+        currentFrame.start=dataPointer+2;
+        currentFrame.size=valueLength;
         //Add the frame to list.
         frameList.append(currentFrame);
         //Move the pointer to next position.
@@ -85,6 +85,15 @@ private:
     {
         QString name;
         QByteArray data;
+        char *start;
+        quint16 size;
+        KNMusicWMAFrame() :
+            name(QString()),
+            data(QByteArray()),
+            start(nullptr),
+            size(0)
+        {
+        }
     };
     inline quint64 dataToInt64(const char *dataArray);
     inline void parseStandardFrame(char *frameStart,
@@ -46,6 +46,19 @@ public:
      * \return If analysis the file successfully, return true.
      */
     virtual bool analysis(KNMusicDetailInfo &detailInfo)=0;
+
+    /*!
+     * \brief Decode the whole file and measure its loudness, write the track
+     * gain and the track peak to the replay gain of the detail info. The
+     * analysiser which could decode the file should reimplement this function.
+     * \param detailInfo The detail info of the file.
+     * \return If the loudness is measured successfully, return true.
+     */
+    virtual bool scanLoudness(KNMusicDetailInfo &detailInfo)
+    {
+        Q_UNUSED(detailInfo)
+        return false;
+    }
 };
 
 #endif // KNMUSICANALYSISER_H
@@ -21,7 +21,8 @@
 
 KNMusicAnalysisQueue::KNMusicAnalysisQueue(QObject *parent) :
     QObject(parent),
-    m_isWorking(false)
+    m_isWorking(false),
+    m_deferAlbumArt(false)
 {
     //Connect analysis loop.
     connect(this, &KNMusicAnalysisQueue::analysisNext,
@@ -34,6 +35,17 @@ bool KNMusicAnalysisQueue::isWorking() const
     return m_isWorking;
 }
 
+bool KNMusicAnalysisQueue::deferAlbumArt() const
+{
+    return m_deferAlbumArt;
+}
+
+void KNMusicAnalysisQueue::setDeferAlbumArt(bool deferAlbumArt)
+{
+    //Save the deferred flag.
+    m_deferAlbumArt=deferAlbumArt;
+}
+
 void KNMusicAnalysisQueue::addFile(const QFileInfo &fileInfo)
 {
     //Check file path queue first.
@@ -67,6 +79,8 @@ void KNMusicAnalysisQueue::onActionAnalysisNext()
     {
         //Generate a simple analysis item.
         KNMusicAnalysisItem analysisItem;
+        //Set the album art deferred flag.
+        analysisItem.deferAlbumArt=m_deferAlbumArt;
         //Parse the file as a single music file.
         parser->parseFile(fileInfo, analysisItem);
         //Emit analysis complete signal.
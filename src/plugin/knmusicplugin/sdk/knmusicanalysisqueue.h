@@ -47,6 +47,21 @@ public:
      */
     bool isWorking() const;
 
+    /*!
+     * \brief Check whether the album art data is deferred.
+     * \return If the queue only records the album art position, return true.
+     */
+    bool deferAlbumArt() const;
+
+    /*!
+     * \brief Set whether the album art data should be deferred. When it's
+     * enabled, the tag parsers only record the position of the album art in
+     * the analysis item instead of copying the raw image data. The data will be
+     * read from the file when KNMusicParser::parseAlbumArt() is called.
+     * \param deferAlbumArt To enable the deferred mode, set it to true.
+     */
+    void setDeferAlbumArt(bool deferAlbumArt);
+
 signals:
     /*!
      * \brief When a file is parsed by the parser, this signal will be emitted.
@@ -73,7 +88,7 @@ private slots:
 
 private:
     QLinkedList<QFileInfo> m_filePathQueue;
-    bool m_isWorking;
+    bool m_isWorking, m_deferAlbumArt;
 };
 
 #endif // KNMUSICANALYSISQUEUE_H
@@ -19,6 +19,9 @@
 #ifndef KNMUSICBACKEND_H
 #define KNMUSICBACKEND_H
 
+#include "knmusicutil.h"
+
+#include <QVector>
 #include <QObject>
 
 /*!
@@ -74,6 +77,64 @@ public:
                            const qint64 &start=-1,
                            const qint64 &duration=-1)=0;
 
+    /*!
+     * \brief Set the music file which will be played right after the current
+     * file of the main thread reaches its end without any gap. When the next
+     * file starts, the nextMusicStarted() signal will be emitted instead of
+     * the finished() signal. Loading another file will clear the next file.\n
+     * A part of a file could be the next music of the part of the same file,
+     * like the tracks of a cue sheet.
+     * \param filePath The next music file path. Set an empty path to clear the
+     * next file.
+     * \param start The start position of the next music, -1 for the whole file.
+     * \param duration The duration of the next music, -1 to play to the end.
+     * \return If the backend doesn't support gapless playing, or the next music
+     * cannot follow the current one, it will be false. The next file should be
+     * loaded after the finished() signal then.
+     */
+    virtual bool setNextMusic(const QString &filePath,
+                              const qint64 &start=-1,
+                              const qint64 &duration=-1)=0;
+
+    /*!
+     * \brief Set the music file which will be crossfaded with the current file
+     * of the main thread. It starts fading in crossfadeDuration() msecond
+     * before the current file reaches its end, the nextMusicStarted() signal
+     * will be emitted when it starts. Loading another file or setting the next
+     * music will clear the crossfade music.
+     * \param filePath The crossfade music file path. Set an empty path to clear
+     * the crossfade music.
+     * \param start The start position of the music, -1 for the whole file.
+     * \param duration The duration of the music, -1 to play to the end.
+     * \return If the crossfade is disabled or the backend doesn't support it,
+     * it will be false.
+     */
+    virtual bool setCrossfadeMusic(const QString &filePath,
+                                   const qint64 &start=-1,
+                                   const qint64 &duration=-1)=0;
+
+    /*!
+     * \brief Get the duration of the crossfade.
+     * \return The crossfade duration in msecond. If the crossfade is disabled
+     * or the backend doesn't support it, return 0.
+     */
+    virtual int crossfadeDuration() const=0;
+
+    /*!
+     * \brief Prefetch a music which is likely to be played next. The backend
+     * opens the file and prepares the decoder in a spare thread a while later,
+     * when loadMusic() is called with the same music, the prepared thread will
+     * be used and the music starts at once.
+     * \param filePath The music file path. Set an empty path to clear the
+     * prefetched music.
+     * \param start The start position of the music, -1 for the whole file.
+     * \param duration The duration of the music, -1 to play to the end.
+     * \return If the backend doesn't support prefetching, it will be false.
+     */
+    virtual bool prefetchMusic(const QString &filePath,
+                               const qint64 &start=-1,
+                               const qint64 &duration=-1)=0;
+
     /*!
      * \brief Play the main thread.
      */
@@ -184,6 +245,19 @@ public:
      */
     virtual bool mute()=0;
 
+    /*!
+     * \brief Get the latest spectrum snapshot of the main thread for the
+     * visualisation. The snapshot is updated about 30 times per second by the
+     * playing thread, this function never blocks it. It should be polled from
+     * the GUI thread only.
+     * \param bands The band levels from the lowest frequency to the highest
+     * frequency, from 0.0 to 1.0.
+     * \return If there's a new snapshot since the last call, return true. If
+     * there's no new snapshot, or the backend cannot analyse the samples, it
+     * will be false and the bands are not touched.
+     */
+    virtual bool spectrum(QVector<float> &bands)=0;
+
 signals:
     /*!
      * \brief When the volume size changed, this signal will be emitted.
@@ -204,11 +278,14 @@ signals:
     void loadSuccess();
 
     /*!
-     * \brief When the position of the main thread is changed, this signal will
-     * be emitted.
-     * \param position The new position of the main thread music.
+     * \brief When the position of the main thread jumps or its playing rate is
+     * changed, this signal will be emitted. Link it to a KNMusicPositionClock
+     * to get the position while playing.
+     * \param position The position of the main thread music at the timestamp.
+     * \param rate The playing rate of the main thread.
+     * \param timestamp The timestamp of the anchor.
      */
-    void positionChanged(qint64 position);
+    void positionAnchorChanged(qint64 position, qreal rate, qint64 timestamp);
 
     /*!
      * \brief When the duration of the main thread is changed, this signal will
@@ -217,6 +294,13 @@ signals:
      */
     void durationChanged(qint64 duration);
 
+    /*!
+     * \brief When the main thread starts to play the next music file set by
+     * setNextMusic(), this signal will be emitted. The duration of the next
+     * file will be sent by durationChanged() signal.
+     */
+    void nextMusicStarted();
+
     /*!
      * \brief When the position reach the end of the file, this signal will be
      * emitted.
@@ -248,11 +332,17 @@ signals:
     void previewLoadSuccess();
 
     /*!
-     * \brief When the position of the preview thread is changed, this signal
-     * will be emitted.
-     * \param position The new position of the preview thread music.
+     * \brief When the position of the preview thread jumps or its playing rate
+     * is changed, this signal will be emitted. Link it to a
+     * KNMusicPositionClock to get the position while playing.
+     * \param position The position of the preview thread music at the
+     * timestamp.
+     * \param rate The playing rate of the preview thread.
+     * \param timestamp The timestamp of the anchor.
      */
-    void previewPositionChanged(qint64 position);
+    void previewPositionAnchorChanged(qint64 position,
+                                      qreal rate,
+                                      qint64 timestamp);
 
     /*!
      * \brief When the duration of the preview thread is changed, this signal
@@ -349,6 +439,40 @@ public slots:
      * \param position The new position of the preview thread.
      */
     virtual void setPreviewPosition(const qint64 &position)=0;
+
+    /*!
+     * \brief Set the parameters of the crossfade.
+     * \param duration The crossfade duration in msecond, 0 to disable the
+     * crossfade.
+     * \param curve The fading curve, it should be one of the
+     * KNMusicCrossfadeCurve.
+     */
+    virtual void setCrossfade(int duration, int curve)=0;
+
+    /*!
+     * \brief Set the replay gain of the music which is playing in the main
+     * thread. It should be called after the music is loaded or the next music
+     * is started, the volume won't be changed.
+     * \param gain The linear volume scale, calculated by
+     * KNMusicUtil::replayGainScale().
+     */
+    virtual void setMusicGain(qreal gain)=0;
+
+    /*!
+     * \brief Get whether the backend could process the samples with the DSP
+     * chain. The DSP preference is only provided when it's supported.
+     * \return If the backend supports the DSP chain, return true.
+     */
+    virtual bool isDspSupported()=0;
+
+    /*!
+     * \brief Set the parameters of the DSP chain (equalizer, preamp, balance
+     * and limiter) which processes the samples of all the threads. The backend
+     * which cannot process the samples should ignore it.
+     * \param parameters The DSP parameters.
+     */
+    virtual void setDspParameters(
+            const MusicUtil::KNMusicDspParameters &parameters)=0;
 };
 
 #endif // KNMUSICBACKEND_H
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QMutexLocker>
+
+#include "knmusicdspequalizer.h"
+#include "knmusicdspgain.h"
+#include "knmusicdsplimiter.h"
+
+#include "knmusicdspchain.h"
+
+#ifdef ENABLE_DSP_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace MusicUtil;
+
+KNMusicDspChain::KNMusicDspChain() :
+    m_processors(QList<KNMusicDspProcessor *>()),
+    m_parameters(KNMusicDspParameters()),
+    m_parametersChanged(0)
+{
+    //Add the default processors, the limiter has to be the last one.
+    addProcessor(new KNMusicDspEqualizer());
+    addProcessor(new KNMusicDspGain());
+    addProcessor(new KNMusicDspLimiter());
+}
+
+KNMusicDspChain::~KNMusicDspChain()
+{
+    //Recover the memory of the processors.
+    qDeleteAll(m_processors);
+}
+
+void KNMusicDspChain::addProcessor(KNMusicDspProcessor *processor)
+{
+    //Apply the current parameters to the processor.
+    QMutexLocker locker(&m_parametersLock);
+    processor->setParameters(m_parameters);
+    //Add the processor to the list.
+    m_processors.append(processor);
+}
+
+void KNMusicDspChain::prepare(int sampleRate, int channels)
+{
+    //Prepare all the processors.
+    for(auto i : m_processors)
+    {
+        i->prepare(sampleRate, channels);
+    }
+}
+
+void KNMusicDspChain::setParameters(const KNMusicDspParameters &parameters)
+{
+    //Save the parameters.
+    {
+        QMutexLocker locker(&m_parametersLock);
+        m_parameters=parameters;
+    }
+    //Mark the parameters changed, they will be applied in the processing
+    //thread.
+    m_parametersChanged.storeRelease(1);
+}
+
+void KNMusicDspChain::process(float *samples, int frames)
+{
+    //Check whether the parameters are changed.
+    if(m_parametersChanged.testAndSetAcquire(1, 0))
+    {
+        applyParameters();
+    }
+#ifdef ENABLE_DSP_SSE2
+    //The feedback of the filters could decay to denormal numbers in the
+    //silence, which are extremely slow. Flush them to zero.
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+    //Process the samples with the active processors.
+    for(auto i : m_processors)
+    {
+        if(i->isActive())
+        {
+            i->process(samples, frames);
+        }
+    }
+}
+
+inline void KNMusicDspChain::applyParameters()
+{
+    //Apply the parameters to all the processors.
+    QMutexLocker locker(&m_parametersLock);
+    for(auto i : m_processors)
+    {
+        i->setParameters(m_parameters);
+    }
+}
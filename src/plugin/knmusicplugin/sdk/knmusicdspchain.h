@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICDSPCHAIN_H
+#define KNMUSICDSPCHAIN_H
+
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+
+#include "knmusicdspprocessor.h"
+
+/*!
+ * \brief The KNMusicDspChain class runs the DSP processors one by one on the
+ * samples. By default, it has an equalizer, a gain for the preamp and the
+ * balance, and a limiter.\n
+ * The parameters could be set from any thread, they will be applied in the
+ * processing thread before processing the next samples. All the other
+ * functions should only be called in the processing thread, or when the
+ * processing thread is stopped.
+ */
+class KNMusicDspChain
+{
+public:
+    /*!
+     * \brief Construct a KNMusicDspChain with the default processors.
+     */
+    KNMusicDspChain();
+    ~KNMusicDspChain();
+
+    /*!
+     * \brief Append a processor to the end of the chain. The chain will take
+     * the ownership of the processor.
+     * \param processor The processor.
+     */
+    void addProcessor(KNMusicDspProcessor *processor);
+
+    /*!
+     * \brief Prepare all the processors for a sample format.
+     * \param sampleRate The sample rate of the samples.
+     * \param channels The channel count of the samples.
+     */
+    void prepare(int sampleRate, int channels);
+
+    /*!
+     * \brief Set the DSP parameters. It could be called from any thread.
+     * \param parameters The DSP parameters.
+     */
+    void setParameters(const MusicUtil::KNMusicDspParameters &parameters);
+
+    /*!
+     * \brief Process the interleaved float samples in place with all the
+     * active processors.
+     * \param samples The samples.
+     * \param frames The frame count of the samples.
+     */
+    void process(float *samples, int frames);
+
+private:
+    inline void applyParameters();
+    QList<KNMusicDspProcessor *> m_processors;
+    MusicUtil::KNMusicDspParameters m_parameters;
+    QMutex m_parametersLock;
+    QAtomicInt m_parametersChanged;
+};
+
+#endif // KNMUSICDSPCHAIN_H
@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QtMath>
+
+#include "knmusicdspequalizer.h"
+
+#define CoefficientCount 5
+#define VectorLanes 4
+#define BandQuality 1.414213562373095
+#define MinimumBandGain 0.01
+#define MaximumBandFrequency 0.45
+
+using namespace MusicUtil;
+
+//The ISO centre frequencies of the octave bands.
+static const qreal BandFrequencies[EqualizerBandCount]=
+{
+    31.25, 62.5, 125.0, 250.0, 500.0,
+    1000.0, 2000.0, 4000.0, 8000.0, 16000.0
+};
+
+KNMusicDspEqualizer::KNMusicDspEqualizer() :
+    m_coefficients(QVector<float>()),
+    m_states(QVector<float>()),
+    m_filterCount(0),
+    m_bandFilterCount(0),
+    m_stateStride(VectorLanes),
+    m_sampleRate(0),
+    m_channels(0),
+    m_enabled(false)
+{
+    //Reset all the band gains.
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        m_bandGains[i]=0.0;
+    }
+}
+
+void KNMusicDspEqualizer::prepare(int sampleRate, int channels)
+{
+    //Save the sample format.
+    m_sampleRate=sampleRate;
+    m_channels=channels;
+    //The states are aligned to the lanes of the SSE register.
+    m_stateStride=qMax(channels, VectorLanes);
+    //Rebuild the filters, the states are reset for the new format.
+    m_states.clear();
+    updateFilters();
+}
+
+void KNMusicDspEqualizer::setParameters(const KNMusicDspParameters &parameters)
+{
+    //Save the parameters.
+    m_enabled=parameters.equalizerEnabled;
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        m_bandGains[i]=parameters.bandGains[i];
+    }
+    //Rebuild the filters.
+    updateFilters();
+}
+
+bool KNMusicDspEqualizer::isActive() const
+{
+    //When all the bands are flat, there's no filter at all.
+    return m_enabled && m_filterCount>0;
+}
+
+void KNMusicDspEqualizer::process(float *samples, int frames)
+{
+#ifdef ENABLE_DSP_SSE2
+    //The channels of a frame could be loaded to a SSE register directly when
+    //there are 1, 2 or 4 channels.
+    if(m_channels==1 || m_channels==2 || m_channels==4)
+    {
+        processVector(samples, frames);
+        return;
+    }
+#endif
+    //Use the scalar filters for the other layouts.
+    processScalar(samples, frames);
+}
+
+inline void KNMusicDspEqualizer::updateFilters()
+{
+    //Clear the previous filters.
+    m_coefficients.clear();
+    m_filterCount=0;
+    //Check the sample format.
+    if(!m_enabled || m_sampleRate<1 || m_channels<1)
+    {
+        return;
+    }
+    //Generate a peaking filter for each band which is not flat. The formula
+    //comes from the Audio EQ Cookbook by Robert Bristow-Johnson.
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        //The flat bands and the bands near the Nyquist frequency are skipped.
+        if(qAbs(m_bandGains[i])<MinimumBandGain ||
+                BandFrequencies[i]>MaximumBandFrequency*(qreal)m_sampleRate)
+        {
+            continue;
+        }
+        qreal amplitude=qPow(10.0, m_bandGains[i]/40.0),
+              omega=2.0*M_PI*BandFrequencies[i]/(qreal)m_sampleRate,
+              alpha=qSin(omega)/(2.0*BandQuality),
+              a0=1.0+alpha/amplitude,
+              coefficients[CoefficientCount]=
+        {
+            (1.0+alpha*amplitude)/a0,
+            -2.0*qCos(omega)/a0,
+            (1.0-alpha*amplitude)/a0,
+            -2.0*qCos(omega)/a0,
+            (1.0-alpha/amplitude)/a0
+        };
+        //Repeat the coefficients for all the lanes.
+        for(int j=0; j<CoefficientCount; ++j)
+        {
+            for(int k=0; k<VectorLanes; ++k)
+            {
+                m_coefficients.append((float)coefficients[j]);
+            }
+        }
+        ++m_filterCount;
+    }
+    //Keep the states when the band filter count is not changed, so changing the
+    //gain of a band while playing won't cause a click.
+    bool resetStates=(m_filterCount!=m_bandFilterCount);
+    m_bandFilterCount=m_filterCount;
+    //The filters are processed in pairs, an odd filter is paired with a
+    //pass-through filter.
+    if(m_filterCount & 1)
+    {
+        const float passThrough[CoefficientCount]={1.0f, 0.0f, 0.0f, 0.0f,
+                                                   0.0f};
+        for(int j=0; j<CoefficientCount; ++j)
+        {
+            for(int k=0; k<VectorLanes; ++k)
+            {
+                m_coefficients.append(passThrough[j]);
+            }
+        }
+        ++m_filterCount;
+    }
+    //Reset the states for the new filters.
+    int stateSize=m_filterCount*2*m_stateStride;
+    if(resetStates || m_states.size()!=stateSize)
+    {
+        m_states.fill(0.0f, stateSize);
+    }
+}
+
+inline void KNMusicDspEqualizer::processScalar(float *samples, int frames)
+{
+    //The filters are in the transposed direct form II. A single filter on a
+    //single channel is a chain of dependent operations, so two filters are
+    //cascaded on two channels at a time to keep four chains in flight.
+    const float *coefficients=m_coefficients.constData();
+    float *states=m_states.data();
+    for(int i=0; i<m_filterCount; i+=2)
+    {
+        //Get the coefficients of the filter pair.
+        const float *first=coefficients+i*CoefficientCount*VectorLanes,
+                    *second=first+CoefficientCount*VectorLanes;
+        float fb0=first[0], fb1=first[VectorLanes],
+              fb2=first[VectorLanes*2], fa1=first[VectorLanes*3],
+              fa2=first[VectorLanes*4],
+              sb0=second[0], sb1=second[VectorLanes],
+              sb2=second[VectorLanes*2], sa1=second[VectorLanes*3],
+              sa2=second[VectorLanes*4];
+        //Get the states of the filter pair.
+        float *firstZ1=states+i*2*m_stateStride,
+              *firstZ2=firstZ1+m_stateStride,
+              *secondZ1=firstZ2+m_stateStride,
+              *secondZ2=secondZ1+m_stateStride;
+        //Filter two channels together, the odd channel is filtered alone.
+        int j=0;
+        for(; j+2<=m_channels; j+=2)
+        {
+            //Keep the states in the registers.
+            float lf1=firstZ1[j], lf2=firstZ2[j],
+                  ls1=secondZ1[j], ls2=secondZ2[j],
+                  rf1=firstZ1[j+1], rf2=firstZ2[j+1],
+                  rs1=secondZ1[j+1], rs2=secondZ2[j+1];
+            float *sample=samples+j;
+            for(int k=0; k<frames; ++k, sample+=m_channels)
+            {
+                float left=sample[0], right=sample[1],
+                      leftMiddle=fb0*left+lf1, rightMiddle=fb0*right+rf1;
+                lf1=fb1*left-fa1*leftMiddle+lf2;
+                rf1=fb1*right-fa1*rightMiddle+rf2;
+                lf2=fb2*left-fa2*leftMiddle;
+                rf2=fb2*right-fa2*rightMiddle;
+                left=sb0*leftMiddle+ls1;
+                right=sb0*rightMiddle+rs1;
+                ls1=sb1*leftMiddle-sa1*left+ls2;
+                rs1=sb1*rightMiddle-sa1*right+rs2;
+                ls2=sb2*leftMiddle-sa2*left;
+                rs2=sb2*rightMiddle-sa2*right;
+                sample[0]=left;
+                sample[1]=right;
+            }
+            //Save the states.
+            firstZ1[j]=lf1;
+            firstZ2[j]=lf2;
+            secondZ1[j]=ls1;
+            secondZ2[j]=ls2;
+            firstZ1[j+1]=rf1;
+            firstZ2[j+1]=rf2;
+            secondZ1[j+1]=rs1;
+            secondZ2[j+1]=rs2;
+        }
+        for(; j<m_channels; ++j)
+        {
+            //Keep the states in the registers.
+            float f1=firstZ1[j], f2=firstZ2[j], s1=secondZ1[j], s2=secondZ2[j];
+            float *sample=samples+j;
+            for(int k=0; k<frames; ++k, sample+=m_channels)
+            {
+                float input=*sample, middle=fb0*input+f1, output;
+                f1=fb1*input-fa1*middle+f2;
+                f2=fb2*input-fa2*middle;
+                output=sb0*middle+s1;
+                s1=sb1*middle-sa1*output+s2;
+                s2=sb2*middle-sa2*output;
+                *sample=output;
+            }
+            //Save the states.
+            firstZ1[j]=f1;
+            firstZ2[j]=f2;
+            secondZ1[j]=s1;
+            secondZ2[j]=s2;
+        }
+    }
+}
+
+#ifdef ENABLE_DSP_SSE2
+inline void KNMusicDspEqualizer::processVector(float *samples, int frames)
+{
+    //All the channels of a frame are in one register. A pair of filters runs
+    //through the whole buffer with the coefficients and the states kept in the
+    //registers, the two filters of the adjacent frames are independent, so
+    //they could be run in parallel by the processor.
+    const float *coefficients=m_coefficients.constData();
+    float *states=m_states.data();
+    for(int i=0; i<m_filterCount; i+=2)
+    {
+        //Load the coefficients of the filter pair.
+        const float *first=coefficients+i*CoefficientCount*VectorLanes,
+                    *second=first+CoefficientCount*VectorLanes;
+        __m128 fb0=_mm_loadu_ps(first), fb1=_mm_loadu_ps(first+4),
+               fb2=_mm_loadu_ps(first+8), fa1=_mm_loadu_ps(first+12),
+               fa2=_mm_loadu_ps(first+16),
+               sb0=_mm_loadu_ps(second), sb1=_mm_loadu_ps(second+4),
+               sb2=_mm_loadu_ps(second+8), sa1=_mm_loadu_ps(second+12),
+               sa2=_mm_loadu_ps(second+16);
+        //Load the states of the filter pair.
+        float *firstStates=states+i*2*m_stateStride,
+              *secondStates=firstStates+2*m_stateStride;
+        __m128 f1=_mm_loadu_ps(firstStates),
+               f2=_mm_loadu_ps(firstStates+m_stateStride),
+               s1=_mm_loadu_ps(secondStates),
+               s2=_mm_loadu_ps(secondStates+m_stateStride);
+        for(int k=0; k<frames; ++k)
+        {
+            //Load the frame.
+            float *frame=samples+k*m_channels;
+            __m128 input=loadFrame(frame),
+                   middle=_mm_add_ps(_mm_mul_ps(fb0, input), f1);
+            //Pass the first filter.
+            f1=_mm_add_ps(_mm_sub_ps(_mm_mul_ps(fb1, input),
+                                     _mm_mul_ps(fa1, middle)),
+                          f2);
+            f2=_mm_sub_ps(_mm_mul_ps(fb2, input), _mm_mul_ps(fa2, middle));
+            //Pass the second filter.
+            __m128 output=_mm_add_ps(_mm_mul_ps(sb0, middle), s1);
+            s1=_mm_add_ps(_mm_sub_ps(_mm_mul_ps(sb1, middle),
+                                     _mm_mul_ps(sa1, output)),
+                          s2);
+            s2=_mm_sub_ps(_mm_mul_ps(sb2, middle), _mm_mul_ps(sa2, output));
+            //Save the frame.
+            storeFrame(frame, output);
+        }
+        //Save the states.
+        _mm_storeu_ps(firstStates, f1);
+        _mm_storeu_ps(firstStates+m_stateStride, f2);
+        _mm_storeu_ps(secondStates, s1);
+        _mm_storeu_ps(secondStates+m_stateStride, s2);
+    }
+}
+
+inline __m128 KNMusicDspEqualizer::loadFrame(const float *frame)
+{
+    //Load the channels of the frame to the lowest lanes.
+    switch(m_channels)
+    {
+    case 1:
+        return _mm_load_ss(frame);
+    case 2:
+        return _mm_castpd_ps(_mm_load_sd((const double *)frame));
+    default:
+        return _mm_loadu_ps(frame);
+    }
+}
+
+inline void KNMusicDspEqualizer::storeFrame(float *frame, __m128 value)
+{
+    //Store the lowest lanes to the channels of the frame.
+    switch(m_channels)
+    {
+    case 1:
+        _mm_store_ss(frame, value);
+        break;
+    case 2:
+        _mm_store_sd((double *)frame, _mm_castps_pd(value));
+        break;
+    default:
+        _mm_storeu_ps(frame, value);
+        break;
+    }
+}
+#endif
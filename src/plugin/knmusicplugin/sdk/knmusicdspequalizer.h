@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICDSPEQUALIZER_H
+#define KNMUSICDSPEQUALIZER_H
+
+#include <QVector>
+
+#include "knmusicdspprocessor.h"
+
+#ifdef ENABLE_DSP_SSE2
+#include <emmintrin.h>
+#endif
+
+/*!
+ * \brief The KNMusicDspEqualizer class is a 10-band graphic equalizer. Each
+ * band is a one octave peaking biquad filter, the bands are centred at the ISO
+ * frequencies from 31Hz to 16kHz. The flat bands are skipped.\n
+ * The filters are processed in pairs. When the SSE2 is available and there're
+ * 1, 2 or 4 channels, all the channels of a frame are filtered together in one
+ * SSE register.
+ */
+class KNMusicDspEqualizer : public KNMusicDspProcessor
+{
+public:
+    /*!
+     * \brief Construct a KNMusicDspEqualizer.
+     */
+    KNMusicDspEqualizer();
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::prepare().
+     */
+    void prepare(int sampleRate, int channels) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::setParameters().
+     */
+    void setParameters(const MusicUtil::KNMusicDspParameters &parameters)
+    Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::isActive().
+     */
+    bool isActive() const Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::process().
+     */
+    void process(float *samples, int frames) Q_DECL_OVERRIDE;
+
+private:
+    inline void updateFilters();
+    inline void processScalar(float *samples, int frames);
+#ifdef ENABLE_DSP_SSE2
+    inline void processVector(float *samples, int frames);
+    inline __m128 loadFrame(const float *frame);
+    inline void storeFrame(float *frame, __m128 value);
+#endif
+    //The coefficients b0, b1, b2, a1 and a2 of each filter, every coefficient
+    //is repeated 4 times to be loaded to a SSE register directly.
+    QVector<float> m_coefficients;
+    //The states z1 and z2 of each filter for each channel, the channels are
+    //aligned to 4 for the SSE registers.
+    QVector<float> m_states;
+    qreal m_bandGains[MusicUtil::EqualizerBandCount];
+    int m_filterCount, m_bandFilterCount, m_stateStride, m_sampleRate,
+        m_channels;
+    bool m_enabled;
+};
+
+#endif // KNMUSICDSPEQUALIZER_H
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QtMath>
+
+#include "knmusicdspgain.h"
+
+#ifdef ENABLE_DSP_SSE2
+#include <emmintrin.h>
+#endif
+
+#define MinimumChange 0.0001
+
+using namespace MusicUtil;
+
+KNMusicDspGain::KNMusicDspGain() :
+    m_leftScale(1.0f),
+    m_rightScale(1.0f),
+    m_preamp(0.0),
+    m_balance(0.0),
+    m_channels(0)
+{
+}
+
+void KNMusicDspGain::prepare(int sampleRate, int channels)
+{
+    Q_UNUSED(sampleRate)
+    //Save the channel count, the balance depends on it.
+    m_channels=channels;
+    //Update the scales.
+    updateScales();
+}
+
+void KNMusicDspGain::setParameters(const KNMusicDspParameters &parameters)
+{
+    //Save the parameters.
+    m_preamp=parameters.preamp;
+    m_balance=qBound(-1.0, parameters.balance, 1.0);
+    //Update the scales.
+    updateScales();
+}
+
+bool KNMusicDspGain::isActive() const
+{
+    //Check whether any channel is scaled.
+    return qAbs(m_leftScale-1.0f)>MinimumChange ||
+            qAbs(m_rightScale-1.0f)>MinimumChange;
+}
+
+void KNMusicDspGain::process(float *samples, int frames)
+{
+    //Get the sample count.
+    int sampleCount=frames*m_channels, i=0;
+    if(m_channels==2)
+    {
+#ifdef ENABLE_DSP_SSE2
+        //Scale two frames at a time.
+        __m128 scale=_mm_setr_ps(m_leftScale, m_rightScale,
+                                 m_leftScale, m_rightScale);
+        for(; i+4<=sampleCount; i+=4)
+        {
+            _mm_storeu_ps(samples+i, _mm_mul_ps(_mm_loadu_ps(samples+i), scale));
+        }
+#endif
+        //Scale the rest frames.
+        for(; i<sampleCount; i+=2)
+        {
+            samples[i]*=m_leftScale;
+            samples[i+1]*=m_rightScale;
+        }
+        return;
+    }
+    //The other layouts only have the preamp.
+#ifdef ENABLE_DSP_SSE2
+    __m128 scale=_mm_set1_ps(m_leftScale);
+    for(; i+4<=sampleCount; i+=4)
+    {
+        _mm_storeu_ps(samples+i, _mm_mul_ps(_mm_loadu_ps(samples+i), scale));
+    }
+#endif
+    for(; i<sampleCount; ++i)
+    {
+        samples[i]*=m_leftScale;
+    }
+}
+
+inline void KNMusicDspGain::updateScales()
+{
+    //Calculate the linear scale of the preamp.
+    qreal preampScale=qPow(10.0, m_preamp/20.0);
+    m_leftScale=(float)preampScale;
+    m_rightScale=(float)preampScale;
+    //The balance turns down the opposite channel of stereo samples.
+    if(m_channels==2)
+    {
+        if(m_balance>0.0)
+        {
+            m_leftScale=(float)(preampScale*(1.0-m_balance));
+        }
+        else if(m_balance<0.0)
+        {
+            m_rightScale=(float)(preampScale*(1.0+m_balance));
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICDSPGAIN_H
+#define KNMUSICDSPGAIN_H
+
+#include "knmusicdspprocessor.h"
+
+/*!
+ * \brief The KNMusicDspGain class applies the preamp and the stereo balance.
+ * The balance only works for the stereo samples.
+ */
+class KNMusicDspGain : public KNMusicDspProcessor
+{
+public:
+    /*!
+     * \brief Construct a KNMusicDspGain.
+     */
+    KNMusicDspGain();
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::prepare().
+     */
+    void prepare(int sampleRate, int channels) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::setParameters().
+     */
+    void setParameters(const MusicUtil::KNMusicDspParameters &parameters)
+    Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::isActive().
+     */
+    bool isActive() const Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::process().
+     */
+    void process(float *samples, int frames) Q_DECL_OVERRIDE;
+
+private:
+    inline void updateScales();
+    //The scales of the left and the right channels, the other channels use the
+    //left scale.
+    float m_leftScale, m_rightScale;
+    qreal m_preamp, m_balance;
+    int m_channels;
+};
+
+#endif // KNMUSICDSPGAIN_H
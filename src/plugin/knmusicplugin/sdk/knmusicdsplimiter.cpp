@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "knmusicdsplimiter.h"
+
+#ifdef ENABLE_DSP_SSE2
+#include <emmintrin.h>
+#endif
+
+#define LimiterThreshold 0.9f
+#define LimiterRange (1.0f-LimiterThreshold)
+
+using namespace MusicUtil;
+
+KNMusicDspLimiter::KNMusicDspLimiter() :
+    m_channels(0),
+    m_enabled(false)
+{
+}
+
+void KNMusicDspLimiter::prepare(int sampleRate, int channels)
+{
+    Q_UNUSED(sampleRate)
+    //Save the channel count.
+    m_channels=channels;
+}
+
+void KNMusicDspLimiter::setParameters(const KNMusicDspParameters &parameters)
+{
+    //Save the switch.
+    m_enabled=parameters.limiterEnabled;
+}
+
+bool KNMusicDspLimiter::isActive() const
+{
+    return m_enabled;
+}
+
+void KNMusicDspLimiter::process(float *samples, int frames)
+{
+    //The limiter works on each sample, the layout doesn't matter.
+    int sampleCount=frames*m_channels, i=0;
+#ifdef ENABLE_DSP_SSE2
+    //Compress all the samples and select the result with the mask of the
+    //samples above the threshold, so there's no branch.
+    __m128 signMask=_mm_set1_ps(-0.0f),
+           threshold=_mm_set1_ps(LimiterThreshold),
+           range=_mm_set1_ps(LimiterRange),
+           one=_mm_set1_ps(1.0f);
+    for(; i+4<=sampleCount; i+=4)
+    {
+        __m128 value=_mm_loadu_ps(samples+i),
+               sign=_mm_and_ps(value, signMask),
+               magnitude=_mm_andnot_ps(signMask, value),
+               over=_mm_div_ps(_mm_sub_ps(magnitude, threshold), range),
+               compressed=_mm_add_ps(
+                   threshold,
+                   _mm_div_ps(_mm_mul_ps(range, over), _mm_add_ps(one, over))),
+               mask=_mm_cmpgt_ps(magnitude, threshold);
+        magnitude=_mm_or_ps(_mm_and_ps(mask, compressed),
+                            _mm_andnot_ps(mask, magnitude));
+        _mm_storeu_ps(samples+i, _mm_or_ps(magnitude, sign));
+    }
+#endif
+    //Compress the rest samples.
+    for(; i<sampleCount; ++i)
+    {
+        float magnitude=qAbs(samples[i]);
+        if(magnitude>LimiterThreshold)
+        {
+            //The curve approaches the full scale when the sample goes to the
+            //infinity.
+            float over=(magnitude-LimiterThreshold)/LimiterRange;
+            magnitude=LimiterThreshold+LimiterRange*over/(1.0f+over);
+            samples[i]=(samples[i]<0.0f)?-magnitude:magnitude;
+        }
+    }
+}
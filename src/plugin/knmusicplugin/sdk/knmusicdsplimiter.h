@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICDSPLIMITER_H
+#define KNMUSICDSPLIMITER_H
+
+#include "knmusicdspprocessor.h"
+
+/*!
+ * \brief The KNMusicDspLimiter class is a soft clipper which prevents the
+ * samples boosted by the equalizer and the preamp from clipping. The samples
+ * under the threshold are untouched, the samples above the threshold are
+ * compressed smoothly to never exceed the full scale.
+ */
+class KNMusicDspLimiter : public KNMusicDspProcessor
+{
+public:
+    /*!
+     * \brief Construct a KNMusicDspLimiter.
+     */
+    KNMusicDspLimiter();
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::prepare().
+     */
+    void prepare(int sampleRate, int channels) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::setParameters().
+     */
+    void setParameters(const MusicUtil::KNMusicDspParameters &parameters)
+    Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::isActive().
+     */
+    bool isActive() const Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicDspProcessor::process().
+     */
+    void process(float *samples, int frames) Q_DECL_OVERRIDE;
+
+private:
+    int m_channels;
+    bool m_enabled;
+};
+
+#endif // KNMUSICDSPLIMITER_H
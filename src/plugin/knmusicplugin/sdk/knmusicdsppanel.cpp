@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QBoxLayout>
+#include <QCheckBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QSlider>
+
+#include "knconfigure.h"
+#include "knlocalemanager.h"
+#include "knpreferenceitem.h"
+
+#include "knmusicbackend.h"
+#include "knmusicglobal.h"
+
+#include "knmusicdsppanel.h"
+
+#define DspConfigure QString("Dsp")
+#define EqualizerEnabled QString("EqualizerEnabled")
+#define EqualizerBand QString("EqualizerBand%1")
+#define DspPreamp QString("Preamp")
+#define DspBalance QString("Balance")
+#define LimiterEnabled QString("LimiterEnabled")
+#define MaximumGain 12
+#define BalanceRange 100
+
+using namespace MusicUtil;
+
+KNMusicDspPanel::KNMusicDspPanel(QWidget *parent) :
+    QWidget(parent),
+    m_preferenceItem(new KNPreferenceItem(this)),
+    m_dspConfigure(knMusicGlobal->configure()->getConfigure(DspConfigure)),
+    m_equalizerEnabled(new QCheckBox(this)),
+    m_limiterEnabled(new QCheckBox(this)),
+    m_preamp(generateSlider(Qt::Horizontal, -MaximumGain, MaximumGain)),
+    m_balance(generateSlider(Qt::Horizontal, -BalanceRange, BalanceRange)),
+    m_preampCaption(new QLabel(this)),
+    m_balanceCaption(new QLabel(this))
+{
+    //Configure the preference item.
+    m_preferenceItem->setIcon(QIcon(":/plugin/music/public/icon.png"));
+    m_preferenceItem->setHeaderIcon(QPixmap(":/plugin/music/public/icon.png"));
+
+    //Initial the main layout.
+    QBoxLayout *mainLayout=new QBoxLayout(QBoxLayout::TopToBottom, this);
+    setLayout(mainLayout);
+    //Add the equalizer switch.
+    mainLayout->addWidget(m_equalizerEnabled);
+    //Initial the band layout.
+    QBoxLayout *bandLayout=new QBoxLayout(QBoxLayout::LeftToRight,
+                                          mainLayout->widget());
+    mainLayout->addLayout(bandLayout, 1);
+    //The captions of the bands.
+    QString bandCaptions[EqualizerBandCount]=
+    {
+        "31", "62", "125", "250", "500", "1K", "2K", "4K", "8K", "16K"
+    };
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        //Generate the slider of the band.
+        m_bandGains[i]=generateSlider(Qt::Vertical, -MaximumGain, MaximumGain);
+        //Generate the band caption.
+        QLabel *caption=new QLabel(bandCaptions[i], this);
+        caption->setAlignment(Qt::AlignHCenter);
+        //Add the widgets to the band layout.
+        QBoxLayout *columnLayout=new QBoxLayout(QBoxLayout::TopToBottom,
+                                                bandLayout->widget());
+        columnLayout->addWidget(m_bandGains[i], 1, Qt::AlignHCenter);
+        columnLayout->addWidget(caption);
+        bandLayout->addLayout(columnLayout);
+    }
+    //Initial the form layout for the preamp and balance.
+    QFormLayout *optionLayout=new QFormLayout(mainLayout->widget());
+    optionLayout->addRow(m_preampCaption, m_preamp);
+    optionLayout->addRow(m_balanceCaption, m_balance);
+    mainLayout->addLayout(optionLayout);
+    //Add the limiter switch.
+    mainLayout->addWidget(m_limiterEnabled);
+
+    //Load the saved parameters, the signals are linked after it.
+    loadParameters();
+    //Link the widgets.
+    connect(m_equalizerEnabled, &QCheckBox::toggled,
+            this, &KNMusicDspPanel::onActionParameterChanged);
+    connect(m_limiterEnabled, &QCheckBox::toggled,
+            this, &KNMusicDspPanel::onActionParameterChanged);
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        connect(m_bandGains[i], &QSlider::valueChanged,
+                this, &KNMusicDspPanel::onActionParameterChanged);
+    }
+    connect(m_preamp, &QSlider::valueChanged,
+            this, &KNMusicDspPanel::onActionParameterChanged);
+    connect(m_balance, &QSlider::valueChanged,
+            this, &KNMusicDspPanel::onActionParameterChanged);
+    //Apply the saved parameters to the backend.
+    applyParameters();
+
+    //Link retranslate.
+    knI18n->link(this, &KNMusicDspPanel::retranslate);
+    retranslate();
+}
+
+KNPreferenceItem *KNMusicDspPanel::preferenceItem() const
+{
+    return m_preferenceItem;
+}
+
+void KNMusicDspPanel::retranslate()
+{
+    //Update the item title.
+    m_preferenceItem->setText(tr("Equalizer"));
+    //Update the captions.
+    m_equalizerEnabled->setText(tr("Enable equalizer"));
+    m_limiterEnabled->setText(tr("Prevent clipping with limiter"));
+    m_preampCaption->setText(tr("Preamp"));
+    m_balanceCaption->setText(tr("Balance"));
+}
+
+void KNMusicDspPanel::onActionParameterChanged()
+{
+    //Save the parameters.
+    m_dspConfigure->setData(EqualizerEnabled, m_equalizerEnabled->isChecked());
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        m_dspConfigure->setData(EqualizerBand.arg(i), m_bandGains[i]->value());
+    }
+    m_dspConfigure->setData(DspPreamp, m_preamp->value());
+    m_dspConfigure->setData(DspBalance, m_balance->value());
+    m_dspConfigure->setData(LimiterEnabled, m_limiterEnabled->isChecked());
+    //Apply the parameters.
+    applyParameters();
+}
+
+inline QSlider *KNMusicDspPanel::generateSlider(Qt::Orientation orientation,
+                                                int minimum,
+                                                int maximum)
+{
+    //Generate the slider.
+    QSlider *slider=new QSlider(orientation, this);
+    //Configure the slider.
+    slider->setRange(minimum, maximum);
+    slider->setValue(0);
+    return slider;
+}
+
+inline void KNMusicDspPanel::loadParameters()
+{
+    //Load the parameters from the configure to the widgets.
+    m_equalizerEnabled->setChecked(
+                m_dspConfigure->data(EqualizerEnabled, false).toBool());
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        m_bandGains[i]->setValue(
+                    m_dspConfigure->data(EqualizerBand.arg(i), 0).toInt());
+    }
+    m_preamp->setValue(m_dspConfigure->data(DspPreamp, 0).toInt());
+    m_balance->setValue(m_dspConfigure->data(DspBalance, 0).toInt());
+    m_limiterEnabled->setChecked(
+                m_dspConfigure->data(LimiterEnabled, false).toBool());
+}
+
+inline void KNMusicDspPanel::applyParameters()
+{
+    //Check the backend.
+    if(knMusicGlobal->backend()==nullptr)
+    {
+        return;
+    }
+    //Generate the parameters from the widgets.
+    KNMusicDspParameters parameters;
+    parameters.equalizerEnabled=m_equalizerEnabled->isChecked();
+    for(int i=0; i<EqualizerBandCount; ++i)
+    {
+        parameters.bandGains[i]=(qreal)m_bandGains[i]->value();
+    }
+    parameters.preamp=(qreal)m_preamp->value();
+    parameters.balance=(qreal)m_balance->value()/(qreal)BalanceRange;
+    parameters.limiterEnabled=m_limiterEnabled->isChecked();
+    //Apply the parameters to the backend.
+    knMusicGlobal->backend()->setDspParameters(parameters);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICDSPPANEL_H
+#define KNMUSICDSPPANEL_H
+
+#include "knmusicutil.h"
+
+#include <QWidget>
+
+class QLabel;
+class QCheckBox;
+class QSlider;
+class KNConfigure;
+class KNPreferenceItem;
+/*!
+ * \brief The KNMusicDspPanel class is the preference panel of the DSP chain. It
+ * provides the equalizer bands, the preamp, the balance and the limiter. The
+ * parameters are saved in the music configure and applied to the backend
+ * immediately.
+ */
+class KNMusicDspPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicDspPanel widget. The saved parameters will be
+     * applied to the backend of the music global.
+     * \param parent The parent widget.
+     */
+    explicit KNMusicDspPanel(QWidget *parent = 0);
+
+    /*!
+     * \brief Get the tab item of the panel in the preference.
+     * \return The preference item widget pointer.
+     */
+    KNPreferenceItem *preferenceItem() const;
+
+signals:
+
+public slots:
+
+private slots:
+    void retranslate();
+    void onActionParameterChanged();
+
+private:
+    inline QSlider *generateSlider(Qt::Orientation orientation,
+                                   int minimum,
+                                   int maximum);
+    inline void loadParameters();
+    inline void applyParameters();
+    KNPreferenceItem *m_preferenceItem;
+    KNConfigure *m_dspConfigure;
+    QCheckBox *m_equalizerEnabled, *m_limiterEnabled;
+    QSlider *m_bandGains[MusicUtil::EqualizerBandCount], *m_preamp, *m_balance;
+    QLabel *m_preampCaption, *m_balanceCaption;
+};
+
+#endif // KNMUSICDSPPANEL_H
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICDSPPROCESSOR_H
+#define KNMUSICDSPPROCESSOR_H
+
+#include "knmusicutil.h"
+
+//The SSE2 kernels are used when the compiler targets SSE2.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define ENABLE_DSP_SSE2
+#endif
+
+/*!
+ * \brief The KNMusicDspProcessor class is the interface of a stage in the DSP
+ * chain. A processor processes the interleaved float samples in place.\n
+ * All the functions are called in the thread which processes the samples,
+ * prepare() is called before processing any sample of a new format.
+ */
+class KNMusicDspProcessor
+{
+public:
+    /*!
+     * \brief Construct a KNMusicDspProcessor.
+     */
+    KNMusicDspProcessor(){}
+    virtual ~KNMusicDspProcessor(){}
+
+    /*!
+     * \brief Prepare the processor for a sample format, the state of the
+     * processor should be reset.
+     * \param sampleRate The sample rate of the samples.
+     * \param channels The channel count of the samples.
+     */
+    virtual void prepare(int sampleRate, int channels)=0;
+
+    /*!
+     * \brief Apply the DSP parameters. The processor only uses the parameters
+     * it needs.
+     * \param parameters The DSP parameters.
+     */
+    virtual void setParameters(
+            const MusicUtil::KNMusicDspParameters &parameters)=0;
+
+    /*!
+     * \brief Check whether the processor changes the samples. The inactive
+     * processor will be skipped.
+     * \return If the processor should process the samples, return true.
+     */
+    virtual bool isActive() const=0;
+
+    /*!
+     * \brief Process the samples in place.
+     * \param samples The interleaved float samples.
+     * \param frames The frame count of the samples.
+     */
+    virtual void process(float *samples, int frames)=0;
+};
+
+#endif // KNMUSICDSPPROCESSOR_H
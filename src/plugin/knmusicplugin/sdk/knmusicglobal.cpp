@@ -40,9 +40,11 @@ KNMusicGlobal::~KNMusicGlobal()
     //Stop the threads.
     m_searcherThread->quit();
     m_analysisThread->quit();
+    m_filterThread->quit();
     //Wait the threads.
     m_searcherThread->wait();
     m_analysisThread->wait();
+    m_filterThread->wait();
     //Delete the parser.
     delete m_parser;
 }
@@ -103,6 +105,7 @@ void KNMusicGlobal::startThreads()
     //Start threads.
     m_searcherThread->start();
     m_analysisThread->start();
+    m_filterThread->start();
 }
 
 void KNMusicGlobal::retranslate()
@@ -158,6 +161,7 @@ KNMusicGlobal::KNMusicGlobal(QObject *parent) :
     m_lyricsDownloadDialog(nullptr),
     m_searcherThread(new QThread(this)),
     m_analysisThread(new QThread(this)),
+    m_filterThread(new QThread(this)),
     m_musicConfigure(knGlobal->userConfigure()->getConfigure("Music"))
 {
     //Initial the file type.
@@ -167,6 +171,8 @@ KNMusicGlobal::KNMusicGlobal(QObject *parent) :
     //Register the queue arguments.
     qRegisterMetaType<KNMusicAnalysisItem>("KNMusicAnalysisItem");
     qRegisterMetaType<KNMusicDetailInfo>("KNMusicDetailInfo");
+    qRegisterMetaType<QList<KNMusicDetailInfo>>("QList<KNMusicDetailInfo>");
+    qRegisterMetaType<QList<KNMusicSearchBlock>>("QList<KNMusicSearchBlock>");
     qRegisterMetaType<QList<KNMusicLyricsDownloader::KNMusicLyricsDetails>>(
                 "QList<KNMusicLyricsDownloader::KNMusicLyricsDetails>");
 
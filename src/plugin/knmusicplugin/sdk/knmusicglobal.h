@@ -103,6 +103,15 @@ public:
         return m_parser;
     }
 
+    /*!
+     * \brief Get the working thread of the proxy model filters.
+     * \return The filter thread pointer.
+     */
+    QThread *filterThread()
+    {
+        return m_filterThread;
+    }
+
     /*!
      * \brief Get the type description of a specific suffix.
      * \param suffix The file suffix.
@@ -312,7 +321,7 @@ private:
     KNMusicDetailTooltipBase *m_detailTooltip;
     KNMusicLyricsDownloadDialogBase *m_lyricsDownloadDialog;
 
-    QThread *m_searcherThread, *m_analysisThread;
+    QThread *m_searcherThread, *m_analysisThread, *m_filterThread;
     KNConfigure *m_musicConfigure;
 };
 
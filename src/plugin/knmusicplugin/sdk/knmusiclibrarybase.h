@@ -21,6 +21,10 @@
 
 #include <QObject>
 
+#include "knmusicutil.h"
+
+using namespace MusicUtil;
+
 class KNMusicTab;
 class KNMusicNowPlayingBase;
 /*!
@@ -71,6 +75,14 @@ public:
      */
     virtual bool isWorking()=0;
 
+    /*!
+     * \brief Get the precomputed style of an album art in the library.
+     * \param hashKey The album art hash key.
+     * \return The artwork style. If the style is not generated yet, it will be
+     * a null style.
+     */
+    virtual KNMusicArtworkStyle artworkStyle(const QString &hashKey)=0;
+
 signals:
     /*!
      * \brief Ask music plugin to show the playlist float list widget.
@@ -82,6 +94,13 @@ signals:
      */
     void requireHidePlaylistList();
 
+    /*!
+     * \brief When the style of an album art is generated, this signal will be
+     * emitted.
+     * \param hashKey The album art hash key.
+     */
+    void artworkStyleChanged(const QString &hashKey);
+
 public slots:
     /*!
      * \brief Show the now playing song in the song tab.
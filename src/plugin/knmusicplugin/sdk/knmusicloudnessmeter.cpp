@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QtMath>
+
+#include "knmusicloudnessmeter.h"
+
+#define SubBlockPerBlock 4
+#define SubBlockDuration 100
+#define AbsoluteThreshold -70.0
+#define RelativeThreshold -10.0
+#define LoudnessOffset -0.691
+#define ReferenceLoudness -18.0
+#define SurroundWeight 1.41
+
+KNMusicLoudnessMeter::KNMusicLoudnessMeter(int channels, int sampleRate) :
+    m_shelf(KNMusicBiquad()),
+    m_highPass(KNMusicBiquad()),
+    m_shelfStates(QVector<KNMusicBiquadState>(channels)),
+    m_highPassStates(QVector<KNMusicBiquadState>(channels)),
+    m_channelWeights(QVector<qreal>(channels, 1.0)),
+    m_subBlockPowers(QVector<qreal>(SubBlockPerBlock, 0.0)),
+    m_blockPowers(QVector<qreal>()),
+    m_peak(0.0),
+    m_channels(channels),
+    m_subBlockSize(qMax(sampleRate*SubBlockDuration/1000, 1)),
+    m_subBlockFrames(0),
+    m_subBlockCount(0)
+{
+    //Calculate the K-weighting filters for the sample rate, the coefficients
+    //of the ITU-R BS.1770 are only for 48kHz.
+    //Stage 1, the high shelf filter models the acoustic effects of the head.
+    qreal shelfK=qTan(M_PI*1681.974450955533/(qreal)sampleRate),
+          shelfQ=0.7071752369554196,
+          shelfVh=qPow(10.0, 3.999843853973347/20.0),
+          shelfVb=qPow(shelfVh, 0.4996667741545416),
+          shelfA0=1.0+shelfK/shelfQ+shelfK*shelfK;
+    m_shelf.b0=(shelfVh+shelfVb*shelfK/shelfQ+shelfK*shelfK)/shelfA0;
+    m_shelf.b1=2.0*(shelfK*shelfK-shelfVh)/shelfA0;
+    m_shelf.b2=(shelfVh-shelfVb*shelfK/shelfQ+shelfK*shelfK)/shelfA0;
+    m_shelf.a1=2.0*(shelfK*shelfK-1.0)/shelfA0;
+    m_shelf.a2=(1.0-shelfK/shelfQ+shelfK*shelfK)/shelfA0;
+    //Stage 2, the high pass filter.
+    qreal passK=qTan(M_PI*38.13547087602444/(qreal)sampleRate),
+          passQ=0.5003270373238773,
+          passA0=1.0+passK/passQ+passK*passK;
+    m_highPass.b0=1.0;
+    m_highPass.b1=-2.0;
+    m_highPass.b2=1.0;
+    m_highPass.a1=2.0*(passK*passK-1.0)/passA0;
+    m_highPass.a2=(1.0-passK/passQ+passK*passK)/passA0;
+    //For 5.1 channels, the LFE channel is ignored and the surround channels are
+    //weighted.
+    if(m_channels>5)
+    {
+        m_channelWeights[3]=0.0;
+        m_channelWeights[4]=SurroundWeight;
+        m_channelWeights[5]=SurroundWeight;
+    }
+}
+
+void KNMusicLoudnessMeter::addFrame(const qreal *frame)
+{
+    //Get the accumulator of the current sub block.
+    qreal &power=m_subBlockPowers[m_subBlockCount % SubBlockPerBlock];
+    //Process all the channels.
+    for(int i=0; i<m_channels; ++i)
+    {
+        //Update the peak.
+        qreal absoluteSample=qAbs(frame[i]);
+        if(absoluteSample>m_peak)
+        {
+            m_peak=absoluteSample;
+        }
+        //Filter the sample with the K-weighting filter.
+        qreal weighted=filter(m_highPass,
+                              m_highPassStates[i],
+                              filter(m_shelf, m_shelfStates[i], frame[i]));
+        //Accumulate the weighted power.
+        power+=m_channelWeights.at(i)*weighted*weighted;
+    }
+    //Check whether the sub block is finished.
+    if(++m_subBlockFrames==m_subBlockSize)
+    {
+        finishSubBlock();
+    }
+}
+
+bool KNMusicLoudnessMeter::hasLoudness() const
+{
+    //Check whether any block is louder than the absolute threshold.
+    for(auto i : m_blockPowers)
+    {
+        if(LoudnessOffset+10.0*log10(i)>AbsoluteThreshold)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+qreal KNMusicLoudnessMeter::integratedLoudness() const
+{
+    //Gate the blocks with the absolute threshold first, then the relative
+    //threshold is calculated from the result.
+    qreal relativeThreshold=
+            gatedLoudness(AbsoluteThreshold)+RelativeThreshold;
+    //Gate the blocks again with both thresholds.
+    return gatedLoudness(qMax(relativeThreshold, AbsoluteThreshold));
+}
+
+qreal KNMusicLoudnessMeter::peak() const
+{
+    return m_peak;
+}
+
+qreal KNMusicLoudnessMeter::replayGain() const
+{
+    return ReferenceLoudness-integratedLoudness();
+}
+
+inline qreal KNMusicLoudnessMeter::filter(const KNMusicBiquad &biquad,
+                                          KNMusicBiquadState &state,
+                                          const qreal &sample)
+{
+    //Transposed direct form II.
+    qreal result=biquad.b0*sample+state.z1;
+    state.z1=biquad.b1*sample-biquad.a1*result+state.z2;
+    state.z2=biquad.b2*sample-biquad.a2*result;
+    return result;
+}
+
+inline void KNMusicLoudnessMeter::finishSubBlock()
+{
+    //Count the sub block.
+    ++m_subBlockCount;
+    m_subBlockFrames=0;
+    //A block contains the last four sub blocks, the blocks overlap 75%.
+    if(m_subBlockCount>=SubBlockPerBlock)
+    {
+        //Calculate the mean power of the block.
+        qreal blockPower=0.0;
+        for(auto i : m_subBlockPowers)
+        {
+            blockPower+=i;
+        }
+        m_blockPowers.append(blockPower/
+                             (qreal)(SubBlockPerBlock*m_subBlockSize));
+    }
+    //Reset the accumulator for the next sub block.
+    m_subBlockPowers[m_subBlockCount % SubBlockPerBlock]=0.0;
+}
+
+inline qreal KNMusicLoudnessMeter::gatedLoudness(const qreal &threshold) const
+{
+    //Calculate the mean power of the blocks louder than the threshold.
+    qreal powerSum=0.0;
+    int blockCount=0;
+    for(auto i : m_blockPowers)
+    {
+        if(i>0.0 && LoudnessOffset+10.0*log10(i)>threshold)
+        {
+            powerSum+=i;
+            ++blockCount;
+        }
+    }
+    //If there's no block, treat it as the absolute threshold.
+    if(blockCount==0)
+    {
+        return AbsoluteThreshold;
+    }
+    //Translate the mean power to loudness.
+    return LoudnessOffset+10.0*log10(powerSum/(qreal)blockCount);
+}
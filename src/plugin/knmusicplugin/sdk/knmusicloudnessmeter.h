@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICLOUDNESSMETER_H
+#define KNMUSICLOUDNESSMETER_H
+
+#include <QVector>
+
+/*!
+ * \brief The KNMusicLoudnessMeter class measures the integrated loudness of a
+ * track according to the EBU R128 (ITU-R BS.1770). The samples are K-weighted,
+ * measured in 400ms blocks with 75% overlap and gated by the absolute and the
+ * relative threshold.\n
+ * The meter is not thread-safe, but it doesn't depend on anything, so it could
+ * be used in any analysis thread.
+ */
+class KNMusicLoudnessMeter
+{
+public:
+    /*!
+     * \brief Construct a KNMusicLoudnessMeter.
+     * \param channels The channel count of the samples.
+     * \param sampleRate The sample rate of the samples.
+     */
+    KNMusicLoudnessMeter(int channels, int sampleRate);
+
+    /*!
+     * \brief Add one frame of samples to the meter.
+     * \param frame The samples of all the channels, each sample should be in
+     * range [-1.0, 1.0].
+     */
+    void addFrame(const qreal *frame);
+
+    /*!
+     * \brief Check whether there's any block louder than the absolute
+     * threshold.
+     * \return If the integrated loudness is available, return true.
+     */
+    bool hasLoudness() const;
+
+    /*!
+     * \brief Get the integrated loudness of all the frames.
+     * \return The loudness in LUFS.
+     */
+    qreal integratedLoudness() const;
+
+    /*!
+     * \brief Get the sample peak of all the frames.
+     * \return The peak in linear sample scale.
+     */
+    qreal peak() const;
+
+    /*!
+     * \brief Get the ReplayGain 2.0 gain of the integrated loudness, the
+     * reference level is -18 LUFS.
+     * \return The gain in dB.
+     */
+    qreal replayGain() const;
+
+private:
+    struct KNMusicBiquad
+    {
+        qreal b0, b1, b2, a1, a2;
+        KNMusicBiquad() :
+            b0(1.0), b1(0.0), b2(0.0), a1(0.0), a2(0.0)
+        {
+        }
+    };
+    struct KNMusicBiquadState
+    {
+        qreal z1, z2;
+        KNMusicBiquadState() :
+            z1(0.0), z2(0.0)
+        {
+        }
+    };
+    static inline qreal filter(const KNMusicBiquad &biquad,
+                               KNMusicBiquadState &state,
+                               const qreal &sample);
+    inline void finishSubBlock();
+    inline qreal gatedLoudness(const qreal &threshold) const;
+    KNMusicBiquad m_shelf, m_highPass;
+    QVector<KNMusicBiquadState> m_shelfStates, m_highPassStates;
+    QVector<qreal> m_channelWeights, m_subBlockPowers, m_blockPowers;
+    qreal m_peak;
+    int m_channels, m_subBlockSize, m_subBlockFrames, m_subBlockCount;
+};
+
+#endif // KNMUSICLOUDNESSMETER_H
@@ -21,12 +21,20 @@
 
 #include "knmusicplayerbase.h"
 
+class KNMusicLibraryBase;
 class KNMusicMainPlayerBase : public KNMusicPlayerBase
 {
     Q_OBJECT
 public:
     KNMusicMainPlayerBase(QWidget *parent = 0):KNMusicPlayerBase(parent){}
 
+    /*!
+     * \brief Set the music library. The main player could get the album art
+     * style of the playing song from the library.
+     * \param library The music library plugin.
+     */
+    virtual void setLibrary(KNMusicLibraryBase *library)=0;
+
 signals:
     void requireHide();
 
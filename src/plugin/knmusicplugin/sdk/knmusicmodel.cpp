@@ -20,6 +20,8 @@
 #include <QJsonArray>
 #include <QLinkedList>
 
+#include <algorithm>
+
 #include "knutil.h"
 #include "knmusicnowplayingbase.h"
 
@@ -27,6 +29,8 @@
 
 #include <QDebug>
 
+#define SearchGramLength 3
+
 QStringList KNMusicModel::m_dropMimeTypes=QStringList();
 QVariant KNMusicModel::m_alignLeft=QVariant(Qt::AlignLeft | Qt::AlignVCenter);
 QVariant KNMusicModel::m_alignCenter=QVariant(Qt::AlignCenter);
@@ -35,6 +39,10 @@ QVariant KNMusicModel::m_alignRight=QVariant(Qt::AlignRight | Qt::AlignVCenter);
 KNMusicModel::KNMusicModel(QObject *parent) :
     QAbstractTableModel(parent),
     m_detailInfos(QList<KNMusicDetailInfo>()),
+    m_categoryRowIndex(QHash<int, QHash<QString, QList<int>>>()),
+    m_searchIndex(QHash<quint64, QVector<int>>()),
+    m_rowIndexGeneration(0),
+    m_searchIndexBuilt(false),
     m_totalDuration(0),
     m_playingIndex(QPersistentModelIndex()),
     m_playingIcon(QVariant(QIcon(":/plugin/music/public/playingicon.png"))),
@@ -56,6 +64,21 @@ KNMusicModel::KNMusicModel(QObject *parent) :
         m_dropMimeTypes.append(ModelRowData);
         m_dropMimeTypes.append(ModelRowList);
     }
+    //Keep the row index updated. The search index follows the inserted, the
+    //removed and the moved rows, the category index is only appended. The
+    //others will make the row index expired.
+    connect(this, &KNMusicModel::rowsInserted,
+            this, &KNMusicModel::onActionRowsInserted);
+    connect(this, &KNMusicModel::dataChanged,
+            this, &KNMusicModel::onActionRowsDataChanged);
+    connect(this, &KNMusicModel::rowsRemoved,
+            this, &KNMusicModel::onActionRowsRemoved);
+    connect(this, &KNMusicModel::rowsMoved,
+            this, &KNMusicModel::onActionRowsMoved);
+    connect(this, &KNMusicModel::layoutChanged,
+            this, &KNMusicModel::onActionRowIndexExpired);
+    connect(this, &KNMusicModel::modelReset,
+            this, &KNMusicModel::onActionRowIndexExpired);
 }
 
 void KNMusicModel::appendFiles(const QStringList &filePaths)
@@ -191,6 +214,12 @@ bool KNMusicModel::updateRow(int row, KNMusicAnalysisItem analysisItem)
     detailInfo.textLists[DateAdded]=previousDetailInfo.textLists[DateAdded];
     detailInfo.textLists[Plays]=previousDetailInfo.textLists[Plays];
     detailInfo.textLists[Rating]=previousDetailInfo.textLists[Rating];
+    //The measured loudness is not saved in the tag, keep it when the file
+    //doesn't have any loudness tag.
+    if(detailInfo.replayGain.isNull())
+    {
+        detailInfo.replayGain=previousDetailInfo.replayGain;
+    }
     //Replace the row with the new detail info.
     return replaceRow(row, detailInfo);
 }
@@ -668,8 +697,9 @@ bool KNMusicModel::moveRows(const QModelIndex &sourceParent,
         //Insert the clipboard list to target position.
         while(!clipboardList.isEmpty())
         {
-            //Insert the clipboard from the first to the last.
-            m_detailInfos.insert(targetPosition, clipboardList.takeFirst());
+            //Insert the clipboard from the first to the last, keep the order
+            //of the moved rows.
+            m_detailInfos.insert(targetPosition++, clipboardList.takeFirst());
         }
     }
     //Follow the documentation, call this function after move all the rows.
@@ -726,3 +756,311 @@ QList<KNMusicDetailInfo> KNMusicModel::detailInfos() const
     return m_detailInfos;
 }
 
+const KNMusicDetailInfo &KNMusicModel::detailInfoAt(int row) const
+{
+    return m_detailInfos.at(row);
+}
+
+QList<int> KNMusicModel::categoryRows(int column, const QString &content)
+{
+    //Only the text columns could be a category.
+    if(column<0 || column>=MusicDataCount)
+    {
+        return QList<int>();
+    }
+    //Find the row index of the column.
+    auto columnIndex=m_categoryRowIndex.find(column);
+    //Check whether the row index has been built.
+    if(columnIndex==m_categoryRowIndex.end())
+    {
+        //Build the row index of the column in one pass, the rows of each value
+        //are added in order, so they will be sorted.
+        QHash<QString, QList<int>> rowIndex;
+        for(int i=0, rowSize=m_detailInfos.size(); i<rowSize; ++i)
+        {
+            rowIndex[m_detailInfos.at(i).textLists[column].toString()].append(i);
+        }
+        //Save the row index.
+        columnIndex=m_categoryRowIndex.insert(column, rowIndex);
+    }
+    //Give back the rows of the content.
+    return columnIndex.value().value(content);
+}
+
+bool KNMusicModel::searchCandidateRows(const QString &text,
+                                       QVector<int> &rows)
+{
+    //Normalise the search text.
+    QString &&foldedText=KNMusicUtil::searchKey(text);
+    //Check the length of the text, the short text cannot use the index.
+    if(foldedText.size()<SearchGramLength)
+    {
+        return false;
+    }
+    //Check whether the search index has been built.
+    if(!m_searchIndexBuilt)
+    {
+        //Index all the rows.
+        for(int i=0, rowSize=m_detailInfos.size(); i<rowSize; ++i)
+        {
+            indexSearchText(i);
+        }
+        //Set the built flag.
+        m_searchIndexBuilt=true;
+    }
+    //Find the posting lists of all the trigrams of the text.
+    QList<const QVector<int> *> postings;
+    for(int i=0, bound=foldedText.size()-SearchGramLength; i<=bound; ++i)
+    {
+        //Find the posting list of the trigram.
+        auto posting=m_searchIndex.constFind(
+                    (((quint64)foldedText.at(i).unicode())<<32) |
+                    (((quint64)foldedText.at(i+1).unicode())<<16) |
+                    ((quint64)foldedText.at(i+2).unicode()));
+        //If any trigram doesn't exist, no row could contain the text.
+        if(posting==m_searchIndex.constEnd())
+        {
+            rows=QVector<int>();
+            return true;
+        }
+        //Add the posting list.
+        postings.append(&(posting.value()));
+    }
+    //Intersect from the shortest posting list.
+    std::sort(postings.begin(), postings.end(),
+              [](const QVector<int> *left, const QVector<int> *right)
+              {
+                  return left->size() < right->size();
+              });
+    rows=*(postings.first());
+    for(int i=1; i<postings.size() && !rows.isEmpty(); ++i)
+    {
+        //Keep the rows which are in both lists.
+        QVector<int> intersection;
+        std::set_intersection(rows.constBegin(), rows.constEnd(),
+                              postings.at(i)->constBegin(),
+                              postings.at(i)->constEnd(),
+                              std::back_inserter(intersection));
+        rows=intersection;
+    }
+    return true;
+}
+
+quint64 KNMusicModel::rowIndexGeneration() const
+{
+    return m_rowIndexGeneration;
+}
+
+void KNMusicModel::onActionRowsInserted(const QModelIndex &parent,
+                                        int first,
+                                        int last)
+{
+    Q_UNUSED(parent)
+    //Generate the search keys of the new rows.
+    for(int row=first; row<=last; ++row)
+    {
+        KNMusicUtil::updateSearchKeys(m_detailInfos[row]);
+    }
+    //Check whether the rows are appended at the end of the model, the rows
+    //inserted in the middle move all the rows after them.
+    if(last!=m_detailInfos.size()-1)
+    {
+        //The category index will be rebuilt when needed.
+        m_categoryRowIndex.clear();
+        //Move the rows after the inserted rows in the search index.
+        if(m_searchIndexBuilt)
+        {
+            int offset=last-first+1;
+            for(auto i=m_searchIndex.begin(); i!=m_searchIndex.end(); ++i)
+            {
+                QVector<int> &posting=i.value();
+                for(auto j=std::lower_bound(posting.begin(), posting.end(),
+                                            first);
+                    j!=posting.end();
+                    ++j)
+                {
+                    (*j)+=offset;
+                }
+            }
+        }
+    }
+    else
+    {
+        //Add the appended rows to the end of the category posting lists.
+        for(auto i=m_categoryRowIndex.begin(); i!=m_categoryRowIndex.end(); ++i)
+        {
+            for(int row=first; row<=last; ++row)
+            {
+                i.value()[m_detailInfos.at(row).textLists[i.key()].toString()]
+                        .append(row);
+            }
+        }
+    }
+    //Add the inserted rows to the search index.
+    if(m_searchIndexBuilt)
+    {
+        for(int row=first; row<=last; ++row)
+        {
+            indexSearchText(row);
+        }
+    }
+    //Increase the generation.
+    ++m_rowIndexGeneration;
+}
+
+void KNMusicModel::onActionRowsDataChanged(const QModelIndex &topLeft,
+                                           const QModelIndex &bottomRight,
+                                           const QVector<int> &roles)
+{
+    //Only the display text of the text columns is indexed, ignore the other
+    //changes like the playing state.
+    if(topLeft.column()>=MusicDataCount ||
+            (!roles.isEmpty() && !roles.contains(Qt::DisplayRole)))
+    {
+        return;
+    }
+    //Update the search keys of the rows.
+    for(int row=topLeft.row(); row<=bottomRight.row(); ++row)
+    {
+        KNMusicUtil::updateSearchKeys(m_detailInfos[row]);
+    }
+    //The category of the rows may be changed, rebuild it when needed.
+    m_categoryRowIndex.clear();
+    //The search index only needs to give candidates, so simply add the new
+    //text of the rows to it.
+    if(m_searchIndexBuilt)
+    {
+        for(int row=topLeft.row(); row<=bottomRight.row(); ++row)
+        {
+            indexSearchText(row);
+        }
+    }
+    //Increase the generation.
+    ++m_rowIndexGeneration;
+}
+
+void KNMusicModel::onActionRowsRemoved(const QModelIndex &parent,
+                                       int first,
+                                       int last)
+{
+    Q_UNUSED(parent)
+    //The category of the rows is unknown now, rebuild it when needed.
+    m_categoryRowIndex.clear();
+    //Remove the rows from the search index, and move the rows after them.
+    if(m_searchIndexBuilt)
+    {
+        int offset=last-first+1;
+        for(auto i=m_searchIndex.begin(); i!=m_searchIndex.end();)
+        {
+            //Remove the rows from the posting list.
+            QVector<int> &posting=i.value();
+            auto removeStart=std::lower_bound(posting.begin(), posting.end(),
+                                              first);
+            auto removeEnd=std::upper_bound(removeStart, posting.end(), last);
+            int position=removeStart-posting.begin();
+            posting.erase(removeStart, removeEnd);
+            //Move the rows after the removed rows.
+            for(auto j=posting.begin()+position; j!=posting.end(); ++j)
+            {
+                (*j)-=offset;
+            }
+            //Remove the trigram when no row contains it.
+            if(posting.isEmpty())
+            {
+                i=m_searchIndex.erase(i);
+                continue;
+            }
+            ++i;
+        }
+    }
+    //Increase the generation.
+    ++m_rowIndexGeneration;
+}
+
+void KNMusicModel::onActionRowsMoved(const QModelIndex &parent,
+                                     int start,
+                                     int end,
+                                     const QModelIndex &destination,
+                                     int row)
+{
+    Q_UNUSED(parent)
+    Q_UNUSED(destination)
+    //The category index will be rebuilt when needed.
+    m_categoryRowIndex.clear();
+    //Only the rows between the moved rows and the destination are changed.
+    if(m_searchIndexBuilt)
+    {
+        int movedCount=end-start+1,
+            //The rows between the moved rows and the destination move in the
+            //opposite direction.
+            firstChanged=qMin(start, row),
+            lastChanged=(row>end)?row-1:end,
+            movedOffset=(row>end)?row-1-end:row-start,
+            passedOffset=(row>end)?-movedCount:movedCount;
+        for(auto i=m_searchIndex.begin(); i!=m_searchIndex.end(); ++i)
+        {
+            //Find the changed rows in the posting list.
+            QVector<int> &posting=i.value();
+            auto changedStart=std::lower_bound(posting.begin(), posting.end(),
+                                               firstChanged);
+            auto changedEnd=std::upper_bound(changedStart, posting.end(),
+                                             lastChanged);
+            //Map the rows to their new positions.
+            for(auto j=changedStart; j!=changedEnd; ++j)
+            {
+                (*j)+=((*j)>=start && (*j)<=end)?movedOffset:passedOffset;
+            }
+            //Only the changed part needs to be sorted again.
+            std::sort(changedStart, changedEnd);
+        }
+    }
+    //Increase the generation.
+    ++m_rowIndexGeneration;
+}
+
+void KNMusicModel::onActionRowIndexExpired()
+{
+    //Remove all the row index, they will be rebuilt when needed.
+    m_categoryRowIndex.clear();
+    m_searchIndex.clear();
+    m_searchIndexBuilt=false;
+    //Increase the generation.
+    ++m_rowIndexGeneration;
+}
+
+inline void KNMusicModel::indexSearchText(int row)
+{
+    //Get the detail info of the row.
+    const KNMusicDetailInfo &detailInfo=m_detailInfos.at(row);
+    //Add all the trigrams of all the text columns.
+    for(int i=0; i<MusicDataCount; ++i)
+    {
+        //Get the normalised text.
+        QString &&foldedText=(detailInfo.searchKeys.size()==MusicDataCount)?
+                    detailInfo.searchKeys.at(i):
+                    KNMusicUtil::searchKey(detailInfo.textLists[i].toString());
+        //Add all the trigrams.
+        for(int j=0, bound=foldedText.size()-SearchGramLength; j<=bound; ++j)
+        {
+            //Get the posting list of the trigram.
+            QVector<int> &posting=m_searchIndex[
+                    (((quint64)foldedText.at(j).unicode())<<32) |
+                    (((quint64)foldedText.at(j+1).unicode())<<16) |
+                    ((quint64)foldedText.at(j+2).unicode())];
+            //Keep the posting list sorted without duplicate rows. Most of the
+            //time the row is the last one.
+            if(posting.isEmpty() || posting.last()<row)
+            {
+                posting.append(row);
+                continue;
+            }
+            //Find the position of the row.
+            auto position=std::lower_bound(posting.begin(), posting.end(), row);
+            if(*position!=row)
+            {
+                posting.insert(position, row);
+            }
+        }
+    }
+}
+
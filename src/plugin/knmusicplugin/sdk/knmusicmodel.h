@@ -19,8 +19,10 @@
 #ifndef KNMUSICMODEL_H
 #define KNMUSICMODEL_H
 
+#include <QHash>
 #include <QList>
 #include <QUrl>
+#include <QVector>
 
 #include "knmusicglobal.h"
 #include <QStandardItemModel>
@@ -269,6 +271,54 @@ public:
                   const QModelIndex &destinationParent,
                   int destinationChild) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Get the rows whose text of a column is the specific content. The
+     * rows of all the values in the column are indexed at the first calling
+     * after the model is changed, then a category switch only costs the
+     * matching rows.
+     * \param column The category column, it should be a text column.
+     * \param content The category content text.
+     * \return The rows in ascending order.
+     */
+    QList<int> categoryRows(int column, const QString &content);
+
+    /*!
+     * \brief Get the detail info list from the model. The list is implicitly
+     * shared, it could be used as a snapshot of the model in other threads.
+     * \return The total detail info list from the model.
+     */
+    QList<KNMusicDetailInfo> detailInfos() const;
+
+    /*!
+     * \brief Get the detail info of a row without copying it. The reference is
+     * valid until the model is changed.
+     * \param row The row index.
+     * \return The detail info structure of the song.
+     */
+    const KNMusicDetailInfo &detailInfoAt(int row) const;
+
+    /*!
+     * \brief Find the candidate rows which may contain the text in any text
+     * column. The rows are found from a trigram index of all the text columns,
+     * it may contain a few rows which don't contain the text, but it will never
+     * miss a row which contains the text. The index will be built at the first
+     * calling, then the inserted, removed and moved rows will be updated in it
+     * incrementally.
+     * \param text The search text, it is normalised as the search keys.
+     * \param rows The candidate rows in ascending order.
+     * \return If the text is too short to use the index, it will be false, and
+     * all the rows should be treated as candidates.
+     */
+    bool searchCandidateRows(const QString &text, QVector<int> &rows);
+
+    /*!
+     * \brief Get the generation of the row index. It will be increased every
+     * time the model rows or text data is changed, which means all the rows got
+     * from categoryRows() and searchCandidateRows() before are expired.
+     * \return The generation number.
+     */
+    quint64 rowIndexGeneration() const;
+
     /*!
      * \brief Get whether this music model is searching and adding songs.
      * \return If the current model is working, then it should return true.
@@ -328,14 +378,26 @@ protected:
      */
     void initialTotalDuration(const quint64 &totalDuration);
 
-    /*!
-     * \brief Get the detail info list from the model.
-     * \return The total detail info list from the model.
-     */
-    QList<KNMusicDetailInfo> detailInfos() const;
+private slots:
+    void onActionRowsInserted(const QModelIndex &parent, int first, int last);
+    void onActionRowsDataChanged(const QModelIndex &topLeft,
+                                 const QModelIndex &bottomRight,
+                                 const QVector<int> &roles);
+    void onActionRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onActionRowsMoved(const QModelIndex &parent,
+                           int start,
+                           int end,
+                           const QModelIndex &destination,
+                           int row);
+    void onActionRowIndexExpired();
 
 private:
+    inline void indexSearchText(int row);
     QList<KNMusicDetailInfo> m_detailInfos;
+    QHash<int, QHash<QString, QList<int>>> m_categoryRowIndex;
+    QHash<quint64, QVector<int>> m_searchIndex;
+    quint64 m_rowIndexGeneration;
+    bool m_searchIndexBuilt;
     quint64 m_totalDuration;
     QPersistentModelIndex m_playingIndex;
     QVariant m_playingIcon, m_cannotPlayIcon;
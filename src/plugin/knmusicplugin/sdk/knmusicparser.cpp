@@ -28,8 +28,12 @@
 
 #include <QDebug>
 
+#define CoverCacheSize 67108864
+#define DirectoryCoverCost 1024
+
 KNMusicParser::KNMusicParser(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_coverCache(CoverCacheSize)
 {
     //Initial the image types.
     m_imageTypes.append("jpg");
@@ -239,6 +243,13 @@ void KNMusicParser::parseTrackList(const QString &filePath,
 
 void KNMusicParser::parseAlbumArt(KNMusicAnalysisItem &analysisItem)
 {
+    //If the tag parser only recorded the positions of the album art, read the
+    //raw data from the music file now.
+    if(!analysisItem.imageLocations.isEmpty())
+    {
+        //Load the album art data.
+        loadImageData(analysisItem);
+    }
     //The analysis item should contains the data when the tag parser parse the
     //tag. If the image data is not empty, then try all the parser.
     if(!analysisItem.imageData.isEmpty())
@@ -259,51 +270,114 @@ void KNMusicParser::parseAlbumArt(KNMusicAnalysisItem &analysisItem)
     {
         //Get the file info of the music file.
         QFileInfo musicFileInfo(analysisItem.detailInfo.filePath);
+        //Get the directory path of the music file.
+        QString directoryPath=musicFileInfo.absolutePath();
+        //The cover cache is shared by all the threads which use the parser,
+        //lock the cache before reading. The lock is only held for looking up
+        //the paths, the images are decoded without it, so the threads won't
+        //wait for the others' decoding.
+        m_coverCacheLock.lock();
+        //Get the image information of the directory. The directory will only
+        //be listed once until it is modified.
+        DirectoryCover *cover=directoryCover(QFileInfo(directoryPath));
         //Try to find external images, here is the policy:
         // 1. Find the same file name in the same folder.
-        if(findImageFile(musicFileInfo.absolutePath() + "/" +
-                         musicFileInfo.completeBaseName(), analysisItem) ||
-           findImageFile(musicFileInfo.absolutePath() + "/" +
-                         musicFileInfo.baseName(), analysisItem))
+        QString imagePath=findImageFile(cover,
+                                        directoryPath,
+                                        musicFileInfo.completeBaseName());
+        if(imagePath.isEmpty())
         {
-            return;
+            imagePath=findImageFile(cover,
+                                    directoryPath,
+                                    musicFileInfo.baseName());
         }
-        // 2. Find the 'cover' named image in the save folder.
-        if(findImageFile(musicFileInfo.absoluteFilePath() + "/cover",
-                         analysisItem))
+        // 2. Find the 'cover' named image in the same folder.
+        // 3. Find the file name contains 'cover' in the same folder.
+        //Both of them are resolved when listing the directory. Copy the cover
+        //out, the cache entry might be removed after the lock is released.
+        QString coverPath=cover->coverPath;
+        QImage coverImage=cover->coverImage;
+        bool coverDecoded=cover->coverDecoded;
+        m_coverCacheLock.unlock();
+        //The image of the same file name only belongs to this track, load it
+        //without caching.
+        if(!imagePath.isEmpty() && checkImageFile(imagePath, analysisItem))
         {
             return;
         }
-        //3. Find the file name contains 'cover' in the same folder.
-        QDir musicDir(musicFileInfo.absoluteDir());
-        QFileInfoList dirFileList=musicDir.entryInfoList();
-        for(auto i=dirFileList.begin();
-            i!=dirFileList.end();
-            ++i)
+        //The directory cover is shared by all the tracks in the folder, so
+        //decode it only once.
+        if(!coverDecoded)
         {
-            //Ignore dot and dot dot.
-            if((*i).fileName()=="." || (*i).fileName()=="..")
+            //Load the cover image.
+            coverImage=coverPath.isEmpty()?QImage():QImage(coverPath);
+            //Publish the decoded cover to the cache. Another thread might
+            //decode the same cover at the same time, the images are the same.
+            QMutexLocker cacheLocker(&m_coverCacheLock);
+            cover=m_coverCache.object(directoryPath);
+            if(cover!=nullptr && !cover->coverDecoded &&
+                    cover->coverPath==coverPath)
             {
-                continue;
+                cover->coverImage=coverImage;
+                cover->coverDecoded=true;
+                //The cost of the directory is the bytes of the decoded image,
+                //insert it again to update the cost. The cache might drop the
+                //other directories, or this one when the image is too large.
+                m_coverCache.take(directoryPath);
+                m_coverCache.insert(directoryPath,
+                                    cover,
+                                    DirectoryCoverCost+coverImage.byteCount());
             }
-            //Check if the current item is image type. Then find text 'cover' in
-            //the file name.
-            //If we can finished those steps, then load this file as cover
-            //image.
-            if(m_imageTypes.contains((*i).suffix().toLower()) &&
-                    (*i).fileName().toLower().contains("cover") &&
-                    checkImageFile((*i).absoluteFilePath(), analysisItem))
+        }
+        //Set the directory cover image to the analysis item.
+        analysisItem.coverImage=coverImage;
+    }
+}
+
+inline void KNMusicParser::loadImageData(KNMusicAnalysisItem &analysisItem)
+{
+    //Open the music file at read only mode.
+    QFile musicFile(analysisItem.detailInfo.filePath);
+    if(musicFile.open(QIODevice::ReadOnly))
+    {
+        //Get the file size.
+        qint64 fileSize=musicFile.size();
+        //Read all the recorded album art data.
+        for(auto i=analysisItem.imageLocations.constBegin();
+            i!=analysisItem.imageLocations.constEnd();
+            ++i)
+        {
+            //Get the image data list of the tag.
+            QList<QByteArray> &imageList=analysisItem.imageData[i.key()];
+            //Read all the locations.
+            for(auto location : i.value())
             {
-                break;
+                //Check the location is still in the file, the file might be
+                //changed after it is analysised.
+                if(location.offset<0 || location.size<=0 ||
+                        location.offset+location.size>fileSize ||
+                        !musicFile.seek(location.offset))
+                {
+                    //Ignore the invalid location.
+                    continue;
+                }
+                //Read the raw data.
+                imageList.append(musicFile.read(location.size));
             }
         }
+        //Close the music file.
+        musicFile.close();
     }
+    //Clear the locations, all the data has been loaded.
+    analysisItem.imageLocations.clear();
 }
 
 bool KNMusicParser::reanalysisItem(KNMusicAnalysisItem &analysisItem)
 {
     //Get the detail info of the item.
     KNMusicDetailInfo &detailInfo=analysisItem.detailInfo;
+    //Backup the replay gain, the measured loudness isn't saved in the tag.
+    KNMusicReplayGain replayGain=detailInfo.replayGain;
     //Check the type of the anlaysis item, if it's a single file, then we will
     //use the parseFile() and parseAlbumArt() to parse the file.
     if(-1==detailInfo.trackIndex)
@@ -312,6 +386,11 @@ bool KNMusicParser::reanalysisItem(KNMusicAnalysisItem &analysisItem)
         parseFile(detailInfo.filePath, analysisItem);
         //Use parseAlbumArt function to update the album art.
         parseAlbumArt(analysisItem);
+        //Recover the measured replay gain.
+        if(analysisItem.detailInfo.replayGain.isNull())
+        {
+            analysisItem.detailInfo.replayGain=replayGain;
+        }
         //Reanlaysis complete.
         return true;
     }
@@ -350,10 +429,30 @@ bool KNMusicParser::reanalysisItem(KNMusicAnalysisItem &analysisItem)
     }
     //Parse the album art.
     parseAlbumArt(analysisItem);
+    //Recover the measured replay gain.
+    if(analysisItem.detailInfo.replayGain.isNull())
+    {
+        analysisItem.detailInfo.replayGain=replayGain;
+    }
     //Reanlaysis complete.
     return true;
 }
 
+bool KNMusicParser::scanLoudness(KNMusicDetailInfo &detailInfo)
+{
+    //Using all the analysiser to measure the loudness.
+    //If there's one analysiser can measure it, exit.
+    for(auto i : m_analysisers)
+    {
+        if(i->scanLoudness(detailInfo))
+        {
+            return true;
+        }
+    }
+    //No analysiser could measure the loudness.
+    return false;
+}
+
 bool KNMusicParser::writeAnalysisItem(const KNMusicAnalysisItem &analysisItem)
 {
     //Get the detail info.
@@ -489,40 +588,97 @@ bool KNMusicParser::writeAlbumArt(const KNMusicAnalysisItem &analysisItem)
     return writeResult;
 }
 
-bool KNMusicParser::findImageFile(const QString &baseName,
-                                  KNMusicAnalysisItem &item)
+void KNMusicParser::clearCoverCache()
 {
-    //Check all the types in the image suffix list.
-    for(auto i=m_imageTypes.begin();
-        i!=m_imageTypes.end();
-        ++i)
+    //Lock the cover cache.
+    QMutexLocker cacheLocker(&m_coverCacheLock);
+    //Clear all the directory information.
+    m_coverCache.clear();
+}
+
+inline KNMusicParser::DirectoryCover *KNMusicParser::directoryCover(
+        const QFileInfo &directoryInfo)
+{
+    //Get the directory path.
+    QString directoryPath=directoryInfo.absoluteFilePath();
+    //Get the last modified time of the directory, when a file is added, removed
+    //or renamed in the directory, the time will be changed.
+    QDateTime lastModified=directoryInfo.lastModified();
+    //Find the directory in the cache.
+    DirectoryCover *cover=m_coverCache.object(directoryPath);
+    //Check whether the cached information is still valid.
+    if(cover!=nullptr && cover->lastModified==lastModified)
     {
-        //If any one of the suffix can be loaded, then return true.
-        if(checkImageFile(baseName + "." + (*i), item))
+        //Give back the cached directory.
+        return cover;
+    }
+    //Generate a new directory information.
+    cover=new DirectoryCover;
+    //Save the modified time.
+    cover->lastModified=lastModified;
+    //List the directory, only the files are needed.
+    QFileInfoList dirFileList=QDir(directoryPath).entryInfoList(QDir::Files);
+    //Prepare the first image which contains 'cover'.
+    QString containsCoverPath;
+    for(auto i : dirFileList)
+    {
+        //Check if the current item is image type.
+        if(!m_imageTypes.contains(i.suffix().toLower()))
         {
-            return true;
+            continue;
+        }
+        //Save the image file name, it will be found case insensitively.
+        cover->imageFiles.insert(i.fileName().toLower(), i.fileName());
+        //Find text 'cover' in the file name.
+        if(containsCoverPath.isEmpty() &&
+                i.fileName().toLower().contains("cover"))
+        {
+            //Save the image path.
+            containsCoverPath=i.absoluteFilePath();
         }
     }
-    //All failed, return false.
-    return false;
+    //The 'cover' named image has a higher priority.
+    cover->coverPath=findImageFile(cover, directoryPath, "cover");
+    //If there's no 'cover' named image, use the image contains 'cover'.
+    if(cover->coverPath.isEmpty())
+    {
+        cover->coverPath=containsCoverPath;
+    }
+    //Insert the directory to cache, the previous one will be deleted by the
+    //cache. The cover image is not decoded yet, only the file names are
+    //counted.
+    m_coverCache.insert(directoryPath, cover, DirectoryCoverCost);
+    //Give back the directory information.
+    return cover;
 }
 
-bool KNMusicParser::checkImageFile(const QString &filePath,
-                                   KNMusicAnalysisItem &item)
+inline QString KNMusicParser::findImageFile(const DirectoryCover *cover,
+                                            const QString &directoryPath,
+                                            const QString &baseName)
 {
-    //Use bool QFileInfo::exists(const QString & file) [static].
-    //In the document:
-    //   Using this function is faster than using QFileInfo(file).exists() for
-    //file system access.
-    if(QFileInfo::exists(filePath))
+    //Check all the types in the image suffix list.
+    for(auto i : m_imageTypes)
     {
-        //Load the image.
-        item.coverImage=QImage(filePath);
-        //Check the loading result.
-        return item.coverImage.isNull();
+        //Combine the lower case image file name.
+        QString imageFileName=(baseName + "." + i).toLower();
+        //If any one of the suffix is in the directory, then give back the path
+        //with the original file name.
+        if(cover->imageFiles.contains(imageFileName))
+        {
+            return directoryPath + "/" + cover->imageFiles.value(imageFileName);
+        }
     }
-    //If the file doesn't exist, of course not load success.
-    return false;
+    //All failed, return a null string.
+    return QString();
+}
+
+inline bool KNMusicParser::checkImageFile(const QString &filePath,
+                                          KNMusicAnalysisItem &item)
+{
+    //Load the image.
+    item.coverImage=QImage(filePath);
+    //Check the loading result.
+    return !item.coverImage.isNull();
 }
 
 inline void KNMusicParser::tagParser(const QString &parserName,
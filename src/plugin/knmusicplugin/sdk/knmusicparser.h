@@ -22,6 +22,9 @@
 #include <QList>
 #include <QLinkedList>
 #include <QFileInfo>
+#include <QCache>
+#include <QMutex>
+#include <QHash>
 #include <QObject>
 
 #include "knmusicutil.h"
@@ -97,6 +100,15 @@ public:
      */
     bool reanalysisItem(KNMusicAnalysisItem &analysisItem);
 
+    /*!
+     * \brief Measure the loudness of a music file with the analysisers. It
+     * decodes the whole file, so it should only be called in the analysis
+     * thread.
+     * \param detailInfo The detail info of the file.
+     * \return If any analysiser measured the loudness, return true.
+     */
+    bool scanLoudness(KNMusicDetailInfo &detailInfo);
+
     /*!
      * \brief Write analysis item to file path.
      * \param analysisItem The analysis item.
@@ -111,14 +123,47 @@ public:
      */
     bool writeAlbumArt(const KNMusicAnalysisItem &analysisItem);
 
+    /*!
+     * \brief Clear the external album art cache of all the directories. The
+     * cache will be rebuilt when a track in the directory is parsed again.\n
+     * The cache is limited by the bytes of the decoded cover images, it should
+     * be cleared when the library is cleared.
+     */
+    void clearCoverCache();
+
 private:
-    inline bool findImageFile(const QString &baseName,
-                              KNMusicAnalysisItem &item);
+    struct DirectoryCover
+    {
+        //Last modified time of the directory when it was listed.
+        QDateTime lastModified;
+        //All the image file names in the directory, the key is the lower case
+        //file name, the value is the original file name.
+        QHash<QString, QString> imageFiles;
+        //The 'cover' image of the whole directory.
+        QString coverPath;
+        QImage coverImage;
+        bool coverDecoded;
+        DirectoryCover() :
+            lastModified(QDateTime()),
+            imageFiles(QHash<QString, QString>()),
+            coverPath(QString()),
+            coverImage(QImage()),
+            coverDecoded(false)
+        {
+        }
+    };
+    inline DirectoryCover *directoryCover(const QFileInfo &directoryInfo);
+    inline QString findImageFile(const DirectoryCover *cover,
+                                 const QString &directoryPath,
+                                 const QString &baseName);
+    inline void loadImageData(KNMusicAnalysisItem &analysisItem);
     inline bool checkImageFile(const QString &filePath,
                                KNMusicAnalysisItem &item);
     inline void tagParser(const QString &parserName,
                           QList<KNMusicTagParser *> &tagParserList);
     QList<QString> m_imageTypes;
+    QCache<QString, DirectoryCover> m_coverCache;
+    QMutex m_coverCacheLock;
     QLinkedList<KNMusicAnalysiser *> m_analysisers;
     QLinkedList<KNMusicTagParser *> m_tagParsers;
     QLinkedList<KNMusicListParser *> m_listParsers;
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QBoxLayout>
+#include <QComboBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QSlider>
+
+#include "knconfigure.h"
+#include "knlocalemanager.h"
+#include "knpreferenceitem.h"
+
+#include "knmusicglobal.h"
+#include "knmusicnowplayingbase.h"
+
+#include "knmusicplaybackpanel.h"
+
+#define CrossfadeDuration QString("CrossfadeDuration")
+#define CrossfadeCurve QString("CrossfadeCurve")
+#define ReplayGainMode QString("ReplayGainMode")
+#define ReplayGainPreamp QString("ReplayGainPreamp")
+#define MaximumCrossfade 12
+#define MaximumPreamp 15
+
+using namespace MusicUtil;
+
+KNMusicPlaybackPanel::KNMusicPlaybackPanel(QWidget *parent) :
+    QWidget(parent),
+    m_preferenceItem(new KNPreferenceItem(this)),
+    m_musicConfigure(knMusicGlobal->configure()),
+    m_crossfadeDuration(generateSlider(0, MaximumCrossfade)),
+    m_replayGainPreamp(generateSlider(-MaximumPreamp, MaximumPreamp)),
+    m_crossfadeCurve(new QComboBox(this)),
+    m_replayGainMode(new QComboBox(this)),
+    m_crossfadeDurationCaption(new QLabel(this)),
+    m_crossfadeCurveCaption(new QLabel(this)),
+    m_replayGainModeCaption(new QLabel(this)),
+    m_replayGainPreampCaption(new QLabel(this))
+{
+    //Configure the preference item.
+    m_preferenceItem->setIcon(QIcon(":/plugin/music/public/icon.png"));
+    m_preferenceItem->setHeaderIcon(QPixmap(":/plugin/music/public/icon.png"));
+    //Add the items of the combo boxes, the text will be set in retranslate().
+    for(int i=0; i<CrossfadeCurveCount; ++i)
+    {
+        m_crossfadeCurve->addItem(QString());
+    }
+    for(int i=0; i<ReplayGainModeCount; ++i)
+    {
+        m_replayGainMode->addItem(QString());
+    }
+
+    //Initial the main layout.
+    QBoxLayout *mainLayout=new QBoxLayout(QBoxLayout::TopToBottom, this);
+    setLayout(mainLayout);
+    //Initial the form layout for the settings.
+    QFormLayout *optionLayout=new QFormLayout(mainLayout->widget());
+    optionLayout->addRow(m_crossfadeDurationCaption, m_crossfadeDuration);
+    optionLayout->addRow(m_crossfadeCurveCaption, m_crossfadeCurve);
+    optionLayout->addRow(m_replayGainModeCaption, m_replayGainMode);
+    optionLayout->addRow(m_replayGainPreampCaption, m_replayGainPreamp);
+    mainLayout->addLayout(optionLayout);
+    mainLayout->addStretch();
+
+    //Load the saved settings, the signals are linked after it.
+    loadSettings();
+    //Link the widgets.
+    connect(m_crossfadeDuration, &QSlider::valueChanged,
+            this, &KNMusicPlaybackPanel::onActionSettingChanged);
+    connect(m_replayGainPreamp, &QSlider::valueChanged,
+            this, &KNMusicPlaybackPanel::onActionSettingChanged);
+    connect(m_crossfadeCurve,
+            static_cast<void (QComboBox::*)(int)>(
+                &QComboBox::currentIndexChanged),
+            this, &KNMusicPlaybackPanel::onActionSettingChanged);
+    connect(m_replayGainMode,
+            static_cast<void (QComboBox::*)(int)>(
+                &QComboBox::currentIndexChanged),
+            this, &KNMusicPlaybackPanel::onActionSettingChanged);
+
+    //Link retranslate.
+    knI18n->link(this, &KNMusicPlaybackPanel::retranslate);
+    retranslate();
+}
+
+KNPreferenceItem *KNMusicPlaybackPanel::preferenceItem() const
+{
+    return m_preferenceItem;
+}
+
+void KNMusicPlaybackPanel::retranslate()
+{
+    //Update the item title.
+    m_preferenceItem->setText(tr("Playback"));
+    //Update the captions.
+    m_crossfadeDurationCaption->setText(tr("Crossfade (seconds)"));
+    m_crossfadeCurveCaption->setText(tr("Crossfade curve"));
+    m_replayGainModeCaption->setText(tr("ReplayGain"));
+    m_replayGainPreampCaption->setText(tr("ReplayGain preamp (dB)"));
+    //Update the items of the combo boxes.
+    m_crossfadeCurve->setItemText(CrossfadeLinear, tr("Linear"));
+    m_crossfadeCurve->setItemText(CrossfadeEqualPower, tr("Equal power"));
+    m_crossfadeCurve->setItemText(CrossfadeSmooth, tr("Smooth"));
+    m_replayGainMode->setItemText(ReplayGainOff, tr("Off"));
+    m_replayGainMode->setItemText(ReplayGainTrack, tr("Track"));
+    m_replayGainMode->setItemText(ReplayGainAlbum, tr("Album"));
+}
+
+void KNMusicPlaybackPanel::onActionSettingChanged()
+{
+    //Save the settings, the crossfade duration is saved in msecond.
+    m_musicConfigure->setData(CrossfadeDuration,
+                              m_crossfadeDuration->value()*1000);
+    m_musicConfigure->setData(CrossfadeCurve,
+                              m_crossfadeCurve->currentIndex());
+    m_musicConfigure->setData(ReplayGainMode,
+                              m_replayGainMode->currentIndex());
+    m_musicConfigure->setData(ReplayGainPreamp,
+                              (qreal)m_replayGainPreamp->value());
+    //Ask the now playing to apply the settings.
+    if(knMusicGlobal->nowPlaying()!=nullptr)
+    {
+        knMusicGlobal->nowPlaying()->loadConfigure();
+    }
+}
+
+inline QSlider *KNMusicPlaybackPanel::generateSlider(int minimum, int maximum)
+{
+    //Generate the slider.
+    QSlider *slider=new QSlider(Qt::Horizontal, this);
+    //Configure the slider, mark every step.
+    slider->setRange(minimum, maximum);
+    slider->setTickPosition(QSlider::TicksBelow);
+    slider->setTickInterval(1);
+    slider->setValue(0);
+    return slider;
+}
+
+inline void KNMusicPlaybackPanel::loadSettings()
+{
+    //Load the settings from the configure to the widgets, use the same default
+    //values as the now playing.
+    m_crossfadeDuration->setValue(
+                m_musicConfigure->data(CrossfadeDuration, 0).toInt()/1000);
+    m_crossfadeCurve->setCurrentIndex(
+                m_musicConfigure->data(CrossfadeCurve,
+                                       CrossfadeEqualPower).toInt());
+    m_replayGainMode->setCurrentIndex(
+                m_musicConfigure->data(ReplayGainMode,
+                                       ReplayGainTrack).toInt());
+    m_replayGainPreamp->setValue(
+                qRound(m_musicConfigure->data(ReplayGainPreamp,
+                                              0.0).toDouble()));
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICPLAYBACKPANEL_H
+#define KNMUSICPLAYBACKPANEL_H
+
+#include <QWidget>
+
+class QComboBox;
+class QLabel;
+class QSlider;
+class KNConfigure;
+class KNPreferenceItem;
+/*!
+ * \brief The KNMusicPlaybackPanel class is the preference panel of the
+ * playback. It provides the crossfade duration and curve, the ReplayGain mode
+ * and preamp. The settings are saved in the music configure and applied by the
+ * now playing immediately.
+ */
+class KNMusicPlaybackPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicPlaybackPanel widget. It should be constructed
+     * after the now playing of the music global is set.
+     * \param parent The parent widget.
+     */
+    explicit KNMusicPlaybackPanel(QWidget *parent = 0);
+
+    /*!
+     * \brief Get the tab item of the panel in the preference.
+     * \return The preference item widget pointer.
+     */
+    KNPreferenceItem *preferenceItem() const;
+
+signals:
+
+public slots:
+
+private slots:
+    void retranslate();
+    void onActionSettingChanged();
+
+private:
+    inline QSlider *generateSlider(int minimum, int maximum);
+    inline void loadSettings();
+    KNPreferenceItem *m_preferenceItem;
+    KNConfigure *m_musicConfigure;
+    QSlider *m_crossfadeDuration, *m_replayGainPreamp;
+    QComboBox *m_crossfadeCurve, *m_replayGainMode;
+    QLabel *m_crossfadeDurationCaption, *m_crossfadeCurveCaption,
+           *m_replayGainModeCaption, *m_replayGainPreampCaption;
+};
+
+#endif // KNMUSICPLAYBACKPANEL_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+
+#include "knmusicpositionclock.h"
+
+#define DefaultInterval 33
+
+KNMusicPositionClock::KNMusicPositionClock(QObject *parent) :
+    QObject(parent),
+    m_views(QList<QWidget *>()),
+    m_ticker(new QTimer(this)),
+    m_anchorPosition(-1),
+    m_anchorTimestamp(0),
+    m_rate(0.0)
+{
+    //Configure the ticker.
+    m_ticker->setInterval(DefaultInterval);
+    connect(m_ticker, &QTimer::timeout,
+            this, &KNMusicPositionClock::onActionTick);
+}
+
+qint64 KNMusicPositionClock::position() const
+{
+    //Check the anchor.
+    if(m_anchorPosition==-1)
+    {
+        return -1;
+    }
+    //Calculate the position from the anchor.
+    return m_anchorPosition +
+            (qint64)(m_rate*(currentTimestamp()-m_anchorTimestamp));
+}
+
+int KNMusicPositionClock::interval() const
+{
+    return m_ticker->interval();
+}
+
+qint64 KNMusicPositionClock::currentTimestamp()
+{
+    //Get the reference time of the monotonic clock.
+    QElapsedTimer timer;
+    timer.start();
+    return timer.msecsSinceReference();
+}
+
+void KNMusicPositionClock::setAnchor(qint64 position,
+                                     qreal rate,
+                                     qint64 timestamp)
+{
+    //Save the anchor.
+    m_anchorPosition=position;
+    m_rate=rate;
+    m_anchorTimestamp=timestamp;
+    //Update the ticker.
+    updateTicker();
+    //The position might jump, update the visible views right now.
+    if(isViewVisible())
+    {
+        emit positionChanged(position());
+    }
+}
+
+void KNMusicPositionClock::setInterval(int interval)
+{
+    //Save the interval.
+    m_ticker->setInterval(interval);
+}
+
+void KNMusicPositionClock::addView(QWidget *view)
+{
+    //Check the view.
+    if(view==nullptr || m_views.contains(view))
+    {
+        return;
+    }
+    //Save the view.
+    m_views.append(view);
+    //Watch the show and hide event of the view.
+    view->installEventFilter(this);
+    connect(view, &QWidget::destroyed,
+            this, &KNMusicPositionClock::onActionViewDestroyed);
+    //Update the ticker.
+    updateTicker();
+}
+
+bool KNMusicPositionClock::eventFilter(QObject *watched, QEvent *event)
+{
+    //Check the event type.
+    switch(event->type())
+    {
+    case QEvent::Show:
+        //Update the view which is just shown.
+        emit positionChanged(position());
+        //Update the ticker.
+        updateTicker();
+        break;
+    case QEvent::Hide:
+        //Update the ticker.
+        updateTicker();
+        break;
+    default:
+        break;
+    }
+    //Do the original event filter.
+    return QObject::eventFilter(watched, event);
+}
+
+void KNMusicPositionClock::onActionTick()
+{
+    //Emit the extrapolated position.
+    emit positionChanged(position());
+}
+
+void KNMusicPositionClock::onActionViewDestroyed(QObject *view)
+{
+    //Remove the view.
+    m_views.removeAll(static_cast<QWidget *>(view));
+    //Update the ticker.
+    updateTicker();
+}
+
+inline bool KNMusicPositionClock::isViewVisible() const
+{
+    //A clock without any view is always visible.
+    if(m_views.isEmpty())
+    {
+        return true;
+    }
+    //Check all the views.
+    for(auto i : m_views)
+    {
+        //Check the visibility of the view.
+        if(i->isVisible())
+        {
+            return true;
+        }
+    }
+    //No view is visible.
+    return false;
+}
+
+inline void KNMusicPositionClock::updateTicker()
+{
+    //The clock only ticks when the position is moving and it's visible.
+    if(m_anchorPosition!=-1 && m_rate!=0.0 && isViewVisible())
+    {
+        //Start the ticker.
+        if(!m_ticker->isActive())
+        {
+            m_ticker->start();
+        }
+        return;
+    }
+    //Stop the ticker.
+    m_ticker->stop();
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICPOSITIONCLOCK_H
+#define KNMUSICPOSITIONCLOCK_H
+
+#include <QList>
+
+#include <QObject>
+
+class QTimer;
+class QWidget;
+/*!
+ * \brief The KNMusicPositionClock class extrapolates the playing position from
+ * the position anchor of the backend. The backend only reports an anchor when
+ * the position jumps or the playing rate changes, the clock calculates the
+ * position by itself at its own refresh interval.\n
+ * The clock only ticks when the music is playing and one of its views is
+ * visible. A clock without any view is treated as always visible.
+ */
+class KNMusicPositionClock : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicPositionClock object.
+     * \param parent The parent object.
+     */
+    explicit KNMusicPositionClock(QObject *parent = 0);
+
+    /*!
+     * \brief Get the extrapolated position of the current moment.
+     * \return The position in msecond. If there's no anchor, return -1.
+     */
+    qint64 position() const;
+
+    /*!
+     * \brief Get the refresh interval of the clock.
+     * \return The interval in msecond.
+     */
+    int interval() const;
+
+    /*!
+     * \brief Get the timestamp of the current moment. The timestamp is
+     * monotonic and could be used in any thread, the backend should use it to
+     * stamp its anchor.
+     * \return The timestamp in msecond.
+     */
+    static qint64 currentTimestamp();
+
+signals:
+    /*!
+     * \brief When the position is updated, this signal will be emitted.
+     * \param position The extrapolated position in msecond.
+     */
+    void positionChanged(qint64 position);
+
+public slots:
+    /*!
+     * \brief Set the position anchor of the clock.
+     * \param position The position at the timestamp in msecond.
+     * \param rate The playing rate, 0.0 means the position doesn't move.
+     * \param timestamp The timestamp from currentTimestamp().
+     */
+    void setAnchor(qint64 position, qreal rate, qint64 timestamp);
+
+    /*!
+     * \brief Set the refresh interval of the clock.
+     * \param interval The interval in msecond.
+     */
+    void setInterval(int interval);
+
+    /*!
+     * \brief Add a view which displays the position. The clock only ticks
+     * when one of the views is visible.
+     * \param view The view widget.
+     */
+    void addView(QWidget *view);
+
+protected:
+    /*!
+     * \brief Reimplemented from QObject::eventFilter().
+     */
+    bool eventFilter(QObject *watched, QEvent *event) Q_DECL_OVERRIDE;
+
+private slots:
+    void onActionTick();
+    void onActionViewDestroyed(QObject *view);
+
+private:
+    inline bool isViewVisible() const;
+    inline void updateTicker();
+    QList<QWidget *> m_views;
+    QTimer *m_ticker;
+    qint64 m_anchorPosition, m_anchorTimestamp;
+    qreal m_rate;
+};
+
+#endif // KNMUSICPOSITIONCLOCK_H
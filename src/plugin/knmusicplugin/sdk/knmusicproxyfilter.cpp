@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "knmusicsearchplan.h"
+
+#include "knmusicproxyfilter.h"
+
+#define CancelCheckInterval 1024
+
+KNMusicProxyFilter::KNMusicProxyFilter(QObject *parent) :
+    QObject(parent),
+    m_latestGeneration(0)
+{
+}
+
+void KNMusicProxyFilter::setLatestGeneration(int generation)
+{
+    //Save the generation.
+    m_latestGeneration.store(generation);
+}
+
+void KNMusicProxyFilter::filter(int generation,
+                                const QList<KNMusicDetailInfo> &detailInfos,
+                                const QBitArray &candidateRows,
+                                const QList<KNMusicSearchBlock> &blocks)
+{
+    //Compile the search plan.
+    KNMusicSearchPlan searchPlan(blocks);
+    //Prepare the accepted row flags.
+    QBitArray acceptedRows(detailInfos.size());
+    //Check all the candidate rows.
+    for(int i=0, rowSize=qMin(detailInfos.size(), candidateRows.size());
+        i<rowSize;
+        ++i)
+    {
+        //Check whether there's a newer request every a few rows.
+        if((i % CancelCheckInterval)==0 &&
+                m_latestGeneration.load()!=generation)
+        {
+            //This request is cancelled, no result will be given back.
+            return;
+        }
+        //The category, the search index and the previous result have been
+        //checked by the proxy model.
+        if(!candidateRows.testBit(i))
+        {
+            continue;
+        }
+        //Mark the row which matches the search plan.
+        if(searchPlan.match(detailInfos.at(i)))
+        {
+            acceptedRows.setBit(i);
+        }
+    }
+    //Give back the result.
+    emit filterComplete(generation, acceptedRows);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICPROXYFILTER_H
+#define KNMUSICPROXYFILTER_H
+
+#include <QAtomicInt>
+#include <QBitArray>
+
+#include "knmusicutil.h"
+
+#include <QObject>
+
+using namespace MusicUtil;
+
+/*!
+ * \brief The KNMusicProxyFilter class filters a snapshot of the detail info
+ * list of a music model with the search blocks. It should be moved to a working
+ * thread, the proxy model sends the snapshot to it and gets the accepted rows
+ * back, so the GUI thread won't be blocked by a large library.\n
+ * Each request has a generation number, a newer request will cancel all the
+ * requests before it.
+ */
+class KNMusicProxyFilter : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Construct a KNMusicProxyFilter object.
+     * \param parent The parent object.
+     */
+    explicit KNMusicProxyFilter(QObject *parent = 0);
+
+    /*!
+     * \brief Mark the latest request generation, all the requests before it
+     * will be abandoned. This function is thread-safe, it should be called
+     * before sending a new request.
+     * \param generation The latest request generation.
+     */
+    void setLatestGeneration(int generation);
+
+signals:
+    /*!
+     * \brief When a request is finished, this signal will be emitted.
+     * \param generation The request generation.
+     * \param acceptedRows The accepted row flags of the snapshot.
+     */
+    void filterComplete(int generation, QBitArray acceptedRows);
+
+public slots:
+    /*!
+     * \brief Filter the detail info snapshot with the search blocks.
+     * \param generation The request generation.
+     * \param detailInfos The detail info snapshot of the model.
+     * \param candidateRows The row flags of the snapshot which could match the
+     * blocks, only these rows will be checked.
+     * \param blocks The search blocks.
+     */
+    void filter(int generation,
+                const QList<KNMusicDetailInfo> &detailInfos,
+                const QBitArray &candidateRows,
+                const QList<KNMusicSearchBlock> &blocks);
+
+private:
+    QAtomicInt m_latestGeneration;
+};
+
+#endif // KNMUSICPROXYFILTER_H
@@ -15,20 +15,76 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
+#include "knmusicglobal.h"
 #include "knmusicmodel.h"
+#include "knmusicproxyfilter.h"
 
 #include "knmusicproxymodel.h"
 
+#include <limits>
+
 #include <QDebug>
 
 KNMusicProxyModel::KNMusicProxyModel(QObject *parent) :
     QSortFilterProxyModel(parent),
-    m_categoryColumn(-1)
+    m_searchBlocks(QList<KNMusicSearchBlock>()),
+    m_searchPlan(KNMusicSearchPlan()),
+    m_collator(QCollator()),
+    m_sourceHandler(KNConnectionHandler()),
+    m_sortTieColumns(QHash<int, QList<int>>()),
+    m_numericSortKeys(QHash<int, QVector<qint64>>()),
+    m_textSortKeys(QHash<int, QList<QCollatorSortKey>>()),
+    m_sortKeyColumn(-1),
+    m_filter(nullptr),
+    m_filterRows(QBitArray()),
+    m_filterRowsGeneration(0),
+    m_filterRequestRowsGeneration(0),
+    m_filterRowsModel(nullptr),
+    m_filterGeneration(0),
+    m_filterRunning(false),
+    m_refineRows(QBitArray()),
+    m_refineRowsGeneration(0),
+    m_refineRowsModel(nullptr),
+    m_acceptedRows(QBitArray()),
+    m_acceptedRowsGeneration(0),
+    m_acceptedRowsModel(nullptr),
+    m_categoryRows(QBitArray()),
+    m_searchRows(QBitArray()),
+    m_searchRowsGeneration(0),
+    m_searchRowsModel(nullptr),
+    m_searchRowsFiltered(false),
+    m_categoryRowsGeneration(0),
+    m_categoryRowsModel(nullptr),
+    m_categoryColumn(-1),
+    m_categoryContent(QString())
 {
     //Set properties.
     setFilterKeyColumn(-1); //Search for all columns.
     setFilterCaseSensitivity(Qt::CaseInsensitive); //Filter won't care the case.
     setSortCaseSensitivity(Qt::CaseInsensitive); //Sorter will care the case.
+    //Configure the collator for the text sort keys, the numbers in the text
+    //will be compared by their values.
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    m_collator.setNumericMode(true);
+    //Set the default tie-breaking columns, keep the songs of an album in the
+    //album order.
+    m_sortTieColumns.insert(Album, QList<int>() << DiscNumber << TrackNumber);
+    m_sortTieColumns.insert(Artist, QList<int>() << Album << DiscNumber
+                                                 << TrackNumber);
+    m_sortTieColumns.insert(AlbumArtist, QList<int>() << Year << Album
+                                                      << DiscNumber
+                                                      << TrackNumber);
+}
+
+KNMusicProxyModel::~KNMusicProxyModel()
+{
+    //Recover the filter, it's living in the filter thread.
+    if(m_filter!=nullptr)
+    {
+        //Cancel all the requests.
+        m_filter->setLatestGeneration(-1);
+        m_filter->deleteLater();
+    }
 }
 
 KNMusicModel *KNMusicProxyModel::musicModel()
@@ -76,119 +132,192 @@ void KNMusicProxyModel::clearSearchBlock()
 {
     //Clear all the search blocks.
     m_searchBlocks.clear();
-    //Set a filter text to update the whole proxy model.
-    setFilterFixedString("");
+    m_searchPlan=KNMusicSearchPlan();
+    //Stop refining the previous result.
+    m_refineRowsModel=nullptr;
+    //Expire the search rows.
+    m_searchRowsModel=nullptr;
+    //Stop using the asynchronous search result, cancel the running request.
+    cancelAsynchronousSearch();
+    //Update the whole proxy model.
+    refilter();
+    //Search complete.
+    emit searchComplete();
 }
 
 void KNMusicProxyModel::setSearchBlocks(
         const QList<KNMusicSearchBlock> &blockList)
 {
-    //Save the blocks.
+    //Check whether the new blocks only narrow down the current blocks. If so,
+    //the new result must be a part of the current result, only the accepted
+    //rows need to be checked again. When there's a running asynchronous
+    //search, the current result is an old one, it cannot be used.
+    m_refineRowsModel=nullptr;
+    if(!m_filterRunning && isRefinement(blockList))
+    {
+        //The rows are filtered lazily, make sure all of them are filtered.
+        rowCount();
+        //The accepted source rows are recorded while filtering, share them
+        //when the rows of the model is not changed.
+        if(m_acceptedRowsModel!=nullptr &&
+                m_acceptedRowsModel==musicModel() &&
+                m_acceptedRowsGeneration==
+                m_acceptedRowsModel->rowIndexGeneration())
+        {
+            m_refineRows=m_acceptedRows;
+            //Save the model and the generation of the accepted rows.
+            m_refineRowsModel=m_acceptedRowsModel;
+            m_refineRowsGeneration=m_acceptedRowsGeneration;
+        }
+    }
+    //Save the blocks, compile them to the search plan.
     m_searchBlocks=blockList;
-    //Set a filter text to update the whole proxy model.
-    setFilterFixedString("");
+    m_searchPlan=KNMusicSearchPlan(m_searchBlocks);
+    //Expire the search rows.
+    m_searchRowsModel=nullptr;
+    //Try to search in the filter thread.
+    if(requireAsynchronousSearch())
+    {
+        //The result will be applied when the filter finished.
+        return;
+    }
+    //Update the whole proxy model.
+    refilter();
+    //Search complete.
+    emit searchComplete();
 }
 
-bool KNMusicProxyModel::lessThan(const QModelIndex &source_left,
-                                 const QModelIndex &source_right) const
+void KNMusicProxyModel::setAsynchronousSearch(bool asynchronous)
 {
-    //Check out the column.
-    switch(source_left.column())
-    {
-    //For the time role, we have to get the total duration of the row.
-    case Time:
+    //Check the current state.
+    if(asynchronous==(m_filter!=nullptr))
     {
-        //Get the duration role.
-        qlonglong &&leftData=source_left.data(DurationRole).toLongLong(),
-                  &&rightData=source_right.data(DurationRole).toLongLong();
-        //Compare the size, if they are the same, then the adding order is the
-        //right order.
-        return (leftData == rightData) ?
-                    (source_left.row() < source_right.row()) :
-                    (leftData < rightData);
+        return;
     }
-    case Size:
+    //Check whether we need to enable the asynchronous search.
+    if(asynchronous)
     {
-        //Get the file size role.
-        qlonglong &&leftData=source_left.data(FileSizeRole).toLongLong(),
-                &&rightData=source_right.data(FileSizeRole).toLongLong();
-        //Compare the size, if they are the same, then the adding order is the
-        //right order.
-        return (leftData == rightData) ?
-                    (source_left.row() < source_right.row()) :
-                    (leftData < rightData);
+        //Generate the filter, move it to the filter thread.
+        m_filter=new KNMusicProxyFilter;
+        m_filter->moveToThread(knMusicGlobal->filterThread());
+        //Link the filter.
+        connect(this, &KNMusicProxyModel::requireFilter,
+                m_filter, &KNMusicProxyFilter::filter,
+                Qt::QueuedConnection);
+        connect(m_filter, &KNMusicProxyFilter::filterComplete,
+                this, &KNMusicProxyModel::onActionFilterComplete,
+                Qt::QueuedConnection);
+        return;
     }
-    case DiscNumber:
-    case DiscCount:
-    case TrackNumber:
-    case TrackCount:
+    //Stop using the asynchronous search result.
+    cancelAsynchronousSearch();
+    //Cancel all the requests, recover the filter.
+    m_filter->setLatestGeneration(-1);
+    m_filter->deleteLater();
+    m_filter=nullptr;
+}
+
+void KNMusicProxyModel::onActionFilterComplete(int generation,
+                                               QBitArray acceptedRows)
+{
+    //Check whether the result is the latest one.
+    if(generation!=m_filterGeneration)
     {
-        //Get the display role, translate it into an integer.
-        int &&leftData=source_left.data(Qt::DisplayRole).toString().toInt(),
-            &&rightData=source_right.data(Qt::DisplayRole).toString().toInt();
-        //Compare the size, if they are the same, then the adding order is the
-        //right order.
-        return (leftData == rightData) ?
-                    (source_left.row() < source_right.row()) :
-                    (leftData < rightData);
+        //Abandon the stale result.
+        return;
     }
-    case DateAdded:
+    //The request is finished.
+    m_filterRunning=false;
+    //Check whether the model has been changed after the snapshot.
+    if(musicModel()!=nullptr &&
+            musicModel()->rowIndexGeneration()==m_filterRequestRowsGeneration)
     {
-        //Get the date added role, translate it into date time.
-        QDateTime &&leftData=source_left.data(DateAddedRole).toDateTime(),
-                  &&rightData=source_right.data(DateAddedRole).toDateTime();
-        //Compare the size, if they are the same, then the adding order is the
-        //right order.
-        return (leftData == rightData) ?
-                    (source_left.row() < source_right.row()) :
-                    (leftData < rightData);
+        //Save the result.
+        m_filterRows=acceptedRows;
+        m_filterRowsModel=musicModel();
+        m_filterRowsGeneration=m_filterRequestRowsGeneration;
     }
-    case DateModified:
+    //Or else, the result cannot be used, the blocks will be checked in the GUI
+    //thread.
+    //Update the whole proxy model.
+    refilter();
+    //Search complete.
+    emit searchComplete();
+}
+
+bool KNMusicProxyModel::lessThan(const QModelIndex &source_left,
+                                 const QModelIndex &source_right) const
+{
+    //Get the sort column.
+    int column=source_left.column();
+    //Check whether the sort keys of the column has been prepared.
+    if(m_sortKeyColumn!=column)
     {
-        //Get the date modified role, translate it into date time.
-        QDateTime &&leftData=source_left.data(DateModifiedRole).toDateTime(),
-                  &&rightData=source_right.data(DateModifiedRole).toDateTime();
-        //Compare the size, if they are the same, then the adding order is the
-        //right order.
-        return (leftData == rightData) ?
-                    (source_left.row() < source_right.row()) :
-                    (leftData < rightData);
+        //Build the sort keys of the sort column and its tie-breaking columns
+        //once.
+        prepareSortKeys(column);
     }
-    case LastPlayed:
+    //Get the source rows.
+    int leftRow=source_left.row(), rightRow=source_right.row();
+    //Compare the sort column first.
+    int result=compareSortKeys(column, leftRow, rightRow);
+    if(result!=0)
     {
-        //Get the date last played role, translate it into date time.
-        QDateTime &&leftData=source_left.data(DateLastPlayedRole).toDateTime(),
-                 &&rightData=source_right.data(DateLastPlayedRole).toDateTime();
-        //Compare the size, if they are the same, then the adding order is the
-        //right order.
-        return (leftData == rightData) ?
-                    (source_left.row() < source_right.row()) :
-                    (leftData < rightData);
+        return result<0;
     }
+    //The tie-breaking columns and the adding order are always in ascending
+    //order. For the descending order, the proxy model swaps the rows, so swap
+    //the result back.
+    bool descending=(sortOrder()==Qt::DescendingOrder);
+    //Compare the tie-breaking columns.
+    for(auto i : m_sortTieColumns.value(column))
+    {
+        //Compare the tie-breaking column.
+        result=compareSortKeys(i, leftRow, rightRow);
+        if(result!=0)
+        {
+            return descending?(result>0):(result<0);
+        }
     }
-    //Get the display role, translate it into text.
-    QString &&leftData=source_left.data(Qt::DisplayRole).toString(),
-            &&rightData=source_right.data(Qt::DisplayRole).toString();
-    //Compare the size, if they are the same, then the adding order is the
-    //right order.
-    return (leftData == rightData) ?
-                (source_left.row() < source_right.row()) :
-                (leftData < rightData);
+    //If they are all the same, then the adding order is the right order.
+    return descending?(leftRow>rightRow):(leftRow<rightRow);
 }
 
 bool KNMusicProxyModel::filterAcceptsRow(int source_row,
                                          const QModelIndex &source_parent) const
 {
     Q_UNUSED(source_parent)
+    //Check the row.
+    bool accepted=isAcceptedRow(source_row);
+    //Record the result when the rows of the model is not changed after the
+    //whole model is filtered.
+    if(m_acceptedRowsModel!=nullptr && m_acceptedRowsModel==sourceModel() &&
+            m_acceptedRowsGeneration==
+            m_acceptedRowsModel->rowIndexGeneration() &&
+            source_row<m_acceptedRows.size())
+    {
+        m_acceptedRows.setBit(source_row, accepted);
+    }
+    return accepted;
+}
+
+inline bool KNMusicProxyModel::isAcceptedRow(int source_row) const
+{
     //Get the source model.
     QAbstractItemModel *model=sourceModel();
+    //Check whether the asynchronous search result could be used. It contains
+    //both the category and the search result.
+    if(m_filterRowsModel!=nullptr && m_filterRowsModel==model &&
+            m_filterRowsGeneration==m_filterRowsModel->rowIndexGeneration())
+    {
+        return source_row<m_filterRows.size() &&
+                m_filterRows.testBit(source_row);
+    }
     //Check the validation of category column.
     if(m_categoryColumn!=-1)
     {
-        //Check out the category column data.
-        if(model->index(source_row,
-                        m_categoryColumn).data(Qt::DisplayRole).toString() !=
-                m_categoryContent)
+        //Check out the category rows.
+        if(!isCategoryRow(source_row))
         {
             //Abandon the data which didn't match the category content.
             return false;
@@ -201,12 +330,179 @@ bool KNMusicProxyModel::filterAcceptsRow(int source_row,
         //All the row will become accept if there's no blocks filter.
         return true;
     }
-    //Check if the row comply with the limits.
+    //When refining the previous result, the row which was not accepted cannot
+    //match the blocks.
+    if(isRefineRowsValid() &&
+            (source_row>=m_refineRows.size() ||
+             !m_refineRows.testBit(source_row)))
+    {
+        return false;
+    }
+    //Check the search index first, the row which is not a candidate cannot
+    //match the blocks.
+    if(!isSearchCandidateRow(source_row))
+    {
+        return false;
+    }
+    //Check if the row comply with the search plan.
+    return m_searchPlan.match(
+                static_cast<KNMusicModel *>(model)->detailInfoAt(source_row));
+}
+
+inline bool KNMusicProxyModel::isRefineRowsValid() const
+{
+    //The refine rows is valid only when the rows of the model is not changed.
+    return m_refineRowsModel!=nullptr && m_refineRowsModel==sourceModel() &&
+            m_refineRowsGeneration==m_refineRowsModel->rowIndexGeneration();
+}
+
+inline QBitArray KNMusicProxyModel::candidateRows() const
+{
+    //Get the source music model.
+    KNMusicModel *model=static_cast<KNMusicModel *>(sourceModel());
+    //Start from all the rows.
+    QBitArray rows(model->rowCount(), true);
+    //Only the rows of the category content could be accepted.
+    if(m_categoryColumn!=-1)
+    {
+        updateCategoryRows();
+        rows&=m_categoryRows;
+    }
+    //Only the candidates of the search index could match the blocks.
+    updateSearchRows();
+    if(m_searchRowsFiltered)
+    {
+        rows&=m_searchRows;
+    }
+    //When refining the previous result, only the accepted rows could match.
+    if(isRefineRowsValid())
+    {
+        rows&=m_refineRows;
+    }
+    return rows;
+}
+
+inline void KNMusicProxyModel::updateCategoryRows() const
+{
+    //Get the source music model.
+    KNMusicModel *model=static_cast<KNMusicModel *>(sourceModel());
+    //Check whether the category rows are expired.
+    if(m_categoryRowsModel!=model ||
+            m_categoryRowsGeneration!=model->rowIndexGeneration())
+    {
+        //Reset the category row flags.
+        m_categoryRows.fill(false, model->rowCount());
+        //Mark all the rows of the category content from the row index.
+        for(auto i : model->categoryRows(m_categoryColumn, m_categoryContent))
+        {
+            m_categoryRows.setBit(i);
+        }
+        //Save the model and the generation of the category rows.
+        m_categoryRowsModel=model;
+        m_categoryRowsGeneration=model->rowIndexGeneration();
+    }
+}
+
+inline bool KNMusicProxyModel::isCategoryRow(int row) const
+{
+    //Check the model.
+    if(sourceModel()==nullptr)
+    {
+        return false;
+    }
+    //Update the category rows.
+    updateCategoryRows();
+    //Check the row flag.
+    return row<m_categoryRows.size() && m_categoryRows.testBit(row);
+}
+
+inline void KNMusicProxyModel::updateSearchRows() const
+{
+    //Get the source music model.
+    KNMusicModel *model=static_cast<KNMusicModel *>(sourceModel());
+    //Check whether the search rows are expired.
+    if(m_searchRowsModel!=model ||
+            m_searchRowsGeneration!=model->rowIndexGeneration())
+    {
+        //Reset the search rows, all the rows are candidates.
+        m_searchRowsFiltered=false;
+        //Find the candidate rows of all the texts which must be matched.
+        for(auto i : m_searchPlan.indexedTexts())
+        {
+            //Find the candidate rows of the text.
+            QVector<int> candidateRows;
+            if(!model->searchCandidateRows(i, candidateRows))
+            {
+                //The text is too short to use the index.
+                continue;
+            }
+            //Mark the candidate rows.
+            QBitArray blockRows(model->rowCount());
+            for(auto j : candidateRows)
+            {
+                blockRows.setBit(j);
+            }
+            //The row should be the candidate of all the blocks.
+            if(m_searchRowsFiltered)
+            {
+                m_searchRows&=blockRows;
+            }
+            else
+            {
+                m_searchRows=blockRows;
+                m_searchRowsFiltered=true;
+            }
+        }
+        //Save the model and the generation of the search rows.
+        m_searchRowsModel=model;
+        m_searchRowsGeneration=model->rowIndexGeneration();
+    }
+}
+
+inline bool KNMusicProxyModel::isSearchCandidateRow(int row) const
+{
+    //Update the search rows.
+    updateSearchRows();
+    //Check the row flag.
+    return !m_searchRowsFiltered ||
+            (row<m_searchRows.size() && m_searchRows.testBit(row));
+}
+
+inline bool KNMusicProxyModel::isRefinement(
+        const QList<KNMusicSearchBlock> &blockList) const
+{
+    //When there's no block, all the rows are accepted, nothing to refine.
+    if(m_searchBlocks.isEmpty())
+    {
+        return false;
+    }
+    //When every block matches the text by containing, the new block list is a
+    //refinement when each current block has a new block on the same column or
+    //property whose text contains the current text.
     for(auto i : m_searchBlocks)
     {
-        //Check the the rule, if the row can not match one rule, then it cannot
-        //be accept.
-        if(!checkRule(model, source_row, i))
+        //Only the positive containing block could be narrowed.
+        if(!isContainingBlock(i))
+        {
+            return false;
+        }
+        //Get the current block search key.
+        QString &&blockText=KNMusicUtil::searchKey(i.value.toString());
+        //Find the narrower block.
+        bool found=false;
+        for(auto j : blockList)
+        {
+            if(isContainingBlock(j) &&
+                    j.index==i.index && j.isColumn==i.isColumn &&
+                    KNMusicUtil::searchKey(j.value.toString()).contains(
+                        blockText))
+            {
+                found=true;
+                break;
+            }
+        }
+        //If any block is not narrowed, the result could be larger.
+        if(!found)
         {
             return false;
         }
@@ -214,51 +510,338 @@ bool KNMusicProxyModel::filterAcceptsRow(int source_row,
     return true;
 }
 
-inline bool KNMusicProxyModel::checkRule(QAbstractItemModel *model,
-                                         const int &row,
-                                         const KNMusicSearchBlock &block) const
+inline bool KNMusicProxyModel::isContainingBlock(
+        const KNMusicSearchBlock &block) const
 {
-    //Check if this block a common search block,
-    if(block.index==-1)
+    //The block should be a positive text block which is not in a group.
+    return block.comparison==SearchContains && block.group==-1 &&
+            !block.isNegative;
+}
+
+QList<int> KNMusicProxyModel::sortTieColumns(int column) const
+{
+    return m_sortTieColumns.value(column);
+}
+
+void KNMusicProxyModel::setSortTieColumns(int column,
+                                          const QList<int> &tieColumns)
+{
+    //Save the tie-breaking columns.
+    m_sortTieColumns.insert(column, tieColumns);
+    //Check whether the model is sorted by the column.
+    if(sortColumn()==column)
     {
-        //Translate the format of the search block data to QString.
-        QString &&ruleText=block.value.toString();
-        //Search the text in all column.
-        for(int i=0; i<MusicColumnCount; i++)
+        //Prepare the keys again and sort the model.
+        m_sortKeyColumn=-1;
+        invalidate();
+    }
+}
+
+void KNMusicProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    //Disconnect the previous source model.
+    m_sourceHandler.disconnectAll();
+    //Clear the sort keys.
+    clearSortKeys();
+    //Link the source model to keep the sort keys updated. These connections
+    //must be made before the proxy model's own, so the keys will be updated
+    //before the proxy model sorts the changed rows.
+    if(sourceModel!=nullptr)
+    {
+        m_sourceHandler+=connect(
+                    sourceModel, &QAbstractItemModel::dataChanged,
+                    this, &KNMusicProxyModel::onActionSourceDataChanged);
+        m_sourceHandler+=connect(
+                    sourceModel, &QAbstractItemModel::rowsInserted,
+                    this, &KNMusicProxyModel::onActionSourceRowsInserted);
+        m_sourceHandler+=connect(
+                    sourceModel, &QAbstractItemModel::rowsRemoved,
+                    this, &KNMusicProxyModel::onActionSourceRowsRemoved);
+        m_sourceHandler+=connect(
+                    sourceModel, &QAbstractItemModel::rowsMoved,
+                    this, &KNMusicProxyModel::onActionSourceLayoutChanged);
+        m_sourceHandler+=connect(
+                    sourceModel, &QAbstractItemModel::layoutChanged,
+                    this, &KNMusicProxyModel::onActionSourceLayoutChanged);
+        m_sourceHandler+=connect(
+                    sourceModel, &QAbstractItemModel::modelReset,
+                    this, &KNMusicProxyModel::onActionSourceLayoutChanged);
+    }
+    //Set the source model.
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+void KNMusicProxyModel::onActionSourceDataChanged(
+        const QModelIndex &topLeft,
+        const QModelIndex &bottomRight)
+{
+    //Update the numeric sort keys of the changed rows.
+    for(auto i=m_numericSortKeys.begin(); i!=m_numericSortKeys.end(); ++i)
+    {
+        //Check whether the column is changed.
+        if(i.key()>=topLeft.column() && i.key()<=bottomRight.column())
         {
-            //Search the rule text in the whole data.
-            if(model->index(row, i).data(Qt::DisplayRole).toString().
-                    contains(ruleText, Qt::CaseInsensitive))
+            for(int row=topLeft.row(); row<=bottomRight.row(); ++row)
             {
-                //Once match, then it should be true.
-                return true;
+                i.value()[row]=numericSortKey(row, i.key());
             }
         }
-        return false;
     }
-    //Or else, check the specific column.
-    if(block.isColumn)
+    //Update the text sort keys of the changed rows.
+    for(auto i=m_textSortKeys.begin(); i!=m_textSortKeys.end(); ++i)
+    {
+        //Check whether the column is changed.
+        if(i.key()>=topLeft.column() && i.key()<=bottomRight.column())
+        {
+            for(int row=topLeft.row(); row<=bottomRight.row(); ++row)
+            {
+                i.value()[row]=textSortKey(row, i.key());
+            }
+        }
+    }
+}
+
+void KNMusicProxyModel::onActionSourceRowsInserted(const QModelIndex &parent,
+                                                   int first,
+                                                   int last)
+{
+    Q_UNUSED(parent)
+    //Insert the sort keys of the new rows.
+    for(int row=first; row<=last; ++row)
     {
-        //Check the block index, for most of the blocks, simply match the string
-        //in the text.
-        switch(block.index)
+        for(auto i=m_numericSortKeys.begin(); i!=m_numericSortKeys.end(); ++i)
+        {
+            i.value().insert(row, numericSortKey(row, i.key()));
+        }
+        for(auto i=m_textSortKeys.begin(); i!=m_textSortKeys.end(); ++i)
         {
-        default:
-            return model->data(model->index(row, block.index), Qt::DisplayRole)
-                    .toString().contains(block.value.toString(),
-                                         Qt::CaseInsensitive);
+            i.value().insert(row, textSortKey(row, i.key()));
         }
     }
-    //So now it should be a property of the data.
-    //Get the data from the Name column.
-    QVariant &&propertyData=model->data(model->index(row, 0), block.index);
-    //Check the data.
-    switch(block.index)
+}
+
+void KNMusicProxyModel::onActionSourceRowsRemoved(const QModelIndex &parent,
+                                                  int first,
+                                                  int last)
+{
+    Q_UNUSED(parent)
+    //Remove the sort keys of the removed rows.
+    for(auto i=m_numericSortKeys.begin(); i!=m_numericSortKeys.end(); ++i)
+    {
+        i.value().remove(first, last-first+1);
+    }
+    for(auto i=m_textSortKeys.begin(); i!=m_textSortKeys.end(); ++i)
+    {
+        i.value().erase(i.value().begin()+first, i.value().begin()+last+1);
+    }
+}
+
+void KNMusicProxyModel::onActionSourceLayoutChanged()
+{
+    //The rows are moved, the sort keys will be rebuilt when sorting.
+    clearSortKeys();
+}
+
+inline bool KNMusicProxyModel::isNumericSortColumn(int column) const
+{
+    //Check the column.
+    switch(column)
+    {
+    case Time:
+    case Size:
+    case DiscNumber:
+    case DiscCount:
+    case TrackNumber:
+    case TrackCount:
+    case DateAdded:
+    case DateModified:
+    case LastPlayed:
+        return true;
+    default:
+        return false;
+    }
+}
+
+inline qint64 KNMusicProxyModel::numericSortKey(int row, int column) const
+{
+    //Get the source model.
+    QAbstractItemModel *model=sourceModel();
+    //Get the data index of the row.
+    QModelIndex &&dataIndex=model->index(row, column);
+    //Check out the column.
+    switch(column)
     {
+    //For the time role, we have to get the total duration of the row.
+    case Time:
+        return dataIndex.data(DurationRole).toLongLong();
+    case Size:
+        return dataIndex.data(FileSizeRole).toLongLong();
+    case DiscNumber:
+    case DiscCount:
+    case TrackNumber:
+    case TrackCount:
+        //Get the display role, translate it into an integer.
+        return dataIndex.data(Qt::DisplayRole).toString().toInt();
     default:
-        return propertyData.toString().contains(block.value.toString(),
-                                                Qt::CaseInsensitive);
+    {
+        //Get the date time of the date columns.
+        QDateTime &&dateTime=dataIndex.data(
+                    column==DateAdded?
+                        DateAddedRole:
+                        (column==DateModified?
+                             DateModifiedRole:
+                             DateLastPlayedRole)).toDateTime();
+        //The invalid date time will be the smallest one.
+        return dateTime.isValid()?
+                    dateTime.toMSecsSinceEpoch():
+                    std::numeric_limits<qint64>::min();
+    }
+    }
+}
+
+inline QCollatorSortKey KNMusicProxyModel::textSortKey(int row,
+                                                       int column) const
+{
+    //Get the display role, generate the collator key.
+    return m_collator.sortKey(
+                sourceModel()->index(row, column).data(
+                    Qt::DisplayRole).toString());
+}
+
+inline int KNMusicProxyModel::compareSortKeys(int column,
+                                              int leftRow,
+                                              int rightRow) const
+{
+    //Check the column type.
+    if(isNumericSortColumn(column))
+    {
+        //Get the numeric keys.
+        const QVector<qint64> &keys=m_numericSortKeys[column];
+        qint64 leftKey=keys.at(leftRow), rightKey=keys.at(rightRow);
+        return (leftKey==rightKey)?0:(leftKey<rightKey?-1:1);
+    }
+    //Compare the collator keys.
+    const QList<QCollatorSortKey> &keys=m_textSortKeys[column];
+    return keys.at(leftRow).compare(keys.at(rightRow));
+}
+
+inline void KNMusicProxyModel::prepareSortKeys(int column) const
+{
+    //Get all the columns needed by the sort.
+    QList<int> sortColumns=m_sortTieColumns.value(column);
+    sortColumns.prepend(column);
+    //Remove the keys of the columns which are not used any more.
+    for(auto i=m_numericSortKeys.begin(); i!=m_numericSortKeys.end();)
+    {
+        i=sortColumns.contains(i.key())?i+1:m_numericSortKeys.erase(i);
+    }
+    for(auto i=m_textSortKeys.begin(); i!=m_textSortKeys.end();)
+    {
+        i=sortColumns.contains(i.key())?i+1:m_textSortKeys.erase(i);
+    }
+    //Get the row count of the source model.
+    int rowCount=sourceModel()->rowCount();
+    //Generate the keys of the columns which haven't been built.
+    for(auto i : sortColumns)
+    {
+        if(isNumericSortColumn(i))
+        {
+            //Check whether the keys exist.
+            if(m_numericSortKeys.contains(i))
+            {
+                continue;
+            }
+            //Generate the keys for all the rows.
+            QVector<qint64> &keys=m_numericSortKeys[i];
+            keys.reserve(rowCount);
+            for(int row=0; row<rowCount; ++row)
+            {
+                keys.append(numericSortKey(row, i));
+            }
+        }
+        else
+        {
+            //Check whether the keys exist.
+            if(m_textSortKeys.contains(i))
+            {
+                continue;
+            }
+            //Generate the keys for all the rows.
+            QList<QCollatorSortKey> &keys=m_textSortKeys[i];
+            keys.reserve(rowCount);
+            for(int row=0; row<rowCount; ++row)
+            {
+                keys.append(textSortKey(row, i));
+            }
+        }
+    }
+    //Save the column.
+    m_sortKeyColumn=column;
+}
+
+inline void KNMusicProxyModel::clearSortKeys()
+{
+    //Remove all the keys.
+    m_numericSortKeys.clear();
+    m_textSortKeys.clear();
+    m_sortKeyColumn=-1;
+}
+
+inline void KNMusicProxyModel::cancelAsynchronousSearch()
+{
+    //Stop using the previous asynchronous search result.
+    m_filterRowsModel=nullptr;
+    m_filterRunning=false;
+    //Increase the generation, the result of the running request will be
+    //abandoned.
+    ++m_filterGeneration;
+    if(m_filter!=nullptr)
+    {
+        //Cancel the running request.
+        m_filter->setLatestGeneration(m_filterGeneration);
+    }
+}
+
+inline bool KNMusicProxyModel::requireAsynchronousSearch()
+{
+    //Stop using the previous asynchronous search result.
+    cancelAsynchronousSearch();
+    //Check whether the asynchronous search is enabled.
+    if(m_filter==nullptr)
+    {
+        return false;
     }
+    //Get the music model, and check the blocks. Clearing the blocks is fast
+    //enough to be done in the GUI thread.
+    KNMusicModel *model=musicModel();
+    if(model==nullptr || m_searchBlocks.isEmpty())
+    {
+        return false;
+    }
+    //Save the rows generation of the snapshot.
+    m_filterRequestRowsGeneration=model->rowIndexGeneration();
+    m_filterRunning=true;
+    //Send the snapshot to the filter, the filter only checks the candidate
+    //rows.
+    emit requireFilter(m_filterGeneration,
+                       model->detailInfos(),
+                       candidateRows(),
+                       m_searchBlocks);
+    return true;
+}
+
+inline void KNMusicProxyModel::refilter()
+{
+    //Record the accepted rows while filtering the whole model, a narrower
+    //search only needs to check them again.
+    m_acceptedRowsModel=musicModel();
+    if(m_acceptedRowsModel!=nullptr)
+    {
+        m_acceptedRows.fill(false, m_acceptedRowsModel->rowCount());
+        m_acceptedRowsGeneration=m_acceptedRowsModel->rowIndexGeneration();
+    }
+    //Set a filter text to update the whole proxy model.
+    setFilterFixedString("");
 }
 
 QString KNMusicProxyModel::categoryContent() const
@@ -271,8 +854,14 @@ void KNMusicProxyModel::setCategoryContent(const QString &categoryContent)
 {
     //Save the category content.
     m_categoryContent = categoryContent;
-    //Set a filter text to update the whole proxy model.
-    setFilterFixedString("");
+    //Stop refining the previous result.
+    m_refineRowsModel=nullptr;
+    //The asynchronous search result is for the previous category.
+    cancelAsynchronousSearch();
+    //Expire the category rows.
+    m_categoryRowsModel=nullptr;
+    //Update the whole proxy model.
+    refilter();
 }
 
 int KNMusicProxyModel::categoryColumn() const
@@ -284,6 +873,12 @@ void KNMusicProxyModel::setCategoryColumn(int categoryColumn)
 {
     //Save the categroy column.
     m_categoryColumn = categoryColumn;
-    //Set a filter text to update the whole proxy model.
-    setFilterFixedString("");
+    //Stop refining the previous result.
+    m_refineRowsModel=nullptr;
+    //The asynchronous search result is for the previous category.
+    cancelAsynchronousSearch();
+    //Expire the category rows.
+    m_categoryRowsModel=nullptr;
+    //Update the whole proxy model.
+    refilter();
 }
@@ -19,13 +19,19 @@
 #ifndef KNMUSICPROXYMODEL_H
 #define KNMUSICPROXYMODEL_H
 
+#include "knconnectionhandler.h"
+
+#include "knmusicsearchplan.h"
 #include "knmusicutil.h"
 
+#include <QBitArray>
+#include <QCollator>
 #include <QSortFilterProxyModel>
 
 using namespace MusicUtil;
 
 class KNMusicModel;
+class KNMusicProxyFilter;
 class KNMusicProxyModel : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -35,6 +41,7 @@ public:
      * \param parent The parent object.
      */
     explicit KNMusicProxyModel(QObject *parent = 0);
+    ~KNMusicProxyModel();
 
     /*!
      * \brief Get the source model as a music model.
@@ -76,7 +83,60 @@ public:
 
     QString categoryContent() const;
 
+    /*!
+     * \brief Enable or disable the asynchronous search. When it's enabled, the
+     * search blocks will be checked in the filter thread with a snapshot of
+     * the music model, the search result will be applied when the filter
+     * finished. Before that, the previous result will be kept.\n
+     * It should only be enabled for the model which is used for displaying,
+     * because the result of setSearchBlocks() won't be ready at once.
+     * \param asynchronous To enable the asynchronous search, set it to true.
+     */
+    void setAsynchronousSearch(bool asynchronous);
+
+    /*!
+     * \brief Get the tie-breaking columns of a sort column.
+     * \param column The sort column.
+     * \return The tie-breaking column list.
+     */
+    QList<int> sortTieColumns(int column) const;
+
+    /*!
+     * \brief Set the tie-breaking columns of a sort column. When two rows have
+     * the same data in the sort column, they will be compared by the
+     * tie-breaking columns one by one in ascending order, and then the adding
+     * order. By default, the album columns and the artist columns will keep
+     * the album order of the songs.
+     * \param column The sort column.
+     * \param tieColumns The tie-breaking column list.
+     */
+    void setSortTieColumns(int column, const QList<int> &tieColumns);
+
+    /*!
+     * \brief Reimplemented from QSortFilterProxyModel::setSourceModel().
+     */
+    void setSourceModel(QAbstractItemModel *sourceModel) Q_DECL_OVERRIDE;
+
 signals:
+    /*!
+     * \brief When the search blocks are applied to the model, this signal will
+     * be emitted. For an asynchronous search, it will be emitted when the
+     * search result is ready.
+     */
+    void searchComplete();
+
+    /*!
+     * \brief Ask the filter to filter the snapshot of the music model.
+     * \param generation The request generation.
+     * \param detailInfos The detail info snapshot.
+     * \param blocks The search blocks.
+     * \param categoryColumn The category column.
+     * \param categoryContent The category content.
+     */
+    void requireFilter(int generation,
+                       QList<KNMusicDetailInfo> detailInfos,
+                       QBitArray candidateRows,
+                       QList<KNMusicSearchBlock> blocks);
 
 public slots:
     /*!
@@ -110,11 +170,63 @@ protected:
                           const QModelIndex &source_parent) const
     Q_DECL_OVERRIDE;
 
+private slots:
+    void onActionFilterComplete(int generation, QBitArray acceptedRows);
+    void onActionSourceDataChanged(const QModelIndex &topLeft,
+                                   const QModelIndex &bottomRight);
+    void onActionSourceRowsInserted(const QModelIndex &parent,
+                                    int first,
+                                    int last);
+    void onActionSourceRowsRemoved(const QModelIndex &parent,
+                                   int first,
+                                   int last);
+    void onActionSourceLayoutChanged();
+
 private:
-    inline bool checkRule(QAbstractItemModel *model,
-                                const int &row,
-                                const KNMusicSearchBlock &block) const;
+    inline bool isNumericSortColumn(int column) const;
+    inline qint64 numericSortKey(int row, int column) const;
+    inline QCollatorSortKey textSortKey(int row, int column) const;
+    inline int compareSortKeys(int column, int leftRow, int rightRow) const;
+    inline void prepareSortKeys(int column) const;
+    inline void clearSortKeys();
+    inline void cancelAsynchronousSearch();
+    inline bool requireAsynchronousSearch();
+    inline void refilter();
+    inline bool isAcceptedRow(int row) const;
+    inline bool isRefineRowsValid() const;
+    inline QBitArray candidateRows() const;
+    inline void updateCategoryRows() const;
+    inline void updateSearchRows() const;
+    inline bool isCategoryRow(int row) const;
+    inline bool isSearchCandidateRow(int row) const;
+    inline bool isContainingBlock(const KNMusicSearchBlock &block) const;
+    inline bool isRefinement(const QList<KNMusicSearchBlock> &blockList) const;
     QList<KNMusicSearchBlock> m_searchBlocks;
+    KNMusicSearchPlan m_searchPlan;
+    QCollator m_collator;
+    KNConnectionHandler m_sourceHandler;
+    QHash<int, QList<int>> m_sortTieColumns;
+    mutable QHash<int, QVector<qint64>> m_numericSortKeys;
+    mutable QHash<int, QList<QCollatorSortKey>> m_textSortKeys;
+    mutable int m_sortKeyColumn;
+    KNMusicProxyFilter *m_filter;
+    QBitArray m_filterRows;
+    quint64 m_filterRowsGeneration, m_filterRequestRowsGeneration;
+    KNMusicModel *m_filterRowsModel;
+    int m_filterGeneration;
+    bool m_filterRunning;
+    QBitArray m_refineRows;
+    quint64 m_refineRowsGeneration;
+    KNMusicModel *m_refineRowsModel;
+    mutable QBitArray m_acceptedRows;
+    quint64 m_acceptedRowsGeneration;
+    KNMusicModel *m_acceptedRowsModel;
+    mutable QBitArray m_categoryRows, m_searchRows;
+    mutable quint64 m_searchRowsGeneration;
+    mutable KNMusicModel *m_searchRowsModel;
+    mutable bool m_searchRowsFiltered;
+    mutable quint64 m_categoryRowsGeneration;
+    mutable KNMusicModel *m_categoryRowsModel;
     int m_categoryColumn;
     QString m_categoryContent;
 };
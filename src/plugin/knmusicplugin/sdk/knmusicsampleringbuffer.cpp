@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <cstring>
+
+#include "knmusicsampleringbuffer.h"
+
+KNMusicSampleRingBuffer::KNMusicSampleRingBuffer(int capacity) :
+    m_buffer(QVector<float>()),
+    m_readIndex(0),
+    m_writeIndex(0),
+    m_closed(0),
+    m_mask(0)
+{
+    //Allocate the buffer.
+    setCapacity(capacity);
+}
+
+int KNMusicSampleRingBuffer::capacity() const
+{
+    return m_buffer.size();
+}
+
+void KNMusicSampleRingBuffer::setCapacity(int capacity)
+{
+    //Round the capacity up to the power of 2, the index could be wrapped with
+    //the mask then.
+    quint32 roundedCapacity=1;
+    while((int)roundedCapacity<capacity)
+    {
+        roundedCapacity<<=1;
+    }
+    //Reallocate the buffer.
+    m_buffer=QVector<float>((int)roundedCapacity, 0.0f);
+    m_mask=roundedCapacity-1;
+    //Clear the buffer.
+    clear();
+}
+
+void KNMusicSampleRingBuffer::clear()
+{
+    //Reset the indexes and the closed flag.
+    m_readIndex.storeRelease(0);
+    m_writeIndex.storeRelease(0);
+    m_closed.storeRelease(0);
+}
+
+int KNMusicSampleRingBuffer::available() const
+{
+    //The indexes are never wrapped, the difference is the sample count.
+    return (int)(m_writeIndex.loadAcquire()-m_readIndex.loadAcquire());
+}
+
+int KNMusicSampleRingBuffer::space() const
+{
+    return m_buffer.size()-available();
+}
+
+int KNMusicSampleRingBuffer::write(const float *samples, int count)
+{
+    //Only the producer changes the write index, the read index is acquired to
+    //make sure the samples are read before they are overwritten.
+    quint32 writeIndex=m_writeIndex.load(),
+            readIndex=m_readIndex.loadAcquire();
+    //Check the free space.
+    count=qMin(count, m_buffer.size()-(int)(writeIndex-readIndex));
+    if(count<=0)
+    {
+        return 0;
+    }
+    //Copy the samples, the data might be wrapped to the beginning.
+    int start=(int)(writeIndex & m_mask),
+        firstPart=qMin(count, m_buffer.size()-start);
+    float *buffer=m_buffer.data();
+    memcpy(buffer+start, samples, firstPart*sizeof(float));
+    memcpy(buffer, samples+firstPart, (count-firstPart)*sizeof(float));
+    //Publish the samples to the consumer.
+    m_writeIndex.storeRelease(writeIndex+(quint32)count);
+    return count;
+}
+
+int KNMusicSampleRingBuffer::read(float *samples, int count)
+{
+    //Only the consumer changes the read index, the write index is acquired to
+    //make sure the samples are written before they are read.
+    quint32 readIndex=m_readIndex.load(),
+            writeIndex=m_writeIndex.loadAcquire();
+    //Check the available samples.
+    count=qMin(count, (int)(writeIndex-readIndex));
+    if(count<=0)
+    {
+        return 0;
+    }
+    //Copy the samples, the data might be wrapped to the beginning.
+    int start=(int)(readIndex & m_mask),
+        firstPart=qMin(count, m_buffer.size()-start);
+    const float *buffer=m_buffer.constData();
+    memcpy(samples, buffer+start, firstPart*sizeof(float));
+    memcpy(samples+firstPart, buffer, (count-firstPart)*sizeof(float));
+    //Give the space back to the producer.
+    m_readIndex.storeRelease(readIndex+(quint32)count);
+    return count;
+}
+
+void KNMusicSampleRingBuffer::close()
+{
+    m_closed.storeRelease(1);
+}
+
+bool KNMusicSampleRingBuffer::isClosed() const
+{
+    return m_closed.loadAcquire()!=0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICSAMPLERINGBUFFER_H
+#define KNMUSICSAMPLERINGBUFFER_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+/*!
+ * \brief The KNMusicSampleRingBuffer class is a lock-free ring buffer of audio
+ * samples for one producer thread and one consumer thread, e.g. a decoder and
+ * an audio output.\n
+ * The read and write indexes are only increased by their own side, so neither
+ * side has to wait for the other one. The producer could close the buffer when
+ * there won't be any more samples, the consumer should stop after reading all
+ * the rest samples then.
+ */
+class KNMusicSampleRingBuffer
+{
+public:
+    /*!
+     * \brief Construct a KNMusicSampleRingBuffer.
+     * \param capacity The sample count the buffer could hold, it will be
+     * rounded up to the power of 2.
+     */
+    explicit KNMusicSampleRingBuffer(int capacity=0);
+
+    /*!
+     * \brief Get the sample count the buffer could hold.
+     * \return The capacity of the buffer.
+     */
+    int capacity() const;
+
+    /*!
+     * \brief Change the capacity of the buffer, all the samples in the buffer
+     * will be cleared. This should only be called when neither the producer nor
+     * the consumer is working.
+     * \param capacity The sample count the buffer could hold.
+     */
+    void setCapacity(int capacity);
+
+    /*!
+     * \brief Clear all the samples in the buffer and reopen it. This should
+     * only be called when neither the producer nor the consumer is working.
+     */
+    void clear();
+
+    /*!
+     * \brief Get the sample count which could be read. This should be called
+     * by the consumer.
+     * \return The readable sample count.
+     */
+    int available() const;
+
+    /*!
+     * \brief Get the sample count which could be written. This should be
+     * called by the producer.
+     * \return The writable sample count.
+     */
+    int space() const;
+
+    /*!
+     * \brief Write samples to the buffer. This should only be called by the
+     * producer.
+     * \param samples The sample data.
+     * \param count The sample count of the data.
+     * \return The sample count which is actually written, it could be less
+     * than the count when the buffer is full.
+     */
+    int write(const float *samples, int count);
+
+    /*!
+     * \brief Read samples from the buffer. This should only be called by the
+     * consumer.
+     * \param samples The target data.
+     * \param count The maximum sample count to read.
+     * \return The sample count which is actually read.
+     */
+    int read(float *samples, int count);
+
+    /*!
+     * \brief Mark that there won't be any more samples. This should be called
+     * by the producer after all the samples are written.
+     */
+    void close();
+
+    /*!
+     * \brief Check whether the producer closed the buffer.
+     * \return If the buffer is closed, return true.
+     */
+    bool isClosed() const;
+
+private:
+    QVector<float> m_buffer;
+    QAtomicInteger<quint32> m_readIndex, m_writeIndex;
+    QAtomicInt m_closed;
+    quint32 m_mask;
+};
+
+#endif // KNMUSICSAMPLERINGBUFFER_H
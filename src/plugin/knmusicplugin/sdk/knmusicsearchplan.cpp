@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QHash>
+
+#include <algorithm>
+
+#include "knmusicsearchplan.h"
+
+KNMusicSearchPlan::KNMusicSearchPlan() :
+    m_clauses(QList<SearchClause>())
+{
+}
+
+KNMusicSearchPlan::KNMusicSearchPlan(const QList<KNMusicSearchBlock> &blocks) :
+    m_clauses(QList<SearchClause>())
+{
+    //Group the blocks into clauses.
+    QHash<int, int> groupClauses;
+    for(const auto &i : blocks)
+    {
+        //Copy the block, the value might be normalised.
+        KNMusicSearchBlock block=i;
+        //Normalise the text of the text block once, so it could be compared
+        //with the search keys directly.
+        if(block.comparison==SearchContains || block.comparison==SearchEqual)
+        {
+            block.value=KNMusicUtil::searchKey(block.value.toString());
+        }
+        //Find the clause of the group.
+        int clauseIndex=(block.group==-1)?
+                    -1:groupClauses.value(block.group, -1);
+        if(clauseIndex==-1)
+        {
+            //Create a new clause for the block.
+            clauseIndex=m_clauses.size();
+            m_clauses.append(SearchClause());
+            //Save the clause of the group.
+            if(block.group!=-1)
+            {
+                groupClauses.insert(block.group, clauseIndex);
+            }
+        }
+        //Add the block to the clause, the cost of an OR clause is the total
+        //cost of its blocks.
+        SearchClause &clause=m_clauses[clauseIndex];
+        clause.blocks.append(block);
+        clause.cost+=blockCost(block);
+    }
+    //Check the cheap clauses first. Keep the order of the same cost, which is
+    //the order of the user typed.
+    std::stable_sort(m_clauses.begin(), m_clauses.end(),
+                     [](const SearchClause &left, const SearchClause &right)
+                     {
+                         return left.cost<right.cost;
+                     });
+}
+
+bool KNMusicSearchPlan::isEmpty() const
+{
+    return m_clauses.isEmpty();
+}
+
+bool KNMusicSearchPlan::match(const KNMusicDetailInfo &detailInfo) const
+{
+    //Check all the clauses.
+    for(const auto &i : m_clauses)
+    {
+        //Check whether any block of the clause matches.
+        bool matched=false;
+        for(const auto &j : i.blocks)
+        {
+            if(checkBlock(detailInfo, j))
+            {
+                matched=true;
+                break;
+            }
+        }
+        //If any clause doesn't match, the row cannot be accepted.
+        if(!matched)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+QStringList KNMusicSearchPlan::indexedTexts() const
+{
+    QStringList texts;
+    //Only the clause which has one positive text block of a column must match
+    //the text.
+    for(const auto &i : m_clauses)
+    {
+        //Check the clause.
+        if(i.blocks.size()!=1)
+        {
+            continue;
+        }
+        //Check the block.
+        const KNMusicSearchBlock &block=i.blocks.first();
+        if(block.isColumn && block.index>-1 && block.index<MusicDataCount &&
+                !block.isNegative &&
+                (block.comparison==SearchContains ||
+                 block.comparison==SearchEqual))
+        {
+            texts.append(block.value.toString());
+        }
+    }
+    return texts;
+}
+
+bool KNMusicSearchPlan::isNumericColumn(int column)
+{
+    switch(column)
+    {
+    case AlbumRating:
+    case BeatsPerMinuate:
+    case BitRate:
+    case DateAdded:
+    case DateModified:
+    case DiscCount:
+    case DiscNumber:
+    case LastPlayed:
+    case Plays:
+    case Rating:
+    case SampleRate:
+    case Size:
+    case Time:
+    case TrackCount:
+    case TrackNumber:
+    case Year:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool KNMusicSearchPlan::numericValue(const KNMusicDetailInfo &detailInfo,
+                                     int column,
+                                     qint64 &value)
+{
+    //Check the column.
+    switch(column)
+    {
+    case BitRate:
+        value=detailInfo.bitRate;
+        return true;
+    case SampleRate:
+        value=detailInfo.samplingRate;
+        return true;
+    case Size:
+        value=detailInfo.size;
+        return true;
+    case Time:
+        value=detailInfo.duration;
+        return true;
+    case DateAdded:
+    case DateModified:
+    case LastPlayed:
+    {
+        //Get the date of the column.
+        const QDateTime &dateTime=(column==DateAdded)?
+                    detailInfo.dateAdded:
+                    ((column==DateModified)?
+                         detailInfo.dateModified:
+                         detailInfo.dateLastPlayed);
+        //The invalid date doesn't have a value.
+        if(!dateTime.isValid())
+        {
+            return false;
+        }
+        value=dateTime.date().toJulianDay();
+        return true;
+    }
+    case Year:
+    {
+        //The year might be saved as a full date, use the first part.
+        bool ok;
+        value=detailInfo.textLists[Year].toString().left(4).toLongLong(&ok);
+        return ok;
+    }
+    default:
+    {
+        //Translate the text of the column.
+        bool ok;
+        value=detailInfo.textLists[column].toString().toLongLong(&ok);
+        return ok;
+    }
+    }
+}
+
+int KNMusicSearchPlan::blockCost(const KNMusicSearchBlock &block)
+{
+    //Comparing numbers is the cheapest.
+    if(block.isColumn && block.comparison!=SearchContains &&
+            block.comparison!=SearchEqual)
+    {
+        return 1;
+    }
+    //Searching all the columns is the most expensive one.
+    if(block.index==-1)
+    {
+        return MusicDataCount;
+    }
+    //Searching a specific text.
+    return 2;
+}
+
+bool KNMusicSearchPlan::checkBlock(const KNMusicDetailInfo &detailInfo,
+                                   const KNMusicSearchBlock &block)
+{
+    //Check if this block a common search block,
+    if(block.index==-1)
+    {
+        //Search the text in all text column.
+        for(int i=0; i<MusicDataCount; ++i)
+        {
+            //Once match, then it should be true.
+            if(checkText(columnKey(detailInfo, i), block))
+            {
+                return !block.isNegative;
+            }
+        }
+        return block.isNegative;
+    }
+    //Check the property, it's matched as the text like the model data.
+    if(!block.isColumn)
+    {
+        return checkText(KNMusicUtil::searchKey(
+                             propertyText(detailInfo, block.index)),
+                         block)!=block.isNegative;
+    }
+    //Check the text of the column.
+    if(block.comparison==SearchContains || block.comparison==SearchEqual)
+    {
+        //The columns after the text columns don't have display text.
+        return checkText(block.index<MusicDataCount?
+                             columnKey(detailInfo, block.index):
+                             QString(),
+                         block)!=block.isNegative;
+    }
+    //Get the number of the column, the row which doesn't have a number could
+    //never match a comparison.
+    qint64 value;
+    if(!numericValue(detailInfo, block.index, value))
+    {
+        return block.isNegative;
+    }
+    //Compare the number.
+    qint64 blockValue=block.value.toLongLong();
+    bool result;
+    switch(block.comparison)
+    {
+    case SearchLess:
+        result=(value<blockValue);
+        break;
+    case SearchLessEqual:
+        result=(value<=blockValue);
+        break;
+    case SearchGreater:
+        result=(value>blockValue);
+        break;
+    case SearchGreaterEqual:
+        result=(value>=blockValue);
+        break;
+    default:
+        //The range contains both the minimum and the maximum.
+        result=(value>=blockValue && value<=block.maximum.toLongLong());
+        break;
+    }
+    return result!=block.isNegative;
+}
+
+bool KNMusicSearchPlan::checkText(const QString &key,
+                                  const KNMusicSearchBlock &block)
+{
+    //Both of the key and the block text are normalised, check the text with
+    //the comparison.
+    return (block.comparison==SearchEqual)?
+                (key==block.value.toString()):
+                key.contains(block.value.toString());
+}
+
+inline QString KNMusicSearchPlan::propertyText(
+        const KNMusicDetailInfo &detailInfo,
+        int role)
+{
+    //Get the property from the detail info, it's the same as the data of the
+    //role from the music model.
+    switch(role)
+    {
+    case FilePathRole:
+        return detailInfo.filePath;
+    case FileNameRole:
+        return detailInfo.fileName;
+    case StartPositionRole:
+        return QString::number(detailInfo.startPosition);
+    case ArtworkKeyRole:
+        return detailInfo.coverImageHash;
+    case TrackFileRole:
+        return detailInfo.trackFilePath;
+    case TrackIndexRole:
+        return QString::number(detailInfo.trackIndex);
+    case CannotPlayFlagRole:
+        return QVariant(detailInfo.cannotPlay).toString();
+    case DurationRole:
+        return QString::number(detailInfo.duration);
+    case FileSizeRole:
+        return QString::number(detailInfo.size);
+    case DateAddedRole:
+        return QVariant(detailInfo.dateAdded).toString();
+    case DateModifiedRole:
+        return QVariant(detailInfo.dateModified).toString();
+    case DateLastPlayedRole:
+        return QVariant(detailInfo.dateLastPlayed).toString();
+    default:
+        //The model doesn't have the data of the other roles.
+        return QString();
+    }
+}
+
+inline QString KNMusicSearchPlan::columnKey(
+        const KNMusicDetailInfo &detailInfo,
+        int column)
+{
+    //Use the search keys generated by the music model, or else normalise the
+    //text now.
+    return (detailInfo.searchKeys.size()==MusicDataCount)?
+                detailInfo.searchKeys.at(column):
+                KNMusicUtil::searchKey(detailInfo.textLists[column].toString());
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICSEARCHPLAN_H
+#define KNMUSICSEARCHPLAN_H
+
+#include <QStringList>
+
+#include "knmusicutil.h"
+
+using namespace MusicUtil;
+
+/*!
+ * \brief The KNMusicSearchPlan class compiles a search block list into the
+ * clauses which could be checked with a detail info. A row matches the plan
+ * when it matches all the clauses, and a clause matches when any of its blocks
+ * matches.\n
+ * The clauses are sorted by their cost, the numeric comparisons are checked
+ * before the text blocks, and the blocks which search all the columns are
+ * checked at last, so most of the rows could be rejected by a cheap clause.\n
+ * The texts are compared with the normalised search keys, which ignore the
+ * case, the accents and the width of the characters.
+ */
+class KNMusicSearchPlan
+{
+public:
+    /*!
+     * \brief Construct an empty KNMusicSearchPlan which matches all the rows.
+     */
+    KNMusicSearchPlan();
+
+    /*!
+     * \brief Construct a KNMusicSearchPlan from a search block list.
+     * \param blocks The search block list.
+     */
+    explicit KNMusicSearchPlan(const QList<KNMusicSearchBlock> &blocks);
+
+    /*!
+     * \brief Check whether the plan contains no clause.
+     * \return If the plan matches all the rows, return true.
+     */
+    bool isEmpty() const;
+
+    /*!
+     * \brief Check whether a row matches the plan.
+     * \param detailInfo The detail info of the row.
+     * \return If the row matches all the clauses, return true.
+     */
+    bool match(const KNMusicDetailInfo &detailInfo) const;
+
+    /*!
+     * \brief Get the text which must be contained by a column of the matched
+     * rows. These texts could be used to find the candidate rows from the
+     * search index of the music model.
+     * \return The text list.
+     */
+    QStringList indexedTexts() const;
+
+    /*!
+     * \brief Check whether a column could be compared with numbers.
+     * \param column The column index.
+     * \return If the column is a numeric column, return true.
+     */
+    static bool isNumericColumn(int column);
+
+    /*!
+     * \brief Get the number of a numeric column from the detail info. The time
+     * is in milliseconds, the size is in bytes, and the dates are Julian days.
+     * \param detailInfo The detail info.
+     * \param column The column index.
+     * \param value The number of the column.
+     * \return If the row doesn't have a number in the column, return false.
+     */
+    static bool numericValue(const KNMusicDetailInfo &detailInfo,
+                             int column,
+                             qint64 &value);
+
+private:
+    struct SearchClause
+    {
+        QList<KNMusicSearchBlock> blocks;
+        int cost;
+        SearchClause() :
+            blocks(QList<KNMusicSearchBlock>()),
+            cost(0)
+        {
+        }
+    };
+    static int blockCost(const KNMusicSearchBlock &block);
+    static bool checkBlock(const KNMusicDetailInfo &detailInfo,
+                           const KNMusicSearchBlock &block);
+    static bool checkText(const QString &key,
+                          const KNMusicSearchBlock &block);
+    static inline QString propertyText(const KNMusicDetailInfo &detailInfo,
+                                       int role);
+    static inline QString columnKey(const KNMusicDetailInfo &detailInfo,
+                                    int column);
+    QList<SearchClause> m_clauses;
+};
+
+#endif // KNMUSICSEARCHPLAN_H
@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <cstring>
+
+#include <QtMath>
+
+#include "knmusicdspprocessor.h"
+
+#include "knmusicspectrumanalyser.h"
+
+#ifdef ENABLE_DSP_SSE2
+#include <emmintrin.h>
+#endif
+
+#define FftSize 2048
+#define SpectrumFrameRate 30
+#define SpectrumBandCount 32
+#define MinimumFrequency 40.0
+#define MaximumFrequency 16000.0
+#define LevelFloor -70.0
+#define SnapshotDirty 4
+#define SnapshotIndexMask 3
+
+KNMusicSpectrumAnalyser::KNMusicSpectrumAnalyser() :
+    m_history(QVector<float>(FftSize, 0.0f)),
+    m_window(QVector<float>(FftSize)),
+    m_bitReversal(QVector<int>(FftSize)),
+    m_twiddleReal(QVector<float>()),
+    m_twiddleImaginary(QVector<float>()),
+    m_input(QVector<float>(FftSize)),
+    m_real(QVector<float>(FftSize)),
+    m_imaginary(QVector<float>(FftSize)),
+    m_bandStarts(QVector<int>(SpectrumBandCount, 0)),
+    m_bandEnds(QVector<int>(SpectrumBandCount, 0)),
+    m_snapshots(QVector<float>(SpectrumBandCount*3, 0.0f)),
+    m_middleSnapshot(1),
+    m_backSnapshot(0),
+    m_frontSnapshot(2),
+    m_historyPosition(0),
+    m_hopFrames(0),
+    m_pendingFrames(0),
+    m_channels(0)
+{
+    //Calculate the bits of the FFT size.
+    int bits=0;
+    while((1<<bits)<FftSize)
+    {
+        ++bits;
+    }
+    //Prepare the window and the bit reversal table.
+    for(int i=0; i<FftSize; ++i)
+    {
+        //Calculate the Hann window.
+        m_window[i]=(float)(0.5-0.5*qCos(2.0*M_PI*(qreal)i/(qreal)FftSize));
+        //Reverse the bits of the index.
+        int reversed=0;
+        for(int j=0; j<bits; ++j)
+        {
+            reversed|=((i>>j) & 1)<<(bits-1-j);
+        }
+        m_bitReversal[i]=reversed;
+    }
+    //Prepare the twiddle factors, the factors of each stage are saved
+    //continuously, so the butterflies of a stage could be vectorised.
+    for(int half=1; half<FftSize; half<<=1)
+    {
+        for(int i=0; i<half; ++i)
+        {
+            qreal angle=-M_PI*(qreal)i/(qreal)half;
+            m_twiddleReal.append((float)qCos(angle));
+            m_twiddleImaginary.append((float)qSin(angle));
+        }
+    }
+}
+
+void KNMusicSpectrumAnalyser::prepare(int sampleRate, int channels)
+{
+    //Save the format.
+    m_channels=channels;
+    //Calculate the frames between two snapshots.
+    m_hopFrames=qMax(1, sampleRate/SpectrumFrameRate);
+    //Split the frequency range into the logarithmic spaced bands.
+    qreal maximumFrequency=qMin(MaximumFrequency, (qreal)sampleRate/2.0),
+          binWidth=(qreal)qMax(sampleRate, 1)/(qreal)FftSize;
+    for(int i=0; i<SpectrumBandCount; ++i)
+    {
+        //Calculate the frequency range of the band.
+        qreal start=MinimumFrequency*qPow(maximumFrequency/MinimumFrequency,
+                                          (qreal)i/SpectrumBandCount),
+              end=MinimumFrequency*qPow(maximumFrequency/MinimumFrequency,
+                                        (qreal)(i+1)/SpectrumBandCount);
+        //Each band has one bin at least, the DC bin is skipped.
+        m_bandStarts[i]=qBound(1, (int)(start/binWidth), FftSize/2-1);
+        m_bandEnds[i]=qBound(m_bandStarts[i]+1,
+                             (int)qCeil(end/binWidth),
+                             FftSize/2);
+    }
+    //Clear the previous samples.
+    reset();
+}
+
+void KNMusicSpectrumAnalyser::addSamples(const float *samples, int frames)
+{
+    //Check the format.
+    if(m_channels<1)
+    {
+        return;
+    }
+    float channelScale=1.0f/(float)m_channels;
+    for(int i=0; i<frames; ++i, samples+=m_channels)
+    {
+        //Mix down the frame to the history.
+        float mono=0.0f;
+        for(int j=0; j<m_channels; ++j)
+        {
+            mono+=samples[j];
+        }
+        m_history[m_historyPosition]=mono*channelScale;
+        m_historyPosition=(m_historyPosition+1) & (FftSize-1);
+        //Check whether it's time for a new snapshot.
+        if(++m_pendingFrames==m_hopFrames)
+        {
+            m_pendingFrames=0;
+            analyse();
+        }
+    }
+}
+
+void KNMusicSpectrumAnalyser::reset()
+{
+    //Clear the history.
+    m_history.fill(0.0f);
+    m_historyPosition=0;
+    m_pendingFrames=0;
+    //Publish the silence.
+    float *levels=m_snapshots.data()+m_backSnapshot*SpectrumBandCount;
+    for(int i=0; i<SpectrumBandCount; ++i)
+    {
+        levels[i]=0.0f;
+    }
+    publish();
+}
+
+bool KNMusicSpectrumAnalyser::spectrum(QVector<float> &bands)
+{
+    //Check whether there's a new snapshot.
+    if(!(m_middleSnapshot.loadAcquire() & SnapshotDirty))
+    {
+        return false;
+    }
+    //Swap the front snapshot with the new snapshot. The exchange is ordered in
+    //both directions: the reads of the new snapshot can't move before it, and
+    //the reads of the old front snapshot can't move after it, where the writer
+    //could already be writing to it.
+    m_frontSnapshot=m_middleSnapshot.fetchAndStoreOrdered(m_frontSnapshot) &
+            SnapshotIndexMask;
+    //Copy the levels.
+    bands.resize(SpectrumBandCount);
+    const float *levels=m_snapshots.constData()+
+            m_frontSnapshot*SpectrumBandCount;
+    for(int i=0; i<SpectrumBandCount; ++i)
+    {
+        bands[i]=levels[i];
+    }
+    return true;
+}
+
+inline void KNMusicSpectrumAnalyser::analyse()
+{
+    //Calculate the spectrum of the history.
+    transform();
+    //The amplitude of a full scale sine wave is FftSize/4 with the Hann
+    //window, normalise the power to the full scale.
+    const qreal powerScale=16.0/((qreal)FftSize*(qreal)FftSize);
+    const float *real=m_real.constData(),
+                *imaginary=m_imaginary.constData();
+    float *levels=m_snapshots.data()+m_backSnapshot*SpectrumBandCount;
+    for(int i=0; i<SpectrumBandCount; ++i)
+    {
+        //Find the peak power of the bins in the band.
+        float power=0.0f;
+        for(int j=m_bandStarts.at(i); j<m_bandEnds.at(i); ++j)
+        {
+            power=qMax(power, real[j]*real[j]+imaginary[j]*imaginary[j]);
+        }
+        //Map the decibel to the level.
+        qreal decibel=10.0*log10((qreal)power*powerScale+1e-20);
+        levels[i]=(float)qBound(0.0, 1.0-decibel/LevelFloor, 1.0);
+    }
+    //Publish the levels.
+    publish();
+}
+
+inline void KNMusicSpectrumAnalyser::publish()
+{
+    //Swap the back snapshot with the middle one, and mark it as a new
+    //snapshot. The reader might be copying the front snapshot at the same
+    //time, it's never touched here. The exchange publishes the levels, and
+    //keeps the writes to the new back snapshot after the reader released it.
+    m_backSnapshot=m_middleSnapshot.fetchAndStoreOrdered(
+                m_backSnapshot | SnapshotDirty) & SnapshotIndexMask;
+}
+
+inline void KNMusicSpectrumAnalyser::transform()
+{
+    //Unroll the circular history from the oldest sample.
+    const float *history=m_history.constData();
+    float *input=m_input.data();
+    int tailSize=FftSize-m_historyPosition;
+    memcpy(input, history+m_historyPosition, tailSize*sizeof(float));
+    memcpy(input+tailSize, history, m_historyPosition*sizeof(float));
+    //Apply the window.
+    const float *window=m_window.constData();
+    int i=0;
+#ifdef ENABLE_DSP_SSE2
+    for(; i<FftSize; i+=4)
+    {
+        _mm_storeu_ps(input+i, _mm_mul_ps(_mm_loadu_ps(input+i),
+                                          _mm_loadu_ps(window+i)));
+    }
+#endif
+    for(; i<FftSize; ++i)
+    {
+        input[i]*=window[i];
+    }
+    //Reorder the samples in the bit reversal order.
+    float *real=m_real.data(), *imaginary=m_imaginary.data();
+    const int *bitReversal=m_bitReversal.constData();
+    for(i=0; i<FftSize; ++i)
+    {
+        real[bitReversal[i]]=input[i];
+        imaginary[i]=0.0f;
+    }
+    //Do the radix-2 butterflies stage by stage.
+    const float *twiddleReal=m_twiddleReal.constData(),
+                *twiddleImaginary=m_twiddleImaginary.constData();
+    for(int half=1; half<FftSize; half<<=1)
+    {
+        for(int block=0; block<FftSize; block+=(half<<1))
+        {
+            float *topReal=real+block, *topImaginary=imaginary+block,
+                  *bottomReal=topReal+half,
+                  *bottomImaginary=topImaginary+half;
+            int j=0;
+#ifdef ENABLE_DSP_SSE2
+            //The butterflies of a block are independent, calculate 4 of them
+            //at a time when the block is large enough.
+            for(; j+4<=half; j+=4)
+            {
+                __m128 wr=_mm_loadu_ps(twiddleReal+j),
+                       wi=_mm_loadu_ps(twiddleImaginary+j),
+                       br=_mm_loadu_ps(bottomReal+j),
+                       bi=_mm_loadu_ps(bottomImaginary+j),
+                       tr=_mm_sub_ps(_mm_mul_ps(wr, br), _mm_mul_ps(wi, bi)),
+                       ti=_mm_add_ps(_mm_mul_ps(wr, bi), _mm_mul_ps(wi, br)),
+                       ar=_mm_loadu_ps(topReal+j),
+                       ai=_mm_loadu_ps(topImaginary+j);
+                _mm_storeu_ps(bottomReal+j, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(bottomImaginary+j, _mm_sub_ps(ai, ti));
+                _mm_storeu_ps(topReal+j, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(topImaginary+j, _mm_add_ps(ai, ti));
+            }
+#endif
+            for(; j<half; ++j)
+            {
+                float tr=twiddleReal[j]*bottomReal[j]-
+                        twiddleImaginary[j]*bottomImaginary[j],
+                      ti=twiddleReal[j]*bottomImaginary[j]+
+                        twiddleImaginary[j]*bottomReal[j];
+                bottomReal[j]=topReal[j]-tr;
+                bottomImaginary[j]=topImaginary[j]-ti;
+                topReal[j]+=tr;
+                topImaginary[j]+=ti;
+            }
+        }
+        //Move to the twiddle factors of the next stage.
+        twiddleReal+=half;
+        twiddleImaginary+=half;
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KNMUSICSPECTRUMANALYSER_H
+#define KNMUSICSPECTRUMANALYSER_H
+
+#include <QVector>
+#include <QAtomicInt>
+
+/*!
+ * \brief The KNMusicSpectrumAnalyser class calculates the spectrum of the
+ * playing samples for the visualisation. The samples are mixed down to mono,
+ * and about 30 times per second, a Hann windowed FFT of the latest samples is
+ * calculated and reduced to logarithmic spaced band levels.\n
+ * The band levels are published with a triple buffer, so the writer never
+ * waits for the reader and the reader always gets the latest complete
+ * snapshot. prepare(), addSamples() and reset() should be called in the audio
+ * thread, spectrum() should only be called in one reader thread.
+ */
+class KNMusicSpectrumAnalyser
+{
+public:
+    /*!
+     * \brief Construct a KNMusicSpectrumAnalyser.
+     */
+    KNMusicSpectrumAnalyser();
+
+    /*!
+     * \brief Prepare the analyser for a sample format, the previous samples and
+     * the published levels will be cleared.
+     * \param sampleRate The sample rate of the samples.
+     * \param channels The channel count of the samples.
+     */
+    void prepare(int sampleRate, int channels);
+
+    /*!
+     * \brief Add the playing samples to the analyser. When enough samples are
+     * added since the last snapshot, a new snapshot will be published.
+     * \param samples The interleaved float samples.
+     * \param frames The frame count of the samples.
+     */
+    void addSamples(const float *samples, int frames);
+
+    /*!
+     * \brief Clear the samples and publish a silent snapshot. It should be
+     * called when the samples stop playing.
+     */
+    void reset();
+
+    /*!
+     * \brief Get the latest published snapshot. It never blocks.
+     * \param bands The band levels from the lowest frequency to the highest
+     * frequency, from 0.0 (silent) to 1.0 (full scale). The vector will be
+     * resized to the band count.
+     * \return If there's a new snapshot since the last call, return true, or
+     * else the bands are not touched.
+     */
+    bool spectrum(QVector<float> &bands);
+
+private:
+    inline void analyse();
+    inline void publish();
+    inline void transform();
+    //The history of the mono samples, it's a circular buffer of the FFT size.
+    QVector<float> m_history;
+    //The Hann window, the bit reversal table and the twiddle factors of all the
+    //FFT stages.
+    QVector<float> m_window;
+    QVector<int> m_bitReversal;
+    QVector<float> m_twiddleReal, m_twiddleImaginary;
+    //The working buffers of the FFT.
+    QVector<float> m_input, m_real, m_imaginary;
+    //The FFT bins range of each band.
+    QVector<int> m_bandStarts, m_bandEnds;
+    //The triple buffer of the band levels.
+    QVector<float> m_snapshots;
+    QAtomicInt m_middleSnapshot;
+    int m_backSnapshot, m_frontSnapshot;
+    int m_historyPosition, m_hopFrames, m_pendingFrames, m_channels;
+};
+
+#endif // KNMUSICSPECTRUMANALYSER_H
@@ -15,20 +15,59 @@
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
+#include <QTimer>
+#include <QTimeLine>
+#include <QtMath>
+
 #include "knmusicstandardbackendthread.h"
 
 #include "knmusicstandardbackend.h"
 
 #include <QDebug>
 
+#define PrefetchDelay 1500
+
+using namespace MusicUtil;
+
 KNMusicStandardBackend::KNMusicStandardBackend(QObject *parent) :
     KNMusicBackend(parent),
     m_main(nullptr),
     m_preview(nullptr),
+    m_crossfade(nullptr),
+    m_crossfadeTimer(new QTimer(this)),
+    m_prefetchTimer(new QTimer(this)),
+    m_crossfadeTimeLine(new QTimeLine(1000, this)),
+    m_crossfadeFilePath(QString()),
+    m_prefetchFilePath(QString()),
+    m_crossfadeStart(-1),
+    m_crossfadeMusicDuration(-1),
+    m_prefetchStart(-1),
+    m_prefetchDuration(-1),
     m_originalVolume(-1),
     m_volumeBeforeMute(-1),
-    m_mute(false)
-{
+    m_crossfadeDuration(0),
+    m_crossfadeCurve(CrossfadeEqualPower),
+    m_mute(false),
+    m_crossfading(false),
+    m_prefetched(false)
+{
+    //Configure the crossfade timer.
+    m_crossfadeTimer->setSingleShot(true);
+    connect(m_crossfadeTimer, &QTimer::timeout,
+            this, &KNMusicStandardBackend::onActionCrossfadeStart);
+    //Configure the prefetch timer, the music is prefetched a while after the
+    //current music starts, so the current music won't be delayed.
+    m_prefetchTimer->setInterval(PrefetchDelay);
+    m_prefetchTimer->setSingleShot(true);
+    connect(m_prefetchTimer, &QTimer::timeout,
+            this, &KNMusicStandardBackend::onActionPrefetch);
+    //Configure the crossfade time line.
+    m_crossfadeTimeLine->setCurveShape(QTimeLine::LinearCurve);
+    m_crossfadeTimeLine->setUpdateInterval(20);
+    connect(m_crossfadeTimeLine, &QTimeLine::valueChanged,
+            this, &KNMusicStandardBackend::onActionCrossfadeFrame);
+    connect(m_crossfadeTimeLine, &QTimeLine::finished,
+            this, &KNMusicStandardBackend::onActionCrossfadeFinished);
 }
 
 qint64 KNMusicStandardBackend::duration() const
@@ -47,10 +86,95 @@ bool KNMusicStandardBackend::loadMusic(const QString &filePath,
                                        const qint64 &start,
                                        const qint64 &duration)
 {
+    //The crossfade is only for the previous file.
+    clearCrossfadeMusic();
+    finishCrossfade();
+    //Check whether the music is prefetched.
+    if(takePrefetchedMusic(filePath, start, duration))
+    {
+        //Stop the current music, and use the prefetched thread as the main
+        //thread.
+        m_main->reset();
+        swapMainThread();
+        //The prefetched thread is not linked when the file is loaded, emit the
+        //load signals for it.
+        emit durationChanged(m_main->duration());
+        emit loadSuccess();
+        return true;
+    }
     //Load the music to the main thread.
     return threadLoadMusic(m_main, filePath, start, duration);
 }
 
+bool KNMusicStandardBackend::setNextMusic(const QString &filePath,
+                                          const qint64 &start,
+                                          const qint64 &duration)
+{
+    //The next music won't be crossfaded.
+    clearCrossfadeMusic();
+    //Set the next file to the main thread.
+    return m_main?m_main->setNextFile(filePath, start, duration):false;
+}
+
+bool KNMusicStandardBackend::setCrossfadeMusic(const QString &filePath,
+                                               const qint64 &start,
+                                               const qint64 &duration)
+{
+    //Clear the previous crossfade music.
+    clearCrossfadeMusic();
+    //Check whether the crossfade is enabled.
+    if(filePath.isEmpty() || crossfadeDuration()==0 || m_main==nullptr)
+    {
+        return false;
+    }
+    //The music won't follow the current file without gap.
+    m_main->setNextFile(QString());
+    //Save the crossfade music.
+    m_crossfadeFilePath=filePath;
+    m_crossfadeStart=start;
+    m_crossfadeMusicDuration=duration;
+    //Schedule the crossfade with the current position.
+    onActionMainAnchorChanged(m_main->position(),
+                              m_main->state()==Playing?1.0:0.0,
+                              KNMusicPositionClock::currentTimestamp());
+    return true;
+}
+
+int KNMusicStandardBackend::crossfadeDuration() const
+{
+    //The crossfade needs the crossfade thread.
+    return m_crossfade==nullptr?0:m_crossfadeDuration;
+}
+
+bool KNMusicStandardBackend::prefetchMusic(const QString &filePath,
+                                           const qint64 &start,
+                                           const qint64 &duration)
+{
+    //The music is prefetched in the crossfade thread.
+    if(m_crossfade==nullptr)
+    {
+        return false;
+    }
+    //Check whether the music is already prefetched or waiting for prefetching.
+    if(filePath==m_prefetchFilePath && start==m_prefetchStart &&
+            duration==m_prefetchDuration)
+    {
+        return !filePath.isEmpty();
+    }
+    //Clear the previous prefetched music.
+    clearPrefetchedMusic();
+    if(filePath.isEmpty())
+    {
+        return false;
+    }
+    //Save the music, it will be loaded when the timer is timeout.
+    m_prefetchFilePath=filePath;
+    m_prefetchStart=start;
+    m_prefetchDuration=duration;
+    m_prefetchTimer->start();
+    return true;
+}
+
 int KNMusicStandardBackend::state() const
 {
     //Get the main thread playing state.
@@ -65,18 +189,26 @@ void KNMusicStandardBackend::play()
 
 void KNMusicStandardBackend::pause()
 {
+    //Finish the crossfade, the fading out music won't be paused.
+    finishCrossfade();
     //Pause the main thread.
     threadPause(m_main);
 }
 
 void KNMusicStandardBackend::stop()
 {
+    //Finish the crossfade.
+    finishCrossfade();
     //Stop the main thread.
     threadStop(m_main);
 }
 
 void KNMusicStandardBackend::reset()
 {
+    //Clear the crossfade and the prefetched music.
+    clearCrossfadeMusic();
+    finishCrossfade();
+    clearPrefetchedMusic();
     //Reset the main thread.
     threadReset(m_main);
 }
@@ -149,8 +281,16 @@ bool KNMusicStandardBackend::mute()
     return m_mute;
 }
 
+bool KNMusicStandardBackend::spectrum(QVector<float> &bands)
+{
+    //Get the spectrum of the main thread.
+    return m_main==nullptr?false:m_main->spectrum(bands);
+}
+
 void KNMusicStandardBackend::save()
 {
+    //Finish the crossfade, only the main thread will be saved.
+    finishCrossfade();
     //Call the save function of the main thread.
     m_main->save();
 }
@@ -205,20 +345,7 @@ void KNMusicStandardBackend::setMainThread(KNMusicStandardBackendThread *thread)
     //Save the main thread.
     m_main=thread;
     //Link the main thread to the standard backend.
-    connect(m_main, &KNMusicStandardBackendThread::durationChanged,
-            this, &KNMusicStandardBackend::durationChanged);
-    connect(m_main, &KNMusicStandardBackendThread::positionChanged,
-            this, &KNMusicStandardBackend::positionChanged);
-    connect(m_main, &KNMusicStandardBackendThread::loadFailed,
-            this, &KNMusicStandardBackend::loadFailed);
-    connect(m_main, &KNMusicStandardBackendThread::loadSuccess,
-            this, &KNMusicStandardBackend::loadSuccess);
-    connect(m_main, &KNMusicStandardBackendThread::finished,
-            this, &KNMusicStandardBackend::finished);
-    connect(m_main, &KNMusicStandardBackendThread::stopped,
-            this, &KNMusicStandardBackend::stopped);
-    connect(m_main, &KNMusicStandardBackendThread::stateChanged,
-            this, &KNMusicStandardBackend::playingStateChanged);
+    linkMainThread();
 }
 
 void KNMusicStandardBackend::setPreviewThread(
@@ -234,8 +361,8 @@ void KNMusicStandardBackend::setPreviewThread(
     //Link the preview thread to the standard backend.
     connect(m_preview, &KNMusicStandardBackendThread::durationChanged,
             this, &KNMusicStandardBackend::previewDurationChanged);
-    connect(m_preview, &KNMusicStandardBackendThread::positionChanged,
-            this, &KNMusicStandardBackend::previewPositionChanged);
+    connect(m_preview, &KNMusicStandardBackendThread::positionAnchorChanged,
+            this, &KNMusicStandardBackend::previewPositionAnchorChanged);
     connect(m_preview, &KNMusicStandardBackendThread::loadFailed,
             this, &KNMusicStandardBackend::previewLoadFailed);
     connect(m_preview, &KNMusicStandardBackendThread::loadSuccess,
@@ -248,8 +375,23 @@ void KNMusicStandardBackend::setPreviewThread(
             this, &KNMusicStandardBackend::previewPlayingStateChanged);
 }
 
+void KNMusicStandardBackend::setCrossfadeThread(
+        KNMusicStandardBackendThread *thread)
+{
+    //If there's already a crossfade thread, ignore the later sets.
+    if(m_crossfade)
+    {
+        return;
+    }
+    //Save the crossfade thread, it won't be linked until it becomes the main
+    //thread.
+    m_crossfade=thread;
+}
+
 void KNMusicStandardBackend::setPosition(const qint64 &position)
 {
+    //Finish the crossfade.
+    finishCrossfade();
     //Set the main thread position to a specific value.
     threadSetPosition(m_main, position);
 }
@@ -293,6 +435,279 @@ void KNMusicStandardBackend::volumeDown()
     setVolume(volume()-volumeLevel());
 }
 
+void KNMusicStandardBackend::setCrossfade(int duration, int curve)
+{
+    //Save the crossfade parameters.
+    m_crossfadeDuration=qMax(duration, 0);
+    m_crossfadeCurve=(curve>-1 && curve<CrossfadeCurveCount)?
+                curve:CrossfadeEqualPower;
+    //Check whether the crossfade is disabled.
+    if(m_crossfadeDuration==0)
+    {
+        //Clear the crossfade music.
+        clearCrossfadeMusic();
+    }
+}
+
+void KNMusicStandardBackend::setMusicGain(qreal gain)
+{
+    //Set the gain to the main thread.
+    if(m_main)
+    {
+        m_main->setGainVolume(gain);
+    }
+}
+
+bool KNMusicStandardBackend::isDspSupported()
+{
+    //All the threads are the same type, check the main thread.
+    return m_main==nullptr?false:m_main->isDspSupported();
+}
+
+void KNMusicStandardBackend::setDspParameters(
+        const KNMusicDspParameters &parameters)
+{
+    //Set the parameters to all the threads, the threads might be swapped.
+    if(m_main)
+    {
+        m_main->setDspParameters(parameters);
+    }
+    if(m_preview)
+    {
+        m_preview->setDspParameters(parameters);
+    }
+    if(m_crossfade)
+    {
+        m_crossfade->setDspParameters(parameters);
+    }
+}
+
+void KNMusicStandardBackend::onActionMainAnchorChanged(qint64 position,
+                                                       qreal rate,
+                                                       qint64 timestamp)
+{
+    //Stop the previous schedule.
+    m_crossfadeTimer->stop();
+    //Check whether there's a crossfade music and the main thread is playing.
+    if(m_crossfadeFilePath.isEmpty() || rate==0.0)
+    {
+        return;
+    }
+    //Check the duration, the music should be longer than the crossfade.
+    qint64 mainDuration=m_main->duration();
+    if(mainDuration<=(qint64)m_crossfadeDuration)
+    {
+        return;
+    }
+    //Calculate the time before the crossfade starts.
+    qint64 waitTime=(qint64)((mainDuration-m_crossfadeDuration-position)/rate)-
+            (KNMusicPositionClock::currentTimestamp()-timestamp);
+    //Start the timer.
+    m_crossfadeTimer->start((int)qMax(waitTime, (qint64)0));
+}
+
+void KNMusicStandardBackend::onActionCrossfadeStart()
+{
+    //Take the crossfade music.
+    QString filePath=m_crossfadeFilePath;
+    qint64 start=m_crossfadeStart, duration=m_crossfadeMusicDuration;
+    clearCrossfadeMusic();
+    //Finish the previous crossfade.
+    finishCrossfade();
+    //Load the music to the crossfade thread if it's not prefetched, it starts
+    //from silence. If it cannot be loaded, the main thread will be finished as
+    //usual.
+    if(!takePrefetchedMusic(filePath, start, duration))
+    {
+        //The crossfade thread will be used, clear the prefetched music.
+        clearPrefetchedMusic();
+        if(!threadLoadMusic(m_crossfade, filePath, start, duration))
+        {
+            return;
+        }
+    }
+    m_crossfade->setFadeVolume(0.0);
+    //Swap the main thread and the crossfade thread, the crossfade thread
+    //becomes the main thread.
+    swapMainThread();
+    //Start crossfading.
+    m_crossfading=true;
+    m_crossfadeTimeLine->setDuration(m_crossfadeDuration);
+    m_crossfadeTimeLine->start();
+    //Play the new main thread.
+    m_main->play();
+    //Update the duration when it's known.
+    if(m_main->duration()>0)
+    {
+        emit durationChanged(m_main->duration());
+    }
+    //The crossfade music starts.
+    emit nextMusicStarted();
+}
+
+void KNMusicStandardBackend::onActionCrossfadeFrame(qreal value)
+{
+    //Fade in the main thread and fade out the crossfade thread.
+    m_main->setFadeVolume(crossfadeVolume(value));
+    m_crossfade->setFadeVolume(crossfadeVolume(1.0-value));
+}
+
+void KNMusicStandardBackend::onActionCrossfadeFinished()
+{
+    //Finish the crossfade.
+    finishCrossfade();
+}
+
+void KNMusicStandardBackend::onActionPrefetch()
+{
+    //The crossfade thread is used by the fading out music, wait for it.
+    if(m_crossfading)
+    {
+        m_prefetchTimer->start();
+        return;
+    }
+    //Load the music to the crossfade thread.
+    m_prefetched=threadLoadMusic(m_crossfade,
+                                 m_prefetchFilePath,
+                                 m_prefetchStart,
+                                 m_prefetchDuration);
+}
+
+inline void KNMusicStandardBackend::linkMainThread()
+{
+    //Link the main thread to the standard backend.
+    m_mainLinker.append(
+                connect(m_main, &KNMusicStandardBackendThread::durationChanged,
+                        this, &KNMusicStandardBackend::durationChanged));
+    m_mainLinker.append(
+                connect(m_main,
+                        &KNMusicStandardBackendThread::positionAnchorChanged,
+                        this, &KNMusicStandardBackend::positionAnchorChanged));
+    m_mainLinker.append(
+                connect(m_main,
+                        &KNMusicStandardBackendThread::positionAnchorChanged,
+                        this,
+                        &KNMusicStandardBackend::onActionMainAnchorChanged));
+    m_mainLinker.append(
+                connect(m_main, &KNMusicStandardBackendThread::loadFailed,
+                        this, &KNMusicStandardBackend::loadFailed));
+    m_mainLinker.append(
+                connect(m_main, &KNMusicStandardBackendThread::loadSuccess,
+                        this, &KNMusicStandardBackend::loadSuccess));
+    m_mainLinker.append(
+                connect(m_main, &KNMusicStandardBackendThread::finished,
+                        this, &KNMusicStandardBackend::finished));
+    m_mainLinker.append(
+                connect(m_main, &KNMusicStandardBackendThread::nextFileStarted,
+                        this, &KNMusicStandardBackend::nextMusicStarted));
+    m_mainLinker.append(
+                connect(m_main, &KNMusicStandardBackendThread::stopped,
+                        this, &KNMusicStandardBackend::stopped));
+    m_mainLinker.append(
+                connect(m_main, &KNMusicStandardBackendThread::stateChanged,
+                        this, &KNMusicStandardBackend::playingStateChanged));
+}
+
+inline void KNMusicStandardBackend::clearCrossfadeMusic()
+{
+    //Stop the schedule and clear the crossfade music.
+    m_crossfadeTimer->stop();
+    m_crossfadeFilePath.clear();
+    m_crossfadeStart=-1;
+    m_crossfadeMusicDuration=-1;
+}
+
+inline void KNMusicStandardBackend::finishCrossfade()
+{
+    //Check whether the crossfade is running.
+    if(!m_crossfading)
+    {
+        return;
+    }
+    //Stop the crossfade.
+    m_crossfading=false;
+    m_crossfadeTimeLine->stop();
+    //Stop the fading out thread.
+    m_crossfade->reset();
+    //Recover the volume of both threads.
+    m_crossfade->setFadeVolume(1.0);
+    m_main->setFadeVolume(1.0);
+}
+
+inline void KNMusicStandardBackend::swapMainThread()
+{
+    //Check whether the preview smart volume is enabled.
+    bool smartVolumeEnabled=(m_originalVolume!=-1);
+    if(smartVolumeEnabled)
+    {
+        //Turn off the smart volume for the previous main thread.
+        smartVolumeOff();
+    }
+    //Swap the main thread and the crossfade thread.
+    m_mainLinker.disconnectAll();
+    qSwap(m_main, m_crossfade);
+    linkMainThread();
+    //Turn on the smart volume for the new main thread.
+    if(smartVolumeEnabled)
+    {
+        smartVolumeOn();
+    }
+}
+
+inline bool KNMusicStandardBackend::takePrefetchedMusic(
+        const QString &filePath,
+        const qint64 &start,
+        const qint64 &duration)
+{
+    //Check whether the music is loaded in the crossfade thread. The duration
+    //should be known, or else the thread is still loading or failed to load.
+    if(!m_prefetched || filePath!=m_prefetchFilePath ||
+            start!=m_prefetchStart || duration!=m_prefetchDuration ||
+            m_crossfade->duration()<1)
+    {
+        return false;
+    }
+    //Clear the prefetch information, the thread is taken.
+    m_prefetched=false;
+    m_prefetchFilePath.clear();
+    m_prefetchStart=-1;
+    m_prefetchDuration=-1;
+    return true;
+}
+
+inline void KNMusicStandardBackend::clearPrefetchedMusic()
+{
+    //Stop waiting for prefetching.
+    m_prefetchTimer->stop();
+    //Unload the prefetched music.
+    if(m_prefetched)
+    {
+        m_prefetched=false;
+        m_crossfade->reset();
+    }
+    //Clear the prefetch information.
+    m_prefetchFilePath.clear();
+    m_prefetchStart=-1;
+    m_prefetchDuration=-1;
+}
+
+inline qreal KNMusicStandardBackend::crossfadeVolume(
+        const qreal &progress) const
+{
+    //Calculate the volume scale via the curve.
+    switch(m_crossfadeCurve)
+    {
+    case CrossfadeLinear:
+        return progress;
+    case CrossfadeSmooth:
+        //Smooth step, slow at both ends.
+        return progress*progress*(3.0-2.0*progress);
+    default:
+        //Equal power, the total power keeps the same while fading.
+        return qSin(progress*M_PI_2);
+    }
+}
+
 inline qint64 KNMusicStandardBackend::threadDuration(
         KNMusicStandardBackendThread *thread) const
 {
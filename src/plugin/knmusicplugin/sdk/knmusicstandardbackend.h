@@ -19,8 +19,12 @@
 #ifndef KNMUSICSTANDARDBACKEND_H
 #define KNMUSICSTANDARDBACKEND_H
 
+#include "knconnectionhandler.h"
+
 #include "knmusicbackend.h"
 
+class QTimer;
+class QTimeLine;
 class KNMusicStandardBackendThread;
 /*!
  * \brief The KNMusicStandardBackend class provides a standard backend interface
@@ -55,6 +59,32 @@ public:
                    const qint64 &start=-1,
                    const qint64 &duration=-1) Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicBackend::setNextMusic().
+     */
+    bool setNextMusic(const QString &filePath,
+                      const qint64 &start=-1,
+                      const qint64 &duration=-1) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicBackend::setCrossfadeMusic().
+     */
+    bool setCrossfadeMusic(const QString &filePath,
+                           const qint64 &start=-1,
+                           const qint64 &duration=-1) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicBackend::crossfadeDuration().
+     */
+    int crossfadeDuration() const Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicBackend::prefetchMusic().
+     */
+    bool prefetchMusic(const QString &filePath,
+                       const qint64 &start=-1,
+                       const qint64 &duration=-1) Q_DECL_OVERRIDE;
+
     /*!
      * \brief Reimplemented from KNMusicBackend::state().
      */
@@ -127,6 +157,11 @@ public:
      */
     bool mute() Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicBackend::spectrum().
+     */
+    bool spectrum(QVector<float> &bands) Q_DECL_OVERRIDE;
+
 signals:
 
 public slots:
@@ -175,6 +210,27 @@ public slots:
      */
     void volumeDown() Q_DECL_OVERRIDE;
 
+    /*!
+     * \brief Reimplemented from KNMusicBackend::setCrossfade().
+     */
+    void setCrossfade(int duration, int curve) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicBackend::setMusicGain().
+     */
+    void setMusicGain(qreal gain) Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicBackend::isDspSupported().
+     */
+    bool isDspSupported() Q_DECL_OVERRIDE;
+
+    /*!
+     * \brief Reimplemented from KNMusicBackend::setDspParameters().
+     */
+    void setDspParameters(const MusicUtil::KNMusicDspParameters &parameters)
+    Q_DECL_OVERRIDE;
+
 protected:
     /*!
      * \brief Set the main backend thread.
@@ -188,6 +244,15 @@ protected:
      */
     void setPreviewThread(KNMusicStandardBackendThread *thread);
 
+    /*!
+     * \brief Set the crossfade backend thread. It should be the same kind of
+     * thread as the main thread, the main thread and the crossfade thread swap
+     * their roles when the crossfade starts. Without a crossfade thread, the
+     * backend doesn't support crossfade.
+     * \param thread The crossfade standard backend thread object.
+     */
+    void setCrossfadeThread(KNMusicStandardBackendThread *thread);
+
     /*!
      * \brief Set the global volume of the backend.
      * \param volume The volume number.
@@ -207,7 +272,25 @@ protected:
      */
     virtual qreal smartVolumeScale() const=0;
 
+private slots:
+    void onActionMainAnchorChanged(qint64 position,
+                                   qreal rate,
+                                   qint64 timestamp);
+    void onActionCrossfadeStart();
+    void onActionCrossfadeFrame(qreal value);
+    void onActionCrossfadeFinished();
+    void onActionPrefetch();
+
 private:
+    inline void linkMainThread();
+    inline void clearCrossfadeMusic();
+    inline void finishCrossfade();
+    inline void swapMainThread();
+    inline bool takePrefetchedMusic(const QString &filePath,
+                                    const qint64 &start,
+                                    const qint64 &duration);
+    inline void clearPrefetchedMusic();
+    inline qreal crossfadeVolume(const qreal &progress) const;
     inline qint64 threadDuration(KNMusicStandardBackendThread *thread) const;
     inline qint64 threadPosition(KNMusicStandardBackendThread *thread) const;
     inline int threadState(KNMusicStandardBackendThread *thread) const;
@@ -225,9 +308,16 @@ private:
     inline void smartVolumeOn();
     inline void smartVolumeOff();
 
-    KNMusicStandardBackendThread *m_main, *m_preview;
-    int m_originalVolume, m_volumeBeforeMute;
-    bool m_mute;
+    KNMusicStandardBackendThread *m_main, *m_preview, *m_crossfade;
+    KNConnectionHandler m_mainLinker;
+    QTimer *m_crossfadeTimer, *m_prefetchTimer;
+    QTimeLine *m_crossfadeTimeLine;
+    QString m_crossfadeFilePath, m_prefetchFilePath;
+    qint64 m_crossfadeStart, m_crossfadeMusicDuration, m_prefetchStart,
+           m_prefetchDuration;
+    int m_originalVolume, m_volumeBeforeMute, m_crossfadeDuration,
+        m_crossfadeCurve;
+    bool m_mute, m_crossfading, m_prefetched;
 };
 
 #endif // KNMUSICSTANDARDBACKEND_H
@@ -19,6 +19,9 @@
 #ifndef KNMUSICSTANDARDBACKENDTHREAD_H
 #define KNMUSICSTANDARDBACKENDTHREAD_H
 
+#include "knmusicutil.h"
+#include "knmusicpositionclock.h"
+
 #include <QObject>
 
 /*!
@@ -105,6 +108,83 @@ public:
     virtual void setPlaySection(const qint64 &start=-1,
                                 const qint64 &duration=-1)=0;
 
+    /*!
+     * \brief Set the file which will be played after the current file without
+     * any gap. The thread which supports gapless playing should reimplement
+     * this function.
+     * \param filePath The next file path, an empty path clears the next file.
+     * \param start The start position of the section in msecond, -1 for the
+     * whole file.
+     * \param duration The duration of the section in msecond.
+     * \return If the thread could play the file without gap, return true.
+     */
+    virtual bool setNextFile(const QString &filePath,
+                             const qint64 &start=-1,
+                             const qint64 &duration=-1)
+    {
+        Q_UNUSED(filePath)
+        Q_UNUSED(start)
+        Q_UNUSED(duration)
+        return false;
+    }
+
+    /*!
+     * \brief Scale the volume of the thread for fading in and fading out. The
+     * scale is applied on the volume set by setVolume(). The thread which
+     * supports crossfade should reimplement this function.
+     * \param scale The volume scale, from 0.0 to 1.0.
+     */
+    virtual void setFadeVolume(const qreal &scale)
+    {
+        Q_UNUSED(scale)
+    }
+
+    /*!
+     * \brief Scale the volume of the thread for the replay gain of the current
+     * file. The scale is applied together with the fade volume. The thread
+     * which supports replay gain should reimplement this function.
+     * \param scale The volume scale, it could be larger than 1.0.
+     */
+    virtual void setGainVolume(const qreal &scale)
+    {
+        Q_UNUSED(scale)
+    }
+
+    /*!
+     * \brief Get whether the thread could process its samples with the DSP
+     * chain. The thread which supports it should reimplement this function.
+     * \return If the thread supports the DSP chain, return true.
+     */
+    virtual bool isDspSupported()
+    {
+        return false;
+    }
+
+    /*!
+     * \brief Set the parameters of the DSP chain which processes the samples
+     * of the thread. The thread which could process its samples should
+     * reimplement this function.
+     * \param parameters The DSP parameters.
+     */
+    virtual void setDspParameters(
+            const MusicUtil::KNMusicDspParameters &parameters)
+    {
+        Q_UNUSED(parameters)
+    }
+
+    /*!
+     * \brief Get the latest spectrum snapshot of the playing samples. It
+     * should never block the playing. The thread which could analyse its
+     * samples should reimplement this function.
+     * \param bands The band levels, from 0.0 to 1.0.
+     * \return If there's a new snapshot since the last call, return true.
+     */
+    virtual bool spectrum(QVector<float> &bands)
+    {
+        Q_UNUSED(bands)
+        return false;
+    }
+
 signals:
     /*!
      * \brief When load the file failed, this signal will emitted.
@@ -123,11 +203,20 @@ signals:
     void durationChanged(qint64 duration);
 
     /*!
-     * \brief When the file is playing, and the position is changing, this
-     * signal will emitted.
-     * \param position The new position while playing.
+     * \brief When the next file set by setNextFile() starts to play, this
+     * signal will emitted instead of finished().
      */
-    void positionChanged(qint64 position);
+    void nextFileStarted();
+
+    /*!
+     * \brief When the position jumps or the playing rate is changed, this
+     * signal will emitted. The position between two anchors should be
+     * extrapolated by KNMusicPositionClock.
+     * \param position The position at the timestamp.
+     * \param rate The playing rate, 0.0 when the thread is not playing.
+     * \param timestamp The timestamp of the anchor.
+     */
+    void positionAnchorChanged(qint64 position, qreal rate, qint64 timestamp);
 
     /*!
      * \brief When the state of the thread is changed, this signal will emitted.
@@ -168,6 +257,22 @@ public slots:
      * \param position
      */
     virtual void setPosition(const qint64 &position)=0;
+
+protected:
+    /*!
+     * \brief Report the position anchor of the current moment. The playing rate
+     * is decided by the state of the thread, so this should be called after
+     * the state is updated.
+     * \param position The current position in msecond.
+     */
+    void updatePositionAnchor(const qint64 &position)
+    {
+        //Emit the anchor with the current timestamp.
+        emit positionAnchorChanged(
+                    position,
+                    state()==MusicUtil::Playing?1.0:0.0,
+                    KNMusicPositionClock::currentTimestamp());
+    }
 };
 
 #endif // KNMUSICSTANDARDBACKENDTHREAD_H
@@ -759,6 +759,9 @@ KNMusicProxyModel *KNMusicTreeViewBase::proxyModel()
     {
         //Initial the proxy model.
         m_proxyModel=new KNMusicProxyModel(this);
+        //The tree view is only used for displaying, search the model in the
+        //filter thread.
+        m_proxyModel->setAsynchronousSearch(true);
         //Set the search text.
         m_proxyModel->setSearchBlocks(knMusicGlobal->search()->rules());
         //Set the proxy model.
@@ -16,11 +16,33 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 #include <QJsonArray>
+#include <QVector>
+#include <QtMath>
 
 #include "knmusicutil.h"
 
+#define ArtworkSampleSize 64
+#define ArtworkBlurRadius 16
+#define ColorBucketCount 4096
+#define AccentMinimumSaturation 80
+#define AccentMinimumValue 60
+#define AccentMinimumHueDistance 30
+#define HiraganaStart 0x3041
+#define HiraganaEnd 0x3096
+#define KatakanaOffset 0x60
+#define KanaVoicedMark 0x3099
+#define KanaSemiVoicedMark 0x309A
+#define R128ReferenceOffset 5.0
+#define ReplayGainMaximumPreamp 15.0
+
 using namespace MusicUtil;
 
+// in src/qtbase/src/widgets/effects/qpixmapfilter.cpp
+extern Q_DECL_IMPORT void qt_blurImage(QImage &blurImage,
+                                       qreal radius,
+                                       bool quality,
+                                       int transposed = 0);
+
 KNMusicDetailInfo KNMusicUtil::objectToDetailInfo(const QJsonObject &object)
 {
     //Generate a detail info struct.
@@ -53,6 +75,24 @@ KNMusicDetailInfo KNMusicUtil::objectToDetailInfo(const QJsonObject &object)
     detailInfo.duration=object.value("Time").toDouble();
     detailInfo.bitRate=object.value("BitRate").toDouble();
     detailInfo.samplingRate=object.value("SampleRate").toDouble();
+    //Read the replay gain, it only exists when it's known.
+    QJsonObject replayGainObject=object.value("ReplayGain").toObject();
+    if(replayGainObject.contains("TrackGain"))
+    {
+        detailInfo.replayGain.hasTrackGain=true;
+        detailInfo.replayGain.trackGain=
+                replayGainObject.value("TrackGain").toDouble();
+        detailInfo.replayGain.trackPeak=
+                replayGainObject.value("TrackPeak").toDouble();
+    }
+    if(replayGainObject.contains("AlbumGain"))
+    {
+        detailInfo.replayGain.hasAlbumGain=true;
+        detailInfo.replayGain.albumGain=
+                replayGainObject.value("AlbumGain").toDouble();
+        detailInfo.replayGain.albumPeak=
+                replayGainObject.value("AlbumPeak").toDouble();
+    }
     //Retranslate some text for multi-locale support.
     detailInfo.textLists[DateModified]=
             QVariant(KNMusicUtil::dateTimeToText(detailInfo.dateModified));
@@ -94,6 +134,321 @@ QJsonObject KNMusicUtil::detailInfoToObject(const KNMusicDetailInfo &detailInfo)
     object.insert("Time", (double)detailInfo.duration);
     object.insert("BitRate", (double)detailInfo.bitRate);
     object.insert("SampleRate", (double)detailInfo.samplingRate);
+    //Write the replay gain when it's known.
+    if(!detailInfo.replayGain.isNull())
+    {
+        //Generate the replay gain object.
+        QJsonObject replayGainObject;
+        const KNMusicReplayGain &replayGain=detailInfo.replayGain;
+        if(replayGain.hasTrackGain)
+        {
+            replayGainObject.insert("TrackGain", replayGain.trackGain);
+            replayGainObject.insert("TrackPeak", replayGain.trackPeak);
+        }
+        if(replayGain.hasAlbumGain)
+        {
+            replayGainObject.insert("AlbumGain", replayGain.albumGain);
+            replayGainObject.insert("AlbumPeak", replayGain.albumPeak);
+        }
+        object.insert("ReplayGain", replayGainObject);
+    }
     //Object translated complete.
     return object;
 }
+
+KNMusicArtworkStyle KNMusicUtil::generateArtworkStyle(const QImage &artwork)
+{
+    //Prepare the style.
+    KNMusicArtworkStyle style;
+    //Check the artwork first.
+    if(artwork.isNull())
+    {
+        //Give back a null style.
+        return style;
+    }
+    //Scale the artwork to a small sample, all the analysis will be done on the
+    //sample image.
+    QImage sample=artwork.scaled(ArtworkSampleSize,
+                                 ArtworkSampleSize,
+                                 Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation).convertToFormat(
+                QImage::Format_ARGB32);
+    //Quantize the colours into buckets, 4 bits for each channel. Count the
+    //pixels and sum the colours of each bucket.
+    QVector<int> bucketCount(ColorBucketCount, 0),
+                 bucketRed(ColorBucketCount, 0),
+                 bucketGreen(ColorBucketCount, 0),
+                 bucketBlue(ColorBucketCount, 0);
+    int pixelCount=0;
+    for(int y=0; y<sample.height(); ++y)
+    {
+        //Get the pixel line.
+        const QRgb *line=reinterpret_cast<const QRgb *>(sample.constScanLine(y));
+        for(int x=0; x<sample.width(); ++x)
+        {
+            //Ignore the transparent pixels.
+            if(qAlpha(line[x])<128)
+            {
+                continue;
+            }
+            //Calculate the bucket index.
+            int red=qRed(line[x]), green=qGreen(line[x]), blue=qBlue(line[x]),
+                bucket=((red>>4)<<8) | ((green>>4)<<4) | (blue>>4);
+            //Add the pixel to the bucket.
+            ++bucketCount[bucket];
+            bucketRed[bucket]+=red;
+            bucketGreen[bucket]+=green;
+            bucketBlue[bucket]+=blue;
+            ++pixelCount;
+        }
+    }
+    //Check the pixel count.
+    if(pixelCount==0)
+    {
+        //The whole image is transparent.
+        return style;
+    }
+    //The dominant colour is the average colour of the largest bucket.
+    int dominantBucket=0;
+    for(int i=1; i<ColorBucketCount; ++i)
+    {
+        if(bucketCount.at(i)>bucketCount.at(dominantBucket))
+        {
+            dominantBucket=i;
+        }
+    }
+    int dominantCount=bucketCount.at(dominantBucket);
+    style.dominantColor=QColor(bucketRed.at(dominantBucket)/dominantCount,
+                               bucketGreen.at(dominantBucket)/dominantCount,
+                               bucketBlue.at(dominantBucket)/dominantCount);
+    //The accent colour is the most vivid common colour, which should be
+    //different from the dominant colour.
+    bool dominantChromatic=
+            style.dominantColor.hsvSaturation()>=AccentMinimumSaturation;
+    int dominantHue=style.dominantColor.hsvHue(), accentScore=0,
+        minimumCount=qMax(1, pixelCount/100);
+    for(int i=0; i<ColorBucketCount; ++i)
+    {
+        //Ignore the rare colours.
+        int count=bucketCount.at(i);
+        if(count<minimumCount)
+        {
+            continue;
+        }
+        //Get the average colour of the bucket.
+        QColor color(bucketRed.at(i)/count,
+                     bucketGreen.at(i)/count,
+                     bucketBlue.at(i)/count);
+        //Ignore the grey and dark colours.
+        if(color.hsvSaturation()<AccentMinimumSaturation ||
+                color.value()<AccentMinimumValue)
+        {
+            continue;
+        }
+        //Ignore the colours which are too close to the dominant colour.
+        if(dominantChromatic)
+        {
+            int hueDistance=qAbs(color.hsvHue()-dominantHue);
+            if(qMin(hueDistance, 360-hueDistance)<AccentMinimumHueDistance)
+            {
+                continue;
+            }
+        }
+        //Save the colour which has the highest score.
+        int score=count*color.hsvSaturation();
+        if(score>accentScore)
+        {
+            accentScore=score;
+            style.accentColor=color;
+        }
+    }
+    //If there's no vivid colour, use a variant of the dominant colour.
+    if(!style.accentColor.isValid())
+    {
+        style.accentColor=style.dominantColor.lightness()<128?
+                    style.dominantColor.lighter(160):
+                    style.dominantColor.darker(160);
+    }
+    //Blur the sample image for the background.
+    style.background=sample.convertToFormat(
+                QImage::Format_ARGB32_Premultiplied);
+    qt_blurImage(style.background, ArtworkBlurRadius, true);
+    //Give back the style.
+    return style;
+}
+
+QString KNMusicUtil::searchKey(const QString &text)
+{
+    //Check whether there's any non-ASCII character.
+    bool ascii=true;
+    for(auto i : text)
+    {
+        if(i.unicode()>0x7F)
+        {
+            ascii=false;
+            break;
+        }
+    }
+    //The ASCII text only needs to fold the case.
+    if(ascii)
+    {
+        return text.toCaseFolded();
+    }
+    //Decompose the text, the full-width letters become the ASCII ones, the
+    //half-width kana become the full-width ones, and the accents are split
+    //from the letters.
+    QString key=text.normalized(QString::NormalizationForm_KD);
+    //Remove the accents, fold the kana.
+    QChar *keyData=key.data();
+    int keyLength=0;
+    bool kanaMarked=false;
+    for(int i=0, length=key.size(); i<length; ++i)
+    {
+        //Get the character.
+        QChar character=keyData[i];
+        ushort code=character.unicode();
+        //Skip the accents, but keep the voiced sound marks of the kana, or
+        //else the voiced kana will be the same as the unvoiced one.
+        if(code==KanaVoicedMark || code==KanaSemiVoicedMark)
+        {
+            kanaMarked=true;
+        }
+        else if(character.category()==QChar::Mark_NonSpacing)
+        {
+            continue;
+        }
+        //Fold the hiragana to the katakana.
+        if(code>=HiraganaStart && code<=HiraganaEnd)
+        {
+            character=QChar(code+KatakanaOffset);
+        }
+        //Save the character.
+        keyData[keyLength++]=character;
+    }
+    key.truncate(keyLength);
+    //Compose the voiced kana back to single characters. The accents are
+    //removed, so only the kana could be composed.
+    if(kanaMarked)
+    {
+        key=key.normalized(QString::NormalizationForm_C);
+    }
+    //Fold the case.
+    return key.toCaseFolded();
+}
+
+void KNMusicUtil::updateSearchKeys(MusicUtil::KNMusicDetailInfo &detailInfo)
+{
+    //Generate the key list.
+    QStringList searchKeys;
+    searchKeys.reserve(MusicDataCount);
+    //Generate the keys of all the text columns.
+    for(int i=0; i<MusicDataCount; ++i)
+    {
+        searchKeys.append(searchKey(detailInfo.textLists[i].toString()));
+    }
+    //Save the keys.
+    detailInfo.searchKeys=searchKeys;
+}
+
+bool KNMusicUtil::parseReplayGain(const QString &key,
+                                  const QString &value,
+                                  KNMusicReplayGain &replayGain)
+{
+    //Get the upper case key.
+    QString upperKey=key.trimmed().toUpper();
+    //Check the key prefix first, most of the tags are not loudness tags.
+    if(!upperKey.startsWith("REPLAYGAIN_") && !upperKey.startsWith("R128_"))
+    {
+        return false;
+    }
+    //The R128 gain is a Q7.8 fixed point integer relative to -23 LUFS.
+    if(upperKey=="R128_TRACK_GAIN" || upperKey=="R128_ALBUM_GAIN")
+    {
+        //Translate the value.
+        bool isInt;
+        int rawGain=value.trimmed().toInt(&isInt);
+        if(!isInt)
+        {
+            return false;
+        }
+        //Translate the gain to the ReplayGain reference level, -18 LUFS.
+        qreal gain=(qreal)rawGain/256.0+R128ReferenceOffset;
+        //Save the gain.
+        if(upperKey=="R128_TRACK_GAIN")
+        {
+            replayGain.trackGain=gain;
+            replayGain.hasTrackGain=true;
+        }
+        else
+        {
+            replayGain.albumGain=gain;
+            replayGain.hasAlbumGain=true;
+        }
+        return true;
+    }
+    //The ReplayGain value is a text like "-6.54 dB" or "0.988553".
+    QString numberText=value.trimmed();
+    //Remove the unit of the gain.
+    if(numberText.endsWith("dB", Qt::CaseInsensitive))
+    {
+        numberText.chop(2);
+    }
+    //Translate the value.
+    bool isNumber;
+    qreal number=numberText.trimmed().toDouble(&isNumber);
+    if(!isNumber)
+    {
+        return false;
+    }
+    //Save the value according to the key.
+    if(upperKey=="REPLAYGAIN_TRACK_GAIN")
+    {
+        replayGain.trackGain=number;
+        replayGain.hasTrackGain=true;
+    }
+    else if(upperKey=="REPLAYGAIN_TRACK_PEAK")
+    {
+        replayGain.trackPeak=number;
+    }
+    else if(upperKey=="REPLAYGAIN_ALBUM_GAIN")
+    {
+        replayGain.albumGain=number;
+        replayGain.hasAlbumGain=true;
+    }
+    else if(upperKey=="REPLAYGAIN_ALBUM_PEAK")
+    {
+        replayGain.albumPeak=number;
+    }
+    else
+    {
+        //Unknown ReplayGain tag, e.g. REPLAYGAIN_REFERENCE_LOUDNESS.
+        return false;
+    }
+    return true;
+}
+
+qreal KNMusicUtil::replayGainScale(const KNMusicReplayGain &replayGain,
+                                   int mode,
+                                   qreal preamp)
+{
+    //Check whether the replay gain is enabled and known.
+    if(mode==ReplayGainOff || replayGain.isNull())
+    {
+        return 1.0;
+    }
+    //Pick the gain and the peak according to the mode.
+    bool useAlbum=(mode==ReplayGainAlbum && replayGain.hasAlbumGain) ||
+            !replayGain.hasTrackGain;
+    qreal gain=useAlbum?replayGain.albumGain:replayGain.trackGain,
+          peak=useAlbum?replayGain.albumPeak:replayGain.trackPeak;
+    //Translate the gain to the linear scale.
+    qreal scale=qPow(10.0, (gain+qBound(-ReplayGainMaximumPreamp,
+                                        preamp,
+                                        ReplayGainMaximumPreamp))/20.0);
+    //Prevent clipping, the peak after scaled shouldn't be larger than 1.0.
+    if(peak>0.0 && scale*peak>1.0)
+    {
+        scale=1.0/peak;
+    }
+    return scale;
+}
@@ -20,8 +20,10 @@
 #define KNMUSICUTIL
 
 #include <QString>
+#include <QStringList>
 #include <QDateTime>
 #include <QImage>
+#include <QColor>
 #include <QMap>
 #include <QList>
 #include <QByteArray>
@@ -118,10 +120,87 @@ namespace MusicUtil
         Shuffle,
         LoopCount
     };
+    enum KNMusicCrossfadeCurve
+    {
+        CrossfadeLinear,
+        CrossfadeEqualPower,
+        CrossfadeSmooth,
+        CrossfadeCurveCount
+    };
+    enum KNMusicReplayGainMode
+    {
+        ReplayGainOff,
+        ReplayGainTrack,
+        ReplayGainAlbum,
+        ReplayGainModeCount
+    };
+    enum KNMusicEqualizerBand
+    {
+        Equalizer31Hz,
+        Equalizer62Hz,
+        Equalizer125Hz,
+        Equalizer250Hz,
+        Equalizer500Hz,
+        Equalizer1kHz,
+        Equalizer2kHz,
+        Equalizer4kHz,
+        Equalizer8kHz,
+        Equalizer16kHz,
+        EqualizerBandCount
+    };
+    struct KNMusicDspParameters
+    {
+        //The gains of the equalizer bands and the preamp in dB. The balance is
+        //from -1.0 (left only) to 1.0 (right only).
+        qreal bandGains[EqualizerBandCount];
+        qreal preamp;
+        qreal balance;
+        bool equalizerEnabled;
+        bool limiterEnabled;
+        KNMusicDspParameters() :
+            preamp(0.0),
+            balance(0.0),
+            equalizerEnabled(false),
+            limiterEnabled(false)
+        {
+            //Reset all the band gains.
+            for(int i=0; i<EqualizerBandCount; ++i)
+            {
+                bandGains[i]=0.0;
+            }
+        }
+    };
+    struct KNMusicReplayGain
+    {
+        //The gain in dB and the peak in linear sample scale. When the peak is
+        //unknown, it will be 0.0.
+        qreal trackGain;
+        qreal trackPeak;
+        qreal albumGain;
+        qreal albumPeak;
+        bool hasTrackGain;
+        bool hasAlbumGain;
+        KNMusicReplayGain() :
+            trackGain(0.0),
+            trackPeak(0.0),
+            albumGain(0.0),
+            albumPeak(0.0),
+            hasTrackGain(false),
+            hasAlbumGain(false)
+        {
+        }
+        bool isNull() const
+        {
+            return !hasTrackGain && !hasAlbumGain;
+        }
+    };
     struct KNMusicDetailInfo
     {
         //Tag datas.
         QVariant textLists[MusicDataCount];
+        //The normalised text of the tag datas for searching, generated by the
+        //music model.
+        QStringList searchKeys;
         QString fileName;           //Properties.
         QString filePath;
         QString trackFilePath;
@@ -136,9 +215,11 @@ namespace MusicUtil
         quint32 bitRate;
         quint32 samplingRate;
         qint32 trackIndex;
+        KNMusicReplayGain replayGain;   //Loudness normalisation.
         bool cannotPlay;            //The cannot playing flag.
         //Initial the values
         KNMusicDetailInfo():
+            searchKeys(QStringList()),
             fileName(QString()),
             filePath(QString()),
             trackFilePath(QString()),
@@ -153,6 +234,7 @@ namespace MusicUtil
             bitRate(0),
             samplingRate(0),
             trackIndex(-1),
+            replayGain(KNMusicReplayGain()),
             cannotPlay(false)
         {
         }
@@ -164,12 +246,56 @@ namespace MusicUtil
                     trackIndex==value.trackIndex;
         }
     };
+    struct KNMusicArtworkLocation
+    {
+        //The position and the size of the raw album art data in the file.
+        qint64 offset;
+        qint64 size;
+        KNMusicArtworkLocation() :
+            offset(-1),
+            size(0)
+        {
+        }
+        KNMusicArtworkLocation(qint64 dataOffset, qint64 dataSize) :
+            offset(dataOffset),
+            size(dataSize)
+        {
+        }
+    };
+    struct KNMusicArtworkStyle
+    {
+        //The most common colour and a vivid colour picked from the artwork.
+        QColor dominantColor;
+        QColor accentColor;
+        //A small blurred artwork for painting backgrounds.
+        QImage background;
+        KNMusicArtworkStyle() :
+            dominantColor(QColor()),
+            accentColor(QColor()),
+            background(QImage())
+        {
+        }
+        bool isNull() const
+        {
+            return background.isNull();
+        }
+    };
     struct KNMusicAnalysisItem
     {
         KNMusicDetailInfo detailInfo;
         //Album art data.
         QMap<QString, QList<QByteArray>> imageData;
+        //Album art data positions in the music file, the data will be read to
+        //the image data when parsing the album art.
+        QMap<QString, QList<KNMusicArtworkLocation>> imageLocations;
         QImage coverImage;
+        //When the flag is set, the tag parsers only record the position of the
+        //album art instead of copying the raw data.
+        bool deferAlbumArt;
+        KNMusicAnalysisItem() :
+            deferAlbumArt(false)
+        {
+        }
     };
     struct KNMusicListTrackDetailInfo
     {
@@ -197,28 +323,55 @@ namespace MusicUtil
         //Track list.
         QList<KNMusicListTrackDetailInfo> trackList;
     };
+    enum KNMusicSearchComparison
+    {
+        SearchContains,
+        SearchEqual,
+        SearchLess,
+        SearchLessEqual,
+        SearchGreater,
+        SearchGreaterEqual,
+        SearchRange
+    };
     struct KNMusicSearchBlock
     {
-        //Value of the block.
+        //Value of the block, for a range it is the minimum value.
         QVariant value;
+        //The maximum value of a range.
+        QVariant maximum;
         //Index of the column or the role.
         int index;
+        //How to compare the data with the value.
+        int comparison;
+        //The blocks which have the same group number matches when any of them
+        //matches, -1 means the block is a group itself.
+        int group;
         //Actually there's two kinds of data, so using a bool to check the
         //whether the index means a column or a property.
         bool isColumn;
+        //Reverse the result of the block.
+        bool isNegative;
         //Initial value.
         KNMusicSearchBlock():
             value(QVariant()),
+            maximum(QVariant()),
             index(-1),
-            isColumn(true)
+            comparison(SearchContains),
+            group(-1),
+            isColumn(true),
+            isNegative(false)
         {
         }
 
         bool operator ==(const KNMusicSearchBlock &block) const
         {
             return index==block.index &&
+                    comparison==block.comparison &&
+                    group==block.group &&
                     isColumn==block.isColumn &&
-                    value==block.value;
+                    isNegative==block.isNegative &&
+                    value==block.value &&
+                    maximum==block.maximum;
         }
     };
 }
@@ -344,6 +497,64 @@ public:
     static QJsonObject detailInfoToObject(
             const MusicUtil::KNMusicDetailInfo &detailInfo);
 
+    /*!
+     * \brief Generate the colours and the blurred background from an artwork.
+     * This function only uses QImage, it could be called in any thread. It is
+     * used to prepare the style before the artwork is displayed, so the widgets
+     * don't need to analysis the image in the GUI thread.
+     * \param artwork The artwork image.
+     * \return The artwork style. It will be a null style if the image is null.
+     */
+    static MusicUtil::KNMusicArtworkStyle generateArtworkStyle(
+            const QImage &artwork);
+
+    /*!
+     * \brief Generate the normalised search key of a text. The compatibility
+     * characters are decomposed, the accents are removed, the case is folded
+     * and the hiragana are folded to katakana. So 'Beyonce' matches
+     * 'Beyonc\u00e9', and the full-width and half-width letters are the same.
+     * The voiced sound marks of the kana are kept, so the voiced kana doesn't
+     * match the unvoiced one.
+     * \param text The text.
+     * \return The search key of the text.
+     */
+    static QString searchKey(const QString &text);
+
+    /*!
+     * \brief Generate the search keys of all the text columns of a detail info.
+     * \param detailInfo The detail info.
+     */
+    static void updateSearchKeys(MusicUtil::KNMusicDetailInfo &detailInfo);
+
+    /*!
+     * \brief Parse a loudness tag, the ReplayGain tags
+     * (REPLAYGAIN_TRACK_GAIN, REPLAYGAIN_TRACK_PEAK, REPLAYGAIN_ALBUM_GAIN and
+     * REPLAYGAIN_ALBUM_PEAK) and the R128 tags (R128_TRACK_GAIN and
+     * R128_ALBUM_GAIN) are supported. The R128 gain is translated to the
+     * ReplayGain reference level.
+     * \param key The key of the tag, it's case insensitive.
+     * \param value The text value of the tag.
+     * \param replayGain The replay gain which will be updated.
+     * \return If the key is a loudness tag and the value is valid, return true.
+     */
+    static bool parseReplayGain(const QString &key,
+                                const QString &value,
+                                MusicUtil::KNMusicReplayGain &replayGain);
+
+    /*!
+     * \brief Calculate the volume scale of a replay gain. The scale is limited
+     * by the peak to prevent clipping.
+     * \param replayGain The replay gain.
+     * \param mode The replay gain mode. For album mode, when the album gain is
+     * unknown, the track gain will be used.
+     * \param preamp The pre-amplification in dB.
+     * \return The linear volume scale. When the replay gain is disabled or
+     * unknown, it will be 1.0.
+     */
+    static qreal replayGainScale(const MusicUtil::KNMusicReplayGain &replayGain,
+                                 int mode,
+                                 qreal preamp);
+
 private:
     KNMusicUtil();
     KNMusicUtil(const KNMusicUtil &);
@@ -372,6 +583,28 @@ inline QDataStream &operator <<(QDataStream &out,
     return out;
 }
 
+inline QDataStream &operator <<(QDataStream &out,
+                                const MusicUtil::KNMusicReplayGain &replayGain)
+{
+    //Output the gain and the peak.
+    out << replayGain.trackGain << replayGain.trackPeak
+        << replayGain.albumGain << replayGain.albumPeak
+        << replayGain.hasTrackGain << replayGain.hasAlbumGain;
+    //Give the stream back.
+    return out;
+}
+
+inline QDataStream &operator >>(QDataStream &in,
+                                MusicUtil::KNMusicReplayGain &replayGain)
+{
+    //Input the gain and the peak.
+    in >> replayGain.trackGain >> replayGain.trackPeak
+       >> replayGain.albumGain >> replayGain.albumPeak
+       >> replayGain.hasTrackGain >> replayGain.hasAlbumGain;
+    //Give the stream back.
+    return in;
+}
+
 inline QDataStream &operator >>(QDataStream &in,
                                 MusicUtil::KNMusicDetailInfo &detailInfo)
 {
@@ -143,8 +143,10 @@ macx: {
 }
 
 linux: {
-    # Enable the backend and analysiser.
-    CONFIG += backend-gstreamer analysiser-ffmpeg i18n
+    # Enable the backend and analysiser. The native FFMpeg backend could be
+    # enabled instead of GStreamer with "qmake CONFIG+=backend-ffmpeg".
+    !backend-ffmpeg: CONFIG += backend-gstreamer
+    CONFIG += analysiser-ffmpeg i18n
     # Set the destination directory for the Linux special.
     DESTDIR = ../bin
     # This options is added for Linux specially.
@@ -221,6 +223,34 @@ backend-bass: {
         plugin/knmusicplugin/plugin/knmusicbackendbass/knmusicbassanalysiser.h
 }
 
+backend-ffmpeg: {
+    # Check whether there's a backend enabled already
+    contains(DEFINES, BACKEND_ENABLED){
+        error("You can't enable more than one backend at the same time.")
+    }
+    # Define the backend enabled flag.
+    DEFINES += ENABLE_BACKEND_FFMPEG BACKEND_ENABLED
+    # Add backend library to the project.
+    LIBS += -lavformat -lavcodec -lavutil
+    # Use PulseAudio as the output under Linux, or else the null sink is used.
+    linux: {
+        DEFINES += ENABLE_PULSEAUDIO_OUTPUT
+        CONFIG += link_pkgconfig
+        PKGCONFIG += libpulse-simple
+    }
+    # Add backend files to the project.
+    SOURCES += \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicbackendffmpeg.cpp \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicbackendffmpegthread.cpp \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicffmpegdecoder.cpp \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicffmpegoutput.cpp
+    HEADERS += \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicbackendffmpeg.h \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicbackendffmpegthread.h \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicffmpegdecoder.h \
+        plugin/knmusicplugin/plugin/knmusicbackendffmpeg/knmusicffmpegoutput.h
+}
+
 # Analysiser Specific Configuration
 analysiser-ffmpeg: {
     # Add libraries.
@@ -311,6 +341,9 @@ SOURCES += \
     plugin/knmusicplugin/plugin/knmusicplaylist/sdk/knmusicplaylistmanager.cpp \
     plugin/knmusicplugin/plugin/knmusicplaylist/sdk/knmusicplaylistengine.cpp \
     plugin/knmusicplugin/plugin/knmusicplaylist/sdk/knmusicplaylistlistmodel.cpp \
+    plugin/knmusicplugin/sdk/knmusicpositionclock.cpp \
+    plugin/knmusicplugin/sdk/knmusicproxyfilter.cpp \
+    plugin/knmusicplugin/sdk/knmusicsearchplan.cpp \
     plugin/knmusicplugin/sdk/knmusicproxymodel.cpp \
     plugin/knmusicplugin/plugin/knmusicplaylist/sdk/knmusicplaylistindexdelegate.cpp \
     plugin/knmusicplugin/sdk/knmusicratingdelegate.cpp \
@@ -327,6 +360,15 @@ SOURCES += \
     plugin/knmusicplugin/plugin/knmusictagapev2/knmusictagapev2.cpp \
     plugin/knmusicplugin/sdk/knmusicsearcher.cpp \
     plugin/knmusicplugin/sdk/knmusicanalysisqueue.cpp \
+    plugin/knmusicplugin/sdk/knmusicloudnessmeter.cpp \
+    plugin/knmusicplugin/sdk/knmusicsampleringbuffer.cpp \
+    plugin/knmusicplugin/sdk/knmusicdspequalizer.cpp \
+    plugin/knmusicplugin/sdk/knmusicdspgain.cpp \
+    plugin/knmusicplugin/sdk/knmusicdsplimiter.cpp \
+    plugin/knmusicplugin/sdk/knmusicdspchain.cpp \
+    plugin/knmusicplugin/sdk/knmusicdsppanel.cpp \
+    plugin/knmusicplugin/sdk/knmusicplaybackpanel.cpp \
+    plugin/knmusicplugin/sdk/knmusicspectrumanalyser.cpp \
     plugin/knmusicplugin/plugin/knmusicheaderplayer/knmusicheaderplayer.cpp \
     sdk/knhighlightlabel.cpp \
     sdk/knscrolllabel.cpp \
@@ -374,7 +416,9 @@ SOURCES += \
     plugin/knmusicplugin/plugin/knmusicmainplayer/knmusicmainplayercontent.cpp \
     plugin/knmusicplugin/sdk/knmusiclibrarybase.cpp \
     plugin/knmusicplugin/plugin/knmusiclibrary/knmusiclibrary.cpp \
+    plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibraryimagecache.cpp \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibraryimagemanager.cpp \
+    plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibraryloudnessscanner.cpp \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibrarymodel.cpp \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibrarytab.cpp \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibrarysongtab.cpp \
@@ -407,6 +451,7 @@ SOURCES += \
     plugin/knmusicplugin/plugin/knmusiclyricsdownloaddialog/knmusiclyricsdetaillistmodel.cpp \
     plugin/knmusicplugin/sdk/knmusiconlinelyricsdownloader.cpp \
     plugin/knmusicplugin/plugin/knmusicmainplayer/knmusiccodeclabel.cpp \
+    plugin/knmusicplugin/plugin/knmusicmainplayer/knmusicspectrumview.cpp \
     plugin/knmusicplugin/plugin/knmusicmainplayer/knmusicmainplayercontentswitcher.cpp \
     sdk/knlabelbutton.cpp \
     plugin/knmusicplugin/sdk/knmusiccategorysearch.cpp \
@@ -524,6 +569,9 @@ HEADERS += \
     plugin/knmusicplugin/plugin/knmusicplaylist/sdk/knmusicplaylistparser.h \
     plugin/knmusicplugin/plugin/knmusicplaylist/sdk/knmusicplaylistengine.h \
     plugin/knmusicplugin/plugin/knmusicplaylist/sdk/knmusicplaylistlistmodel.h \
+    plugin/knmusicplugin/sdk/knmusicpositionclock.h \
+    plugin/knmusicplugin/sdk/knmusicproxyfilter.h \
+    plugin/knmusicplugin/sdk/knmusicsearchplan.h \
     plugin/knmusicplugin/sdk/knmusicproxymodel.h \
     plugin/knmusicplugin/sdk/knmusicnowplayingbase.h \
     plugin/knmusicplugin/sdk/knmusicbackend.h \
@@ -544,6 +592,16 @@ HEADERS += \
     plugin/knmusicplugin/plugin/knmusictagapev2/knmusictagapev2.h \
     plugin/knmusicplugin/sdk/knmusicsearcher.h \
     plugin/knmusicplugin/sdk/knmusicanalysisqueue.h \
+    plugin/knmusicplugin/sdk/knmusicloudnessmeter.h \
+    plugin/knmusicplugin/sdk/knmusicsampleringbuffer.h \
+    plugin/knmusicplugin/sdk/knmusicdspprocessor.h \
+    plugin/knmusicplugin/sdk/knmusicdspequalizer.h \
+    plugin/knmusicplugin/sdk/knmusicdspgain.h \
+    plugin/knmusicplugin/sdk/knmusicdsplimiter.h \
+    plugin/knmusicplugin/sdk/knmusicdspchain.h \
+    plugin/knmusicplugin/sdk/knmusicdsppanel.h \
+    plugin/knmusicplugin/sdk/knmusicplaybackpanel.h \
+    plugin/knmusicplugin/sdk/knmusicspectrumanalyser.h \
     plugin/knmusicplugin/sdk/knmusicheaderplayerbase.h \
     plugin/knmusicplugin/plugin/knmusicheaderplayer/knmusicheaderplayer.h \
     sdk/knhighlightlabel.h \
@@ -597,7 +655,9 @@ HEADERS += \
     plugin/knmusicplugin/plugin/knmusicmainplayer/knmusicmainplayercontent.h \
     plugin/knmusicplugin/sdk/knmusiclibrarybase.h \
     plugin/knmusicplugin/plugin/knmusiclibrary/knmusiclibrary.h \
+    plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibraryimagecache.h \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibraryimagemanager.h \
+    plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibraryloudnessscanner.h \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibrarymodel.h \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibrarytab.h \
     plugin/knmusicplugin/plugin/knmusiclibrary/sdk/knmusiclibrarysongtab.h \
@@ -632,6 +692,7 @@ HEADERS += \
     plugin/knmusicplugin/plugin/knmusiclyricsdownloaddialog/knmusiclyricsdetaillistmodel.h \
     plugin/knmusicplugin/sdk/knmusiconlinelyricsdownloader.h \
     plugin/knmusicplugin/plugin/knmusicmainplayer/knmusiccodeclabel.h \
+    plugin/knmusicplugin/plugin/knmusicmainplayer/knmusicspectrumview.h \
     plugin/knmusicplugin/plugin/knmusicmainplayer/knmusicmainplayercontentswitcher.h \
     sdk/knlabelbutton.h \
     sdk/knplatformextras.h \
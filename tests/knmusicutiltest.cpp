@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) Kreogist Dev Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include <QtTest>
+
+#include "knmusicutil.h"
+
+class KNMusicUtilTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void searchKey_data();
+    void searchKey();
+    void voicedKanaSearchKey_data();
+    void voicedKanaSearchKey();
+};
+
+void KNMusicUtilTest::searchKey_data()
+{
+    //The texts which should have the same key.
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("key");
+    QTest::newRow("case") << QString("ABBA") << QString("abba");
+    QTest::newRow("accent") << QString::fromUtf8("Beyoncé")
+                            << QString("beyonce");
+    QTest::newRow("full width") << QString::fromUtf8("ＡＢＣ")
+                                << QString("abc");
+    QTest::newRow("hiragana") << QString::fromUtf8("ぱっぷす")
+                              << QString::fromUtf8("パップス");
+    QTest::newRow("half width voiced kana")
+            << QString::fromUtf8("ｶﾞ")
+            << QString::fromUtf8("ガ");
+}
+
+void KNMusicUtilTest::searchKey()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, key);
+    QCOMPARE(KNMusicUtil::searchKey(text), key);
+}
+
+void KNMusicUtilTest::voicedKanaSearchKey_data()
+{
+    //The voiced kana and the unvoiced kana which shouldn't match.
+    QTest::addColumn<QString>("voiced");
+    QTest::addColumn<QString>("unvoiced");
+    QTest::newRow("ga and ka") << QString::fromUtf8("ガ")
+                               << QString::fromUtf8("カ");
+    QTest::newRow("band and hand")
+            << QString::fromUtf8("バンド")
+            << QString::fromUtf8("ハンド");
+    QTest::newRow("hiragana pa and ha") << QString::fromUtf8("ぱ")
+                                        << QString::fromUtf8("は");
+}
+
+void KNMusicUtilTest::voicedKanaSearchKey()
+{
+    QFETCH(QString, voiced);
+    QFETCH(QString, unvoiced);
+    QVERIFY(KNMusicUtil::searchKey(voiced)!=KNMusicUtil::searchKey(unvoiced));
+    QVERIFY(!KNMusicUtil::searchKey(voiced).contains(
+                KNMusicUtil::searchKey(unvoiced)));
+}
+
+QTEST_APPLESS_MAIN(KNMusicUtilTest)
+
+#include "knmusicutiltest.moc"
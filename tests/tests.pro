@@ -0,0 +1,45 @@
+# Copyright (C) Kreogist Dev Team
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+# The unit tests of the code which doesn't need the application, run them with
+# "make check".
+TEMPLATE = app
+TARGET = mu-tests
+
+# Add Qt modules, the music utilities need the image and the blur effect.
+QT += \
+    core \
+    gui \
+    widgets \
+    testlib
+
+# Enabled C++ 11 configures.
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+# The tested code is compiled from the main project.
+MUSIC_SDK = ../src/plugin/knmusicplugin/sdk
+
+INCLUDEPATH += \
+    $$MUSIC_SDK
+
+# Source and Headers.
+SOURCES += \
+    knmusicutiltest.cpp \
+    $$MUSIC_SDK/knmusicutil.cpp
+
+HEADERS += \
+    $$MUSIC_SDK/knmusicutil.h